@@ -0,0 +1,147 @@
+// Throughput of every hash kernel this CPU supports. Each kernel is first
+// checked against the scalar code, then run on same-length candidates for a
+// fixed time; the report gives hashes per second and the speedup over scalar.
+// With -w the wordlist splitter is timed on a real file too, for comparison.
+#include "../lib/hash_kernels.h"
+#include "../lib/mapped_wordlist.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [-t seconds] [-l length] [-w wordlist]\n"
+              << "  -t S   time per kernel in seconds (default 0.5)\n"
+              << "  -l N   candidate length, 1 to 55 (default 8)\n"
+              << "  -w F   also time splitting wordlist F into candidates\n";
+}
+
+// Same candidates through the kernel and through hashOne
+static bool matchesScalar(const Oroto::HashKernel& kernel, size_t length) {
+    std::vector<std::string> messages;
+    const uint8_t* pointers[Oroto::MAX_KERNEL_LANES];
+    for (size_t lane = 0; lane < kernel.lanes; ++lane) {
+        messages.emplace_back(length, static_cast<char>('a' + lane));
+        pointers[lane] = reinterpret_cast<const uint8_t*>(messages.back().data());
+    }
+    uint8_t digests[Oroto::MAX_KERNEL_LANES * Oroto::MAX_DIGEST_SIZE];
+    kernel.run(pointers, length, digests);
+    size_t size = Oroto::digestSize(kernel.algorithm);
+    for (size_t lane = 0; lane < kernel.lanes; ++lane) {
+        uint8_t expected[Oroto::MAX_DIGEST_SIZE];
+        Oroto::hashOne(kernel.algorithm, messages[lane], expected);
+        if (std::memcmp(expected, digests + lane * size, size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double measure(const Oroto::HashKernel& kernel, size_t length, double seconds) {
+    uint8_t buffers[Oroto::MAX_KERNEL_LANES][Oroto::MAX_BLOCK_MESSAGE] = {};
+    const uint8_t* pointers[Oroto::MAX_KERNEL_LANES];
+    for (size_t lane = 0; lane < kernel.lanes; ++lane) {
+        std::memset(buffers[lane], 'a' + static_cast<int>(lane), length);
+        pointers[lane] = buffers[lane];
+    }
+    uint8_t digests[Oroto::MAX_KERNEL_LANES * Oroto::MAX_DIGEST_SIZE];
+    uint64_t hashes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int round = 0; round < 1024; ++round) {
+            // Change the candidates the way an enumerator would
+            buffers[0][0] = static_cast<uint8_t>(round);
+            kernel.run(pointers, length, digests);
+        }
+        hashes += 1024 * kernel.lanes;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < seconds);
+    return static_cast<double>(hashes) / elapsed;
+}
+
+// Candidates per second the splitter delivers from a mapped wordlist, best
+// of a few passes so the first one's page faults do not count
+static bool measureWordlist(const std::string& path) {
+    Oroto::MappedWordlist wordlist;
+    if (!wordlist.open(path)) {
+        std::cerr << "Cannot map wordlist: " << path << "\n";
+        return false;
+    }
+    const char* begin = wordlist.text().data();
+    uint64_t lines = 0;
+    uint64_t checksum = 0;
+    double best = 0.0;
+    for (int pass = 0; pass < 3; ++pass) {
+        lines = 0;
+        const auto start = std::chrono::steady_clock::now();
+        Oroto::forEachLine(begin, begin + wordlist.size(), [&](std::string_view word) {
+            ++lines;
+            checksum += word.size();
+            return false;
+        });
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (pass == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    std::cout << "\nWordlist " << path << ": " << lines << " candidates, " << std::fixed << std::setprecision(2)
+              << wordlist.size() / best / 1e6 << " MB/s, " << lines / best / 1e6 << " M candidates/s"
+              << (checksum == 0 ? " (empty)" : "") << "\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = 0.5;
+    size_t length = 8;
+    std::string wordlist;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            length = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            wordlist = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (seconds <= 0.0 || length == 0 || length > Oroto::MAX_BLOCK_MESSAGE) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::cout << "Candidate length " << length << ", " << seconds << " s per kernel\n\n"
+              << std::left << std::setw(10) << "Algorithm" << std::setw(9) << "Kernel" << std::right
+              << std::setw(6) << "Lanes" << std::setw(14) << "MH/s" << std::setw(10) << "Speedup" << "\n";
+
+    int failures = 0;
+    const Oroto::HashAlgorithm algorithms[] = {Oroto::HashAlgorithm::MD5, Oroto::HashAlgorithm::SHA1,
+                                               Oroto::HashAlgorithm::SHA256};
+    for (Oroto::HashAlgorithm algorithm : algorithms) {
+        double scalarRate = 0.0;
+        for (const Oroto::HashKernel* kernel : Oroto::hashKernels(algorithm)) {
+            std::cout << std::left << std::setw(10) << Oroto::hashAlgorithmName(algorithm) << std::setw(9)
+                      << kernel->name << std::right << std::setw(6) << kernel->lanes;
+            if (!matchesScalar(*kernel, length)) {
+                std::cout << "  WRONG DIGESTS\n";
+                ++failures;
+                continue;
+            }
+            double rate = measure(*kernel, length, seconds);
+            if (kernel->lanes == 1) {
+                scalarRate = rate;
+            }
+            std::cout << std::fixed << std::setprecision(2) << std::setw(14) << rate / 1e6 << std::setw(9)
+                      << (scalarRate > 0.0 ? rate / scalarRate : 0.0) << "x\n";
+        }
+    }
+    if (!wordlist.empty() && !measureWordlist(wordlist)) {
+        ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// Load generator for the kernel control socket (oroto-kernel -s PATH).
+// Opens N concurrent sessions, sends the same command M times on each and
+// reports throughput and latency percentiles.
+#include "../lib/control_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " SOCKET [-c sessions] [-n requests] [command...]\n"
+              << "  -c N   concurrent sessions (default 4)\n"
+              << "  -n N   requests per session (default 1000)\n"
+              << "  command defaults to 'pwd'\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::string socketPath = argv[1];
+    size_t sessions = 4;
+    size_t requests = 1000;
+    std::string command;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            sessions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            requests = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            command += command.empty() ? argv[i] : std::string(" ") + argv[i];
+        }
+    }
+    if (command.empty()) {
+        command = "pwd";
+    }
+    if (sessions == 0 || requests == 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // Latencies in microseconds, one slot per request; each session fills its own range
+    std::vector<double> latencies(sessions * requests, 0.0);
+    std::atomic<size_t> failed(0);
+    std::atomic<size_t> transportErrors(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t s = 0; s < sessions; ++s) {
+        workers.emplace_back([&, s]() {
+            Oroto::ControlClient client;
+            if (!client.connect(socketPath)) {
+                transportErrors += requests;
+                return;
+            }
+            std::string output;
+            for (size_t r = 0; r < requests; ++r) {
+                auto sent = std::chrono::steady_clock::now();
+                auto code = client.execute(command, output);
+                auto received = std::chrono::steady_clock::now();
+                latencies[s * requests + r] = std::chrono::duration<double, std::micro>(received - sent).count();
+                if (!code) {
+                    transportErrors += requests - r;
+                    return;
+                }
+                if (*code != Oroto::ErrorCode::SUCCESS) {
+                    ++failed;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t total = sessions * requests;
+    if (transportErrors.load() == total) {
+        std::cerr << "[LOADGEN] Cannot reach " << socketPath << "\n";
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1));
+        return latencies[index];
+    };
+
+    size_t completed = total - transportErrors.load();
+    std::cout << std::fixed << std::setprecision(1)
+              << "[LOADGEN] " << sessions << " sessions x " << requests << " requests of '" << command << "'\n"
+              << "[LOADGEN] " << completed << " completed, " << failed.load() << " failed, "
+              << transportErrors.load() << " lost in " << std::setprecision(3) << seconds << "s\n"
+              << std::setprecision(0)
+              << "[LOADGEN] throughput " << static_cast<double>(completed) / seconds << " commands/sec\n"
+              << std::setprecision(1)
+              << "[LOADGEN] latency us: p50 " << percentile(0.50) << "  p99 " << percentile(0.99)
+              << "  max " << latencies.back() << "\n";
+    return transportErrors.load() == 0 && failed.load() == 0 ? 0 : 1;
+}
@@ -8,11 +8,20 @@
 #include <iomanip>
 #include <algorithm>
 
+static void seedCompletions();
+
 void initCommandParser() {
+    registerBuiltinCommands();
+    seedCompletions();
     LOG_INFO("CommandParser", "Command parser module initialized");
 }
 
 #include "lib/thread_pool.h"
+#include "lib/plugin_manager.h"
+#include "lib/command_tokenizer.h"
+#include "lib/record_stream.h"
+#include "lib/command_history.h"
+#include "lib/completion_trie.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -21,438 +30,1259 @@ void initCommandParser() {
 #include <chrono>
 #include <iomanip>
 
-extern void executeSystemCall(const std::string& syscall, const std::vector<std::string>& args);
-extern void executeDeviceCommand(const std::string& device, const std::string& action, const std::vector<std::string>& args);
-extern void executeNmapScan(const std::vector<std::string>& args);
-extern void executeHashCrack(const std::vector<std::string>& args);
-extern void executePing(const std::vector<std::string>& args);
+#include <charconv>
+#include <cctype>
+#include <mutex>
+#include <iterator>
+#include <cstring>
+
+extern Oroto::Status executeSystemCall(const std::string& syscall, const CommandArgs& args);
+extern Oroto::Status executeDeviceCommand(const std::string& device, std::string_view action, const CommandArgs& args);
+extern Oroto::Status executeNmapScan(const CommandArgs& args);
+extern Oroto::Status executeHashCrack(const CommandArgs& args);
+extern Oroto::Status executeHashId(const CommandArgs& args);
+extern Oroto::Status executeCrackBench(const CommandArgs& args);
+extern Oroto::Status executePing(const CommandArgs& args);
+extern Oroto::Status streamNmapScan(const CommandArgs& args, Oroto::RecordStream& stream);
+extern Oroto::Status streamBannerGrab(const CommandArgs& args, Oroto::RecordStream& stream);
 
-void executeDirectCommand(const std::string& command, const std::vector<std::string>& args);
 void showJobs();
-void killJob(const std::string& jobIdStr);
+Oroto::Status killJob(std::string_view jobIdStr);
+Oroto::Status waitJobs(const CommandArgs& args);
+Oroto::Status foregroundJob(std::string_view jobIdStr);
+Oroto::Status executePluginCommand(const CommandArgs& args);
+void showToolList();
+static Oroto::Status dispatchEntry(const Oroto::CommandEntry& entry, const CommandArgs& args);
 
-std::vector<std::string> parseArguments(const std::string& command) {
-    std::vector<std::string> args;
-    std::stringstream ss(command);
-    std::string arg;
+using Oroto::Tone;
 
-    while (ss >> arg) {
-        args.push_back(arg);
-    }
+// Owner of the built-in rows in the command registry
+static const char* const KERNEL_OWNER = "kernel";
 
-    return args;
-}
+// Per-thread arena backing every allocation made while dispatching one command line
+static thread_local Oroto::CommandArena commandArena;
 
+// Generated from the command table; sections keep registration order
 void showCommandHelp() {
-    std::cout << "\n" << BOLD << YELLOW << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << YELLOW << "║                    OROTO COMPLETE COMMAND REFERENCE             ║" << RESET << "\n";
-    std::cout << BOLD << YELLOW << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-
-    std::cout << WHITE << "📁 File and Directory Operations:" << RESET << "\n";
-    std::cout << GREEN << "  ls" << WHITE << "                     - List files in current directory" << RESET << "\n";
-    std::cout << GREEN << "  cd [folder]" << WHITE << "            - Change to specified directory" << RESET << "\n";
-    std::cout << GREEN << "  pwd" << WHITE << "                    - Show current directory path" << RESET << "\n";
-    std::cout << GREEN << "  mkdir [name]" << WHITE << "           - Create new folder" << RESET << "\n";
-    std::cout << GREEN << "  rm [file]" << WHITE << "              - Delete file (safe mode)" << RESET << "\n";
-    std::cout << GREEN << "  rmdir [folder]" << WHITE << "         - Delete empty folder" << RESET << "\n";
-    std::cout << GREEN << "  touch [file]" << WHITE << "           - Create new empty file" << RESET << "\n";
-    std::cout << GREEN << "  cat [file]" << WHITE << "             - Display file contents" << RESET << "\n";
-    std::cout << GREEN << "  echo [text] > [file]" << WHITE << "   - Write text to file" << RESET << "\n\n";
-
-    std::cout << WHITE << "🔧 System Commands:" << RESET << "\n";
-    std::cout << GREEN << "  clear" << WHITE << "                  - Clear screen (keep OROTO header)" << RESET << "\n";
-    std::cout << GREEN << "  reboot" << WHITE << "                 - Restart system" << RESET << "\n";
-    std::cout << GREEN << "  shutdown" << WHITE << "               - Shutdown system" << RESET << "\n";
-    std::cout << GREEN << "  help" << WHITE << "                   - Show this help" << RESET << "\n";
-    std::cout << GREEN << "  status" << WHITE << "                 - System status and kernel usage" << RESET << "\n";
-    std::cout << GREEN << "  memory" << WHITE << "                 - RAM usage information" << RESET << "\n";
-    std::cout << GREEN << "  cpu" << WHITE << "                    - Processor information" << RESET << "\n";
-    std::cout << GREEN << "  uptime" << WHITE << "                 - System uptime" << RESET << "\n";
-    std::cout << GREEN << "  date" << WHITE << "                   - Current date and time" << RESET << "\n\n";
-
-    std::cout << WHITE << "🌐 Network Commands:" << RESET << "\n";
-    std::cout << GREEN << "  ping [host]" << WHITE << "            - Ping specified IP or domain" << RESET << "\n";
-    std::cout << GREEN << "  ifconfig" << WHITE << "               - Network interface information" << RESET << "\n";
-    std::cout << GREEN << "  netstat" << WHITE << "                - List active connections" << RESET << "\n";
-    std::cout << GREEN << "  traceroute [host]" << WHITE << "      - Show route to target" << RESET << "\n";
-    std::cout << GREEN << "  whois [domain]" << WHITE << "         - Get domain information" << RESET << "\n";
-    std::cout << GREEN << "  dnslookup [host]" << WHITE << "       - Perform DNS resolution" << RESET << "\n\n";
-
-    std::cout << WHITE << "🛡️ Security Tools:" << RESET << "\n";
-    std::cout << GREEN << "  nmap [host]" << WHITE << "            - Scan ports (safe mode)" << RESET << "\n";
-    std::cout << GREEN << "  hashid [hash]" << WHITE << "          - Identify hash type" << RESET << "\n";
-    std::cout << GREEN << "  crack [md5_hash]" << WHITE << "       - Crack simple hashes" << RESET << "\n";
-    std::cout << GREEN << "  ftpconnect [host]" << WHITE << "      - Establish FTP connection" << RESET << "\n";
-    std::cout << GREEN << "  tcpdump" << WHITE << "                - Analyze network traffic" << RESET << "\n\n";
-
-    std::cout << WHITE << "📷 Hardware Access:" << RESET << "\n";
-    std::cout << GREEN << "  cam open" << WHITE << "               - Start camera" << RESET << "\n";
-    std::cout << GREEN << "  cam snap" << WHITE << "               - Take photo" << RESET << "\n";
-    std::cout << GREEN << "  cam close" << WHITE << "              - Close camera" << RESET << "\n";
-    std::cout << GREEN << "  mic status" << WHITE << "             - Check microphone status" << RESET << "\n";
-    std::cout << GREEN << "  storage list" << WHITE << "           - List storage contents" << RESET << "\n\n";
-
-    std::cout << WHITE << "🔰 Kernel Commands:" << RESET << "\n";
-    std::cout << GREEN << "  oroto status" << WHITE << "           - Detailed kernel status" << RESET << "\n";
-    std::cout << GREEN << "  oroto root" << WHITE << "             - Enter root kernel mode" << RESET << "\n";
-    std::cout << GREEN << "  oroto tool list" << WHITE << "        - List all installed tools" << RESET << "\n\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("OROTO COMPLETE COMMAND REFERENCE", YELLOW);
+
+    auto commands = Oroto::getCommandRegistry().listCommands();
+    auto sectionOf = [](const Oroto::CommandEntry& command) -> std::string {
+        if (command.owner != KERNEL_OWNER) {
+            return command.category.empty() ? "🧩 Plugin Commands" : command.category;
+        }
+        return command.category;
+    };
+
+    std::vector<std::string> sections;
+    for (const auto& command : commands) {
+        std::string section = sectionOf(*command);
+        if (!section.empty() && std::find(sections.begin(), sections.end(), section) == sections.end()) {
+            sections.push_back(section);
+        }
+    }
+
+    for (const auto& section : sections) {
+        out.section(section);
+        for (const auto& command : commands) {
+            if (sectionOf(*command) == section) {
+                out.item(command->usage, command->description);
+            }
+        }
+        out.blank();
+    }
 }
 
 void showToolList() {
-    std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                     INSTALLED SECURITY TOOLS                    ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("INSTALLED SECURITY TOOLS");
 
-    std::cout << WHITE << "Network Tools:" << RESET << "\n";
-    std::cout << GREEN << "  nmap" << WHITE << "              - Network port scanner" << RESET << "\n";
-    std::cout << GREEN << "  whois" << WHITE << "             - Domain information" << RESET << "\n";
-    std::cout << GREEN << "  traceroute" << WHITE << "        - Route tracer" << RESET << "\n";
-    std::cout << GREEN << "  netstat" << WHITE << "           - Network statistics" << RESET << "\n";
-    std::cout << GREEN << "  tcpdump" << WHITE << "           - Packet analyzer" << RESET << "\n\n";
+    out.section("Network Tools");
+    out.item("nmap", "Network port scanner", 16);
+    out.item("whois", "Domain information", 16);
+    out.item("traceroute", "Route tracer", 16);
+    out.item("netstat", "Network statistics", 16);
+    out.item("tcpdump", "Packet analyzer", 16);
+    out.blank();
 
-    std::cout << WHITE << "Security Tools:" << RESET << "\n";
-    std::cout << GREEN << "  hash-identifier" << WHITE << "   - Hash type detector" << RESET << "\n";
-    std::cout << GREEN << "  sqlmap" << WHITE << "            - SQL injection tool" << RESET << "\n";
-    std::cout << GREEN << "  hydra" << WHITE << "             - Brute force tool" << RESET << "\n";
-    std::cout << GREEN << "  airmon-ng" << WHITE << "         - Wireless monitor" << RESET << "\n";
-    std::cout << GREEN << "  aircrack" << WHITE << "          - WiFi cracker" << RESET << "\n\n";
+    out.section("Security Tools");
+    out.item("hash-identifier", "Hash type detector", 16);
+    out.item("sqlmap", "SQL injection tool", 16);
+    out.item("hydra", "Brute force tool", 16);
+    out.item("airmon-ng", "Wireless monitor", 16);
+    out.item("aircrack", "WiFi cracker", 16);
+    out.blank();
 
-    std::cout << WHITE << "Remote Access:" << RESET << "\n";
-    std::cout << GREEN << "  ssh" << WHITE << "               - Secure shell" << RESET << "\n";
-    std::cout << GREEN << "  ftp" << WHITE << "               - File transfer" << RESET << "\n\n";
+    out.section("Remote Access");
+    out.item("ssh", "Secure shell", 16);
+    out.item("ftp", "File transfer", 16);
+    out.blank();
 }
 
-void processCommand(const std::string& command) {
-    std::vector<std::string> args = parseArguments(command);
+// Built-ins and plugin commands share one hashed table: a single lookup per command
+static std::shared_ptr<const Oroto::CommandEntry> findCommand(std::string_view name) {
+    std::pmr::string mainCmd(name, &commandArena);
+    std::transform(mainCmd.begin(), mainCmd.end(), mainCmd.begin(), ::tolower);
 
-    if (args.empty()) return;
+    auto entry = Oroto::getCommandRegistry().find(mainCmd);
+    if (!entry) {
+        Oroto::OutputWriter& out = Oroto::out();
+        out.message(Tone::ERROR, "ERROR", {"Unknown command: ", mainCmd});
+        out.message(Tone::HINT, "HINT", "Type 'help' for available commands or 'oroto help' for kernel commands");
+    }
+    return entry;
+}
 
-    std::string mainCmd = args[0];
-    std::transform(mainCmd.begin(), mainCmd.end(), mainCmd.begin(), ::tolower);
+static Oroto::Status executeCommand(const CommandArgs& args) {
+    auto entry = findCommand(args[0]);
+    if (!entry) {
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+    }
+    return dispatchEntry(*entry, args);
+}
 
-    // Handle direct commands without 'oroto' prefix
-    if (mainCmd == "ls" || mainCmd == "cd" || mainCmd == "pwd" || mainCmd == "mkdir" || 
-        mainCmd == "rm" || mainCmd == "rmdir" || mainCmd == "touch" || mainCmd == "cat" || 
-        mainCmd == "echo" || mainCmd == "clear" || mainCmd == "reboot" || mainCmd == "shutdown" ||
-        mainCmd == "help" || mainCmd == "status" || mainCmd == "memory" || mainCmd == "cpu" ||
-        mainCmd == "uptime" || mainCmd == "date" || mainCmd == "ping" || mainCmd == "ifconfig" ||
-        mainCmd == "netstat" || mainCmd == "traceroute" || mainCmd == "whois" || mainCmd == "dnslookup" ||
-        mainCmd == "nmap" || mainCmd == "hashid" || mainCmd == "crack" || mainCmd == "ftpconnect" ||
-        mainCmd == "tcpdump" || mainCmd == "cam" || mainCmd == "mic" || mainCmd == "storage") {
-        executeDirectCommand(mainCmd, args);
-        return;
+// 'a | b | c': every command must have a stream form. All of them are looked
+// up before any starts, so a typo in the last stage does not run the first.
+static Oroto::Status executePipeline(const Oroto::ParsedCommand* first, size_t count) {
+    // Held for the whole run: they keep plugin code behind a stage loaded
+    std::vector<std::shared_ptr<const Oroto::CommandEntry>> entries;
+    std::vector<Oroto::PipelineStage> stages;
+    for (size_t i = 0; i < count; ++i) {
+        const CommandArgs& args = first[i].args;
+        auto entry = findCommand(args[0]);
+        if (!entry) {
+            return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+        }
+        if (!entry->stream) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"'", entry->name, "' cannot be used in a pipeline"});
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        if (args.size() < entry->minArgs) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Usage: ", entry->usage});
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        stages.push_back(Oroto::PipelineStage{&args, entry->stream});
+        entries.push_back(std::move(entry));
     }
+    return Oroto::runPipeline(stages, std::cout);
+}
 
-    if (mainCmd != "oroto") {
-        std::cout << RED << "[ERROR] Unknown command: " << mainCmd << RESET << "\n";
-        std::cout << YELLOW << "[HINT] Type 'help' for available commands or 'oroto help' for kernel commands" << RESET << "\n";
-        return;
+// One command, or a run of commands joined by '|'
+static Oroto::Status executeSegment(const Oroto::ParsedCommand* first, size_t count) {
+    return count == 1 ? executeCommand(first->args) : executePipeline(first, count);
+}
+
+// Runs a command or pipeline as a pool job with its output captured. The job
+// gets its own copy of the arguments: the line and the arena are gone by the
+// time it runs.
+static size_t startBackgroundJob(const Oroto::ParsedCommand* first, size_t count) {
+    Oroto::installOutputRouter(std::cout);
+
+    std::vector<std::vector<std::string>> owned;
+    std::string name;
+    for (size_t i = 0; i < count; ++i) {
+        owned.emplace_back(first[i].args.begin(), first[i].args.end());
+        for (const auto& arg : owned.back()) {
+            name += name.empty() ? arg : " " + arg;
+        }
+        if (i + 1 < count) {
+            name += " |";
+        }
     }
 
-    if (args.size() < 2) {
-        std::cout << RED << "[ERROR] Incomplete command. Type 'oroto help' for usage" << RESET << "\n";
+    Oroto::OutputMode mode = Oroto::currentOutputMode();
+    return Oroto::getThreadPool().submitCapturedJob(name, [owned = std::move(owned), mode]() {
+        Oroto::OutputModeScope modeScope(mode);
+        Oroto::ArenaScope scope(commandArena);
+        Oroto::CommandList steps(&commandArena);
+        for (const auto& words : owned) {
+            steps.push_back(Oroto::ParsedCommand{CommandArgs(words.begin(), words.end(), &commandArena),
+                                                 Oroto::CommandSeparator::PIPE});
+        }
+        steps.back().next = Oroto::CommandSeparator::END;
+        Oroto::Status status = executeSegment(steps.data(), steps.size());
+        if (!status) {
+            throw Oroto::OrotoException(status.error(), "Jobs", Oroto::errorMessage(status.error()));
+        }
+    });
+}
+
+// Machine-readable sessions get a result event after each step, so a script
+// can tell where one command's output ends and whether it worked
+static void reportResult(const Oroto::ParsedCommand* first, size_t count, const Oroto::Status& status) {
+    Oroto::OutputWriter& out = Oroto::out();
+    if (out.human()) {
         return;
     }
+    std::string line;
+    for (size_t i = 0; i < count; ++i) {
+        for (const auto& arg : first[i].args) {
+            if (!line.empty()) {
+                line += ' ';
+            }
+            line += arg;
+        }
+        if (i + 1 < count) {
+            line += " |";
+        }
+    }
+    out.result(line, status ? Oroto::ErrorCode::SUCCESS : status.error());
+}
 
-    std::string subCmd = args[1];
-    std::transform(subCmd.begin(), subCmd.end(), subCmd.begin(), ::tolower);
+// '!!' is the last command, '!N' command number N and '!text' the newest
+// command starting with text. Lines not starting with '!' are left alone.
+static bool expandHistory(const std::string& line, std::string& command) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line[start] != '!' || start + 1 == line.size()) {
+        command = line;
+        return true;
+    }
+    std::string_view event = std::string_view(line).substr(start + 1);
+    size_t end = event.find_first_of(" \t");
+    std::string_view rest = end == std::string_view::npos ? std::string_view() : event.substr(end);
+    event = event.substr(0, end);
 
-    if (subCmd == "help") {
-        showCommandHelp();
-    } else if (subCmd == "status") {
-        executeSystemCall("status", args);
-    } else if (subCmd == "root") {
-        executeSystemCall("root", args);
-    } else if (subCmd == "cam") {
-        if (args.size() >= 3) {
-            executeDeviceCommand("camera", args[2], args);
-        } else {
-            std::cout << RED << "[ERROR] Camera command requires action: open, snap, close" << RESET << "\n";
+    Oroto::CommandHistory& history = Oroto::getCommandHistory();
+    Oroto::HistoryEntry entry;
+    size_t number = 0;
+    auto [last, ec] = std::from_chars(event.data(), event.data() + event.size(), number);
+    bool found;
+    if (event == "!") {
+        found = history.get(history.size(), entry);
+    } else if (ec == std::errc() && last == event.data() + event.size()) {
+        found = history.get(number, entry);
+    } else {
+        found = history.findPrefix(event, entry);
+    }
+    if (!found) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"!", event, ": event not found"});
+        return false;
+    }
+    command = entry.command;
+    command += rest;
+    Oroto::out().message(Tone::NOTICE, "HISTORY", command);
+    return true;
+}
+
+Oroto::Status processCommand(const std::string& line) {
+    std::string command;
+    if (!expandHistory(line, command)) {
+        Oroto::out().result(line, Oroto::ErrorCode::COMMAND_NOT_FOUND);
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+    }
+    Oroto::CommandHistory& history = Oroto::getCommandHistory();
+    if (history.isOpen() && !history.append(command)) {
+        LOG_WARNING("History", "Cannot record command in history");
+    }
+
+    // Everything below allocates from the arena; leaving the scope frees it in one step
+    Oroto::ArenaScope scope(commandArena);
+    auto parsed = Oroto::tokenizeCommandLine(command, &commandArena);
+    if (!parsed) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Cannot parse command: check quotes, escapes and '&&'");
+        Oroto::out().result(command, parsed.error());
+        return Oroto::makeError(parsed.error());
+    }
+
+    // 'a && b' skips b (and the rest of that && chain) when a fails; ';' always continues.
+    // 'a &' starts a as a job and counts as success, like a shell. A pipeline
+    // 'a | b' is one step: the separator after its last command applies to it.
+    const Oroto::CommandList& steps = *parsed;
+    Oroto::Status status = Oroto::ok();
+    bool run = true;
+    for (size_t begin = 0; begin < steps.size();) {
+        size_t end = begin;
+        while (steps[end].next == Oroto::CommandSeparator::PIPE) {
+            ++end;
         }
-    } else if (subCmd == "mic") {
-        if (args.size() >= 3) {
-            executeDeviceCommand("microphone", args[2], args);
-        } else {
-            std::cout << RED << "[ERROR] Microphone command requires action: status, start, stop" << RESET << "\n";
+        const size_t count = end - begin + 1;
+        const Oroto::CommandSeparator next = steps[end].next;
+        if (run) {
+            if (next == Oroto::CommandSeparator::BACKGROUND) {
+                size_t jobId = startBackgroundJob(&steps[begin], count);
+                Oroto::out().message(Tone::NOTICE, "JOBS", {"Job ", std::to_string(jobId), " started in background"});
+                status = Oroto::ok();
+            } else {
+                status = executeSegment(&steps[begin], count);
+            }
+            reportResult(&steps[begin], count, status);
         }
-    } else if (subCmd == "storage") {
-        if (args.size() >= 3) {
-            executeDeviceCommand("storage", args[2], args);
-        } else {
-            std::cout << RED << "[ERROR] Storage command requires action: info, write, read" << RESET << "\n";
+        run = next != Oroto::CommandSeparator::AND || status.hasValue();
+        begin = end + 1;
+    }
+    if (status) {
+        Oroto::getCompletionEngine().noteTargets(command);
+    }
+    return status;
+}
+
+static Oroto::Status dispatchEntry(const Oroto::CommandEntry& entry, const CommandArgs& args) {
+    if (args.size() < entry.minArgs) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Usage: ", entry.usage});
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    return entry.handler(args);
+}
+
+// Pipeline stages. Records come from 'nmap' (see tools/nmap_module.cpp) and
+// are reshaped by the stages below; whatever reaches the end of a pipeline
+// is printed one record per line unless 'report' formats it.
+
+static Oroto::Status cmdPipelineOnly(const CommandArgs& args) {
+    Oroto::out().message(Tone::ERROR, "ERROR", {args[0], " reads records: use it after '|', e.g. 'nmap 10.0.0.0/24 | ", args[0], "'"});
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+// One 'filter' term: key=value, key!=value, or a bare word that matches the
+// record kind or any field value
+static bool matchesTerm(const Oroto::Record& record, std::string_view term) {
+    size_t equals = term.find('=');
+    if (equals == std::string_view::npos) {
+        if (term == Oroto::recordKindName(record.kind)) {
+            return true;
         }
-    } else if (subCmd == "scan") {
-        if (args.size() >= 3 && args[2] == "net") {
-            executeNmapScan(args);
-        } else {
-            std::cout << RED << "[ERROR] Unknown scan target. Use 'oroto scan net'" << RESET << "\n";
+        return std::any_of(record.fields.begin(), record.fields.end(),
+                           [term](const auto& field) { return field.second == term; });
+    }
+
+    bool negated = equals > 0 && term[equals - 1] == '!';
+    std::string_view key = term.substr(0, negated ? equals - 1 : equals);
+    std::string_view value = term.substr(equals + 1);
+    const std::string* actual = record.find(key);
+    bool equal = actual && *actual == value;
+    return negated ? !equal : equal;
+}
+
+// Passes records that match every term
+static Oroto::Status streamFilter(const CommandArgs& args, Oroto::RecordStream& stream) {
+    Oroto::Record record;
+    while (stream.next(record)) {
+        bool keep = std::all_of(args.begin() + 1, args.end(),
+                                [&record](std::string_view term) { return matchesTerm(record, term); });
+        if (keep && !stream.emit(std::move(record))) {
+            break;
         }
-    } else if (subCmd == "crack") {
-        if (args.size() >= 3 && args[2] == "hash") {
-            executeHashCrack(args);
-        } else {
-            std::cout << RED << "[ERROR] Use 'oroto crack hash [md5_hash]'" << RESET << "\n";
+    }
+    return Oroto::ok();
+}
+
+// Passes the first N records (default 10), then stops the stages before it
+static Oroto::Status streamHead(const CommandArgs& args, Oroto::RecordStream& stream) {
+    size_t limit = 10;
+    if (args.size() >= 2) {
+        auto [end, ec] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), limit);
+        if (ec != std::errc() || end != args[1].data() + args[1].size()) {
+            Oroto::out().message(Tone::ERROR, "ERROR", "Usage: head [count]");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
         }
-    } else if (subCmd == "ping") {
-        executePing(args);
-    } else if (subCmd == "tool") {
-        if (args.size() >= 3 && args[2] == "list") {
-            showToolList();
-        } else {
-            std::cout << RED << "[ERROR] Use 'oroto tool list' to see available tools" << RESET << "\n";
+    }
+
+    Oroto::Record record;
+    for (size_t passed = 0; passed < limit && stream.next(record); ++passed) {
+        if (!stream.emit(std::move(record))) {
+            break;
         }
-    } else if (subCmd == "exec") {
-        if (args.size() >= 3) {
-            executeSystemCall("exec", args);
+    }
+    return Oroto::ok();
+}
+
+// Writes each record as it arrives: 'text' (the default) ends with a summary,
+// 'json' is one object per line and nothing else
+static Oroto::Status streamReport(const CommandArgs& args, Oroto::RecordStream& stream) {
+    std::string_view format = args.size() >= 2 ? std::string_view(args[1]) : std::string_view("text");
+    if ((format != "text" && format != "json") || !stream.isLast()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Usage: ... | report [text|json] (last in the pipeline)");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    std::ostream& out = stream.terminal();
+    const bool json = format == "json";
+    size_t hosts = 0;
+    size_t ports = 0;
+    size_t total = 0;
+    Oroto::Record record;
+    while (stream.next(record)) {
+        if (json) {
+            Oroto::writeRecordJson(record, out);
         } else {
-            std::cout << RED << "[ERROR] Specify tool to execute: oroto exec [tool_name]" << RESET << "\n";
+            Oroto::writeRecordText(record, out);
         }
-    } else {
-        std::cout << RED << "[ERROR] Unknown command: " << subCmd << RESET << "\n";
-        std::cout << YELLOW << "[HINT] Type 'oroto help' for available commands" << RESET << "\n";
-    }
-}
-
-void executeDirectCommand(const std::string& command, const std::vector<std::string>& args) {
-    if (command == "ls") {
-        std::cout << YELLOW << "[FS] Listing directory contents..." << RESET << "\n";
-        std::cout << BLUE << "drwxr-xr-x" << WHITE << "  root  root   4096  Jan 02 14:30  " << GREEN << "bin/" << RESET << "\n";
-        std::cout << BLUE << "drwxr-xr-x" << WHITE << "  root  root   4096  Jan 02 14:30  " << GREEN << "etc/" << RESET << "\n";
-        std::cout << BLUE << "drwxr-xr-x" << WHITE << "  root  root   4096  Jan 02 14:30  " << GREEN << "home/" << RESET << "\n";
-        std::cout << BLUE << "drwxr-xr-x" << WHITE << "  root  root   4096  Jan 02 14:30  " << GREEN << "storage/" << RESET << "\n";
-        std::cout << WHITE << "-rw-r--r--" << WHITE << "  root  root   2048  Jan 02 14:30  " << WHITE << "system.log" << RESET << "\n";
-        std::cout << WHITE << "-rw-r--r--" << WHITE << "  root  root   1024  Jan 02 14:30  " << WHITE << "kernel.conf" << RESET << "\n\n";
-    } else if (command == "pwd") {
-        std::cout << GREEN << "/home/oroto" << RESET << "\n\n";
-    } else if (command == "date") {
-        std::cout << GREEN << "Tue Jan  2 14:32:15 UTC 2024" << RESET << "\n\n";
-    } else if (command == "uptime") {
-        std::cout << GREEN << "System uptime: 0 days, 0 hours, 23 minutes, 42 seconds" << RESET << "\n";
-        std::cout << WHITE << "Load average: 0.15, 0.08, 0.05" << RESET << "\n\n";
-    } else if (command == "memory") {
-        std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-        std::cout << BOLD << CYAN << "║                        MEMORY USAGE REPORT                      ║" << RESET << "\n";
-        std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-        std::cout << WHITE << "Total RAM:     " << GREEN << "8192 MB" << RESET << "\n";
-        std::cout << WHITE << "Used RAM:      " << GREEN << "2150 MB (26.3%)" << RESET << "\n";
-        std::cout << WHITE << "Free RAM:      " << GREEN << "6042 MB (73.7%)" << RESET << "\n";
-        std::cout << WHITE << "Cached:        " << GREEN << "485 MB" << RESET << "\n";
-        std::cout << WHITE << "Buffers:       " << GREEN << "127 MB" << RESET << "\n";
-        std::cout << WHITE << "Swap Total:    " << GREEN << "2048 MB" << RESET << "\n";
-        std::cout << WHITE << "Swap Used:     " << GREEN << "0 MB (0%)" << RESET << "\n\n";
-    } else if (command == "cpu") {
-        std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-        std::cout << BOLD << CYAN << "║                       CPU INFORMATION                           ║" << RESET << "\n";
-        std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-        std::cout << WHITE << "Processor:     " << GREEN << "ARM Cortex-A78 (4 cores)" << RESET << "\n";
-        std::cout << WHITE << "Architecture:  " << GREEN << "ARM64" << RESET << "\n";
-        std::cout << WHITE << "Clock Speed:   " << GREEN << "2.8 GHz" << RESET << "\n";
-        std::cout << WHITE << "Cache L1:      " << GREEN << "64KB (per core)" << RESET << "\n";
-        std::cout << WHITE << "Cache L2:      " << GREEN << "512KB (per core)" << RESET << "\n";
-        std::cout << WHITE << "Cache L3:      " << GREEN << "4MB (shared)" << RESET << "\n";
-        std::cout << WHITE << "Current Load:  " << GREEN << "12% average" << RESET << "\n\n";
-    } else if (command == "ifconfig") {
-        std::cout << GREEN << "wlan0: " << WHITE << "WiFi Interface" << RESET << "\n";
-        std::cout << WHITE << "  inet addr: 192.168.1.105  Bcast: 192.168.1.255  Mask: 255.255.255.0" << RESET << "\n";
-        std::cout << WHITE << "  UP BROADCAST RUNNING MULTICAST  MTU: 1500  Metric: 1" << RESET << "\n";
-        std::cout << WHITE << "  RX packets: 15847  TX packets: 12043" << RESET << "\n\n";
-        std::cout << GREEN << "lo: " << WHITE << "Loopback Interface" << RESET << "\n";
-        std::cout << WHITE << "  inet addr: 127.0.0.1  Mask: 255.0.0.0" << RESET << "\n";
-        std::cout << WHITE << "  UP LOOPBACK RUNNING  MTU: 65536  Metric: 1" << RESET << "\n\n";
-    } else if (command == "netstat") {
-        std::cout << YELLOW << "[NETWORK] Active connections:" << RESET << "\n";
-        std::cout << WHITE << "Proto  Local Address         Foreign Address       State" << RESET << "\n";
-        std::cout << GREEN << "tcp    127.0.0.1:5000       *:*                   LISTEN" << RESET << "\n";
-        std::cout << GREEN << "tcp    192.168.1.105:53     8.8.8.8:53            ESTABLISHED" << RESET << "\n";
-        std::cout << GREEN << "udp    0.0.0.0:68           *:*                   " << RESET << "\n\n";
-    } else if (command == "clear") {
-        #ifdef _WIN32
-            if (system("cls") != 0) {
-                // Ignore clear screen failure
-            }
-        #else
-            if (system("clear") != 0) {
-                // Ignore clear screen failure
+        out << std::flush;
+        hosts += record.kind == Oroto::RecordKind::HOST;
+        ports += record.kind == Oroto::RecordKind::PORT;
+        ++total;
+    }
+    if (!json) {
+        out << GREEN << "[REPORT] " << total << " records: " << hosts << " hosts, "
+            << ports << " ports" << RESET << "\n\n";
+    }
+    return Oroto::ok();
+}
+
+// Direct commands (no 'oroto' prefix)
+
+namespace {
+
+struct FileEntry {
+    const char* mode;
+    const char* size;
+    const char* name;   // directories end in '/'
+};
+
+// Contents of the kernel's working directory, as listed by 'ls'
+const FileEntry ROOT_FILES[] = {
+    {"drwxr-xr-x", "4096", "bin/"},
+    {"drwxr-xr-x", "4096", "etc/"},
+    {"drwxr-xr-x", "4096", "home/"},
+    {"drwxr-xr-x", "4096", "storage/"},
+    {"-rw-r--r--", "2048", "system.log"},
+    {"-rw-r--r--", "1024", "kernel.conf"},
+};
+
+} // namespace
+
+static Oroto::Status cmdLs(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "FS", "Listing directory contents...");
+    for (const auto& file : ROOT_FILES) {
+        std::string_view name = file.name;
+        out.row({{"mode", file.mode, 0}, {"owner", "root", 4}, {"group", "root", 4}, {"size", file.size, -5},
+                 {"modified", "Jan 02 14:30", 0}, {"name", name, 0}},
+                name.back() == '/' ? Tone::OK : Tone::PLAIN);
+    }
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdPwd(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.line("/home/oroto", Tone::OK);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdDate(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.line("Tue Jan  2 14:32:15 UTC 2024", Tone::OK);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdUptime(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.field("System uptime", "0 days, 0 hours, 23 minutes, 42 seconds", Tone::OK, 0);
+    out.field("Load average", "0.15, 0.08, 0.05", Tone::PLAIN, 0);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdMemory(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("MEMORY USAGE REPORT");
+    out.field("Total RAM", "8192 MB");
+    out.field("Used RAM", "2150 MB (26.3%)");
+    out.field("Free RAM", "6042 MB (73.7%)");
+    out.field("Cached", "485 MB");
+    out.field("Buffers", "127 MB");
+    out.field("Swap Total", "2048 MB");
+    out.field("Swap Used", "0 MB (0%)");
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdCpu(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("CPU INFORMATION");
+    out.field("Processor", "ARM Cortex-A78 (4 cores)");
+    out.field("Architecture", "ARM64");
+    out.field("Clock Speed", "2.8 GHz");
+    out.field("Cache L1", "64KB (per core)");
+    out.field("Cache L2", "512KB (per core)");
+    out.field("Cache L3", "4MB (shared)");
+    out.field("Current Load", "12% average");
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdIfconfig(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.section("wlan0 (WiFi Interface)");
+    out.field("  inet addr", "192.168.1.105  Bcast: 192.168.1.255  Mask: 255.255.255.0", Tone::PLAIN, 0);
+    out.field("  flags", "UP BROADCAST RUNNING MULTICAST  MTU: 1500  Metric: 1", Tone::PLAIN, 0);
+    out.field("  packets", "RX 15847  TX 12043", Tone::PLAIN, 0);
+    out.blank();
+    out.section("lo (Loopback Interface)");
+    out.field("  inet addr", "127.0.0.1  Mask: 255.0.0.0", Tone::PLAIN, 0);
+    out.field("  flags", "UP LOOPBACK RUNNING  MTU: 65536  Metric: 1", Tone::PLAIN, 0);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdNetstat(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "NETWORK", "Active connections:");
+    out.decoration(WHITE "Proto  Local Address         Foreign Address       State" RESET "\n");
+    auto connection = [&out](std::string_view proto, std::string_view local, std::string_view foreign, std::string_view state) {
+        out.row({{"proto", proto, 5}, {"local", local, 19}, {"foreign", foreign, 20}, {"state", state, 0}}, Tone::OK);
+    };
+    connection("tcp", "127.0.0.1:5000", "*:*", "LISTEN");
+    connection("tcp", "192.168.1.105:53", "8.8.8.8:53", "ESTABLISHED");
+    connection("udp", "0.0.0.0:68", "*:*", "");
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdClear(const CommandArgs&) {
+    // Only a person's terminal has a screen to clear
+    if (!Oroto::out().human()) {
+        return Oroto::ok();
+    }
+    #ifdef _WIN32
+        if (system("cls") != 0) {
+            // Ignore clear screen failure
+        }
+    #else
+        if (system("clear") != 0) {
+            // Ignore clear screen failure
+        }
+    #endif
+    Oroto::out().decoration(BOLD CYAN
+        "╔══════════════════════════════════════════════════════════════════╗\n"
+        "║   ██████╗ ██████╗  ██████╗ ████████╗ ██████╗                    ║\n"
+        "║  ██╔═══██╗██╔══██╗██╔═══██╗╚══██╔══╝██╔═══██╗                   ║\n"
+        "║  ██║   ██║██████╔╝██║   ██║   ██║   ██║   ██║                   ║\n"
+        "║  ██║   ██║██╔══██╗██║   ██║   ██║   ██║   ██║                   ║\n"
+        "║  ╚██████╔╝██║  ██║╚██████╔╝   ██║   ╚██████╔╝                   ║\n"
+        "║   ╚═════╝ ╚═╝  ╚═╝ ╚═════╝    ╚═╝    ╚═════╝                    ║\n"
+        "║                 Oroto Kernel v3.2.1 - Ready                    ║\n"
+        "╚══════════════════════════════════════════════════════════════════╝\n"
+        RESET "\n");
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdMkdir(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::OK, "FS", {"Directory created: ", args[1]});
+    Oroto::getCompletionEngine().addFile(std::string(args[1]) + "/");
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdTouch(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::OK, "FS", {"File created: ", args[1]});
+    Oroto::getCompletionEngine().addFile(args[1]);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdRm(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::WARNING, "FS", {"File deleted (safe mode): ", args[1]});
+    Oroto::getCompletionEngine().removeFile(args[1]);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdCat(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.section(std::string("File contents of ").append(args[1]));
+    out.line("# Oroto system configuration", Tone::OK);
+    out.line("kernel_version=3.2.1", Tone::OK);
+    out.line("security_level=high", Tone::OK);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdNotImplemented(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::ERROR, "ERROR", "Command requires additional parameters or is not implemented");
+    out.message(Tone::HINT, "HINT", "Type 'help' for usage information");
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+static Oroto::Status cmdHashid(const CommandArgs& args) {
+    return executeHashId(args);
+}
+
+static Oroto::Status cmdCrack(const CommandArgs& args) {
+    // Same shape as 'oroto crack hash HASH ...' (or 'oroto crack bench ...'),
+    // which the cracker parses
+    bool bench = args[1] == "bench";
+    CommandArgs crackArgs(args.get_allocator());
+    crackArgs.emplace_back("oroto");
+    crackArgs.emplace_back("crack");
+    crackArgs.emplace_back(bench ? "bench" : "hash");
+    crackArgs.insert(crackArgs.end(), args.begin() + (bench ? 2 : 1), args.end());
+    return bench ? executeCrackBench(crackArgs) : executeHashCrack(crackArgs);
+}
+
+static Oroto::Status cmdTcpdump(const CommandArgs&) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "TCPDUMP", "Starting packet capture...");
+    out.line("14:32:15.123456 IP 192.168.1.105.5000 > 8.8.8.8.53: UDP, length 32", Tone::OK);
+    out.line("14:32:15.167834 IP 8.8.8.8.53 > 192.168.1.105.5000: UDP, length 48", Tone::OK);
+    out.line("14:32:16.234567 ARP, Request who-has 192.168.1.1 tell 192.168.1.105", Tone::OK);
+    out.field("Packets captured", "3", Tone::PLAIN, 0);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdWhois(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "WHOIS", {"Looking up domain: ", args[1]});
+    out.field("Domain Name", args[1], Tone::OK, 0);
+    out.field("Registry Domain ID", "D123456789-LROR", Tone::PLAIN, 0);
+    out.field("Registrar", "Example Registrar Inc.", Tone::PLAIN, 0);
+    out.field("Creation Date", "2020-01-01T00:00:00Z", Tone::PLAIN, 0);
+    out.field("Registry Expiry Date", "2025-01-01T00:00:00Z", Tone::PLAIN, 0);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdDnslookup(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "DNS", {"Resolving: ", args[1]});
+    out.row({{"host", args[1], 0}, {"type", "has address", 0}, {"address", "8.8.8.8", 0}}, Tone::OK);
+    out.row({{"host", args[1], 0}, {"type", "has IPv6 address", 0}, {"address", "2001:4860:4860::8888", 0}}, Tone::OK);
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdTraceroute(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "TRACEROUTE", {"Tracing route to ", args[1]});
+    auto hop = [&out](std::string_view number, std::string_view host, std::string_view times) {
+        out.row({{"hop", number, -2}, {"host", host, 17}, {"times", times, 0}});
+    };
+    hop("1", "192.168.1.1", " 2.456 ms  2.123 ms  1.987 ms");
+    hop("2", "10.0.0.1", "15.234 ms 14.567 ms 15.123 ms");
+    hop("3", "203.0.113.1", "28.456 ms 29.123 ms 27.987 ms");
+    hop("4", args[1], "45.234 ms 44.567 ms 45.123 ms");
+    out.blank();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdFtpconnect(const CommandArgs& args) {
+    Oroto::OutputWriter& out = Oroto::out();
+    out.message(Tone::PROGRESS, "FTP", {"Connecting to ", args[1], "..."});
+    out.message(Tone::OK, "FTP", {"Connected to ", args[1]});
+    out.line("220 FTP Server ready.");
+    out.decoration(std::string(WHITE "User (").append(args[1]).append(":(none)): " RESET));
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdCam(const CommandArgs& args) {
+    if (args[1] == "open" || args[1] == "snap" || args[1] == "close") {
+        return executeDeviceCommand("camera", args[1], args);
+    }
+    Oroto::out().message(Tone::ERROR, "ERROR", "Camera usage: cam [open|snap|close]");
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+static Oroto::Status cmdMic(const CommandArgs& args) {
+    return executeDeviceCommand("microphone", args[1], args);
+}
+
+static Oroto::Status cmdStorage(const CommandArgs& args) {
+    std::string_view action = args[1] == "list" ? std::string_view("info") : std::string_view(args[1]);
+    return executeDeviceCommand("storage", action, args);
+}
+
+static Oroto::Status cmdJobs(const CommandArgs&) {
+    showJobs();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdKill(const CommandArgs& args) {
+    return killJob(args[1]);
+}
+
+static Oroto::Status cmdWait(const CommandArgs& args) {
+    return waitJobs(args);
+}
+
+static Oroto::Status cmdFg(const CommandArgs& args) {
+    return foregroundJob(args[1]);
+}
+
+static Oroto::Status cmdHelp(const CommandArgs&) {
+    showCommandHelp();
+    return Oroto::ok();
+}
+
+static Oroto::Status cmdStatus(const CommandArgs& args) {
+    return executeSystemCall("status", args);
+}
+
+static Oroto::Status cmdReboot(const CommandArgs& args) {
+    return executeSystemCall("reboot", args);
+}
+
+static Oroto::Status cmdShutdown(const CommandArgs& args) {
+    return executeSystemCall("shutdown", args);
+}
+
+// 'output' alone shows the session's format; 'output json' switches it for
+// every later command of this session (the shell, a script, a socket client)
+static Oroto::Status cmdOutput(const CommandArgs& args) {
+    if (args.size() < 2) {
+        Oroto::out().field("Output format", Oroto::outputModeName(Oroto::currentOutputMode()), Tone::OK, 0);
+        return Oroto::ok();
+    }
+    Oroto::OutputMode mode;
+    if (!Oroto::parseOutputMode(args[1], mode)) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Usage: output [human|json|binary]");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    Oroto::sessionOutputMode() = mode;
+    return Oroto::ok();
+}
+
+static bool parseCount(std::string_view text, size_t& count) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), count);
+    return ec == std::errc() && end == text.data() + text.size() && count > 0;
+}
+
+static void showHistoryEntry(const Oroto::HistoryEntry& entry) {
+    char when[20] = "";
+    std::time_t time = static_cast<std::time_t>(entry.time);
+    std::tm local{};
+    if (localtime_r(&time, &local)) {
+        std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    Oroto::out().row({{"number", std::to_string(entry.number), -5}, {"time", when, 0},
+                      {"command", entry.command, 0}});
+}
+
+// 'history [count]' lists the newest commands of every session sharing the
+// history file; 'history search TERM' lists those containing TERM, newest
+// first, and '^TERM' those starting with it (using the sorted index)
+static Oroto::Status cmdHistory(const CommandArgs& args) {
+    static const char* const USAGE = "Usage: history [count] | history search TERM [count]";
+    Oroto::CommandHistory& history = Oroto::getCommandHistory();
+    if (!history.isOpen()) {
+        Oroto::out().message(Tone::WARNING, "WARNING", "Command history is not available (see OROTO_HISTORY)");
+        return Oroto::makeError(Oroto::ErrorCode::FILE_NOT_FOUND);
+    }
+
+    size_t count = 20;
+    if (args.size() >= 2 && args[1] == "search") {
+        if (args.size() < 3 || (args.size() >= 4 && !parseCount(args[3], count))) {
+            Oroto::out().message(Tone::ERROR, "ERROR", USAGE);
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        std::string_view term = args[2];
+        if (!term.empty() && term[0] == '^') {
+            Oroto::HistoryEntry entry;
+            size_t before = 0;
+            for (size_t shown = 0; shown < count && history.findPrefix(term.substr(1), entry, before); ++shown) {
+                showHistoryEntry(entry);
+                before = entry.number;
             }
-        #endif
-        std::cout << BOLD << CYAN;
-        std::cout << "╔══════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║   ██████╗ ██████╗  ██████╗ ████████╗ ██████╗                    ║\n";
-        std::cout << "║  ██╔═══██╗██╔══██╗██╔═══██╗╚══██╔══╝██╔═══██╗                   ║\n";
-        std::cout << "║  ██║   ██║██████╔╝██║   ██║   ██║   ██║   ██║                   ║\n";
-        std::cout << "║  ██║   ██║██╔══██╗██║   ██║   ██║   ██║   ██║                   ║\n";
-        std::cout << "║  ╚██████╔╝██║  ██║╚██████╔╝   ██║   ╚██████╔╝                   ║\n";
-        std::cout << "║   ╚═════╝ ╚═╝  ╚═╝ ╚═════╝    ╚═╝    ╚═════╝                    ║\n";
-        std::cout << "║                 Oroto Kernel v3.2.1 - Ready                    ║\n";
-        std::cout << "╚══════════════════════════════════════════════════════════════════╝\n";
-        std::cout << RESET << "\n";
-    } else if (command == "mkdir" && args.size() >= 2) {
-        std::cout << GREEN << "[FS] Directory created: " << args[1] << RESET << "\n\n";
-    } else if (command == "touch" && args.size() >= 2) {
-        std::cout << GREEN << "[FS] File created: " << args[1] << RESET << "\n\n";
-    } else if (command == "rm" && args.size() >= 2) {
-        std::cout << YELLOW << "[FS] File deleted (safe mode): " << args[1] << RESET << "\n\n";
-    } else if (command == "cat" && args.size() >= 2) {
-        std::cout << WHITE << "File contents of " << args[1] << ":" << RESET << "\n";
-        std::cout << GREEN << "# Oroto system configuration" << RESET << "\n";
-        std::cout << GREEN << "kernel_version=3.2.1" << RESET << "\n";
-        std::cout << GREEN << "security_level=high" << RESET << "\n\n";
-    } else if (command == "ping" && args.size() >= 2) {
-        executePing(args);
-    } else if (command == "nmap" && args.size() >= 2) {
-        executeNmapScan(args);
-    } else if (command == "hashid" && args.size() >= 2) {
-        std::cout << YELLOW << "[HASHID] Analyzing hash: " << args[1] << RESET << "\n";
-        std::cout << GREEN << "[HASHID] Most likely hash type: MD5" << RESET << "\n";
-        std::cout << WHITE << "Other possibilities: NTLM, MD4" << RESET << "\n\n";
-    } else if (command == "crack" && args.size() >= 2) {
-        std::vector<std::string> crackArgs = {"crack", "hash", args[1]};
-        executeHashCrack(crackArgs);
-    } else if (command == "tcpdump") {
-        std::cout << YELLOW << "[TCPDUMP] Starting packet capture..." << RESET << "\n";
-        std::cout << GREEN << "14:32:15.123456 IP 192.168.1.105.5000 > 8.8.8.8.53: UDP, length 32" << RESET << "\n";
-        std::cout << GREEN << "14:32:15.167834 IP 8.8.8.8.53 > 192.168.1.105.5000: UDP, length 48" << RESET << "\n";
-        std::cout << GREEN << "14:32:16.234567 ARP, Request who-has 192.168.1.1 tell 192.168.1.105" << RESET << "\n";
-        std::cout << WHITE << "3 packets captured" << RESET << "\n\n";
-    } else if (command == "whois" && args.size() >= 2) {
-        std::cout << YELLOW << "[WHOIS] Looking up domain: " << args[1] << RESET << "\n";
-        std::cout << WHITE << "Domain Name: " << GREEN << args[1] << RESET << "\n";
-        std::cout << WHITE << "Registry Domain ID: D123456789-LROR" << RESET << "\n";
-        std::cout << WHITE << "Registrar: Example Registrar Inc." << RESET << "\n";
-        std::cout << WHITE << "Creation Date: 2020-01-01T00:00:00Z" << RESET << "\n";
-        std::cout << WHITE << "Registry Expiry Date: 2025-01-01T00:00:00Z" << RESET << "\n\n";
-    } else if (command == "dnslookup" && args.size() >= 2) {
-        std::cout << YELLOW << "[DNS] Resolving: " << args[1] << RESET << "\n";
-        std::cout << GREEN << args[1] << " has address 8.8.8.8" << RESET << "\n";
-        std::cout << GREEN << args[1] << " has IPv6 address 2001:4860:4860::8888" << RESET << "\n\n";
-    } else if (command == "traceroute" && args.size() >= 2) {
-        std::cout << YELLOW << "[TRACEROUTE] Tracing route to " << args[1] << RESET << "\n";
-        std::cout << WHITE << " 1  192.168.1.1         2.456 ms  2.123 ms  1.987 ms" << RESET << "\n";
-        std::cout << WHITE << " 2  10.0.0.1           15.234 ms 14.567 ms 15.123 ms" << RESET << "\n";
-        std::cout << WHITE << " 3  203.0.113.1        28.456 ms 29.123 ms 27.987 ms" << RESET << "\n";
-        std::cout << WHITE << " 4  " << GREEN << args[1] << WHITE << "  45.234 ms 44.567 ms 45.123 ms" << RESET << "\n\n";
-    } else if (command == "ftpconnect" && args.size() >= 2) {
-        std::cout << YELLOW << "[FTP] Connecting to " << args[1] << "..." << RESET << "\n";
-        std::cout << GREEN << "[FTP] Connected to " << args[1] << RESET << "\n";
-        std::cout << WHITE << "220 FTP Server ready." << RESET << "\n";
-        std::cout << WHITE << "User (" << args[1] << ":(none)): " << RESET;
-    } else if (command == "cam") {
-        if (args.size() >= 2) {
-            if (args[1] == "open") executeDeviceCommand("camera", "open", args);
-            else if (args[1] == "snap") executeDeviceCommand("camera", "snap", args);
-            else if (args[1] == "close") executeDeviceCommand("camera", "close", args);
-            else std::cout << RED << "[ERROR] Camera usage: cam [open|snap|close]" << RESET << "\n";
         } else {
-            std::cout << RED << "[ERROR] Camera usage: cam [open|snap|close]" << RESET << "\n";
+            for (const auto& entry : history.search(term, count)) {
+                showHistoryEntry(entry);
+            }
         }
-    } else if (command == "mic") {
-        if (args.size() >= 2) {
-            executeDeviceCommand("microphone", args[1], args);
-        } else {
-            std::cout << RED << "[ERROR] Microphone usage: mic [status|start|stop]" << RESET << "\n";
+        return Oroto::ok();
+    }
+
+    if (args.size() >= 2 && !parseCount(args[1], count)) {
+        Oroto::out().message(Tone::ERROR, "ERROR", USAGE);
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    for (const auto& entry : history.tail(count)) {
+        showHistoryEntry(entry);
+    }
+    return Oroto::ok();
+}
+
+// Hosts typed in earlier sessions come from the shared history
+static void seedCompletions() {
+    static constexpr size_t HISTORY_SEED_ENTRIES = 50000;
+    Oroto::CompletionEngine& engine = Oroto::getCompletionEngine();
+    for (const auto& file : ROOT_FILES) {
+        engine.addFile(file.name);
+    }
+    Oroto::CommandHistory& history = Oroto::getCommandHistory();
+    if (history.isOpen()) {
+        for (const auto& entry : history.tail(HISTORY_SEED_ENTRIES)) {
+            engine.noteTargets(entry.command);
         }
-    } else if (command == "storage") {
-        if (args.size() >= 2) {
-            if (args[1] == "list") executeDeviceCommand("storage", "info", args);
-            else executeDeviceCommand("storage", args[1], args);
-        } else {
-            std::cout << RED << "[ERROR] Storage usage: storage [list|info|write|read]" << RESET << "\n";
-        }
-    } else if (command == "jobs") {
-        showJobs();
-    } else if (command == "kill" && args.size() >= 2) {
-        killJob(args[1]);
-    } else if (command == "help") {
-        showCommandHelp();
-    } else if (command == "status") {
-        executeSystemCall("status", args);
-    } else if (command == "reboot") {
-        executeSystemCall("reboot", args);
-    } else if (command == "shutdown") {
-        executeSystemCall("shutdown", args);
-    } else {
-        std::cout << RED << "[ERROR] Command requires additional parameters or is not implemented" << RESET << "\n";
-        std::cout << YELLOW << "[HINT] Type 'help' for usage information" << RESET << "\n";
     }
+    LOG_INFO("CommandParser", "Completion ready with " + std::to_string(engine.hostCount()) + " known hosts");
+}
+
+// 'complete TEXT' lists what Tab would offer for TEXT, for sessions without a
+// line editor (scripts, socket clients); quote TEXT to keep a trailing space
+static Oroto::Status cmdComplete(const CommandArgs& args) {
+    static constexpr size_t LIMIT = 100;
+    std::string line;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (i > 1) {
+            line += ' ';
+        }
+        line += args[i];
+    }
+    Oroto::CompletionResult result = Oroto::getCompletionEngine().complete(line, LIMIT);
+    for (const auto& candidate : result.candidates) {
+        Oroto::out().row({{"candidate", candidate, 0}});
+    }
+    if (result.total > result.candidates.size()) {
+        Oroto::out().message(Tone::HINT, "COMPLETE", {"... ", std::to_string(result.total - result.candidates.size()), " more"});
+    }
+    return Oroto::ok();
+}
+
+// 'oroto' subcommands, registered as "oroto <name>"
+
+static Oroto::Status cmdOroto(const CommandArgs& args) {
+    if (args.size() < 2) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Incomplete command. Type 'oroto help' for usage");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    std::pmr::string path("oroto ", args.get_allocator().resource());
+    size_t subStart = path.size();
+    path += args[1];
+    std::transform(path.begin() + subStart, path.end(), path.begin() + subStart, ::tolower);
+
+    auto entry = Oroto::getCommandRegistry().find(path);
+    if (!entry) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown command: ", std::string_view(path).substr(subStart)});
+        Oroto::out().message(Tone::HINT, "HINT", "Type 'oroto help' for available commands");
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+    }
+    return dispatchEntry(*entry, args);
+}
+
+static Oroto::Status orotoRoot(const CommandArgs& args) {
+    return executeSystemCall("root", args);
+}
+
+static Oroto::Status orotoCam(const CommandArgs& args) {
+    return executeDeviceCommand("camera", args[2], args);
+}
+
+static Oroto::Status orotoMic(const CommandArgs& args) {
+    return executeDeviceCommand("microphone", args[2], args);
+}
+
+static Oroto::Status orotoStorage(const CommandArgs& args) {
+    return executeDeviceCommand("storage", args[2], args);
+}
+
+static Oroto::Status orotoScan(const CommandArgs& args) {
+    if (args.size() >= 3 && args[2] == "net") {
+        return executeNmapScan(args);
+    }
+    Oroto::out().message(Tone::ERROR, "ERROR", "Unknown scan target. Use 'oroto scan net'");
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+static Oroto::Status orotoCrack(const CommandArgs& args) {
+    if (args.size() >= 3 && args[2] == "hash") {
+        return executeHashCrack(args);
+    }
+    if (args.size() >= 3 && args[2] == "bench") {
+        return executeCrackBench(args);
+    }
+    Oroto::out().message(Tone::ERROR, "ERROR", "Use 'oroto crack hash HASH|--hashfile=FILE [--mode=dict|brute] [--wordlist=FILE] [--rules=FILE]' or 'oroto crack bench'");
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+static Oroto::Status orotoTool(const CommandArgs& args) {
+    if (args.size() >= 3 && args[2] == "list") {
+        showToolList();
+        return Oroto::ok();
+    }
+    Oroto::out().message(Tone::ERROR, "ERROR", "Use 'oroto tool list' to see available tools");
+    return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+}
+
+static Oroto::Status orotoExec(const CommandArgs& args) {
+    return executeSystemCall("exec", args);
+}
+
+namespace {
+
+const char* const FILE_COMMANDS = "📁 File and Directory Operations";
+const char* const SYSTEM_COMMANDS = "🔧 System Commands";
+const char* const NETWORK_COMMANDS = "🌐 Network Commands";
+const char* const SECURITY_TOOLS = "🛡️ Security Tools";
+const char* const HARDWARE_ACCESS = "📷 Hardware Access";
+const char* const KERNEL_COMMANDS = "🔰 Kernel Commands";
+const char* const PIPELINE_STAGES = "🔗 Pipeline Stages (cmd | cmd)";
+
+// One row per command path; minArgs counts the command words themselves.
+// Entries without a category dispatch normally but are left out of help.
+struct BuiltinCommand {
+    const char* path;
+    const char* usage;
+    const char* description;
+    const char* category;
+    size_t minArgs;
+    Oroto::Status (*handler)(const CommandArgs& args);
+};
+
+const BuiltinCommand BUILTIN_COMMANDS[] = {
+    {"ls",         "ls",                   "List files in current directory",     FILE_COMMANDS, 1, cmdLs},
+    {"cd",         "cd [folder]",          "Change to specified directory",       FILE_COMMANDS, 1, cmdNotImplemented},
+    {"pwd",        "pwd",                  "Show current directory path",         FILE_COMMANDS, 1, cmdPwd},
+    {"mkdir",      "mkdir [name]",         "Create new folder",                   FILE_COMMANDS, 2, cmdMkdir},
+    {"rm",         "rm [file]",            "Delete file (safe mode)",             FILE_COMMANDS, 2, cmdRm},
+    {"rmdir",      "rmdir [folder]",       "Delete empty folder",                 FILE_COMMANDS, 1, cmdNotImplemented},
+    {"touch",      "touch [file]",         "Create new empty file",               FILE_COMMANDS, 2, cmdTouch},
+    {"cat",        "cat [file]",           "Display file contents",               FILE_COMMANDS, 2, cmdCat},
+    {"echo",       "echo [text] > [file]", "Write text to file",                  FILE_COMMANDS, 1, cmdNotImplemented},
+
+    {"clear",      "clear",                "Clear screen (keep OROTO header)",    SYSTEM_COMMANDS, 1, cmdClear},
+    {"reboot",     "reboot",               "Restart system",                      SYSTEM_COMMANDS, 1, cmdReboot},
+    {"shutdown",   "shutdown",             "Shutdown system",                     SYSTEM_COMMANDS, 1, cmdShutdown},
+    {"help",       "help",                 "Show this help",                      SYSTEM_COMMANDS, 1, cmdHelp},
+    {"status",     "status",               "System status and kernel usage",      SYSTEM_COMMANDS, 1, cmdStatus},
+    {"memory",     "memory",               "RAM usage information",               SYSTEM_COMMANDS, 1, cmdMemory},
+    {"cpu",        "cpu",                  "Processor information",               SYSTEM_COMMANDS, 1, cmdCpu},
+    {"uptime",     "uptime",               "System uptime",                       SYSTEM_COMMANDS, 1, cmdUptime},
+    {"date",       "date",                 "Current date and time",               SYSTEM_COMMANDS, 1, cmdDate},
+    {"jobs",       "jobs",                 "List thread pool jobs",               SYSTEM_COMMANDS, 1, cmdJobs},
+    {"kill",       "kill [job_id]",        "Cancel a job",                        SYSTEM_COMMANDS, 2, cmdKill},
+    {"wait",       "wait [job_id]",        "Wait for one or all jobs to finish",  SYSTEM_COMMANDS, 1, cmdWait},
+    {"fg",         "fg [job_id]",          "Show a job's output until it ends",   SYSTEM_COMMANDS, 2, cmdFg},
+    {"output",     "output [human|json|binary]", "Show or set this session's output format", SYSTEM_COMMANDS, 1, cmdOutput},
+    {"complete",   "complete [text]",      "List Tab completions for a command line", SYSTEM_COMMANDS, 1, cmdComplete},
+    {"history",    "history [count] | history search TERM", "List or search earlier commands (!! !N !text rerun)", SYSTEM_COMMANDS, 1, cmdHistory},
+
+    {"ping",       "ping [host]",          "Ping specified IP or domain",         NETWORK_COMMANDS, 2, executePing},
+    {"ifconfig",   "ifconfig",             "Network interface information",       NETWORK_COMMANDS, 1, cmdIfconfig},
+    {"netstat",    "netstat",              "List active connections",             NETWORK_COMMANDS, 1, cmdNetstat},
+    {"traceroute", "traceroute [host]",    "Show route to target",                NETWORK_COMMANDS, 2, cmdTraceroute},
+    {"whois",      "whois [domain]",       "Get domain information",              NETWORK_COMMANDS, 2, cmdWhois},
+    {"dnslookup",  "dnslookup [host]",     "Perform DNS resolution",              NETWORK_COMMANDS, 2, cmdDnslookup},
+
+    {"nmap",       "nmap [host|net/24]",   "Scan ports (safe mode)",              SECURITY_TOOLS, 2, executeNmapScan},
+    {"hashid",     "hashid HASH|--file=FILE", "Identify hash types, one or a whole file", SECURITY_TOOLS, 2, cmdHashid},
+    {"crack",      "crack HASH|--hashfile=FILE|--resume NAME|bench [--mode=dict|brute] [--wordlist=FILE] [--rules=FILE]", "Crack MD5, SHA-1 or SHA-256 hashes, or benchmark the cracker", SECURITY_TOOLS, 2, cmdCrack},
+    {"ftpconnect", "ftpconnect [host]",    "Establish FTP connection",            SECURITY_TOOLS, 2, cmdFtpconnect},
+    {"tcpdump",    "tcpdump",              "Analyze network traffic",             SECURITY_TOOLS, 1, cmdTcpdump},
+
+    {"filter",     "filter [term...]",     "Keep records matching open, key=v, key!=v", PIPELINE_STAGES, 1, cmdPipelineOnly},
+    {"banner",     "banner",               "Grab service banners of open ports",  PIPELINE_STAGES, 1, cmdPipelineOnly},
+    {"head",       "head [count]",         "Keep the first records, stop the rest", PIPELINE_STAGES, 1, cmdPipelineOnly},
+    {"report",     "report [text|json]",   "Print records with a summary or as JSON", PIPELINE_STAGES, 1, cmdPipelineOnly},
+
+    {"cam",        "cam [open|snap|close]",        "Camera control",              HARDWARE_ACCESS, 2, cmdCam},
+    {"mic",        "mic [status|start|stop]",      "Microphone control",          HARDWARE_ACCESS, 2, cmdMic},
+    {"storage",    "storage [list|info|write|read]", "Storage access",            HARDWARE_ACCESS, 2, cmdStorage},
+
+    {"oroto",         "oroto [command]",           "Kernel command namespace",    nullptr, 1, cmdOroto},
+    {"oroto help",    "oroto help",                "Kernel command reference",    nullptr, 2, cmdHelp},
+    {"oroto status",  "oroto status",              "Detailed kernel status",      KERNEL_COMMANDS, 2, cmdStatus},
+    {"oroto root",    "oroto root [kernel.cmd]",   "Enter root kernel mode",      KERNEL_COMMANDS, 2, orotoRoot},
+    {"oroto cam",     "oroto cam [open|snap|close]", "Camera device call",        KERNEL_COMMANDS, 3, orotoCam},
+    {"oroto mic",     "oroto mic [status|start|stop]", "Microphone device call",  KERNEL_COMMANDS, 3, orotoMic},
+    {"oroto storage", "oroto storage [info|write|read]", "Storage device call",   KERNEL_COMMANDS, 3, orotoStorage},
+    {"oroto scan",    "oroto scan net",            "Network scan",                KERNEL_COMMANDS, 2, orotoScan},
+    {"oroto crack",   "oroto crack hash HASH|--hashfile=FILE [--mode=dict|brute] [--wordlist=FILE] [--rules=FILE] [--charset=SET] [--max-length=N] [--mask=MASK] | oroto crack bench [--threads=N] [--duration=SECONDS] [--algorithm=md5|sha1|sha256] [--kernel=NAME]", "Hash cracker and its benchmark", KERNEL_COMMANDS, 2, orotoCrack},
+    {"oroto ping",    "oroto ping [host] [--mode=1-4]", "Ping engine",   KERNEL_COMMANDS, 2, executePing},
+    {"oroto tool",    "oroto tool list",           "List all installed tools",    KERNEL_COMMANDS, 2, orotoTool},
+    {"oroto exec",    "oroto exec [tool_name]",    "Execute installed tool",      KERNEL_COMMANDS, 3, orotoExec},
+    {"oroto plugin",  "oroto plugin [list|load|unload|reload] [file]", "Manage plugins", KERNEL_COMMANDS, 2, executePluginCommand},
+};
+
+// Commands that can also run as a pipeline stage, and the form used there
+struct StreamCommand {
+    const char* path;
+    Oroto::Status (*stream)(const CommandArgs& args, Oroto::RecordStream& stream);
+};
+
+const StreamCommand STREAM_COMMANDS[] = {
+    {"nmap",   streamNmapScan},
+    {"filter", streamFilter},
+    {"banner", streamBannerGrab},
+    {"head",   streamHead},
+    {"report", streamReport},
+};
+
+} // namespace
+
+// Publish the built-in table; runs before plugins load so built-in names win
+void registerBuiltinCommands() {
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        std::vector<Oroto::CommandEntry> entries;
+        entries.reserve(std::size(BUILTIN_COMMANDS));
+        for (const auto& command : BUILTIN_COMMANDS) {
+            Oroto::CommandEntry entry = Oroto::CommandRegistry::makeEntry(
+                command.path, KERNEL_OWNER, command.handler, command.usage, command.description, command.minArgs);
+            entry.category = command.category ? command.category : "";
+            for (const auto& streamCommand : STREAM_COMMANDS) {
+                if (std::strcmp(streamCommand.path, command.path) == 0) {
+                    entry.stream = streamCommand.stream;
+                }
+            }
+            entries.push_back(std::move(entry));
+        }
+        Oroto::getCommandRegistry().replaceOwner(KERNEL_OWNER, std::move(entries));
+    });
 }
 
 void showJobs() {
-    std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                        ACTIVE JOBS MANAGER                      ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("ACTIVE JOBS MANAGER");
 
     auto& threadPool = Oroto::getThreadPool();
     auto jobs = threadPool.listJobs();
+    std::sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a->id < b->id; });
     auto stats = threadPool.getStats();
 
-    std::cout << WHITE << "Thread Pool Statistics:" << RESET << "\n";
-    std::cout << GREEN << "  Active Threads: " << stats.numThreads << RESET << "\n";
-    std::cout << GREEN << "  Queue Size: " << stats.queueSize << RESET << "\n";
-    std::cout << GREEN << "  Total Jobs: " << stats.totalJobs << RESET << "\n";
-    std::cout << GREEN << "  Pending: " << stats.pendingJobs << RESET << "\n";
-    std::cout << GREEN << "  Running: " << stats.runningJobs << RESET << "\n";
-    std::cout << GREEN << "  Completed: " << stats.completedJobs << RESET << "\n";
-    std::cout << GREEN << "  Failed: " << stats.failedJobs << RESET << "\n\n";
+    out.section("Thread Pool Statistics");
+    out.field("  Active Threads", std::to_string(stats.numThreads), Tone::OK, 0);
+    out.field("  Queue Size", std::to_string(stats.queueSize), Tone::OK, 0);
+    out.field("  Total Jobs", std::to_string(stats.totalJobs), Tone::OK, 0);
+    out.field("  Pending", std::to_string(stats.pendingJobs), Tone::OK, 0);
+    out.field("  Running", std::to_string(stats.runningJobs), Tone::OK, 0);
+    out.field("  Completed", std::to_string(stats.completedJobs), Tone::OK, 0);
+    out.field("  Failed", std::to_string(stats.failedJobs), Tone::OK, 0);
+    out.blank();
 
     if (jobs.empty()) {
-        std::cout << YELLOW << "No active jobs" << RESET << "\n\n";
+        out.message(Tone::WARNING, "", "No active jobs");
+        out.blank();
         return;
     }
 
-    std::cout << WHITE << "Job ID  Status      Name                Duration" << RESET << "\n";
-    std::cout << WHITE << "------  ----------  ------------------  --------" << RESET << "\n";
+    out.decoration(WHITE "Job ID  Status      Name                Duration  Output" RESET "\n"
+                   WHITE "------  ----------  ------------------  --------  ------" RESET "\n");
 
     for (const auto& job : jobs) {
-        std::string statusStr;
-        std::string color;
+        std::string_view statusStr;
+        Tone tone = Tone::PLAIN;
 
         switch (job->status) {
             case Oroto::JobStatus::PENDING:
                 statusStr = "PENDING";
-                color = YELLOW;
+                tone = Tone::PROGRESS;
                 break;
             case Oroto::JobStatus::RUNNING:
                 statusStr = "RUNNING";
-                color = GREEN;
+                tone = Tone::OK;
                 break;
             case Oroto::JobStatus::COMPLETED:
                 statusStr = "COMPLETED";
-                color = BLUE;
                 break;
             case Oroto::JobStatus::FAILED:
                 statusStr = "FAILED";
-                color = RED;
+                tone = Tone::ERROR;
                 break;
             case Oroto::JobStatus::CANCELLED:
                 statusStr = "CANCELLED";
-                color = MAGENTA;
+                tone = Tone::WARNING;
                 break;
         }
 
-        auto duration = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::steady_clock::now() - job->startTime
-        ).count();
+        auto end = job->finished() ? job->endTime : std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - job->startTime).count();
+        std::string output = job->output ? std::to_string(job->output->size()) + "B" : "-";
+
+        out.row({{"id", std::to_string(job->id), -6}, {"status", statusStr, -10},
+                 {"name", std::string_view(job->name).substr(0, 18), -18},
+                 {"duration", std::to_string(duration) + "s", -8}, {"output", output, 0}},
+                tone);
+    }
+    out.blank();
+}
+
+static bool parseJobId(std::string_view jobIdStr, size_t& jobId) {
+    auto [end, ec] = std::from_chars(jobIdStr.data(), jobIdStr.data() + jobIdStr.size(), jobId);
+    if (ec != std::errc() || end != jobIdStr.data() + jobIdStr.size()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid job ID: ", jobIdStr});
+        Oroto::out().blank();
+        return false;
+    }
+    return true;
+}
+
+// The job's result as a command status, so 'wait 3 && ...' chains on it
+static Oroto::Status jobOutcome(const Oroto::JobInfo& job) {
+    switch (job.status.load()) {
+        case Oroto::JobStatus::COMPLETED:
+            return Oroto::ok();
+        case Oroto::JobStatus::CANCELLED:
+            return Oroto::makeError(Oroto::ErrorCode::CANCELLED);
+        default:
+            return Oroto::makeError(job.errorCode);
+    }
+}
 
-        std::cout << WHITE << std::setw(6) << job->id << "  "
-                  << color << std::setw(10) << statusStr << WHITE << "  "
-                  << std::setw(18) << job->name.substr(0, 18) << "  "
-                  << std::setw(8) << duration << "s" << RESET << "\n";
+static void reportFinished(const Oroto::JobInfo& job) {
+    std::string id = std::to_string(job.id);
+    switch (job.status.load()) {
+        case Oroto::JobStatus::COMPLETED:
+            Oroto::out().message(Tone::OK, "JOBS", {"Job ", id, " done: ", job.name});
+            break;
+        case Oroto::JobStatus::CANCELLED:
+            Oroto::out().message(Tone::WARNING, "JOBS", {"Job ", id, " cancelled: ", job.name});
+            break;
+        default:
+            Oroto::out().message(Tone::ERROR, "JOBS", {"Job ", id, " failed (", job.error, "): ", job.name});
+            break;
     }
-    std::cout << "\n";
 }
 
-void killJob(const std::string& jobIdStr) {
-    try {
-        size_t jobId = std::stoull(jobIdStr);
-        auto& threadPool = Oroto::getThreadPool();
+Oroto::Status killJob(std::string_view jobIdStr) {
+    size_t jobId = 0;
+    if (!parseJobId(jobIdStr, jobId)) {
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    auto& threadPool = Oroto::getThreadPool();
 
-        if (threadPool.cancelJob(jobId)) {
-            std::cout << GREEN << "[JOBS] Job " << jobId << " cancelled successfully" << RESET << "\n\n";
+    if (threadPool.cancelJob(jobId)) {
+        auto job = threadPool.getJobInfo(jobId);
+        if (job && job->finished()) {
+            Oroto::out().message(Tone::OK, "JOBS", {"Job ", std::to_string(jobId), " cancelled successfully"});
         } else {
-            std::cout << RED << "[ERROR] Cannot cancel job " << jobId 
-                      << " (not found or already running)" << RESET << "\n\n";
+            Oroto::out().message(Tone::OK, "JOBS", {"Job ", std::to_string(jobId), " will stop at its next step"});
+        }
+        Oroto::out().blank();
+        return Oroto::ok();
+    }
+    Oroto::out().message(Tone::ERROR, "ERROR", {"Cannot cancel job ", std::to_string(jobId), " (not found or already finished)"});
+    Oroto::out().blank();
+    return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+}
+
+// 'wait' blocks until every job has finished, 'wait N' until job N has
+Oroto::Status waitJobs(const CommandArgs& args) {
+    auto& threadPool = Oroto::getThreadPool();
+
+    if (args.size() >= 2) {
+        size_t jobId = 0;
+        if (!parseJobId(args[1], jobId)) {
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        auto job = threadPool.waitJob(jobId);
+        if (!job) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"No such job: ", std::to_string(jobId)});
+            Oroto::out().blank();
+            return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+        }
+        reportFinished(*job);
+        return jobOutcome(*job);
+    }
+
+    Oroto::Status status = Oroto::ok();
+    auto jobs = threadPool.listJobs();
+    std::sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a->id < b->id; });
+    for (const auto& job : jobs) {
+        if (!job->finished()) {
+            threadPool.waitJob(job->id);
+            reportFinished(*job);
+        }
+        if (status.hasValue()) {
+            status = jobOutcome(*job);
+        }
+    }
+    return status;
+}
+
+// Prints what the job has written so far, then follows it live until it ends
+Oroto::Status foregroundJob(std::string_view jobIdStr) {
+    size_t jobId = 0;
+    if (!parseJobId(jobIdStr, jobId)) {
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    auto& threadPool = Oroto::getThreadPool();
+    auto job = threadPool.waitJobStarted(jobId);
+    if (!job || !job->output) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"No background job ", std::to_string(jobId)});
+        Oroto::out().blank();
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+    }
+
+    size_t offset = 0;
+    std::string chunk;
+    while (true) {
+        chunk.clear();
+        bool closed = job->output->closed();
+        offset = job->output->readFrom(offset, chunk, !closed);
+        std::cout << chunk << std::flush;
+        if (closed && chunk.empty()) {
+            break;
         }
-    } catch (const std::exception& e) {
-        std::cout << RED << "[ERROR] Invalid job ID: " << jobIdStr << RESET << "\n\n";
     }
-}
\ No newline at end of file
+
+    threadPool.waitJob(jobId);
+    reportFinished(*job);
+    return jobOutcome(*job);
+}
+
+Oroto::Status executePluginCommand(const CommandArgs& args) {
+    auto& pluginManager = Oroto::getPluginManager();
+    std::string_view action = args.size() >= 3 ? std::string_view(args[2]) : std::string_view("list");
+
+    if (action == "list") {
+        Oroto::OutputWriter& out = Oroto::out();
+        auto plugins = pluginManager.listPlugins();
+        out.field("Loaded plugins", std::to_string(plugins.size()), Tone::OK, 0);
+        for (const auto& plugin : plugins) {
+            std::string reloaded = plugin.generation > 0 ? ", reloaded " + std::to_string(plugin.generation) + "x" : "";
+            out.row({{"name", plugin.name, 0}, {"version", "v" + plugin.version, 0},
+                     {"file", "(" + plugin.filename + reloaded + ")", 0}, {"description", plugin.description, 0}},
+                    Tone::OK);
+        }
+
+        auto commands = Oroto::getCommandRegistry().listCommands();
+        commands.erase(std::remove_if(commands.begin(), commands.end(),
+                                      [](const auto& command) { return command->owner == KERNEL_OWNER; }),
+                       commands.end());
+        if (!commands.empty()) {
+            out.blank();
+            out.section("Plugin commands");
+            for (const auto& command : commands) {
+                out.item(command->usage, command->description + " [" + command->owner + "]", 24);
+            }
+        }
+        out.blank();
+        return Oroto::ok();
+    }
+
+    if ((action == "load" || action == "unload" || action == "reload") && args.size() < 4) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Use 'oroto plugin ", action, " [file]'"});
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    if (action == "load") {
+        std::string filename(args[3]);
+        if (!pluginManager.loadPlugin(filename)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Failed to load plugin: ", filename});
+            return Oroto::makeError(Oroto::ErrorCode::FILE_NOT_FOUND);
+        }
+        Oroto::out().message(Tone::OK, "PLUGIN", {"Loaded ", filename});
+        Oroto::out().blank();
+    } else if (action == "unload") {
+        std::string filename(args[3]);
+        if (!pluginManager.unloadPlugin(filename)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Plugin not loaded: ", filename});
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        Oroto::out().message(Tone::OK, "PLUGIN", {"Unloaded ", filename});
+        Oroto::out().blank();
+    } else if (action == "reload") {
+        std::string filename(args[3]);
+        if (!pluginManager.reloadPlugin(filename)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Failed to reload plugin: ", filename, " (the running version is unchanged)"});
+            return Oroto::makeError(Oroto::ErrorCode::INTERNAL_ERROR);
+        }
+        Oroto::out().message(Tone::OK, "PLUGIN", {"Reloaded ", filename});
+        Oroto::out().blank();
+    } else {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Plugin usage: oroto plugin [list|load|unload|reload] [file]");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    return Oroto::ok();
+}
@@ -1,5 +1,8 @@
 #include "lib/oroto_shell.h"
 #include "lib/colors.h"
+#include "lib/batch_runner.h"
+#include "lib/thread_pool.h"
+#include "lib/output_writer.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -8,126 +11,151 @@
 #include <fstream>
 #include <iomanip>
 
+using Oroto::Tone;
+
 void simulateDeviceOperation(int milliseconds) {
+    // Delays are where a killed background job stops
+    Oroto::ThreadPool::cancellationPoint();
+    if (Oroto::isBatchMode()) {
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
 void cameraOpen() {
-    std::cout << YELLOW << "[CAMERA] Initializing camera hardware..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "CAMERA", "Initializing camera hardware...");
     simulateDeviceOperation(1200);
 
-    std::cout << GREEN << "[CAMERA] Camera module activated" << RESET << "\n";
-    std::cout << WHITE << "Resolution: 12MP (4032x3024)" << RESET << "\n";
-    std::cout << WHITE << "Status: Ready for capture" << RESET << "\n";
-    std::cout << WHITE << "Focus: Auto-focus enabled" << RESET << "\n";
-    std::cout << WHITE << "Flash: Available" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "CAMERA", "Camera module activated");
+    Oroto::out().field("Resolution", "12MP (4032x3024)", Tone::PLAIN, 0);
+    Oroto::out().field("Status", "Ready for capture", Tone::PLAIN, 0);
+    Oroto::out().field("Focus", "Auto-focus enabled", Tone::PLAIN, 0);
+    Oroto::out().field("Flash", "Available", Tone::PLAIN, 0);
+    Oroto::out().blank();
 }
 
 void cameraSnap() {
-    std::cout << YELLOW << "[CAMERA] Preparing to capture image..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "CAMERA", "Preparing to capture image...");
     simulateDeviceOperation(800);
 
-    std::cout << GREEN << "[CAMERA] 📸 Photo captured successfully!" << RESET << "\n";
-    std::cout << WHITE << "Filename: IMG_" << std::time(nullptr) << ".jpg" << RESET << "\n";
-    std::cout << WHITE << "Size: 2.4MB" << RESET << "\n";
-    std::cout << WHITE << "Location: /storage/photos/" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "CAMERA", "📸 Photo captured successfully!");
+    Oroto::out().field("Filename", "IMG_" + std::to_string(std::time(nullptr)) + ".jpg", Tone::PLAIN, 0);
+    Oroto::out().field("Size", "2.4MB", Tone::PLAIN, 0);
+    Oroto::out().field("Location", "/storage/photos/", Tone::PLAIN, 0);
+    Oroto::out().blank();
 }
 
 void cameraClose() {
-    std::cout << YELLOW << "[CAMERA] Shutting down camera..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "CAMERA", "Shutting down camera...");
     simulateDeviceOperation(500);
-    std::cout << GREEN << "[CAMERA] Camera hardware deactivated" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "CAMERA", "Camera hardware deactivated");
+    Oroto::out().blank();
 }
 
 void microphoneStatus() {
-    std::cout << YELLOW << "[MICROPHONE] Checking microphone status..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "MICROPHONE", "Checking microphone status...");
     simulateDeviceOperation(600);
 
-    std::cout << GREEN << "[MICROPHONE] Hardware detected and functional" << RESET << "\n";
-    std::cout << WHITE << "Type: Digital MEMS microphone" << RESET << "\n";
-    std::cout << WHITE << "Sample Rate: 48kHz" << RESET << "\n";
-    std::cout << WHITE << "Bit Depth: 16-bit" << RESET << "\n";
-    std::cout << WHITE << "Status: Ready for recording" << RESET << "\n";
-    std::cout << WHITE << "Noise Cancellation: Active" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "MICROPHONE", "Hardware detected and functional");
+    Oroto::out().field("Type", "Digital MEMS microphone", Tone::PLAIN, 0);
+    Oroto::out().field("Sample Rate", "48kHz", Tone::PLAIN, 0);
+    Oroto::out().field("Bit Depth", "16-bit", Tone::PLAIN, 0);
+    Oroto::out().field("Status", "Ready for recording", Tone::PLAIN, 0);
+    Oroto::out().field("Noise Cancellation", "Active", Tone::PLAIN, 0);
+    Oroto::out().blank();
 }
 
 void microphoneStart() {
-    std::cout << YELLOW << "[MICROPHONE] Starting audio recording..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "MICROPHONE", "Starting audio recording...");
     simulateDeviceOperation(700);
 
-    std::cout << GREEN << "[MICROPHONE] 🎤 Recording started" << RESET << "\n";
-    std::cout << WHITE << "Format: WAV (PCM)" << RESET << "\n";
-    std::cout << WHITE << "Quality: High (48kHz/16-bit)" << RESET << "\n";
-    std::cout << RED << "Press 'oroto mic stop' to end recording" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "MICROPHONE", "🎤 Recording started");
+    Oroto::out().field("Format", "WAV (PCM)", Tone::PLAIN, 0);
+    Oroto::out().field("Quality", "High (48kHz/16-bit)", Tone::PLAIN, 0);
+    Oroto::out().message(Tone::HINT, "", "Press 'oroto mic stop' to end recording");
+    Oroto::out().blank();
 }
 
 void microphoneStop() {
-    std::cout << YELLOW << "[MICROPHONE] Stopping recording..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "MICROPHONE", "Stopping recording...");
     simulateDeviceOperation(500);
 
-    std::cout << GREEN << "[MICROPHONE] Recording saved successfully" << RESET << "\n";
-    std::cout << WHITE << "Filename: REC_" << std::time(nullptr) << ".wav" << RESET << "\n";
-    std::cout << WHITE << "Duration: 00:01:23" << RESET << "\n";
-    std::cout << WHITE << "Size: 1.2MB" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "MICROPHONE", "Recording saved successfully");
+    Oroto::out().field("Filename", "REC_" + std::to_string(std::time(nullptr)) + ".wav", Tone::PLAIN, 0);
+    Oroto::out().field("Duration", "00:01:23", Tone::PLAIN, 0);
+    Oroto::out().field("Size", "1.2MB", Tone::PLAIN, 0);
+    Oroto::out().blank();
 }
 
 void storageInfo() {
-    std::cout << YELLOW << "[STORAGE] Analyzing storage devices..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "STORAGE", "Analyzing storage devices...");
     simulateDeviceOperation(1000);
 
-    std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                        STORAGE ANALYSIS                         ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-
-    std::cout << WHITE << "Internal Storage:" << RESET << "\n";
-    std::cout << GREEN << "  Device: /dev/storage0" << RESET << "\n";
-    std::cout << WHITE << "  Type: UFS 3.1 Flash" << RESET << "\n";
-    std::cout << WHITE << "  Total: 256GB" << RESET << "\n";
-    std::cout << WHITE << "  Used: 58GB (23%)" << RESET << "\n";
-    std::cout << WHITE << "  Free: 198GB (77%)" << RESET << "\n";
-    std::cout << WHITE << "  Health: Excellent" << RESET << "\n\n";
-
-    std::cout << WHITE << "Memory (RAM):" << RESET << "\n";
-    std::cout << GREEN << "  Device: /dev/mem0" << RESET << "\n";
-    std::cout << WHITE << "  Type: LPDDR5" << RESET << "\n";
-    std::cout << WHITE << "  Total: 8GB" << RESET << "\n";
-    std::cout << WHITE << "  Used: 2.1GB (26%)" << RESET << "\n";
-    std::cout << WHITE << "  Available: 5.9GB (74%)" << RESET << "\n";
-    std::cout << WHITE << "  Speed: 6400 MT/s" << RESET << "\n\n";
-
-    std::cout << GREEN << "[STORAGE] All storage devices healthy and operational" << RESET << "\n\n";
+    Oroto::out().title("STORAGE ANALYSIS");
+
+    Oroto::out().section("Internal Storage");
+    Oroto::out().field("  Device", "/dev/storage0", Tone::OK, 0);
+    Oroto::out().field("  Type", "UFS 3.1 Flash", Tone::PLAIN, 0);
+    Oroto::out().field("  Total", "256GB", Tone::PLAIN, 0);
+    Oroto::out().field("  Used", "58GB (23%)", Tone::PLAIN, 0);
+    Oroto::out().field("  Free", "198GB (77%)", Tone::PLAIN, 0);
+    Oroto::out().field("  Health", "Excellent", Tone::PLAIN, 0);
+    Oroto::out().blank();
+
+    Oroto::out().section("Memory (RAM)");
+    Oroto::out().field("  Device", "/dev/mem0", Tone::OK, 0);
+    Oroto::out().field("  Type", "LPDDR5", Tone::PLAIN, 0);
+    Oroto::out().field("  Total", "8GB", Tone::PLAIN, 0);
+    Oroto::out().field("  Used", "2.1GB (26%)", Tone::PLAIN, 0);
+    Oroto::out().field("  Available", "5.9GB (74%)", Tone::PLAIN, 0);
+    Oroto::out().field("  Speed", "6400 MT/s", Tone::PLAIN, 0);
+    Oroto::out().blank();
+
+    Oroto::out().message(Tone::OK, "STORAGE", "All storage devices healthy and operational");
+    Oroto::out().blank();
 }
 
-void storageWrite(const std::vector<std::string>& args) {
-    if (args.size() < 4) {
-        std::cout << RED << "[ERROR] Usage: oroto storage write [filename] [data]" << RESET << "\n";
-        return;
+Oroto::Status storageWrite(const CommandArgs& args) {
+    const size_t first = actionOperand(args);
+    if (args.size() <= first) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Usage: storage write [filename] [data]");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
     }
 
-    std::string filename = args[3];
-    std::cout << YELLOW << "[STORAGE] Writing to file: " << filename << RESET << "\n";
+    std::string filename(args[first]);
+    Oroto::out().message(Tone::PROGRESS, "STORAGE", {"Writing to file: ", filename});
     simulateDeviceOperation(800);
 
-    std::cout << GREEN << "[STORAGE] ✍️  File written successfully" << RESET << "\n";
-    std::cout << WHITE << "Path: /storage/user/" << filename << RESET << "\n";
-    std::cout << WHITE << "Size: " << (rand() % 1000 + 100) << " bytes" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "STORAGE", "✍️  File written successfully");
+    Oroto::out().field("Path", "/storage/user/" + filename, Tone::PLAIN, 0);
+    if (args.size() > first + 1) {
+        Oroto::out().field("Size", std::to_string(args[first + 1].size()) + " bytes", Tone::PLAIN, 0);
+        Oroto::out().blank();
+    } else {
+        Oroto::out().field("Size", std::to_string(rand() % 1000 + 100) + " bytes", Tone::PLAIN, 0);
+        Oroto::out().blank();
+    }
+    return Oroto::ok();
 }
 
-void storageRead(const std::vector<std::string>& args) {
-    if (args.size() < 4) {
-        std::cout << RED << "[ERROR] Usage: oroto storage read [filename]" << RESET << "\n";
-        return;
+Oroto::Status storageRead(const CommandArgs& args) {
+    const size_t first = actionOperand(args);
+    if (args.size() <= first) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Usage: storage read [filename]");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
     }
 
-    std::string filename = args[3];
-    std::cout << YELLOW << "[STORAGE] Reading file: " << filename << RESET << "\n";
+    std::string filename(args[first]);
+    Oroto::out().message(Tone::PROGRESS, "STORAGE", {"Reading file: ", filename});
     simulateDeviceOperation(600);
 
-    std::cout << GREEN << "[STORAGE] 📖 File read successfully" << RESET << "\n";
-    std::cout << WHITE << "Content preview: [Binary data - " << (rand() % 5000 + 500) << " bytes]" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "STORAGE", "📖 File read successfully");
+    Oroto::out().field("Content preview", "[Binary data - " + std::to_string(rand() % 5000 + 500) + " bytes]", Tone::PLAIN, 0);
+    Oroto::out().blank();
+    return Oroto::ok();
 }
 
-void executeDeviceCommand(const std::string& device, const std::string& action, const std::vector<std::string>& args) {
+Oroto::Status executeDeviceCommand(const std::string& device, std::string_view action, const CommandArgs& args) {
     if (device == "camera") {
         if (action == "open") {
             cameraOpen();
@@ -136,8 +164,9 @@ void executeDeviceCommand(const std::string& device, const std::string& action,
         } else if (action == "close") {
             cameraClose();
         } else {
-            std::cout << RED << "[ERROR] Unknown camera action: " << action << RESET << "\n";
-            std::cout << YELLOW << "[HINT] Available: open, snap, close" << RESET << "\n";
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown camera action: ", action});
+            Oroto::out().message(Tone::HINT, "HINT", "Available: open, snap, close");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
         }
     } else if (device == "microphone") {
         if (action == "status") {
@@ -147,25 +176,29 @@ void executeDeviceCommand(const std::string& device, const std::string& action,
         } else if (action == "stop") {
             microphoneStop();
         } else {
-            std::cout << RED << "[ERROR] Unknown microphone action: " << action << RESET << "\n";
-            std::cout << YELLOW << "[HINT] Available: status, start, stop" << RESET << "\n";
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown microphone action: ", action});
+            Oroto::out().message(Tone::HINT, "HINT", "Available: status, start, stop");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
         }
     } else if (device == "storage") {
         if (action == "info") {
             storageInfo();
         } else if (action == "write") {
-            storageWrite(args);
+            return storageWrite(args);
         } else if (action == "read") {
-            storageRead(args);
+            return storageRead(args);
         } else {
-            std::cout << RED << "[ERROR] Unknown storage action: " << action << RESET << "\n";
-            std::cout << YELLOW << "[HINT] Available: info, write, read" << RESET << "\n";
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown storage action: ", action});
+            Oroto::out().message(Tone::HINT, "HINT", "Available: info, write, read");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
         }
     } else {
-        std::cout << RED << "[ERROR] Unknown device: " << device << RESET << "\n";
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown device: ", device});
+        return Oroto::makeError(Oroto::ErrorCode::DEVICE_ERROR);
     }
+    return Oroto::ok();
 }
 
 void initDeviceInterface() {
-    std::cout << GREEN << "[DEVICES] Hardware abstraction layer initialized" << RESET << "\n";
+    Oroto::out().message(Tone::OK, "DEVICES", "Hardware abstraction layer initialized");
 }
\ No newline at end of file
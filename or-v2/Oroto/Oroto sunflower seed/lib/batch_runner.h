@@ -0,0 +1,105 @@
+#ifndef OROTO_BATCH_RUNNER_H
+#define OROTO_BATCH_RUNNER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <iostream>
+#include <string>
+#include "expected.h"
+
+namespace Oroto {
+
+// Process-wide switch set once at startup. In batch mode nothing waits on a
+// human: simulated delays return at once and tools take menu choices from
+// flags (or their defaults) instead of reading std::cin.
+inline std::atomic<bool>& batchModeFlag() {
+    static std::atomic<bool> flag(false);
+    return flag;
+}
+
+inline bool isBatchMode() {
+    return batchModeFlag().load(std::memory_order_relaxed);
+}
+
+inline void setBatchMode(bool enabled) {
+    batchModeFlag().store(enabled, std::memory_order_relaxed);
+}
+
+struct BatchResult {
+    size_t commands = 0;
+    size_t failed = 0;
+    double seconds = 0.0;
+
+    double commandsPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(commands) / seconds : 0.0;
+    }
+
+    // Shell convention: 0 when every command succeeded
+    int exitCode() const {
+        return failed == 0 ? 0 : 1;
+    }
+};
+
+// Runs a script one line at a time until EOF or stop(). Blank lines and lines
+// starting with '#' are skipped; a failing line is reported on stderr with its
+// line number and the run carries on, unless stopOnError is set.
+class BatchRunner {
+public:
+    using Executor = std::function<Status(const std::string&)>;
+
+private:
+    Executor execute_;
+    bool stopOnError_;
+    bool stopped_;
+
+    static bool isSkippable(const std::string& line) {
+        size_t first = line.find_first_not_of(" \t\r");
+        return first == std::string::npos || line[first] == '#';
+    }
+
+public:
+    explicit BatchRunner(Executor execute, bool stopOnError = false)
+        : execute_(std::move(execute)), stopOnError_(stopOnError), stopped_(false) {}
+
+    // Called from the executor (e.g. for 'oroto poweroff') to end the run after this line
+    void stop() {
+        stopped_ = true;
+    }
+
+    BatchResult run(std::istream& input) {
+        BatchResult result;
+        std::string line;
+        size_t lineNumber = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (!stopped_ && std::getline(input, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (isSkippable(line)) {
+                continue;
+            }
+
+            ++result.commands;
+            Status status = execute_(line);
+            if (!status) {
+                ++result.failed;
+                std::cerr << "[BATCH] line " << lineNumber << " failed ("
+                          << errorMessage(status.error()) << "): " << line << "\n";
+                if (stopOnError_) {
+                    break;
+                }
+            }
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_BATCH_RUNNER_H
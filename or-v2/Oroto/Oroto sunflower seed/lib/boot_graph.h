@@ -0,0 +1,222 @@
+#ifndef OROTO_BOOT_GRAPH_H
+#define OROTO_BOOT_GRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "expected.h"
+#include "thread_pool.h"
+
+namespace Oroto {
+
+// Process-wide switch set once at startup: boot through a BootGraph with no
+// cosmetic delays. Script and daemon runs always boot fast.
+inline std::atomic<bool>& fastBootFlag() {
+    static std::atomic<bool> flag(false);
+    return flag;
+}
+
+inline bool isFastBoot() {
+    return fastBootFlag().load(std::memory_order_relaxed);
+}
+
+inline void setFastBoot(bool enabled) {
+    fastBootFlag().store(enabled, std::memory_order_relaxed);
+}
+
+struct BootStageTiming {
+    std::string name;
+    double startMs = 0.0;      // since run() began
+    double durationMs = 0.0;
+    bool ran = false;          // false: skipped because a dependency failed
+    bool succeeded = false;
+};
+
+// Subsystem initialisation as a dependency graph. run() starts every stage as
+// soon as all stages it depends on have succeeded, spreading independent
+// stages over the ThreadPool (the calling thread takes stages too, so a busy
+// pool only slows boot down). A failed stage skips everything that depends on
+// it; run() reports the first failure.
+class BootGraph {
+public:
+    using StageFn = std::function<Status()>;
+
+private:
+    struct Stage {
+        std::string name;
+        std::vector<std::string> dependsOn;
+        StageFn fn;
+        std::vector<size_t> dependents;
+        size_t waitingOn = 0;
+    };
+
+    std::vector<Stage> stages_;
+    std::vector<BootStageTiming> timings_;
+    std::string failedStage_;
+    double totalMs_ = 0.0;
+
+public:
+    void addStage(std::string name, std::vector<std::string> dependsOn, StageFn fn) {
+        Stage stage;
+        stage.name = std::move(name);
+        stage.dependsOn = std::move(dependsOn);
+        stage.fn = std::move(fn);
+        stages_.push_back(std::move(stage));
+    }
+
+    // INVALID_ARGUMENTS for an unknown dependency or a cycle (nothing runs);
+    // otherwise the error of the first stage that failed
+    Status run(ThreadPool& pool) {
+        const size_t count = stages_.size();
+        timings_.assign(count, BootStageTiming());
+        failedStage_.clear();
+        totalMs_ = 0.0;
+
+        std::unordered_map<std::string, size_t> index;
+        for (size_t i = 0; i < count; ++i) {
+            timings_[i].name = stages_[i].name;
+            stages_[i].dependents.clear();
+            index[stages_[i].name] = i;
+        }
+        std::deque<size_t> ready;
+        for (size_t i = 0; i < count; ++i) {
+            stages_[i].waitingOn = stages_[i].dependsOn.size();
+            for (const auto& dependency : stages_[i].dependsOn) {
+                auto it = index.find(dependency);
+                if (it == index.end()) {
+                    failedStage_ = stages_[i].name;
+                    return makeError(ErrorCode::INVALID_ARGUMENTS);
+                }
+                stages_[it->second].dependents.push_back(i);
+            }
+            if (stages_[i].waitingOn == 0) {
+                ready.push_back(i);
+            }
+        }
+        if (!isAcyclic(ready)) {
+            return makeError(ErrorCode::INVALID_ARGUMENTS);
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t settled = 0;
+        ErrorCode firstError = ErrorCode::SUCCESS;
+        const auto start = std::chrono::steady_clock::now();
+        auto since = [start](std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration<double, std::milli>(t - start).count();
+        };
+
+        // Marks `failed` and everything downstream of it as settled without running
+        std::function<void(size_t)> skipDependents = [&](size_t failed) {
+            for (size_t dependent : stages_[failed].dependents) {
+                if (stages_[dependent].waitingOn != SIZE_MAX) {
+                    stages_[dependent].waitingOn = SIZE_MAX;
+                    ++settled;
+                    skipDependents(dependent);
+                }
+            }
+        };
+
+        auto drain = [&](size_t) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                changed.wait(lock, [&] { return !ready.empty() || settled == count; });
+                if (ready.empty()) {
+                    return;
+                }
+                size_t current = ready.front();
+                ready.pop_front();
+
+                lock.unlock();
+                auto began = std::chrono::steady_clock::now();
+                Status status = makeError(ErrorCode::INTERNAL_ERROR);
+                try {
+                    status = stages_[current].fn();
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Boot", "Stage " + stages_[current].name + " threw: " + e.what());
+                }
+                auto ended = std::chrono::steady_clock::now();
+                lock.lock();
+
+                BootStageTiming& timing = timings_[current];
+                timing.ran = true;
+                timing.succeeded = status.hasValue();
+                timing.startMs = since(began);
+                timing.durationMs = std::chrono::duration<double, std::milli>(ended - began).count();
+                ++settled;
+
+                if (status.hasValue()) {
+                    for (size_t dependent : stages_[current].dependents) {
+                        if (stages_[dependent].waitingOn != SIZE_MAX && --stages_[dependent].waitingOn == 0) {
+                            ready.push_back(dependent);
+                        }
+                    }
+                } else {
+                    if (firstError == ErrorCode::SUCCESS) {
+                        firstError = status.error();
+                        failedStage_ = stages_[current].name;
+                    }
+                    skipDependents(current);
+                }
+                changed.notify_all();
+            }
+        };
+
+        // More drainers than the widest level of the graph would only wait
+        pool.parallelFor(std::min(count, pool.workerCount() + 1), drain);
+
+        totalMs_ = since(std::chrono::steady_clock::now());
+        if (firstError != ErrorCode::SUCCESS) {
+            return makeError(firstError);
+        }
+        return ok();
+    }
+
+    // Per-stage results of the last run(), in the order stages were added
+    const std::vector<BootStageTiming>& timings() const { return timings_; }
+    const std::string& failedStage() const { return failedStage_; }
+    double totalMs() const { return totalMs_; }
+
+private:
+    // Kahn's algorithm over a copy of the in-degrees
+    bool isAcyclic(const std::deque<size_t>& roots) {
+        std::vector<size_t> waiting(stages_.size());
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            waiting[i] = stages_[i].waitingOn;
+        }
+        std::vector<size_t> queue(roots.begin(), roots.end());
+        size_t visited = 0;
+        while (!queue.empty()) {
+            size_t current = queue.back();
+            queue.pop_back();
+            ++visited;
+            for (size_t dependent : stages_[current].dependents) {
+                if (--waiting[dependent] == 0) {
+                    queue.push_back(dependent);
+                }
+            }
+        }
+        if (visited == stages_.size()) {
+            return true;
+        }
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            if (waiting[i] != 0) {
+                failedStage_ = stages_[i].name;
+                break;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_BOOT_GRAPH_H
@@ -0,0 +1,134 @@
+#ifndef OROTO_COMMAND_ARENA_H
+#define OROTO_COMMAND_ARENA_H
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+namespace Oroto {
+
+// Bump allocator scoped to one command execution.
+// Allocations are served from an inline buffer first and spill into heap
+// blocks that are kept between commands, so a warmed-up arena never touches
+// the global heap. Individual deallocations are no-ops; memory is released
+// all at once by rewinding to a marker (or reset()).
+class CommandArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t INLINE_SIZE = 4096;
+    static constexpr size_t BLOCK_SIZE = 16384;
+
+    // Position inside the arena, used to free everything allocated after it
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    CommandArena() : current_(0), offset_(0), highWater_(0) {}
+
+    CommandArena(const CommandArena&) = delete;
+    CommandArena& operator=(const CommandArena&) = delete;
+
+    Marker mark() const { return Marker{current_, offset_}; }
+
+    void rewind(const Marker& marker) {
+        current_ = marker.block;
+        offset_ = marker.offset;
+    }
+
+    // Free every allocation; spill blocks stay around for the next command
+    void reset() { rewind(Marker{0, 0}); }
+
+    // Bytes handed out since the last reset (approximate across blocks)
+    size_t bytesUsed() const {
+        size_t used = offset_;
+        for (size_t i = 0; i < current_; ++i) {
+            used += blockSize(i);
+        }
+        return used;
+    }
+
+    size_t highWaterMark() const { return highWater_; }
+    size_t spillBlockCount() const { return blocks_.size(); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        while (true) {
+            std::byte* base = blockData(current_);
+            size_t size = blockSize(current_);
+            uintptr_t start = reinterpret_cast<uintptr_t>(base) + offset_;
+            uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t(alignment) - 1);
+            size_t padding = aligned - start;
+
+            if (offset_ + padding + bytes <= size) {
+                offset_ += padding + bytes;
+                highWater_ = std::max(highWater_, bytesUsed());
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // Move to the next spill block, reusing one from an earlier command if it fits
+            size_t next = current_ + 1;
+            if (next > blocks_.size() || blockSize(next) < bytes + alignment) {
+                size_t newSize = std::max(BLOCK_SIZE, bytes + alignment);
+                Block block{std::unique_ptr<std::byte[]>(new std::byte[newSize]), newSize};
+                if (next > blocks_.size()) {
+                    blocks_.push_back(std::move(block));
+                } else {
+                    blocks_[next - 1] = std::move(block);
+                }
+            }
+            current_ = next;
+            offset_ = 0;
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        // Released in bulk by rewind()/reset()
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    // Block 0 is the inline buffer, block N is blocks_[N - 1]
+    std::byte* blockData(size_t index) {
+        return index == 0 ? inline_ : blocks_[index - 1].data.get();
+    }
+
+    size_t blockSize(size_t index) const {
+        return index == 0 ? INLINE_SIZE : blocks_[index - 1].size;
+    }
+
+    alignas(std::max_align_t) std::byte inline_[INLINE_SIZE];
+    std::vector<Block> blocks_;
+    size_t current_;
+    size_t offset_;
+    size_t highWater_;
+};
+
+// Rewinds the arena to where it was when the scope was entered.
+// Nested scopes (a command dispatching another command) only free their own memory.
+class ArenaScope {
+private:
+    CommandArena& arena_;
+    CommandArena::Marker marker_;
+
+public:
+    explicit ArenaScope(CommandArena& arena) : arena_(arena), marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(marker_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+} // namespace Oroto
+
+#endif // OROTO_COMMAND_ARENA_H
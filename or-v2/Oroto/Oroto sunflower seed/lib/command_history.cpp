@@ -0,0 +1,10 @@
+#include "command_history.h"
+
+namespace Oroto {
+
+CommandHistory& getCommandHistory() {
+    static CommandHistory history;
+    return history;
+}
+
+} // namespace Oroto
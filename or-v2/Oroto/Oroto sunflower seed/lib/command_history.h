@@ -0,0 +1,518 @@
+#ifndef OROTO_COMMAND_HISTORY_H
+#define OROTO_COMMAND_HISTORY_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "expected.h"
+#include "logger.h"
+
+namespace Oroto {
+
+// Fixed sequence of integers that answers "largest value <= x among
+// positions [lo, hi)" in O(L^2) rank lookups at worst, usually O(L), for L
+// bit levels. Each level keeps one bit per position plus a running count of
+// ones per 64 positions; build() is O(n) per level.
+class WaveletMatrix {
+private:
+    struct Level {
+        std::vector<uint64_t> bits;
+        std::vector<uint32_t> ranks;   // ones before each word
+        size_t zeros = 0;
+
+        size_t ones(size_t pos) const {
+            size_t count = ranks[pos / 64];
+            if (pos % 64 != 0) {
+                count += static_cast<size_t>(__builtin_popcountll(bits[pos / 64] & ((uint64_t(1) << (pos % 64)) - 1)));
+            }
+            return count;
+        }
+    };
+    std::vector<Level> levels_;
+
+    // Best value on the levels below `l`; tight while `value` still equals x's high bits
+    int64_t descend(size_t l, size_t lo, size_t hi, uint64_t x, bool tight, uint64_t value) const {
+        if (lo >= hi) {
+            return -1;
+        }
+        if (l == levels_.size()) {
+            return static_cast<int64_t>(value);
+        }
+        const Level& level = levels_[l];
+        uint64_t bit = uint64_t(1) << (levels_.size() - 1 - l);
+        size_t onesLo = level.ones(lo);
+        size_t onesHi = level.ones(hi);
+        if (tight && !(x & bit)) {
+            return descend(l + 1, lo - onesLo, hi - onesHi, x, true, value);
+        }
+        int64_t found = descend(l + 1, level.zeros + onesLo, level.zeros + onesHi, x, tight, value | bit);
+        return found >= 0 ? found : descend(l + 1, lo - onesLo, hi - onesHi, x, false, value);
+    }
+
+public:
+    void build(const std::vector<uint32_t>& values, uint32_t maxValue) {
+        size_t depth = 1;
+        while (depth < 32 && (uint64_t(1) << depth) <= maxValue) {
+            ++depth;
+        }
+        levels_.assign(depth, Level());
+        size_t words = values.size() / 64 + 1;
+        std::vector<uint32_t> current(values);
+        std::vector<uint32_t> next(values.size());
+        for (size_t l = 0; l < depth; ++l) {
+            Level& level = levels_[l];
+            size_t shift = depth - 1 - l;
+            level.bits.assign(words, 0);
+            level.ranks.assign(words + 1, 0);
+            for (size_t i = 0; i < current.size(); ++i) {
+                level.bits[i / 64] |= static_cast<uint64_t>((current[i] >> shift) & 1) << (i % 64);
+            }
+            for (size_t w = 0; w < words; ++w) {
+                level.ranks[w + 1] = level.ranks[w] + static_cast<uint32_t>(__builtin_popcountll(level.bits[w]));
+            }
+            level.zeros = current.size() - level.ranks[words];
+            // Stable split: the next level sees zeros first, then ones
+            size_t zero = 0;
+            size_t one = level.zeros;
+            for (uint32_t value : current) {
+                next[(value >> shift) & 1 ? one++ : zero++] = value;
+            }
+            current.swap(next);
+        }
+    }
+
+    void clear() { levels_.clear(); }
+
+    // Largest value <= x in positions [lo, hi), or -1
+    int64_t maxAtMost(size_t lo, size_t hi, uint64_t x) const {
+        if (levels_.empty()) {
+            return -1;
+        }
+        uint64_t top = (uint64_t(1) << levels_.size()) - 1;
+        return descend(0, lo, hi, std::min(x, top), true, 0);
+    }
+};
+
+struct HistoryEntry {
+    size_t number = 0;       // 1-based position in the file
+    int64_t time = 0;        // unix seconds
+    std::string command;
+};
+
+// Append-only command history shared by every session and process that
+// opens the same file. The log holds one "<unix time>\t<command>\n" line per
+// command, so it doubles as an audit trail; a sidecar index (<path>.idx) holds
+// the byte offset of each line as a native uint64_t. Both are memory-mapped,
+// so opening costs nothing but catching up lines the index is missing (after a
+// crash between the two writes, or a deleted index).
+//
+// Appends take an exclusive flock() on the log, so lines and index slots of
+// concurrent sessions stay in the same order. Readers pick up other sessions'
+// appends by remapping when the index has grown.
+//
+// Prefix search binary-searches a permutation of entry numbers sorted by
+// command text for the range sharing the prefix; a wavelet matrix over the
+// permutation then gives the newest entry in that range below any bound in
+// O(log^2 n). Entries appended since the permutation was last extended are
+// the newest, so they are checked first, one by one; once UNSORTED_LIMIT of
+// them have gathered they are merged in and the matrix is rebuilt, O(n log n)
+// spread over that many appends.
+//
+// Substring search uses postings of every 3-byte gram: the entries holding
+// the term's rarest gram are checked newest first, so the cost follows that
+// gram's frequency rather than the history's length. The postings take about
+// 4 bytes per distinct gram of each command; terms under 3 bytes scan the
+// mapping backwards instead.
+class CommandHistory {
+private:
+    std::string path_;
+    int logFd_;
+    int indexFd_;
+    const char* log_;
+    size_t logSize_;
+    const uint64_t* index_;
+    size_t indexBytes_;
+    size_t count_;
+    std::vector<uint32_t> sorted_;   // entry numbers - 1, ordered by command text
+    size_t sortedCount_;             // entries already merged into sorted_
+    WaveletMatrix sortedIndex_;      // over sorted_, for the newest entry in a range
+    std::unordered_map<uint32_t, std::vector<uint32_t>> grams_;  // gram -> entries - 1, ascending
+    size_t gramCount_;               // entries already in grams_
+    mutable std::mutex mutex_;
+
+    static void unmap(const void* data, size_t size) {
+        if (data && size > 0) {
+            ::munmap(const_cast<void*>(data), size);
+        }
+    }
+
+    static const void* map(int fd, size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        return data == MAP_FAILED ? nullptr : data;
+    }
+
+    static size_t fileSize(int fd) {
+        struct stat info;
+        return ::fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+    }
+
+    static bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Remaps both files if they grew (or shrank) since the last look
+    bool remap() {
+        size_t logSize = fileSize(logFd_);
+        size_t indexBytes = fileSize(indexFd_) / sizeof(uint64_t) * sizeof(uint64_t);
+        if (logSize != logSize_) {
+            unmap(log_, logSize_);
+            log_ = static_cast<const char*>(map(logFd_, logSize));
+            logSize_ = log_ ? logSize : 0;
+        }
+        if (indexBytes != indexBytes_) {
+            unmap(index_, indexBytes_);
+            index_ = static_cast<const uint64_t*>(map(indexFd_, indexBytes));
+            indexBytes_ = index_ ? indexBytes : 0;
+        }
+        count_ = indexBytes_ / sizeof(uint64_t);
+        // An index pointing past the log (log truncated by hand) is useless
+        if (count_ > 0 && index_[count_ - 1] >= logSize_) {
+            count_ = 0;
+            return false;
+        }
+        if (sortedCount_ > count_) {
+            sorted_.clear();
+            sortedIndex_.clear();
+            sortedCount_ = 0;
+        }
+        if (gramCount_ > count_) {
+            grams_.clear();
+            gramCount_ = 0;
+        }
+        return true;
+    }
+
+    // Offset just past the last indexed line
+    size_t indexedEnd() const {
+        if (count_ == 0) {
+            return 0;
+        }
+        const char* line = log_ + index_[count_ - 1];
+        const void* newline = std::memchr(line, '\n', logSize_ - index_[count_ - 1]);
+        return newline ? static_cast<const char*>(newline) - log_ + 1 : logSize_;
+    }
+
+    // Indexes complete lines the index does not cover yet; caller holds the flock
+    bool catchUp() {
+        if (!remap()) {
+            if (::ftruncate(indexFd_, 0) != 0) {
+                return false;
+            }
+            LOG_WARNING("History", "Index of " + path_ + " did not match the log; rebuilding");
+            remap();
+        }
+        size_t end = indexedEnd();
+        if (end >= logSize_) {
+            return true;
+        }
+        std::vector<uint64_t> offsets;
+        for (size_t pos = end; pos < logSize_;) {
+            const void* newline = std::memchr(log_ + pos, '\n', logSize_ - pos);
+            if (!newline) {
+                break;  // a line still being written
+            }
+            offsets.push_back(pos);
+            pos = static_cast<const char*>(newline) - log_ + 1;
+        }
+        if (offsets.empty()) {
+            return true;
+        }
+        if (::lseek(indexFd_, static_cast<off_t>(count_ * sizeof(uint64_t)), SEEK_SET) < 0 ||
+            !writeAll(indexFd_, reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t))) {
+            return false;
+        }
+        return remap();
+    }
+
+    // Command text of entry `i` (0-based) inside the mapping
+    std::string_view commandAt(size_t i) const {
+        size_t start = index_[i];
+        size_t stop = i + 1 < count_ ? index_[i + 1] : indexedEnd();
+        std::string_view line(log_ + start, stop - start);
+        if (!line.empty() && line.back() == '\n') {
+            line.remove_suffix(1);
+        }
+        size_t tab = line.find('\t');
+        return tab == std::string_view::npos ? line : line.substr(tab + 1);
+    }
+
+    HistoryEntry entryAt(size_t i) const {
+        HistoryEntry entry;
+        entry.number = i + 1;
+        entry.time = std::strtoll(log_ + index_[i], nullptr, 10);
+        entry.command = std::string(commandAt(i));
+        return entry;
+    }
+
+    // Picks up appends from other sessions without taking the flock
+    void refresh() {
+        if (fileSize(indexFd_) / sizeof(uint64_t) != count_ || fileSize(logFd_) != logSize_) {
+            remap();
+        }
+    }
+
+    static constexpr size_t UNSORTED_LIMIT = 1024;
+
+    void extendSorted() {
+        if (count_ - sortedCount_ < UNSORTED_LIMIT) {
+            return;
+        }
+        auto less = [this](uint32_t a, uint32_t b) {
+            int order = commandAt(a).compare(commandAt(b));
+            return order != 0 ? order < 0 : a < b;
+        };
+        size_t middle = sorted_.size();
+        for (size_t i = sortedCount_; i < count_; ++i) {
+            sorted_.push_back(static_cast<uint32_t>(i));
+        }
+        std::sort(sorted_.begin() + middle, sorted_.end(), less);
+        std::inplace_merge(sorted_.begin(), sorted_.begin() + middle, sorted_.end(), less);
+        sortedCount_ = count_;
+
+        sortedIndex_.build(sorted_, static_cast<uint32_t>(count_));
+    }
+
+    static constexpr size_t GRAM = 3;
+
+    static uint32_t gramAt(std::string_view text, size_t pos) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+    }
+
+    void extendGrams() {
+        std::vector<uint32_t> grams;
+        for (size_t i = gramCount_; i < count_; ++i) {
+            std::string_view command = commandAt(i);
+            grams.clear();
+            for (size_t pos = 0; pos + GRAM <= command.size(); ++pos) {
+                grams.push_back(gramAt(command, pos));
+            }
+            std::sort(grams.begin(), grams.end());
+            grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+            for (uint32_t gram : grams) {
+                grams_[gram].push_back(static_cast<uint32_t>(i));
+            }
+        }
+        gramCount_ = count_;
+    }
+
+    void closeFiles() {
+        unmap(log_, logSize_);
+        unmap(index_, indexBytes_);
+        if (logFd_ >= 0) {
+            ::close(logFd_);
+        }
+        if (indexFd_ >= 0) {
+            ::close(indexFd_);
+        }
+        logFd_ = indexFd_ = -1;
+        log_ = nullptr;
+        index_ = nullptr;
+        logSize_ = indexBytes_ = count_ = sortedCount_ = gramCount_ = 0;
+        sorted_.clear();
+        sortedIndex_.clear();
+        grams_.clear();
+    }
+
+public:
+    CommandHistory()
+        : logFd_(-1), indexFd_(-1), log_(nullptr), logSize_(0), index_(nullptr),
+          indexBytes_(0), count_(0), sortedCount_(0), gramCount_(0) {}
+
+    ~CommandHistory() { closeFiles(); }
+
+    CommandHistory(const CommandHistory&) = delete;
+    CommandHistory& operator=(const CommandHistory&) = delete;
+
+    Status open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closeFiles();
+        path_ = path;
+        logFd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+        indexFd_ = ::open((path + ".idx").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (logFd_ < 0 || indexFd_ < 0) {
+            LOG_WARNING("History", "Cannot open " + path + ": " + std::strerror(errno));
+            closeFiles();
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        ::flock(logFd_, LOCK_EX);
+        bool indexed = catchUp();
+        ::flock(logFd_, LOCK_UN);
+        if (!indexed) {
+            closeFiles();
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        return ok();
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return logFd_ >= 0;
+    }
+
+    // Records one command line; blank lines are not kept
+    Status append(std::string_view command, int64_t time = static_cast<int64_t>(std::time(nullptr))) {
+        if (command.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+            return ok();
+        }
+        std::string line = std::to_string(time);
+        line += '\t';
+        for (char c : command) {
+            line += (c == '\n' || c == '\r') ? ' ' : c;
+        }
+        line += '\n';
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (logFd_ < 0) {
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        ::flock(logFd_, LOCK_EX);
+        bool written = catchUp();
+        // Finish a line left incomplete by a crash so this one stays whole
+        if (written && logSize_ > 0 && log_[logSize_ - 1] != '\n') {
+            written = writeAll(logFd_, "\n", 1) && catchUp();
+        }
+        uint64_t offset = logSize_;
+        written = written && writeAll(logFd_, line.data(), line.size()) &&
+                  ::lseek(indexFd_, static_cast<off_t>(count_ * sizeof(uint64_t)), SEEK_SET) >= 0 &&
+                  writeAll(indexFd_, reinterpret_cast<const char*>(&offset), sizeof(offset));
+        ::flock(logFd_, LOCK_UN);
+        remap();
+        return written ? ok() : makeError(ErrorCode::INTERNAL_ERROR);
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        return count_;
+    }
+
+    // Entry by 1-based number
+    bool get(size_t number, HistoryEntry& entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        if (number == 0 || number > count_) {
+            return false;
+        }
+        entry = entryAt(number - 1);
+        return true;
+    }
+
+    // The newest `limit` entries, oldest first
+    std::vector<HistoryEntry> tail(size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        std::vector<HistoryEntry> entries;
+        for (size_t i = count_ > limit ? count_ - limit : 0; i < count_; ++i) {
+            entries.push_back(entryAt(i));
+        }
+        return entries;
+    }
+
+    // Newest entry numbered below `before` (0: anywhere) that starts with `prefix`
+    bool findPrefix(std::string_view prefix, HistoryEntry& entry, size_t before = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        extendSorted();
+        size_t limit = before == 0 || before > count_ ? count_ : before - 1;
+        // Entries not merged yet are newer than every merged one
+        for (size_t i = limit; i-- > sortedCount_;) {
+            if (commandAt(i).substr(0, prefix.size()) == prefix) {
+                entry = entryAt(i);
+                return true;
+            }
+        }
+        auto head = [this, &prefix](uint32_t i) { return commandAt(i).substr(0, prefix.size()); };
+        auto first = std::lower_bound(sorted_.begin(), sorted_.end(), prefix,
+            [&head](uint32_t i, std::string_view value) { return head(i) < value; });
+        auto last = std::upper_bound(first, sorted_.end(), prefix,
+            [&head](std::string_view value, uint32_t i) { return value < head(i); });
+        size_t lo = static_cast<size_t>(first - sorted_.begin());
+        size_t hi = static_cast<size_t>(last - sorted_.begin());
+        int64_t newest = limit == 0 ? -1 : sortedIndex_.maxAtMost(lo, hi, limit - 1);
+        if (newest < 0) {
+            return false;
+        }
+        entry = entryAt(static_cast<size_t>(newest));
+        return true;
+    }
+
+    // Entries containing `term`, newest first, at most `limit` of them
+    std::vector<HistoryEntry> search(std::string_view term, size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        std::vector<HistoryEntry> matches;
+        if (term.size() < GRAM) {
+            for (size_t i = count_; i-- > 0 && matches.size() < limit;) {
+                if (commandAt(i).find(term) != std::string_view::npos) {
+                    matches.push_back(entryAt(i));
+                }
+            }
+            return matches;
+        }
+
+        // Every match holds all of the term's grams; the rarest one has the
+        // fewest candidates to check
+        extendGrams();
+        const std::vector<uint32_t>* rarest = nullptr;
+        for (size_t pos = 0; pos + GRAM <= term.size(); ++pos) {
+            auto it = grams_.find(gramAt(term, pos));
+            if (it == grams_.end()) {
+                return matches;
+            }
+            if (!rarest || it->second.size() < rarest->size()) {
+                rarest = &it->second;
+            }
+        }
+        for (auto it = rarest->rbegin(); it != rarest->rend() && matches.size() < limit; ++it) {
+            if (commandAt(*it).find(term) != std::string_view::npos) {
+                matches.push_back(entryAt(*it));
+            }
+        }
+        return matches;
+    }
+};
+
+CommandHistory& getCommandHistory();
+
+} // namespace Oroto
+
+#endif // OROTO_COMMAND_HISTORY_H
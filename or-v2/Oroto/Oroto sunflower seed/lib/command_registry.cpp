@@ -0,0 +1,10 @@
+#include "command_registry.h"
+
+namespace Oroto {
+
+CommandRegistry& getCommandRegistry() {
+    static CommandRegistry registry;
+    return registry;
+}
+
+} // namespace Oroto
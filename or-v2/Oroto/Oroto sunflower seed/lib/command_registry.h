@@ -0,0 +1,299 @@
+#ifndef OROTO_COMMAND_REGISTRY_H
+#define OROTO_COMMAND_REGISTRY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <algorithm>
+#include "oroto_shell.h"
+#include "expected.h"
+#include "logger.h"
+
+namespace Oroto {
+
+class RecordStream;
+
+// Handler invoked with the full argument list (args[0] is the command name)
+using CommandHandler = std::function<Status(const CommandArgs& args)>;
+
+// Form of a command used as a pipeline stage ('a | b'); see record_stream.h
+using CommandStreamHandler = std::function<Status(const CommandArgs& args, RecordStream& stream)>;
+
+// A named command and the metadata used for dispatch and help text
+struct CommandEntry {
+    std::string name;
+    std::string owner;
+    std::string usage;
+    std::string description;
+    std::string category;   // help section heading
+    size_t minArgs;
+    // Keeps the code behind handler (e.g. a plugin library) loaded while any
+    // reference to the entry exists. Declared first so handler is destroyed first.
+    std::shared_ptr<const void> keepAlive;
+    CommandHandler handler;
+    // Empty for commands that cannot take part in a pipeline
+    CommandStreamHandler stream;
+
+    CommandEntry() : minArgs(1) {}
+};
+
+// FNV-1a, shared by the registry and anything that precomputes command hashes
+constexpr uint64_t hashCommandName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Read-mostly command table.
+// Lookups are lock-free: they probe an immutable open-addressing table reached
+// through one atomic pointer. Writers (plugin load/unload) take a mutex, build a
+// new table and publish it. A replaced table is only freed once no lookup is in
+// flight, so a reader that raced with a writer never touches released memory.
+class CommandRegistry {
+private:
+    struct Table {
+        std::vector<std::shared_ptr<const CommandEntry>> slots;
+        std::vector<uint64_t> hashes;
+        size_t mask;
+        size_t count;
+    };
+
+    std::atomic<const Table*> current_;
+    mutable std::atomic<size_t> activeReaders_;
+    std::unique_ptr<const Table> owned_;
+    std::vector<std::unique_ptr<const Table>> retired_;
+    std::vector<std::shared_ptr<const CommandEntry>> entries_;
+    std::atomic<uint64_t> generation_;
+    mutable std::mutex writeMutex_;
+
+    static std::unique_ptr<const Table> buildTable(const std::vector<std::shared_ptr<const CommandEntry>>& entries) {
+        auto table = std::make_unique<Table>();
+        size_t capacity = 16;
+        while (capacity < entries.size() * 2) {
+            capacity <<= 1;
+        }
+
+        table->slots.resize(capacity);
+        table->hashes.resize(capacity, 0);
+        table->mask = capacity - 1;
+        table->count = entries.size();
+
+        for (const auto& entry : entries) {
+            uint64_t hash = hashCommandName(entry->name);
+            size_t slot = hash & table->mask;
+            while (table->slots[slot]) {
+                slot = (slot + 1) & table->mask;
+            }
+            table->slots[slot] = entry;
+            table->hashes[slot] = hash;
+        }
+        return table;
+    }
+
+    // Caller holds writeMutex_
+    void publish() {
+        auto table = buildTable(entries_);
+        current_.store(table.get());
+        if (owned_) {
+            retired_.push_back(std::move(owned_));
+        }
+        owned_ = std::move(table);
+        generation_.fetch_add(1);
+
+        // Any reader that starts after the store above sees the new table
+        if (activeReaders_.load() == 0) {
+            retired_.clear();
+        }
+    }
+
+public:
+    CommandRegistry() : current_(nullptr), activeReaders_(0), generation_(0) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        publish();
+    }
+
+    CommandRegistry(const CommandRegistry&) = delete;
+    CommandRegistry& operator=(const CommandRegistry&) = delete;
+
+    // Register a command; fails if the name is already taken
+    bool registerCommand(CommandEntry entry) {
+        if (entry.name.empty() || !entry.handler) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        for (const auto& existing : entries_) {
+            if (existing->name == entry.name) {
+                LOG_WARNING("CommandRegistry", "Command already registered: " + entry.name +
+                           " (owner: " + existing->owner + ")");
+                return false;
+            }
+        }
+
+        LOG_INFO("CommandRegistry", "Registered command '" + entry.name + "' from " + entry.owner);
+        entries_.push_back(std::make_shared<const CommandEntry>(std::move(entry)));
+        publish();
+        return true;
+    }
+
+    bool registerCommand(const std::string& name, const std::string& owner,
+                         CommandHandler handler, const std::string& usage = "",
+                         const std::string& description = "", size_t minArgs = 1) {
+        return registerCommand(makeEntry(name, owner, std::move(handler), usage, description, minArgs));
+    }
+
+    static CommandEntry makeEntry(const std::string& name, const std::string& owner,
+                                  CommandHandler handler, const std::string& usage = "",
+                                  const std::string& description = "", size_t minArgs = 1) {
+        CommandEntry entry;
+        entry.name = name;
+        entry.owner = owner;
+        entry.usage = usage.empty() ? name : usage;
+        entry.description = description;
+        entry.minArgs = minArgs;
+        entry.handler = std::move(handler);
+        return entry;
+    }
+
+    // Swap every command of oldOwner for a new set in one publish, so a lookup
+    // sees either the old commands or the new ones, never a mix or a gap.
+    // Entries whose name belongs to another owner are skipped. Returns the
+    // number of entries added.
+    size_t replaceOwner(const std::string& oldOwner, std::vector<CommandEntry> replacement) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                      [&oldOwner](const auto& entry) { return entry->owner == oldOwner; }),
+                       entries_.end());
+
+        size_t added = 0;
+        for (auto& entry : replacement) {
+            bool taken = std::any_of(entries_.begin(), entries_.end(),
+                                     [&entry](const auto& existing) { return existing->name == entry.name; });
+            if (entry.name.empty() || !entry.handler || taken) {
+                LOG_WARNING("CommandRegistry", "Skipping command '" + entry.name + "' from " + entry.owner);
+                continue;
+            }
+            entries_.push_back(std::make_shared<const CommandEntry>(std::move(entry)));
+            ++added;
+        }
+        publish();
+        return added;
+    }
+
+    bool unregisterCommand(std::string_view name) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if ((*it)->name == name) {
+                entries_.erase(it);
+                publish();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Drop every command registered by one owner (e.g. a plugin being unloaded)
+    size_t unregisterOwner(const std::string& owner) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        size_t before = entries_.size();
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                      [&owner](const auto& entry) { return entry->owner == owner; }),
+                       entries_.end());
+        size_t removed = before - entries_.size();
+        if (removed > 0) {
+            publish();
+        }
+        return removed;
+    }
+
+    // Lock-free lookup. The returned entry stays alive while the caller holds it,
+    // even if its owner unregisters it concurrently.
+    std::shared_ptr<const CommandEntry> find(std::string_view name) const {
+        uint64_t hash = hashCommandName(name);
+
+        activeReaders_.fetch_add(1);
+        const Table* table = current_.load();
+        size_t slot = hash & table->mask;
+        std::shared_ptr<const CommandEntry> found;
+
+        while (const CommandEntry* entry = table->slots[slot].get()) {
+            if (table->hashes[slot] == hash && entry->name == name) {
+                found = table->slots[slot];
+                break;
+            }
+            slot = (slot + 1) & table->mask;
+        }
+        activeReaders_.fetch_sub(1);
+        return found;
+    }
+
+    std::vector<std::shared_ptr<const CommandEntry>> listCommands() const {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return entries_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return entries_.size();
+    }
+
+    // Changes whenever the set of commands does, so caches built from
+    // listCommands() can tell they are stale without taking the lock
+    uint64_t generation() const { return generation_.load(); }
+};
+
+// Registration handle given to a plugin; every command it adds is owned by that plugin.
+// A deferred registrar only collects the commands; commit() later swaps them in
+// for replacedOwner's commands in one step (used by plugin hot reload).
+class CommandRegistrar {
+private:
+    CommandRegistry& registry_;
+    std::string owner_;
+    std::shared_ptr<const void> keepAlive_;
+    bool deferred_;
+    std::vector<CommandEntry> staged_;
+
+public:
+    CommandRegistrar(CommandRegistry& registry, const std::string& owner,
+                     std::shared_ptr<const void> keepAlive = nullptr, bool deferred = false)
+        : registry_(registry), owner_(owner), keepAlive_(std::move(keepAlive)), deferred_(deferred) {}
+
+    bool add(const std::string& name, CommandHandler handler, const std::string& usage = "",
+             const std::string& description = "", size_t minArgs = 1) {
+        CommandEntry entry = CommandRegistry::makeEntry(name, owner_, std::move(handler), usage, description, minArgs);
+        entry.keepAlive = keepAlive_;
+        if (!deferred_) {
+            return registry_.registerCommand(std::move(entry));
+        }
+
+        bool duplicate = std::any_of(staged_.begin(), staged_.end(),
+                                     [&name](const CommandEntry& staged) { return staged.name == name; });
+        if (name.empty() || !entry.handler || duplicate) {
+            return false;
+        }
+        staged_.push_back(std::move(entry));
+        return true;
+    }
+
+    // Deferred mode only: publish the staged commands in place of replacedOwner's
+    size_t commit(const std::string& replacedOwner) {
+        return registry_.replaceOwner(replacedOwner, std::move(staged_));
+    }
+
+    const std::string& owner() const { return owner_; }
+};
+
+// Global command registry
+CommandRegistry& getCommandRegistry();
+
+} // namespace Oroto
+
+#endif // OROTO_COMMAND_REGISTRY_H
@@ -0,0 +1,206 @@
+#ifndef OROTO_COMMAND_TOKENIZER_H
+#define OROTO_COMMAND_TOKENIZER_H
+
+#include <string_view>
+#include <memory_resource>
+#include <cstring>
+#include "oroto_shell.h"
+#include "expected.h"
+
+namespace Oroto {
+
+// How a command is joined to the one after it on the same line
+enum class CommandSeparator {
+    END,        // last command on the line
+    SEQUENCE,   // ';'  run the next command regardless
+    AND,        // '&&' run the next command only if this one succeeded
+    BACKGROUND, // '&'  run this command as a background job and move on
+    PIPE        // '|'  stream this command's records into the next one
+};
+
+// '&&' and '|' are meaningless without a command on their right
+inline bool needsNextCommand(CommandSeparator separator) {
+    return separator == CommandSeparator::AND || separator == CommandSeparator::PIPE;
+}
+
+struct ParsedCommand {
+    CommandArgs args;
+    CommandSeparator next;
+};
+
+using CommandList = std::pmr::vector<ParsedCommand>;
+
+// Single-pass shell-style tokenizer.
+//   - whitespace separates arguments, ';', '&&', '&' and '|' separate commands
+//   - '...' is literal; "..." allows \" and \\ ; outside quotes \x is x
+// Arguments are string_view slices of the input line, so the line must outlive
+// the result. Only an argument that cannot be one slice (an escape, or quoted
+// and unquoted parts glued together) is rebuilt, in one scratch buffer taken
+// from `memory` on first use. Unterminated quotes, a trailing backslash, an
+// '&&' or '|' with no command on either side and a '&' with none before it
+// are PARSE_ERROR.
+class CommandTokenizer {
+private:
+    std::string_view line_;
+    std::pmr::memory_resource* memory_;
+    char* scratch_;
+    size_t scratchUsed_;
+
+    // The argument being built: a slice of line_ until it has to be copied
+    std::string_view current_;
+    bool copied_;
+
+    void append(size_t index, size_t length) {
+        const char* piece = line_.data() + index;
+        if (!copied_) {
+            if (current_.empty()) {
+                current_ = std::string_view(piece, length);
+                return;
+            }
+            if (current_.data() + current_.size() == piece) {
+                current_ = std::string_view(current_.data(), current_.size() + length);
+                return;
+            }
+            // Not contiguous any more: move what we have into the scratch buffer.
+            // Unescaped text is never longer than its source, so one line-sized
+            // buffer holds every rebuilt argument on the line.
+            if (!scratch_) {
+                scratch_ = static_cast<char*>(memory_->allocate(line_.size(), 1));
+            }
+            std::memcpy(scratch_ + scratchUsed_, current_.data(), current_.size());
+            current_ = std::string_view(scratch_ + scratchUsed_, current_.size());
+            copied_ = true;
+        }
+        std::memcpy(scratch_ + scratchUsed_ + current_.size(), piece, length);
+        current_ = std::string_view(current_.data(), current_.size() + length);
+    }
+
+    void finishArgument(CommandArgs& args) {
+        args.push_back(current_);
+        if (copied_) {
+            scratchUsed_ += current_.size();
+        }
+        current_ = std::string_view();
+        copied_ = false;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+public:
+    CommandTokenizer(std::string_view line, std::pmr::memory_resource* memory)
+        : line_(line), memory_(memory), scratch_(nullptr), scratchUsed_(0), copied_(false) {}
+
+    Expected<CommandList> tokenize() {
+        CommandList commands(memory_);
+        CommandArgs args(memory_);
+        const size_t size = line_.size();
+        size_t pos = 0;
+
+        auto endCommand = [&](CommandSeparator separator) -> bool {
+            if (args.empty()) {
+                // Stray ';' is harmless; '&&', '&' and '|' need a command on their left
+                return separator == CommandSeparator::SEQUENCE;
+            }
+            commands.push_back(ParsedCommand{std::move(args), separator});
+            args = CommandArgs(memory_);
+            return true;
+        };
+
+        while (pos < size) {
+            char c = line_[pos];
+            if (isSpace(c)) {
+                ++pos;
+                continue;
+            }
+            if (c == ';') {
+                if (args.empty() && !commands.empty() && needsNextCommand(commands.back().next)) {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                endCommand(CommandSeparator::SEQUENCE);
+                ++pos;
+                continue;
+            }
+            if (c == '&') {
+                bool isAnd = pos + 1 < size && line_[pos + 1] == '&';
+                if (!endCommand(isAnd ? CommandSeparator::AND : CommandSeparator::BACKGROUND)) {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                pos += isAnd ? 2 : 1;
+                continue;
+            }
+            if (c == '|') {
+                // Also rejects '||': the second '|' has no command on its left
+                if (!endCommand(CommandSeparator::PIPE)) {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                ++pos;
+                continue;
+            }
+
+            // One argument: runs until unquoted whitespace, ';', '&' or '|'
+            while (pos < size) {
+                c = line_[pos];
+                if (isSpace(c) || c == ';' || c == '&' || c == '|') {
+                    break;
+                }
+                if (c == '\\') {
+                    if (pos + 1 >= size) {
+                        return makeError(ErrorCode::PARSE_ERROR);
+                    }
+                    append(pos + 1, 1);
+                    pos += 2;
+                } else if (c == '\'') {
+                    size_t close = line_.find('\'', pos + 1);
+                    if (close == std::string_view::npos) {
+                        return makeError(ErrorCode::PARSE_ERROR);
+                    }
+                    if (close > pos + 1) {
+                        append(pos + 1, close - pos - 1);
+                    }
+                    pos = close + 1;
+                } else if (c == '"') {
+                    ++pos;
+                    while (pos < size && line_[pos] != '"') {
+                        if (line_[pos] == '\\' && pos + 1 < size &&
+                            (line_[pos + 1] == '"' || line_[pos + 1] == '\\')) {
+                            ++pos;
+                        }
+                        append(pos, 1);
+                        ++pos;
+                    }
+                    if (pos >= size) {
+                        return makeError(ErrorCode::PARSE_ERROR);
+                    }
+                    ++pos;
+                } else {
+                    append(pos, 1);
+                    ++pos;
+                }
+            }
+            finishArgument(args);
+        }
+
+        if (args.empty()) {
+            // A line may end in ';' or '&' but not in '&&' or '|'
+            if (!commands.empty() && needsNextCommand(commands.back().next)) {
+                return makeError(ErrorCode::PARSE_ERROR);
+            }
+            if (!commands.empty() && commands.back().next == CommandSeparator::SEQUENCE) {
+                commands.back().next = CommandSeparator::END;
+            }
+        } else {
+            commands.push_back(ParsedCommand{std::move(args), CommandSeparator::END});
+        }
+        return commands;
+    }
+};
+
+inline Expected<CommandList> tokenizeCommandLine(std::string_view line, std::pmr::memory_resource* memory) {
+    return CommandTokenizer(line, memory).tokenize();
+}
+
+} // namespace Oroto
+
+#endif // OROTO_COMMAND_TOKENIZER_H
@@ -0,0 +1,10 @@
+#include "completion_trie.h"
+
+namespace Oroto {
+
+CompletionEngine& getCompletionEngine() {
+    static CompletionEngine engine;
+    return engine;
+}
+
+} // namespace Oroto
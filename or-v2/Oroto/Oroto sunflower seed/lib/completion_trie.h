@@ -0,0 +1,499 @@
+#ifndef OROTO_COMPLETION_TRIE_H
+#define OROTO_COMPLETION_TRIE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "command_registry.h"
+
+namespace Oroto {
+
+// Prefix trie over completion candidates. Nodes live in one vector and are
+// never freed (erase only unmarks a word), so a cursor, which is just a node
+// index, stays valid while words are added: a line editor can keep one per
+// word being typed and advance it a character at a time. Siblings are kept
+// sorted by byte, so candidates come out in order. Each node counts the words
+// below it, which lets lookups skip erased branches and report totals without
+// walking them.
+class CompletionTrie {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Cursor {
+        uint32_t node = 0;   // NONE once the prefix matches nothing
+        bool valid() const { return node != NONE; }
+    };
+
+private:
+    struct Node {
+        uint32_t firstChild = NONE;
+        uint32_t nextSibling = NONE;
+        uint32_t words = 0;     // terminal nodes in this subtree, itself included
+        unsigned char label = 0;
+        bool terminal = false;
+    };
+
+    std::vector<Node> nodes_;
+
+    uint32_t findChild(uint32_t node, unsigned char c) const {
+        for (uint32_t child = nodes_[node].firstChild; child != NONE; child = nodes_[child].nextSibling) {
+            if (nodes_[child].label == c) {
+                return child;
+            }
+            if (nodes_[child].label > c) {
+                break;
+            }
+        }
+        return NONE;
+    }
+
+    uint32_t addChild(uint32_t node, unsigned char c) {
+        uint32_t previous = NONE;
+        uint32_t next = nodes_[node].firstChild;
+        while (next != NONE && nodes_[next].label < c) {
+            previous = next;
+            next = nodes_[next].nextSibling;
+        }
+        uint32_t created = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        nodes_[created].label = c;
+        nodes_[created].nextSibling = next;
+        if (previous == NONE) {
+            nodes_[node].firstChild = created;
+        } else {
+            nodes_[previous].nextSibling = created;
+        }
+        return created;
+    }
+
+    void collect(uint32_t node, std::string& word, size_t limit, std::vector<std::string>& out) const {
+        if (nodes_[node].terminal) {
+            out.push_back(word);
+        }
+        for (uint32_t child = nodes_[node].firstChild; child != NONE && out.size() < limit;
+             child = nodes_[child].nextSibling) {
+            if (nodes_[child].words == 0) {
+                continue;
+            }
+            word.push_back(static_cast<char>(nodes_[child].label));
+            collect(child, word, limit, out);
+            word.pop_back();
+        }
+    }
+
+public:
+    CompletionTrie() { nodes_.emplace_back(); }
+
+    // False if the word was already there
+    bool insert(std::string_view word) {
+        if (word.empty() || contains(word)) {
+            return false;
+        }
+        uint32_t node = 0;
+        ++nodes_[node].words;
+        for (char c : word) {
+            uint32_t child = findChild(node, static_cast<unsigned char>(c));
+            node = child != NONE ? child : addChild(node, static_cast<unsigned char>(c));
+            ++nodes_[node].words;
+        }
+        nodes_[node].terminal = true;
+        return true;
+    }
+
+    bool erase(std::string_view word) {
+        if (!contains(word)) {
+            return false;
+        }
+        uint32_t node = 0;
+        --nodes_[node].words;
+        for (char c : word) {
+            node = findChild(node, static_cast<unsigned char>(c));
+            --nodes_[node].words;
+        }
+        nodes_[node].terminal = false;
+        return true;
+    }
+
+    bool contains(std::string_view word) const {
+        Cursor cursor = find(word);
+        return cursor.valid() && nodes_[cursor.node].terminal;
+    }
+
+    // Drops every word and node; outstanding cursors become meaningless
+    void clear() {
+        nodes_.clear();
+        nodes_.emplace_back();
+    }
+
+    size_t size() const { return nodes_[0].words; }
+
+    bool advance(Cursor& cursor, char c) const {
+        if (cursor.valid()) {
+            cursor.node = findChild(cursor.node, static_cast<unsigned char>(c));
+        }
+        return cursor.valid();
+    }
+
+    Cursor find(std::string_view prefix) const {
+        return find(prefix, Cursor());
+    }
+
+    Cursor find(std::string_view prefix, Cursor from) const {
+        for (char c : prefix) {
+            if (!advance(from, c)) {
+                break;
+            }
+        }
+        return from;
+    }
+
+    // Candidates that start with the cursor's prefix
+    size_t count(Cursor cursor) const {
+        return cursor.valid() ? nodes_[cursor.node].words : 0;
+    }
+
+    // Longest text every candidate below the cursor continues with
+    std::string commonExtension(Cursor cursor) const {
+        std::string extension;
+        if (count(cursor) == 0) {
+            return extension;
+        }
+        uint32_t node = cursor.node;
+        while (!nodes_[node].terminal) {
+            uint32_t only = NONE;
+            for (uint32_t child = nodes_[node].firstChild; child != NONE; child = nodes_[child].nextSibling) {
+                if (nodes_[child].words == 0) {
+                    continue;
+                }
+                if (only != NONE) {
+                    return extension;
+                }
+                only = child;
+            }
+            extension.push_back(static_cast<char>(nodes_[only].label));
+            node = only;
+        }
+        return extension;
+    }
+
+    // The first `limit` candidates below the cursor in byte order, each as
+    // `prefix` followed by the rest of the word
+    std::vector<std::string> candidates(Cursor cursor, std::string_view prefix, size_t limit) const {
+        std::vector<std::string> out;
+        if (count(cursor) > 0 && limit > 0) {
+            std::string word(prefix);
+            collect(cursor.node, word, limit, out);
+        }
+        return out;
+    }
+};
+
+// What an argument position holds, read from a command's usage text
+enum class CompletionKind : uint8_t {
+    NONE,
+    COMMAND,
+    HOST,
+    FILE
+};
+
+// Completion state for a line as it is typed. CompletionEngine::update() is
+// meant to be called after every keystroke: while the line only grows inside
+// the current word, the cursor moves down the trie by the new characters
+// instead of the line being parsed again.
+struct CompletionQuery {
+    std::string line;
+    CompletionKind kind = CompletionKind::NONE;
+    size_t start = 0;        // where the word being completed begins in line
+    CompletionTrie::Cursor cursor;
+    uint64_t generation = 0;
+};
+
+struct CompletionResult {
+    size_t start = 0;                     // the candidates replace line[start, end)
+    std::string extension;                // text every candidate adds to the line
+    std::vector<std::string> candidates;  // whole words, sorted, at most the limit asked for
+    size_t total = 0;
+};
+
+// Completion for the shell: command names from the registry (plugin commands
+// included), hosts and targets from earlier commands and scans, and files of
+// the kernel's filesystem. Which of these an argument takes comes from the
+// command's usage text ("ping [host]", "cat [file]"), so plugins get argument
+// completion by describing their usage. The command trie is rebuilt when the
+// registry's generation moves on.
+class CompletionEngine {
+private:
+    CompletionTrie commands_;
+    CompletionTrie hosts_;
+    CompletionTrie files_;
+    // Kind of each argument after the command name, by command
+    std::unordered_map<std::string, std::vector<CompletionKind>> arguments_;
+    uint64_t registryGeneration_;
+    uint64_t generation_;
+    mutable std::mutex mutex_;
+
+    static bool isSeparator(char c) { return c == '|' || c == ';' || c == '&'; }
+    static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+    static CompletionKind kindOfPlaceholder(std::string_view placeholder) {
+        if (placeholder.size() < 2 || placeholder.front() != '[') {
+            return CompletionKind::NONE;
+        }
+        for (std::string_view word : {"host", "domain", "target", "ip"}) {
+            if (placeholder.find(word) != std::string_view::npos) {
+                return CompletionKind::HOST;
+            }
+        }
+        for (std::string_view word : {"file", "folder", "dir"}) {
+            if (placeholder.find(word) != std::string_view::npos) {
+                return CompletionKind::FILE;
+            }
+        }
+        return CompletionKind::NONE;
+    }
+
+    // "nmap [host|net/24]" -> {HOST}; "echo [text] > [file]" -> {NONE, NONE, FILE}
+    static std::vector<CompletionKind> argumentKinds(const CommandEntry& entry) {
+        std::vector<CompletionKind> kinds;
+        std::string_view usage = entry.usage;
+        if (usage.substr(0, entry.name.size()) != entry.name) {
+            return kinds;
+        }
+        usage.remove_prefix(entry.name.size());
+        size_t pos = 0;
+        while (pos < usage.size()) {
+            while (pos < usage.size() && isSpace(usage[pos])) {
+                ++pos;
+            }
+            size_t end = pos;
+            while (end < usage.size() && !isSpace(usage[end])) {
+                ++end;
+            }
+            std::string_view word = usage.substr(pos, end - pos);
+            if (word.empty() || word == "|") {
+                break;   // alternative forms are not followed
+            }
+            kinds.push_back(kindOfPlaceholder(word));
+            pos = end;
+        }
+        return kinds;
+    }
+
+    // Caller holds mutex_
+    void syncCommands() {
+        const CommandRegistry& registry = getCommandRegistry();
+        uint64_t current = registry.generation();
+        if (current == registryGeneration_) {
+            return;
+        }
+        commands_.clear();
+        arguments_.clear();
+        for (const auto& entry : registry.listCommands()) {
+            commands_.insert(entry->name);
+            arguments_[entry->name] = argumentKinds(*entry);
+        }
+        registryGeneration_ = current;
+        ++generation_;
+    }
+
+    const CompletionTrie* trieFor(CompletionKind kind) const {
+        switch (kind) {
+            case CompletionKind::COMMAND: return &commands_;
+            case CompletionKind::HOST: return &hosts_;
+            case CompletionKind::FILE: return &files_;
+            default: return nullptr;
+        }
+    }
+
+    // The longest command name that the segment starts with as whole words
+    size_t matchCommand(std::string_view segment, std::string& name) const {
+        size_t matched = 0;
+        CompletionTrie::Cursor cursor;
+        for (size_t i = 0; i < segment.size() && commands_.advance(cursor, segment[i]); ++i) {
+            bool wordEnd = i + 1 == segment.size() || isSpace(segment[i + 1]);
+            if (wordEnd && commands_.contains(segment.substr(0, i + 1))) {
+                matched = i + 1;
+            }
+        }
+        name.assign(segment.substr(0, matched));
+        return matched;
+    }
+
+    // Caller holds mutex_
+    void locate(CompletionQuery& query) const {
+        std::string_view line = query.line;
+        size_t segmentStart = 0;
+        for (size_t i = line.size(); i-- > 0;) {
+            if (isSeparator(line[i])) {
+                segmentStart = i + 1;
+                break;
+            }
+        }
+        while (segmentStart < line.size() && isSpace(line[segmentStart])) {
+            ++segmentStart;
+        }
+        std::string_view segment = line.substr(segmentStart);
+
+        // Command names may hold spaces ("oroto scan"), so the whole segment
+        // is a command prefix for as long as the trie follows it
+        CompletionTrie::Cursor cursor = commands_.find(segment);
+        if (commands_.count(cursor) > 0) {
+            query.kind = CompletionKind::COMMAND;
+            query.start = segmentStart;
+            query.cursor = cursor;
+            return;
+        }
+
+        size_t wordStart = line.size();
+        while (wordStart > segmentStart && !isSpace(line[wordStart - 1])) {
+            --wordStart;
+        }
+        query.start = wordStart;
+        query.kind = CompletionKind::NONE;
+
+        std::string name;
+        size_t nameEnd = matchCommand(segment, name);
+        auto arguments = arguments_.find(name);
+        if (nameEnd == 0 || arguments == arguments_.end() || segmentStart + nameEnd >= wordStart) {
+            query.cursor.node = CompletionTrie::NONE;
+            return;
+        }
+        size_t position = 0;
+        bool inWord = false;
+        for (size_t i = segmentStart + nameEnd; i < wordStart; ++i) {
+            if (!isSpace(line[i]) && !inWord) {
+                ++position;
+            }
+            inWord = !isSpace(line[i]);
+        }
+        if (position < arguments->second.size()) {
+            query.kind = arguments->second[position];
+        }
+        const CompletionTrie* trie = trieFor(query.kind);
+        query.cursor = trie ? trie->find(line.substr(wordStart)) : CompletionTrie::Cursor{CompletionTrie::NONE};
+    }
+
+public:
+    CompletionEngine() : registryGeneration_(UINT64_MAX), generation_(0) {}
+
+    CompletionEngine(const CompletionEngine&) = delete;
+    CompletionEngine& operator=(const CompletionEngine&) = delete;
+
+    bool addHost(std::string_view host) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hosts_.insert(host);
+    }
+
+    bool addFile(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return files_.insert(name);
+    }
+
+    bool removeFile(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return files_.erase(name);
+    }
+
+    // Remembers the host arguments of a command line that ran, so the next
+    // 'ping' or 'nmap' can complete them
+    void noteTargets(std::string_view line) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        syncCommands();
+        size_t begin = 0;
+        while (begin < line.size()) {
+            size_t end = begin;
+            while (end < line.size() && !isSeparator(line[end])) {
+                ++end;
+            }
+            std::string_view segment = line.substr(begin, end - begin);
+            while (!segment.empty() && isSpace(segment.front())) {
+                segment.remove_prefix(1);
+            }
+            std::string name;
+            size_t pos = matchCommand(segment, name);
+            auto arguments = arguments_.find(name);
+            for (size_t position = 0; pos > 0 && arguments != arguments_.end() && pos < segment.size();) {
+                while (pos < segment.size() && isSpace(segment[pos])) {
+                    ++pos;
+                }
+                size_t wordEnd = pos;
+                while (wordEnd < segment.size() && !isSpace(segment[wordEnd])) {
+                    ++wordEnd;
+                }
+                if (wordEnd == pos) {
+                    break;
+                }
+                if (position < arguments->second.size() && arguments->second[position] == CompletionKind::HOST) {
+                    hosts_.insert(segment.substr(pos, wordEnd - pos));
+                }
+                ++position;
+                pos = wordEnd;
+            }
+            begin = end + 1;
+        }
+    }
+
+    // Brings the query up to date with `line`, advancing its cursor when the
+    // line only grew inside the word being completed
+    void update(CompletionQuery& query, std::string_view line) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        syncCommands();
+        bool extends = query.generation == generation_ && line.size() >= query.line.size() &&
+                       line.substr(0, query.line.size()) == query.line;
+        if (extends) {
+            std::string_view added = line.substr(query.line.size());
+            const CompletionTrie* trie = trieFor(query.kind);
+            bool plain = trie && std::none_of(added.begin(), added.end(),
+                                              [](char c) { return isSpace(c) || isSeparator(c); });
+            CompletionTrie::Cursor cursor = query.cursor;
+            for (size_t i = 0; plain && i < added.size(); ++i) {
+                plain = trie->advance(cursor, added[i]);
+            }
+            // A dead end is located again: the word may have been added since
+            if (plain) {
+                query.cursor = cursor;
+                query.line.assign(line);
+                return;
+            }
+        }
+        query.line.assign(line);
+        query.generation = generation_;
+        locate(query);
+    }
+
+    CompletionResult result(const CompletionQuery& query, size_t limit) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CompletionResult result;
+        result.start = query.start;
+        const CompletionTrie* trie = trieFor(query.kind);
+        if (!trie || query.generation != generation_) {
+            return result;
+        }
+        std::string_view word = std::string_view(query.line).substr(query.start);
+        result.total = trie->count(query.cursor);
+        result.extension = trie->commonExtension(query.cursor);
+        result.candidates = trie->candidates(query.cursor, word, limit);
+        return result;
+    }
+
+    CompletionResult complete(std::string_view line, size_t limit) {
+        CompletionQuery query;
+        update(query, line);
+        return result(query, limit);
+    }
+
+    size_t hostCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hosts_.size();
+    }
+};
+
+CompletionEngine& getCompletionEngine();
+
+} // namespace Oroto
+
+#endif // OROTO_COMPLETION_TRIE_H
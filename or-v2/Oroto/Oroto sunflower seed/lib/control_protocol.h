@@ -0,0 +1,128 @@
+#ifndef OROTO_CONTROL_PROTOCOL_H
+#define OROTO_CONTROL_PROTOCOL_H
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "expected.h"
+
+namespace Oroto {
+
+// Wire format of the kernel control socket (oroto-kernel -s PATH).
+//   request: one command line terminated by '\n'
+//   reply:   REPLY_MARK, the numeric ErrorCode, ' ', the output length in
+//            bytes and '\n', then exactly that many bytes of command output
+// The output is framed by its length, not by a terminator, because binary
+// output mode can put any byte in it. A session's requests are answered in
+// order; sessions run concurrently.
+constexpr char CONTROL_REPLY_MARK = '\x1e';
+
+inline std::string formatReplyHeader(ErrorCode code, size_t outputLength) {
+    return std::string(1, CONTROL_REPLY_MARK) + std::to_string(static_cast<int>(code)) + " " +
+           std::to_string(outputLength) + "\n";
+}
+
+inline bool fillSocketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Blocking client for one session; used by the load generator and tests
+class ControlClient {
+private:
+    int fd_;
+    std::string buffer_;
+
+public:
+    ControlClient() : fd_(-1) {}
+    ~ControlClient() { close(); }
+
+    ControlClient(const ControlClient&) = delete;
+    ControlClient& operator=(const ControlClient&) = delete;
+
+    Status connect(const std::string& path) {
+        sockaddr_un address;
+        if (!fillSocketAddress(path, address)) {
+            return makeError(ErrorCode::INVALID_ARGUMENTS);
+        }
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            return makeError(ErrorCode::NETWORK_ERROR);
+        }
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close();
+            return makeError(ErrorCode::NETWORK_ERROR);
+        }
+        return ok();
+    }
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    // Sends one command and waits for its reply. On success `output` holds the
+    // command output and the returned code is the command's own status.
+    Expected<ErrorCode> execute(const std::string& command, std::string& output) {
+        std::string request = command + "\n";
+        size_t sent = 0;
+        while (sent < request.size()) {
+            ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return makeError(ErrorCode::NETWORK_ERROR);
+            }
+            sent += static_cast<size_t>(n);
+        }
+
+        while (true) {
+            size_t end = buffer_.find('\n');
+            if (end != std::string::npos) {
+                if (buffer_[0] != CONTROL_REPLY_MARK) {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                char* next = nullptr;
+                long code = std::strtol(buffer_.c_str() + 1, &next, 10);
+                if (*next != ' ') {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                unsigned long long length = std::strtoull(next + 1, &next, 10);
+                if (next != buffer_.c_str() + end) {
+                    return makeError(ErrorCode::PARSE_ERROR);
+                }
+                if (buffer_.size() - end - 1 >= length) {
+                    output.assign(buffer_, end + 1, length);
+                    buffer_.erase(0, end + 1 + length);
+                    return static_cast<ErrorCode>(code);
+                }
+            }
+
+            char chunk[4096];
+            ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return makeError(ErrorCode::NETWORK_ERROR);
+            }
+            buffer_.append(chunk, static_cast<size_t>(n));
+        }
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_CONTROL_PROTOCOL_H
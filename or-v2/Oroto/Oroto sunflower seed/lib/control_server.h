@@ -0,0 +1,430 @@
+#ifndef OROTO_CONTROL_SERVER_H
+#define OROTO_CONTROL_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "control_protocol.h"
+#include "job_output.h"
+#include "logger.h"
+#include "output_writer.h"
+#include "thread_pool.h"
+
+namespace Oroto {
+
+// Serves many control sessions on one Unix socket from a single epoll loop.
+// The loop only moves bytes: each complete request line is run on the shared
+// ThreadPool with std::cout captured into that request's own buffer, and the
+// result comes back to the loop through an eventfd. A session has at most one
+// request in flight, so its replies stay in order while sessions run in parallel.
+class ControlServer {
+public:
+    using Executor = std::function<Status(const std::string&)>;
+
+    static constexpr size_t MAX_REQUEST_SIZE = 64 * 1024;
+
+private:
+    // epoll tags for the two non-session descriptors; session ids start above them
+    static constexpr uint64_t LISTEN_TAG = 0;
+    static constexpr uint64_t WAKE_TAG = 1;
+
+    struct Session {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        size_t outputSent = 0;
+        std::deque<std::string> pending;
+        bool busy = false;
+        bool peerClosed = false;
+        uint32_t events = 0;
+        OutputMode mode = OutputMode::HUMAN;  // changed by the session's 'output' commands
+    };
+
+    struct Completion {
+        uint64_t sessionId;
+        std::string output;
+        ErrorCode code;
+        OutputMode mode;
+    };
+
+    std::string path_;
+    ThreadPool& pool_;
+    Executor execute_;
+    int listenFd_;
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> stopping_;
+    uint64_t nextSessionId_;
+    std::unordered_map<uint64_t, std::unique_ptr<Session>> sessions_;
+
+    std::mutex completionsMutex_;
+    std::vector<Completion> completions_;
+
+    // Requests running on the pool; the destructor waits for them because they use `this`
+    std::mutex inFlightMutex_;
+    std::condition_variable inFlightDone_;
+    size_t inFlight_;
+
+    std::atomic<size_t> requestsServed_;
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+        (void)written;  // the counter only saturates if the loop is already due to wake
+    }
+
+    bool watch(int fd, uint64_t tag, uint32_t events, int op) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = tag;
+        return ::epoll_ctl(epollFd_, op, fd, &event) == 0;
+    }
+
+    void acceptSessions() {
+        while (true) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    LOG_WARNING("ControlServer", std::string("accept failed: ") + std::strerror(errno));
+                }
+                return;
+            }
+            uint64_t id = nextSessionId_++;
+            auto session = std::make_unique<Session>();
+            session->fd = fd;
+            session->mode = currentOutputMode();
+            session->events = EPOLLIN | EPOLLRDHUP;
+            if (!watch(fd, id, session->events, EPOLL_CTL_ADD)) {
+                ::close(fd);
+                continue;
+            }
+            sessions_.emplace(id, std::move(session));
+            LOG_DEBUG("ControlServer", "Session " + std::to_string(id) + " connected");
+        }
+    }
+
+    void closeSession(uint64_t id) {
+        auto it = sessions_.find(id);
+        if (it == sessions_.end()) {
+            return;
+        }
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, it->second->fd, nullptr);
+        ::close(it->second->fd);
+        sessions_.erase(it);
+        LOG_DEBUG("ControlServer", "Session " + std::to_string(id) + " closed");
+    }
+
+    // Read until the peer hangs up (level-triggered EOF would fire forever),
+    // write only while output is left over. EPOLLHUP is reported whatever the
+    // mask, so a session waiting on nothing but its running request leaves
+    // epoll (events == 0) until a reply needs writing.
+    void updateInterest(uint64_t id, Session& session) {
+        uint32_t events = 0;
+        if (!session.peerClosed) {
+            events |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (!session.output.empty()) {
+            events |= EPOLLOUT;
+        }
+        if (events != session.events) {
+            int op = events == 0 ? EPOLL_CTL_DEL : session.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+            session.events = events;
+            watch(session.fd, id, events, op);
+        }
+    }
+
+    void dispatchNext(uint64_t id, Session& session) {
+        if (session.busy || session.pending.empty() || stopping_.load()) {
+            return;
+        }
+        std::string line = std::move(session.pending.front());
+        session.pending.pop_front();
+        session.busy = true;
+
+        {
+            std::lock_guard<std::mutex> lock(inFlightMutex_);
+            ++inFlight_;
+        }
+        pool_.submitTask([this, id, line = std::move(line), mode = session.mode]() {
+            JobOutput output;
+            ErrorCode code = ErrorCode::SUCCESS;
+            OutputMode nextMode = mode;
+            {
+                OutputCapture capture(&output);
+                OutputModeScope modeScope(mode);
+                try {
+                    Status status = execute_(line);
+                    code = status.error();
+                    nextMode = currentOutputMode();
+                } catch (const std::exception& e) {
+                    std::cout << "[ERROR] " << e.what() << "\n";
+                    code = ErrorCode::INTERNAL_ERROR;
+                }
+            }
+
+            Completion completion{id, std::string(), code, nextMode};
+            output.readFrom(0, completion.output, false);
+            {
+                std::lock_guard<std::mutex> lock(completionsMutex_);
+                completions_.push_back(std::move(completion));
+            }
+            wake();
+
+            std::lock_guard<std::mutex> lock(inFlightMutex_);
+            if (--inFlight_ == 0) {
+                inFlightDone_.notify_all();
+            }
+        });
+    }
+
+    void readSession(uint64_t id, Session& session) {
+        char chunk[4096];
+        while (true) {
+            ssize_t n = ::recv(session.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                session.input.append(chunk, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0) {
+                session.peerClosed = true;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                session.peerClosed = true;
+            }
+            break;
+        }
+
+        size_t start = 0;
+        size_t newline;
+        while ((newline = session.input.find('\n', start)) != std::string::npos) {
+            std::string line = session.input.substr(start, newline - start);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            // Blank lines are answered too, so every request gets exactly one reply
+            session.pending.push_back(std::move(line));
+            start = newline + 1;
+        }
+        session.input.erase(0, start);
+
+        if (session.input.size() > MAX_REQUEST_SIZE) {
+            LOG_WARNING("ControlServer", "Session " + std::to_string(id) + " sent an oversized request");
+            session.peerClosed = true;
+            session.pending.clear();
+        }
+        updateInterest(id, session);
+        dispatchNext(id, session);
+    }
+
+    // Sends what the socket accepts without blocking
+    void flushSession(uint64_t id, Session& session) {
+        while (session.outputSent < session.output.size()) {
+            ssize_t n = ::send(session.fd, session.output.data() + session.outputSent,
+                               session.output.size() - session.outputSent, MSG_NOSIGNAL);
+            if (n > 0) {
+                session.outputSent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            // The peer is gone; nothing more can be delivered
+            session.output.clear();
+            session.outputSent = 0;
+            session.peerClosed = true;
+            session.pending.clear();
+            break;
+        }
+        if (session.outputSent == session.output.size()) {
+            session.output.clear();
+            session.outputSent = 0;
+        }
+        updateInterest(id, session);
+    }
+
+    // A session that hung up is kept until its queued requests are answered
+    void closeIfDone(uint64_t id, Session& session) {
+        if (session.peerClosed && !session.busy && session.pending.empty() && session.output.empty()) {
+            closeSession(id);
+        }
+    }
+
+    void deliverCompletions() {
+        std::vector<Completion> ready;
+        {
+            std::lock_guard<std::mutex> lock(completionsMutex_);
+            ready.swap(completions_);
+        }
+        for (auto& completion : ready) {
+            ++requestsServed_;
+            auto it = sessions_.find(completion.sessionId);
+            if (it == sessions_.end()) {
+                continue;
+            }
+            Session& session = *it->second;
+            session.busy = false;
+            session.mode = completion.mode;
+            session.output += formatReplyHeader(completion.code, completion.output.size());
+            session.output += completion.output;
+            flushSession(completion.sessionId, session);
+            dispatchNext(completion.sessionId, session);
+            closeIfDone(completion.sessionId, session);
+        }
+    }
+
+    void closeAll() {
+        while (!sessions_.empty()) {
+            closeSession(sessions_.begin()->first);
+        }
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+            ::unlink(path_.c_str());
+        }
+        if (epollFd_ >= 0) {
+            ::close(epollFd_);
+            epollFd_ = -1;
+        }
+        if (wakeFd_ >= 0) {
+            ::close(wakeFd_);
+            wakeFd_ = -1;
+        }
+    }
+
+public:
+    ControlServer(std::string path, ThreadPool& pool, Executor execute)
+        : path_(std::move(path)), pool_(pool), execute_(std::move(execute)),
+          listenFd_(-1), epollFd_(-1), wakeFd_(-1), stopping_(false), nextSessionId_(WAKE_TAG + 1),
+          inFlight_(0), requestsServed_(0) {}
+
+    ~ControlServer() {
+        stop();
+        std::unique_lock<std::mutex> lock(inFlightMutex_);
+        inFlightDone_.wait(lock, [this] { return inFlight_ == 0; });
+        lock.unlock();
+        closeAll();
+    }
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    // Bind the socket. A leftover socket file from an earlier run is replaced;
+    // any other file at `path` is left alone and reported.
+    Status listen() {
+        sockaddr_un address;
+        if (!fillSocketAddress(path_, address)) {
+            LOG_ERROR("ControlServer", "Socket path too long: " + path_);
+            return makeError(ErrorCode::INVALID_ARGUMENTS);
+        }
+
+        struct stat info;
+        if (::lstat(path_.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                LOG_ERROR("ControlServer", path_ + " exists and is not a socket");
+                return makeError(ErrorCode::PERMISSION_DENIED);
+            }
+            ::unlink(path_.c_str());
+        }
+
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listenFd_ < 0 || epollFd_ < 0 || wakeFd_ < 0 ||
+            ::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd_, SOMAXCONN) != 0 ||
+            !watch(listenFd_, LISTEN_TAG, EPOLLIN, EPOLL_CTL_ADD) ||
+            !watch(wakeFd_, WAKE_TAG, EPOLLIN, EPOLL_CTL_ADD)) {
+            LOG_ERROR("ControlServer", "Cannot listen on " + path_ + ": " + std::strerror(errno));
+            closeAll();
+            return makeError(ErrorCode::NETWORK_ERROR);
+        }
+
+        installOutputRouter(std::cout);
+        LOG_INFO("ControlServer", "Listening on " + path_);
+        return ok();
+    }
+
+    // Event loop; returns after stop()
+    void run() {
+        std::vector<epoll_event> events(64);
+        while (!stopping_.load()) {
+            int count = ::epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("ControlServer", std::string("epoll_wait failed: ") + std::strerror(errno));
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == LISTEN_TAG) {
+                    acceptSessions();
+                } else if (tag == WAKE_TAG) {
+                    uint64_t value;
+                    while (::read(wakeFd_, &value, sizeof(value)) > 0) {
+                    }
+                    deliverCompletions();
+                } else {
+                    auto it = sessions_.find(tag);
+                    if (it == sessions_.end()) {
+                        continue;
+                    }
+                    Session& session = *it->second;
+                    if (events[i].events & EPOLLOUT) {
+                        flushSession(tag, session);
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                        readSession(tag, session);
+                    }
+                    closeIfDone(tag, session);
+                }
+            }
+        }
+
+        // Answer requests that were already running, e.g. the one that called stop()
+        {
+            std::unique_lock<std::mutex> lock(inFlightMutex_);
+            inFlightDone_.wait(lock, [this] { return inFlight_ == 0; });
+        }
+        deliverCompletions();
+        LOG_INFO("ControlServer", "Stopped after " + std::to_string(requestsServed_.load()) + " requests");
+    }
+
+    // Safe from any thread, including a request running on the pool
+    void stop() {
+        stopping_ = true;
+        if (wakeFd_ >= 0) {
+            wake();
+        }
+    }
+
+    size_t sessionCount() const { return sessions_.size(); }
+    size_t requestsServed() const { return requestsServed_.load(); }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_CONTROL_SERVER_H
@@ -0,0 +1,80 @@
+#include "crack_session.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace Oroto {
+
+namespace {
+
+std::atomic<int> g_resumableAttacks(0);
+std::atomic<bool> g_stopRequested(false);
+std::atomic<bool> g_shutdownPending(false);
+
+std::mutex g_claimsMutex;
+std::unordered_set<std::string> g_claimedSessions;
+
+} // namespace
+
+bool requestCrackStop() {
+    if (g_resumableAttacks.load() == 0) {
+        return false;
+    }
+    // A second signal while the first is being handled falls through to exit
+    return !g_stopRequested.exchange(true);
+}
+
+bool requestCrackShutdown() {
+    if (g_resumableAttacks.load() == 0) {
+        return false;
+    }
+    if (g_shutdownPending.exchange(true)) {
+        return false;
+    }
+    // Set after the pending flag, so no scope clears it again: attacks still
+    // queued behind the running ones stop at their first checkpoint
+    g_stopRequested.store(true);
+    return true;
+}
+
+bool crackStopRequested() {
+    return g_stopRequested.load(std::memory_order_relaxed);
+}
+
+bool crackShutdownPending() {
+    return g_shutdownPending.load();
+}
+
+void waitForStoppedCracks() {
+    while (g_resumableAttacks.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+CrackStopScope::CrackStopScope() {
+    if (g_resumableAttacks.fetch_add(1) == 0 && !g_shutdownPending.load()) {
+        g_stopRequested.store(false);
+    }
+}
+
+CrackStopScope::~CrackStopScope() {
+    if (g_resumableAttacks.fetch_sub(1) == 1 && !g_shutdownPending.load()) {
+        g_stopRequested.store(false);
+    }
+}
+
+CrackSessionClaim::CrackSessionClaim(std::string name) : name_(std::move(name)) {
+    std::lock_guard<std::mutex> lock(g_claimsMutex);
+    held_ = g_claimedSessions.insert(name_).second;
+}
+
+CrackSessionClaim::~CrackSessionClaim() {
+    if (held_) {
+        std::lock_guard<std::mutex> lock(g_claimsMutex);
+        g_claimedSessions.erase(name_);
+    }
+}
+
+} // namespace Oroto
@@ -0,0 +1,191 @@
+#ifndef OROTO_CRACK_SESSION_H
+#define OROTO_CRACK_SESSION_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "expected.h"
+#include "hex.h"
+
+namespace Oroto {
+
+// How far an attack has got: everything before it has been hashed. For brute
+// force `part` is the keyspace and `offset` a candidate index in it; for a
+// wordlist `part` is 0 and `offset` the byte offset of a line start.
+struct CrackPosition {
+    uint64_t part = 0;
+    uint64_t offset = 0;
+};
+
+// For signal handlers: asks the running resumable attack to save its session
+// and stop. Only touches lock-free atomics. False when no such attack is
+// running, so the caller handles the signal as it otherwise would.
+bool requestCrackStop();
+bool crackStopRequested();
+
+// requestCrackStop() for SIGINT and SIGTERM, which also end the process: the
+// stop then holds for every later attack too, and crackShutdownPending()
+// turns true. The attacks return CANCELLED; the thread that owns the process
+// (the shell loop, the batch runner or the control server) is expected to
+// shut down, after waitForStoppedCracks().
+bool requestCrackShutdown();
+bool crackShutdownPending();
+void waitForStoppedCracks();
+
+// Marks a resumable attack as running for requestCrackStop() and drops any
+// request left over from an earlier one
+class CrackStopScope {
+public:
+    CrackStopScope();
+    ~CrackStopScope();
+    CrackStopScope(const CrackStopScope&) = delete;
+    CrackStopScope& operator=(const CrackStopScope&) = delete;
+};
+
+// Holds a session name for one running attack, so two concurrent attacks
+// never checkpoint to (or remove) the same file. held() is false when
+// another attack in this process already has the name.
+class CrackSessionClaim {
+private:
+    std::string name_;
+    bool held_;
+
+public:
+    explicit CrackSessionClaim(std::string name);
+    ~CrackSessionClaim();
+    CrackSessionClaim(const CrackSessionClaim&) = delete;
+    CrackSessionClaim& operator=(const CrackSessionClaim&) = delete;
+
+    bool held() const { return held_; }
+    const std::string& name() const { return name_; }
+};
+
+// What 'crack --resume NAME' needs to carry on: the original arguments, the
+// attack mode, the position and the hashes cracked so far. Saved as one
+// tab-separated record per line; arguments and plaintexts are hex-encoded so
+// any byte survives. save() writes a sibling file and renames it over the old
+// one, so a kill mid-save leaves the previous checkpoint intact.
+struct CrackSession {
+    static constexpr const char* HEADER = "# oroto crack session v1";
+
+    std::vector<std::string> args;      // everything after 'crack'
+    char mode = '1';                    // '1' dictionary, '2' brute force
+    CrackPosition position;
+    uint64_t inputSize = 0;             // wordlist bytes, to notice a changed file
+    uint64_t attempts = 0;              // over all runs so far
+    double seconds = 0.0;
+    std::vector<std::pair<std::string, std::string>> cracked;   // digest hex, plaintext
+
+    // Letters, digits, '-' and '_', so a name is always a plain file name
+    static bool validName(std::string_view name) {
+        if (name.empty() || name.size() > 64) {
+            return false;
+        }
+        for (char c : name) {
+            bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                         c == '-' || c == '_';
+            if (!plain) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // NAME.session in $OROTO_SESSION_DIR, else the working directory
+    static std::string pathFor(std::string_view name) {
+        const char* dir = std::getenv("OROTO_SESSION_DIR");
+        std::string path = dir && *dir ? std::string(dir) + "/" : std::string();
+        return path + std::string(name) + ".session";
+    }
+
+    // FILE_NOT_FOUND if there is no such session, PARSE_ERROR if the file
+    // is not one
+    Status load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        std::string line;
+        if (!std::getline(in, line) || line != HEADER) {
+            return makeError(ErrorCode::PARSE_ERROR);
+        }
+        auto unhex = [](const std::string& hex, std::string& text) {
+            text.assign(hex.size() / 2, '\0');
+            return parseHex(hex, reinterpret_cast<uint8_t*>(text.data()), text.size());
+        };
+        *this = CrackSession();
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string key, first, second;
+            std::getline(fields, key, '\t');
+            std::getline(fields, first, '\t');
+            std::getline(fields, second);
+            bool valid = true;
+            if (key == "arg") {
+                args.emplace_back();
+                valid = unhex(first, args.back());
+            } else if (key == "mode") {
+                valid = first == "1" || first == "2";
+                mode = valid ? first[0] : mode;
+            } else if (key == "position") {
+                char* end = nullptr;
+                position.part = std::strtoull(first.c_str(), &end, 10);
+                valid = end && *end == '\0';
+                position.offset = std::strtoull(second.c_str(), &end, 10);
+                valid = valid && end && *end == '\0';
+            } else if (key == "input") {
+                inputSize = std::strtoull(first.c_str(), nullptr, 10);
+            } else if (key == "attempts") {
+                attempts = std::strtoull(first.c_str(), nullptr, 10);
+            } else if (key == "seconds") {
+                seconds = std::strtod(first.c_str(), nullptr);
+            } else if (key == "cracked") {
+                cracked.emplace_back(first, std::string());
+                valid = unhex(second, cracked.back().second);
+            }
+            if (!valid) {
+                return makeError(ErrorCode::PARSE_ERROR);
+            }
+        }
+        return ok();
+    }
+
+    bool save(const std::string& path) const {
+        auto hex = [](const std::string& text) {
+            return toHex(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+        };
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            out << HEADER << "\n";
+            for (const std::string& arg : args) {
+                out << "arg\t" << hex(arg) << "\n";
+            }
+            out << "mode\t" << mode << "\n"
+                << "position\t" << position.part << '\t' << position.offset << "\n"
+                << "input\t" << inputSize << "\n"
+                << "attempts\t" << attempts << "\n"
+                << "seconds\t" << seconds << "\n";
+            for (const auto& [digest, plaintext] : cracked) {
+                out << "cracked\t" << digest << '\t' << hex(plaintext) << "\n";
+            }
+            if (!out.flush()) {
+                return false;
+            }
+        }
+        return std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_CRACK_SESSION_H
@@ -0,0 +1,140 @@
+#ifndef OROTO_DIGEST_SET_H
+#define OROTO_DIGEST_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "hash_kernels.h"
+
+namespace Oroto {
+
+// Target digests of one algorithm for cracking many hashes at once. Digests
+// are uniformly random, so their leading bytes serve as the hash:
+//   - a bitmap indexed by the low bits of the first 32-bit word, sized at 16
+//     bits per target, rejects about 15 of 16 non-matching candidates with
+//     one read that stays in cache;
+//   - survivors probe an open-addressing table (linear probing, at most half
+//     full) of {first 64 bits, index} slots, and only a 64-bit match is
+//     confirmed against the full digest.
+// So the cost per candidate is nearly the same for one target or a million.
+class DigestSet {
+private:
+    struct Slot {
+        uint64_t key;
+        uint32_t index;   // position + 1; 0 marks an empty slot
+    };
+
+    static constexpr size_t MIN_FILTER_BITS = 1 << 16;
+    static constexpr size_t MAX_FILTER_BITS = size_t(1) << 27;
+
+    HashAlgorithm algorithm_;
+    size_t digestSize_;
+    std::vector<uint8_t> digests_;   // in insertion order
+    std::vector<Slot> slots_;
+    std::vector<uint64_t> filter_;
+    size_t slotMask_;
+    size_t filterMask_;
+
+    static uint32_t prefix32(const uint8_t* digest) {
+        uint32_t word;
+        std::memcpy(&word, digest, sizeof(word));
+        return word;
+    }
+
+    static uint64_t prefix64(const uint8_t* digest) {
+        uint64_t word;
+        std::memcpy(&word, digest, sizeof(word));
+        return word;
+    }
+
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32) & slotMask_;
+    }
+
+    void place(size_t index) {
+        const uint8_t* digest = digests_.data() + index * digestSize_;
+        uint64_t key = prefix64(digest);
+        size_t slot = home(key);
+        while (slots_[slot].index != 0) {
+            slot = (slot + 1) & slotMask_;
+        }
+        slots_[slot] = {key, static_cast<uint32_t>(index + 1)};
+        size_t bit = prefix32(digest) & filterMask_;
+        filter_[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    void rebuild(size_t capacity) {
+        size_t slotCount = 16;
+        while (slotCount < capacity * 2) {
+            slotCount *= 2;
+        }
+        size_t filterBits = MIN_FILTER_BITS;
+        while (filterBits < capacity * 16 && filterBits < MAX_FILTER_BITS) {
+            filterBits *= 2;
+        }
+        slots_.assign(slotCount, Slot{0, 0});
+        filter_.assign(filterBits / 64, 0);
+        slotMask_ = slotCount - 1;
+        filterMask_ = filterBits - 1;
+        for (size_t i = 0; i < size(); ++i) {
+            place(i);
+        }
+    }
+
+public:
+    static constexpr int NOT_FOUND = -1;
+
+    explicit DigestSet(HashAlgorithm algorithm)
+        : algorithm_(algorithm), digestSize_(digestSize(algorithm)), slotMask_(0), filterMask_(0) {
+        rebuild(0);
+    }
+
+    // Sizes the table for this many targets up front
+    void reserve(size_t count) {
+        if (count * 2 > slots_.size()) {
+            digests_.reserve(count * digestSize_);
+            rebuild(count);
+        }
+    }
+
+    // False if the digest is already in the set
+    bool add(const uint8_t* digest) {
+        if (find(digest) != NOT_FOUND) {
+            return false;
+        }
+        digests_.insert(digests_.end(), digest, digest + digestSize_);
+        if (size() * 2 > slots_.size()) {
+            rebuild(size() * 2);
+        } else {
+            place(size() - 1);
+        }
+        return true;
+    }
+
+    // Index of the matching target, or NOT_FOUND
+    int find(const uint8_t* digest) const {
+        size_t bit = prefix32(digest) & filterMask_;
+        if (!(filter_[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return NOT_FOUND;
+        }
+        uint64_t key = prefix64(digest);
+        for (size_t slot = home(key); slots_[slot].index != 0; slot = (slot + 1) & slotMask_) {
+            if (slots_[slot].key == key) {
+                size_t index = slots_[slot].index - 1;
+                if (std::memcmp(digests_.data() + index * digestSize_, digest, digestSize_) == 0) {
+                    return static_cast<int>(index);
+                }
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    HashAlgorithm algorithm() const { return algorithm_; }
+    size_t size() const { return digests_.size() / digestSize_; }
+    const uint8_t* digest(size_t index) const { return digests_.data() + index * digestSize_; }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_DIGEST_SET_H
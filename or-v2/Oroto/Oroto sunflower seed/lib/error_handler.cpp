@@ -4,7 +4,7 @@
 namespace Oroto {
 
 // Static member definitions
-std::map<ErrorCode, std::string> ErrorHandler::errorMessages;
-std::map<ErrorCode, std::function<void()>> ErrorHandler::errorHandlers;
+std::array<std::function<void()>, ERROR_CODE_COUNT> ErrorHandler::errorHandlers;
+std::array<std::atomic<size_t>, ERROR_CODE_COUNT> ErrorHandler::errorCounts{};
 
 } // namespace Oroto
@@ -4,28 +4,17 @@
 
 #include <stdexcept>
 #include <string>
-#include <map>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <type_traits>
 #include "logger.h"
+#include "expected.h"
 
 namespace Oroto {
 
-// Error codes for Oroto system
-enum class ErrorCode {
-    SUCCESS = 0,
-    COMMAND_NOT_FOUND = 1,
-    INVALID_ARGUMENTS = 2,
-    PERMISSION_DENIED = 3,
-    NETWORK_ERROR = 4,
-    FILE_NOT_FOUND = 5,
-    MEMORY_ERROR = 6,
-    DEVICE_ERROR = 7,
-    TIMEOUT = 8,
-    INTERNAL_ERROR = 9,
-    PARSE_ERROR = 10
-};
-
-// Custom exception class for Oroto
+// Custom exception class for Oroto.
+// Logging happens where the exception is handled, not on construction.
 class OrotoException : public std::runtime_error {
 private:
     ErrorCode code_;
@@ -33,9 +22,7 @@ private:
 
 public:
     OrotoException(ErrorCode code, const std::string& module, const std::string& message)
-        : std::runtime_error(message), code_(code), module_(module) {
-        LOG_ERROR(module_, what());
-    }
+        : std::runtime_error(message), code_(code), module_(module) {}
 
     ErrorCode getCode() const { return code_; }
     const std::string& getModule() const { return module_; }
@@ -43,52 +30,64 @@ public:
 
 class ErrorHandler {
 private:
-    static std::map<ErrorCode, std::string> errorMessages;
-    static std::map<ErrorCode, std::function<void()>> errorHandlers;
+    static std::array<std::function<void()>, ERROR_CODE_COUNT> errorHandlers;
+    static std::array<std::atomic<size_t>, ERROR_CODE_COUNT> errorCounts;
+
+    static size_t index(ErrorCode code) {
+        size_t i = static_cast<size_t>(code);
+        return i < ERROR_CODE_COUNT ? i : static_cast<size_t>(ErrorCode::INTERNAL_ERROR);
+    }
 
 public:
     static void initialize() {
-        // Initialize error messages
-        errorMessages[ErrorCode::SUCCESS] = "Operation completed successfully";
-        errorMessages[ErrorCode::COMMAND_NOT_FOUND] = "Command not found";
-        errorMessages[ErrorCode::INVALID_ARGUMENTS] = "Invalid arguments provided";
-        errorMessages[ErrorCode::PERMISSION_DENIED] = "Permission denied";
-        errorMessages[ErrorCode::NETWORK_ERROR] = "Network operation failed";
-        errorMessages[ErrorCode::FILE_NOT_FOUND] = "File or directory not found";
-        errorMessages[ErrorCode::MEMORY_ERROR] = "Memory allocation failed";
-        errorMessages[ErrorCode::DEVICE_ERROR] = "Device operation failed";
-        errorMessages[ErrorCode::TIMEOUT] = "Operation timed out";
-        errorMessages[ErrorCode::INTERNAL_ERROR] = "Internal system error";
-        errorMessages[ErrorCode::PARSE_ERROR] = "Parse or syntax error";
-
         // Initialize default error handlers
-        errorHandlers[ErrorCode::MEMORY_ERROR] = []() {
+        errorHandlers[index(ErrorCode::MEMORY_ERROR)] = []() {
             LOG_CRITICAL("ErrorHandler", "Critical memory error detected");
         };
         
-        errorHandlers[ErrorCode::INTERNAL_ERROR] = []() {
+        errorHandlers[index(ErrorCode::INTERNAL_ERROR)] = []() {
             LOG_CRITICAL("ErrorHandler", "Internal system error occurred");
         };
     }
 
     static std::string getErrorMessage(ErrorCode code) {
-        auto it = errorMessages.find(code);
-        return (it != errorMessages.end()) ? it->second : "Unknown error";
+        return errorMessage(code);
     }
 
     static void handleError(ErrorCode code, const std::string& module = "System") {
-        std::string message = getErrorMessage(code);
-        LOG_ERROR(module, "Error " + std::to_string(static_cast<int>(code)) + ": " + message);
+        recordError(code);
+        LOG_ERROR(module, "Error " + std::to_string(static_cast<int>(code)) + ": " + errorMessage(code));
         
         // Execute custom handler if available
-        auto handler = errorHandlers.find(code);
-        if (handler != errorHandlers.end()) {
-            handler->second();
+        const auto& handler = errorHandlers[index(code)];
+        if (handler) {
+            handler();
         }
     }
 
+    // Cheap bookkeeping for failures reported through Expected results
+    static void recordError(ErrorCode code) {
+        errorCounts[index(code)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t getErrorCount(ErrorCode code) {
+        return errorCounts[index(code)].load(std::memory_order_relaxed);
+    }
+
     static void registerErrorHandler(ErrorCode code, std::function<void()> handler) {
-        errorHandlers[code] = handler;
+        errorHandlers[index(code)] = std::move(handler);
+    }
+
+    // Zero-cost path for operations that report failure through Expected:
+    // nothing is thrown, logged or allocated, the failure is only counted.
+    template<typename F, typename R = std::invoke_result_t<F&>,
+             typename = std::enable_if_t<IsExpected<R>::value>>
+    static R safeExecute(F&& operation) noexcept(noexcept(operation())) {
+        R result = operation();
+        if (!result) {
+            recordError(result.error());
+        }
+        return result;
     }
 
     // Safe wrapper for operations that might fail
@@ -99,6 +98,7 @@ public:
             result = operation();
             return true;
         } catch (const OrotoException& e) {
+            LOG_ERROR(e.getModule(), e.what());
             handleError(e.getCode(), e.getModule());
             return false;
         } catch (const std::exception& e) {
@@ -119,6 +119,7 @@ public:
             operation();
             return true;
         } catch (const OrotoException& e) {
+            LOG_ERROR(e.getModule(), e.what());
             handleError(e.getCode(), e.getModule());
             return false;
         } catch (const std::exception& e) {
@@ -0,0 +1,147 @@
+#ifndef OROTO_EXPECTED_H
+#define OROTO_EXPECTED_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+namespace Oroto {
+
+// Error codes for Oroto system
+enum class ErrorCode {
+    SUCCESS = 0,
+    COMMAND_NOT_FOUND = 1,
+    INVALID_ARGUMENTS = 2,
+    PERMISSION_DENIED = 3,
+    NETWORK_ERROR = 4,
+    FILE_NOT_FOUND = 5,
+    MEMORY_ERROR = 6,
+    DEVICE_ERROR = 7,
+    TIMEOUT = 8,
+    INTERNAL_ERROR = 9,
+    PARSE_ERROR = 10,
+    CANCELLED = 11
+};
+
+constexpr size_t ERROR_CODE_COUNT = 12;
+
+// Message table indexed by ErrorCode, resolved at compile time
+constexpr const char* ERROR_MESSAGES[ERROR_CODE_COUNT] = {
+    "Operation completed successfully",
+    "Command not found",
+    "Invalid arguments provided",
+    "Permission denied",
+    "Network operation failed",
+    "File or directory not found",
+    "Memory allocation failed",
+    "Device operation failed",
+    "Operation timed out",
+    "Internal system error",
+    "Parse or syntax error",
+    "Operation cancelled"
+};
+
+constexpr const char* errorMessage(ErrorCode code) {
+    size_t index = static_cast<size_t>(code);
+    return index < ERROR_CODE_COUNT ? ERROR_MESSAGES[index] : "Unknown error";
+}
+
+static_assert(errorMessage(ErrorCode::PARSE_ERROR)[0] == 'P' && ERROR_MESSAGES[ERROR_CODE_COUNT - 1] != nullptr,
+              "error message table out of sync with ErrorCode");
+
+// Error marker used to construct a failed Expected
+struct Unexpected {
+    ErrorCode code;
+};
+
+constexpr Unexpected makeError(ErrorCode code) { return Unexpected{code}; }
+
+// A failure built from SUCCESS is a bug at the call site, never a success
+constexpr ErrorCode failureCode(Unexpected failure) {
+    return failure.code == ErrorCode::SUCCESS ? ErrorCode::INTERNAL_ERROR : failure.code;
+}
+
+// Value-or-error result. Failures travel by return value: no throw, no allocation.
+template<typename T>
+class [[nodiscard]] Expected {
+private:
+    union {
+        T value_;
+    };
+    ErrorCode error_;
+
+public:
+    Expected(const T& value) : error_(ErrorCode::SUCCESS) { new (&value_) T(value); }
+    Expected(T&& value) : error_(ErrorCode::SUCCESS) { new (&value_) T(std::move(value)); }
+    Expected(Unexpected failure) : error_(failureCode(failure)) {}
+
+    Expected(const Expected& other) : error_(other.error_) {
+        if (hasValue()) new (&value_) T(other.value_);
+    }
+
+    Expected(Expected&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : error_(other.error_) {
+        if (hasValue()) new (&value_) T(std::move(other.value_));
+    }
+
+    Expected& operator=(Expected other) {
+        this->~Expected();
+        new (this) Expected(std::move(other));
+        return *this;
+    }
+
+    ~Expected() {
+        if (hasValue()) value_.~T();
+    }
+
+    bool hasValue() const { return error_ == ErrorCode::SUCCESS; }
+    explicit operator bool() const { return hasValue(); }
+
+    // Reading a failed Expected reads an unconstructed T
+    T& value() { assert(hasValue()); return value_; }
+    const T& value() const { assert(hasValue()); return value_; }
+    T& operator*() { assert(hasValue()); return value_; }
+    const T& operator*() const { assert(hasValue()); return value_; }
+    T* operator->() { assert(hasValue()); return &value_; }
+    const T* operator->() const { assert(hasValue()); return &value_; }
+
+    template<typename U>
+    T valueOr(U&& fallback) const {
+        return hasValue() ? value_ : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    ErrorCode error() const { return error_; }
+    const char* message() const { return errorMessage(error_); }
+};
+
+// Result of an operation that produces no value
+template<>
+class [[nodiscard]] Expected<void> {
+private:
+    ErrorCode error_;
+
+public:
+    constexpr Expected() : error_(ErrorCode::SUCCESS) {}
+    constexpr Expected(Unexpected failure) : error_(failureCode(failure)) {}
+
+    constexpr bool hasValue() const { return error_ == ErrorCode::SUCCESS; }
+    constexpr explicit operator bool() const { return hasValue(); }
+
+    constexpr ErrorCode error() const { return error_; }
+    constexpr const char* message() const { return errorMessage(error_); }
+};
+
+using Status = Expected<void>;
+
+constexpr Status ok() { return Status(); }
+
+template<typename T>
+struct IsExpected : std::false_type {};
+
+template<typename T>
+struct IsExpected<Expected<T>> : std::true_type {};
+
+} // namespace Oroto
+
+#endif // OROTO_EXPECTED_H
@@ -0,0 +1,719 @@
+#ifndef OROTO_HASH_CRACKER_H
+#define OROTO_HASH_CRACKER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "crack_session.h"
+#include "digest_set.h"
+#include "hash_identifier.h"
+#include "hash_kernels.h"
+#include "keyspace.h"
+#include "mangling_rules.h"
+#include "mapped_wordlist.h"
+#include "thread_pool.h"
+
+namespace Oroto {
+
+struct CrackedHash {
+    size_t target;             // index in the DigestSet
+    std::string plaintext;
+};
+
+struct CrackResult {
+    bool found = false;        // at least one target cracked
+    std::string plaintext;     // the first one's
+    std::vector<CrackedHash> cracked;
+    uint64_t attempts = 0;     // candidates actually hashed
+    double seconds = 0.0;
+    bool interrupted = false;  // stopped by requestCrackStop(); the session was saved
+
+    double hashesPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(attempts) / seconds : 0.0;
+    }
+};
+
+// Called every few thousand candidates with the attempts so far and the
+// share of the input consumed (0..1, or -1 when the size is unknown)
+using CrackProgress = std::function<void(uint64_t attempts, double fraction)>;
+
+// Streams a wordlist one candidate per line. Trailing '\r' (wordlists made on
+// Windows) is stripped and empty lines are skipped.
+class WordlistReader {
+private:
+    std::istream& input_;
+    uint64_t bytesRead_;
+
+public:
+    explicit WordlistReader(std::istream& input) : input_(input), bytesRead_(0) {}
+
+    bool next(std::string& word) {
+        while (std::getline(input_, word)) {
+            bytesRead_ += word.size() + 1;
+            if (!word.empty() && word.back() == '\r') {
+                word.pop_back();
+            }
+            if (!word.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t bytesRead() const { return bytesRead_; }
+};
+
+// A digest to crack. The algorithm is that of the most likely format with a
+// cracking kernel (see hash_identifier.h): 32 hex digits are MD5, 40 SHA-1,
+// 64 SHA-256.
+struct CrackTarget {
+    HashAlgorithm algorithm = HashAlgorithm::MD5;
+    std::array<uint8_t, MAX_DIGEST_SIZE> digest{};
+
+    static bool parse(std::string_view hex, CrackTarget& target) {
+        const HashSignature* signature = hashIdentifier().crackable(hex);
+        if (!signature) {
+            return false;
+        }
+        target.algorithm = signature->algorithm;
+        target.digest.fill(0);
+        return parseHex(hex, target.digest.data(), digestSize(target.algorithm));
+    }
+
+    bool matches(const uint8_t* candidate) const {
+        return std::memcmp(candidate, digest.data(), digestSize(algorithm)) == 0;
+    }
+
+    DigestSet toSet() const {
+        DigestSet set(algorithm);
+        set.add(digest.data());
+        return set;
+    }
+};
+
+// Which targets are cracked so far, shared by every thread of one attack.
+// Each target is recorded once, by whichever thread gets there first.
+class CrackLedger {
+private:
+    std::unique_ptr<std::atomic<bool>[]> cracked_;
+    std::atomic<size_t> remaining_;
+    std::mutex mutex_;
+    std::vector<CrackedHash> results_;
+
+public:
+    explicit CrackLedger(size_t targets)
+        : cracked_(std::make_unique<std::atomic<bool>[]>(targets)), remaining_(targets) {
+        for (size_t i = 0; i < targets; ++i) {
+            cracked_[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // False if the target was already cracked
+    bool record(size_t target, std::string_view plaintext) {
+        if (cracked_[target].exchange(true)) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.push_back({target, std::string(plaintext)});
+        }
+        remaining_.fetch_sub(1);
+        return true;
+    }
+
+    bool done() const { return remaining_.load(std::memory_order_relaxed) == 0; }
+
+    // Fills the result fields in the order targets were cracked
+    void report(CrackResult& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.cracked = results_;
+        result.found = !results_.empty();
+        if (result.found) {
+            result.plaintext = results_.front().plaintext;
+        }
+    }
+};
+
+// Groups candidates by length so a multi-lane kernel always gets a full set
+// of equal-length messages. Each length up to MAX_BLOCK_MESSAGE has a bucket
+// of `lanes` slots that is hashed the moment it fills; longer candidates are
+// rare and go through the scalar code one at a time. With the 1-lane scalar
+// kernel every candidate is hashed as soon as it is added. Every digest is
+// looked up in the target set and hits go to the shared ledger.
+class CandidateBatcher {
+private:
+    const DigestSet& targets_;
+    const HashKernel& kernel_;
+    CrackLedger& ledger_;
+    size_t digestSize_;
+    std::vector<uint8_t> slots_;                  // [length][lane][MAX_BLOCK_MESSAGE]
+    std::array<size_t, MAX_BLOCK_MESSAGE + 1> fill_{};
+    uint64_t hashed_;
+
+    uint8_t* slot(size_t length, size_t lane) {
+        return slots_.data() + (length * kernel_.lanes + lane) * MAX_BLOCK_MESSAGE;
+    }
+
+    void check(const uint8_t* digest, const uint8_t* message, size_t length) {
+        int target = targets_.find(digest);
+        if (target != DigestSet::NOT_FOUND) {
+            ledger_.record(static_cast<size_t>(target),
+                           std::string_view(reinterpret_cast<const char*>(message), length));
+        }
+    }
+
+    // Hashes the bucket; unused lanes repeat lane 0 and are not checked
+    void hashBucket(size_t length) {
+        size_t count = fill_[length];
+        fill_[length] = 0;
+        if (count == 0) {
+            return;
+        }
+        const uint8_t* messages[MAX_KERNEL_LANES];
+        for (size_t lane = 0; lane < kernel_.lanes; ++lane) {
+            messages[lane] = slot(length, lane < count ? lane : 0);
+        }
+        uint8_t digests[MAX_KERNEL_LANES * MAX_DIGEST_SIZE];
+        kernel_.run(messages, length, digests);
+        hashed_ += count;
+        for (size_t lane = 0; lane < count; ++lane) {
+            check(digests + lane * digestSize_, messages[lane], length);
+        }
+    }
+
+public:
+    CandidateBatcher(const DigestSet& targets, const HashKernel& kernel, CrackLedger& ledger)
+        : targets_(targets), kernel_(kernel), ledger_(ledger), digestSize_(digestSize(targets.algorithm())),
+          slots_((MAX_BLOCK_MESSAGE + 1) * kernel.lanes * MAX_BLOCK_MESSAGE), hashed_(0) {}
+
+    // Queues a candidate, hashing its bucket if that fills it. True once
+    // every target has been cracked.
+    bool add(std::string_view candidate) {
+        if (candidate.size() > MAX_BLOCK_MESSAGE) {
+            uint8_t digest[MAX_DIGEST_SIZE];
+            hashOne(targets_.algorithm(), candidate, digest);
+            ++hashed_;
+            check(digest, reinterpret_cast<const uint8_t*>(candidate.data()), candidate.size());
+            return ledger_.done();
+        }
+        size_t length = candidate.size();
+        std::memcpy(slot(length, fill_[length]), candidate.data(), length);
+        if (++fill_[length] == kernel_.lanes) {
+            hashBucket(length);
+        }
+        return ledger_.done();
+    }
+
+    // Hashes whatever is left in partly filled buckets
+    bool flush() {
+        for (size_t length = 0; length <= MAX_BLOCK_MESSAGE && !ledger_.done(); ++length) {
+            hashBucket(length);
+        }
+        return ledger_.done();
+    }
+
+    uint64_t hashed() const { return hashed_; }
+};
+
+// Queues a wordlist entry, or with rules every rule's version of it. True
+// once every target has been cracked.
+inline bool addWord(CandidateBatcher& batcher, const RuleSet* rules, std::string_view word) {
+    if (!rules) {
+        return batcher.add(word);
+    }
+    return rules->forEachCandidate(word, [&](std::string_view candidate) { return batcher.add(candidate); });
+}
+
+// Hashes every candidate of the wordlist (each mangled by every rule, if
+// given) until all targets are cracked, batched for the given kernel (the
+// best one for the CPU by default). Honours job cancellation between
+// progress reports.
+inline CrackResult crackDictionary(const DigestSet& targets, std::istream& wordlist, uint64_t totalBytes = 0,
+                                   const CrackProgress& progress = nullptr, const HashKernel* kernel = nullptr,
+                                   const RuleSet* rules = nullptr) {
+    static constexpr uint64_t PROGRESS_INTERVAL = 1 << 14;
+    CrackResult result;
+    CrackLedger ledger(targets.size());
+    CandidateBatcher batcher(targets, kernel ? *kernel : bestHashKernel(targets.algorithm()), ledger);
+    WordlistReader reader(wordlist);
+    const auto start = std::chrono::steady_clock::now();
+
+    const uint64_t weight = rules ? rules->size() : 1;
+    std::string word;
+    uint64_t queued = 0;
+    uint64_t nextReport = PROGRESS_INTERVAL;
+    while (reader.next(word)) {
+        if (addWord(batcher, rules, word)) {
+            break;
+        }
+        if ((queued += weight) >= nextReport) {
+            nextReport = queued + PROGRESS_INTERVAL;
+            ThreadPool::cancellationPoint();
+            if (progress) {
+                progress(batcher.hashed(), totalBytes > 0 ? static_cast<double>(reader.bytesRead()) / totalBytes : -1.0);
+            }
+        }
+    }
+    batcher.flush();
+
+    ledger.report(result);
+    result.attempts = batcher.hashed();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+inline CrackResult crackDictionary(const CrackTarget& target, std::istream& wordlist, uint64_t totalBytes = 0,
+                                   const CrackProgress& progress = nullptr, const HashKernel* kernel = nullptr) {
+    return crackDictionary(target.toSet(), wordlist, totalBytes, progress, kernel);
+}
+
+// Runs a pool helper under the job of the attack it is helping with, so
+// killing that job stops the helper at its next cancellation point
+class AdoptedJob {
+private:
+    JobInfo* previous_;
+
+public:
+    explicit AdoptedJob(JobInfo* job) : previous_(ThreadPool::runningJob()) { ThreadPool::adoptJob(job); }
+    ~AdoptedJob() { ThreadPool::adoptJob(previous_); }
+    AdoptedJob(const AdoptedJob&) = delete;
+    AdoptedJob& operator=(const AdoptedJob&) = delete;
+};
+
+// Lets a long attack be stopped and continued later (see crack_session.h).
+// The attack starts at `start` and counts `cracked` as already found. Every
+// `interval` seconds, and once more if requestCrackStop() stops it, save()
+// is called on the calling thread with the position up to which every
+// candidate has been hashed and the results of all runs so far.
+struct CrackResume {
+    CrackPosition start;
+    std::vector<CrackedHash> cracked;   // in earlier runs
+    uint64_t attempts = 0;              // of earlier runs
+    double seconds = 0.0;
+    double interval = 10.0;
+    std::function<void(const CrackPosition&, const CrackResult&)> save;
+};
+
+// Checkpoint bookkeeping for the chunked attacks. Helpers only flag their
+// chunks as finished; the calling thread works out the first unfinished one
+// when a save is due, so checkpoints cost the hashing threads nothing.
+class CrackCheckpoints {
+private:
+    CrackResume* resume_;
+    CrackLedger& ledger_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point lastSave_;
+    std::unique_ptr<std::atomic<bool>[]> finished_;
+    size_t chunks_ = 0;
+    size_t mark_ = 0;   // chunks before it are all finished
+
+    size_t firstUnfinished() {
+        while (mark_ < chunks_ && finished_[mark_].load(std::memory_order_acquire)) {
+            ++mark_;
+        }
+        return mark_;
+    }
+
+public:
+    CrackCheckpoints(CrackResume* resume, CrackLedger& ledger)
+        : resume_(resume), ledger_(ledger), start_(std::chrono::steady_clock::now()), lastSave_(start_) {
+        if (resume_) {
+            for (const CrackedHash& cracked : resume_->cracked) {
+                ledger_.record(cracked.target, cracked.plaintext);
+            }
+        }
+    }
+
+    // A new run of chunks, numbered from 0
+    void begin(size_t chunks) {
+        if (resume_) {
+            finished_ = std::make_unique<std::atomic<bool>[]>(chunks);
+            for (size_t i = 0; i < chunks; ++i) {
+                finished_[i].store(false, std::memory_order_relaxed);
+            }
+            chunks_ = chunks;
+            mark_ = 0;
+        }
+    }
+
+    void finish(size_t chunk) {
+        if (resume_) {
+            finished_[chunk].store(true, std::memory_order_release);
+        }
+    }
+
+    bool stopping() const { return resume_ && crackStopRequested(); }
+
+    // Saves through position(first unfinished chunk); unless `now`, only if due
+    template <typename Position>
+    void save(uint64_t attempts, Position&& position, bool now = false) {
+        if (!resume_ || !resume_->save) {
+            return;
+        }
+        const auto time = std::chrono::steady_clock::now();
+        if (!now && std::chrono::duration<double>(time - lastSave_).count() < resume_->interval) {
+            return;
+        }
+        lastSave_ = time;
+        CrackResult snapshot;
+        ledger_.report(snapshot);
+        snapshot.attempts = resume_->attempts + attempts;
+        snapshot.seconds = resume_->seconds + std::chrono::duration<double>(time - start_).count();
+        resume_->save(position(firstUnfinished()), snapshot);
+    }
+
+    // Adds the earlier runs to the totals
+    void report(CrackResult& result, bool stopped) const {
+        result.interrupted = stopped;
+        if (resume_) {
+            result.attempts += resume_->attempts;
+            result.seconds += resume_->seconds;
+        }
+    }
+};
+
+// Hashes every line of an in-memory wordlist (usually a MappedWordlist),
+// each mangled by every rule if given, until all targets are cracked. The
+// text is cut into newline-aligned chunks that the pool's workers and the
+// calling thread claim one at a time; each chunk is split in place and its
+// lines go straight to that chunk's batcher as views, so no candidate is
+// ever copied into a std::string. Stopping, cancellation, progress and
+// checkpoints work as in crackKeyspaces.
+inline CrackResult crackWordlist(const DigestSet& targets, std::string_view text,
+                                 const CrackProgress& progress = nullptr, const HashKernel* kernel = nullptr,
+                                 ThreadPool* pool = nullptr, const RuleSet* rules = nullptr,
+                                 CrackResume* resume = nullptr) {
+    static constexpr uint64_t CHECK_INTERVAL = 1 << 12;
+    static constexpr size_t MIN_CHUNK = 1 << 20;
+    static constexpr size_t MAX_CHUNK = 1 << 24;
+    CrackResult result;
+    const HashKernel& chosen = kernel ? *kernel : bestHashKernel(targets.algorithm());
+    const auto start = std::chrono::steady_clock::now();
+
+    CrackLedger ledger(targets.size());
+    CrackCheckpoints checkpoints(resume, ledger);
+    const size_t skipped = resume ? std::min<size_t>(resume->start.offset, text.size()) : 0;
+    const std::string_view rest = text.substr(skipped);
+    std::atomic<uint64_t> hashed(0);
+    std::atomic<uint64_t> covered(skipped);
+    const std::thread::id caller = std::this_thread::get_id();
+    JobInfo* const job = ThreadPool::runningJob();
+    const size_t threads = pool ? pool->workerCount() + 1 : 1;
+    const uint64_t weight = rules ? rules->size() : 1;
+    // Rules multiply the work per byte, so they call for smaller chunks
+    const size_t chunk = std::clamp(rest.size() / (threads * 4), MIN_CHUNK / std::min<uint64_t>(weight, 64),
+                                    MAX_CHUNK);
+    const size_t chunks = rest.empty() ? 0 : (rest.size() - 1) / chunk + 1;
+    auto position = [&](size_t first) {
+        size_t offset = first < chunks ? wordlistChunk(rest, first, chunk).data() - rest.data() : rest.size();
+        return CrackPosition{0, skipped + offset};
+    };
+    checkpoints.begin(chunks);
+
+    auto search = [&](size_t index) {
+        AdoptedJob scope(job);
+        if (ledger.done() || checkpoints.stopping()) {
+            return;
+        }
+        ThreadPool::cancellationPoint();
+
+        const std::string_view range = wordlistChunk(rest, index, chunk);
+        CandidateBatcher batcher(targets, chosen, ledger);
+        const char* reported = range.data();
+        uint64_t queued = 0;
+        uint64_t nextCheck = CHECK_INTERVAL;
+        bool finished = forEachLine(range.data(), range.data() + range.size(), [&](std::string_view word) {
+            if (addWord(batcher, rules, word)) {
+                return true;
+            }
+            if ((queued += weight) < nextCheck) {
+                return false;
+            }
+            nextCheck = queued + CHECK_INTERVAL;
+            const char* consumed = word.data() + word.size();
+            covered.fetch_add(static_cast<uint64_t>(consumed - reported), std::memory_order_relaxed);
+            reported = consumed;
+            if (ledger.done() || checkpoints.stopping()) {
+                return true;
+            }
+            ThreadPool::cancellationPoint();
+            if (std::this_thread::get_id() == caller) {
+                const uint64_t attempts = hashed.load(std::memory_order_relaxed) + batcher.hashed();
+                if (progress) {
+                    progress(attempts, static_cast<double>(covered.load(std::memory_order_relaxed)) / text.size());
+                }
+                checkpoints.save(attempts, position);
+            }
+            return false;
+        });
+        if (!finished) {
+            batcher.flush();
+            covered.fetch_add(static_cast<uint64_t>(range.data() + range.size() - reported), std::memory_order_relaxed);
+            checkpoints.finish(index);
+        }
+        hashed.fetch_add(batcher.hashed(), std::memory_order_relaxed);
+    };
+
+    if (pool && chunks > 1) {
+        pool->parallelFor(chunks, search);
+    } else {
+        for (size_t index = 0; index < chunks && !ledger.done() && !checkpoints.stopping(); ++index) {
+            search(index);
+        }
+    }
+
+    const bool stopped = checkpoints.stopping() && !ledger.done();
+    if (stopped) {
+        checkpoints.save(hashed.load(), position, true);
+    }
+    ledger.report(result);
+    result.attempts = hashed.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    checkpoints.report(result, stopped);
+    return result;
+}
+
+// Searches the keyspaces in order. Each one is cut into chunks of indices
+// that the pool's workers and the calling thread claim one at a time; a chunk
+// decodes its first index and walks the rest in place through its own
+// batcher. Once the last target is cracked the shared ledger says so, and
+// every chunk checks it every few thousand candidates, so all threads stop
+// together. Progress and checkpoints come from the calling thread only, and
+// killing the job that runs this stops the helpers too. Without a pool the
+// calling thread does it all.
+inline CrackResult crackKeyspaces(const DigestSet& targets, const std::vector<Keyspace>& keyspaces,
+                                  const CrackProgress& progress = nullptr, const HashKernel* kernel = nullptr,
+                                  ThreadPool* pool = nullptr, CrackResume* resume = nullptr) {
+    static constexpr uint64_t CHECK_INTERVAL = 1 << 12;
+    static constexpr uint64_t MIN_CHUNK = 1 << 12;
+    static constexpr uint64_t MAX_CHUNK = 1 << 18;
+    CrackResult result;
+    const HashKernel& chosen = kernel ? *kernel : bestHashKernel(targets.algorithm());
+    const auto start = std::chrono::steady_clock::now();
+
+    CrackLedger ledger(targets.size());
+    CrackCheckpoints checkpoints(resume, ledger);
+    const CrackPosition resumeAt = resume ? resume->start : CrackPosition{};
+    double total = 0.0;
+    double skipped = 0.0;
+    for (size_t part = 0; part < keyspaces.size(); ++part) {
+        total += static_cast<double>(keyspaces[part].size());
+        if (part < resumeAt.part) {
+            skipped += static_cast<double>(keyspaces[part].size());
+        } else if (part == resumeAt.part) {
+            skipped += static_cast<double>(std::min(resumeAt.offset, keyspaces[part].size()));
+        }
+    }
+    std::atomic<uint64_t> hashed(0);
+    std::atomic<uint64_t> covered(0);
+    const std::thread::id caller = std::this_thread::get_id();
+    JobInfo* const job = ThreadPool::runningJob();
+    const uint64_t threads = pool ? pool->workerCount() + 1 : 1;
+
+    bool stopped = false;
+    for (size_t part = resumeAt.part; part < keyspaces.size() && !stopped; ++part) {
+        const Keyspace& keyspace = keyspaces[part];
+        const uint64_t base = part == resumeAt.part ? std::min(resumeAt.offset, keyspace.size()) : 0;
+        if (ledger.done() || keyspace.size() == base) {
+            continue;
+        }
+        // Several chunks per thread so a slow one does not hold up the end
+        const uint64_t remaining = keyspace.size() - base;
+        const uint64_t chunk = std::clamp(remaining / (threads * 4), MIN_CHUNK, MAX_CHUNK);
+        const uint64_t chunks = (remaining - 1) / chunk + 1;
+        auto position = [&](size_t first) {
+            return CrackPosition{part, base + std::min<uint64_t>(first * chunk, remaining)};
+        };
+        checkpoints.begin(static_cast<size_t>(chunks));
+
+        auto search = [&](size_t index) {
+            AdoptedJob scope(job);
+            if (ledger.done() || checkpoints.stopping()) {
+                return;
+            }
+            ThreadPool::cancellationPoint();
+
+            const uint64_t first = base + index * chunk;
+            const uint64_t count = std::min(chunk, keyspace.size() - first);
+            CandidateBatcher batcher(targets, chosen, ledger);
+            char candidate[Keyspace::MAX_LENGTH];
+            size_t digits[Keyspace::MAX_LENGTH];
+            keyspace.decode(first, candidate, digits);
+            const std::string_view view(candidate, keyspace.length());
+
+            uint64_t done = 0;
+            bool finished = false;
+            while (done < count && !finished) {
+                const uint64_t end = std::min(count, done + CHECK_INTERVAL);
+                const uint64_t from = done;
+                for (; done < end; ++done) {
+                    if (batcher.add(view)) {
+                        finished = true;
+                        break;
+                    }
+                    keyspace.next(candidate, digits);
+                }
+                covered.fetch_add(done - from, std::memory_order_relaxed);
+                if (!finished && (ledger.done() || checkpoints.stopping())) {
+                    break;
+                }
+                ThreadPool::cancellationPoint();
+                if (std::this_thread::get_id() == caller) {
+                    const uint64_t attempts = hashed.load(std::memory_order_relaxed) + batcher.hashed();
+                    if (progress) {
+                        progress(attempts, (skipped + static_cast<double>(covered.load(std::memory_order_relaxed))) /
+                                           total);
+                    }
+                    checkpoints.save(attempts, position);
+                }
+            }
+            if (!finished && done == count) {
+                batcher.flush();
+                checkpoints.finish(index);
+            }
+            hashed.fetch_add(batcher.hashed(), std::memory_order_relaxed);
+        };
+
+        if (pool && chunks > 1) {
+            pool->parallelFor(static_cast<size_t>(chunks), search);
+        } else {
+            for (uint64_t index = 0; index < chunks && !ledger.done() && !checkpoints.stopping(); ++index) {
+                search(static_cast<size_t>(index));
+            }
+        }
+        stopped = checkpoints.stopping() && !ledger.done();
+        if (stopped) {
+            checkpoints.save(hashed.load(), position, true);
+        }
+    }
+
+    ledger.report(result);
+    result.attempts = hashed.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    checkpoints.report(result, stopped);
+    return result;
+}
+
+inline CrackResult crackKeyspaces(const CrackTarget& target, const std::vector<Keyspace>& keyspaces,
+                                  const CrackProgress& progress = nullptr, const HashKernel* kernel = nullptr,
+                                  ThreadPool* pool = nullptr) {
+    return crackKeyspaces(target.toSet(), keyspaces, progress, kernel, pool);
+}
+
+// Every string over the charset from minLength to maxLength characters,
+// shortest first. Empty if a length's keyspace does not fit 64 bits.
+inline std::vector<Keyspace> bruteForceKeyspaces(std::string_view charset, size_t minLength, size_t maxLength) {
+    std::vector<Keyspace> keyspaces;
+    for (size_t length = minLength; length <= maxLength; ++length) {
+        Keyspace keyspace;
+        if (!Keyspace::uniform(charset, length, keyspace)) {
+            return {};
+        }
+        keyspaces.push_back(std::move(keyspace));
+    }
+    return keyspaces;
+}
+
+// What each thread of one benchmark run hashed
+struct KernelBenchmark {
+    std::vector<uint64_t> hashed;   // per thread
+    double seconds = 0.0;
+
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (uint64_t count : hashed) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    double hashesPerSecond() const { return seconds > 0.0 ? static_cast<double>(total()) / seconds : 0.0; }
+
+    // Standard deviation of the per-thread counts over their mean: 0 when
+    // every thread did the same work
+    double spread() const {
+        if (hashed.empty() || total() == 0) {
+            return 0.0;
+        }
+        double mean = static_cast<double>(total()) / hashed.size();
+        double squares = 0.0;
+        for (uint64_t count : hashed) {
+            squares += (count - mean) * (count - mean);
+        }
+        return std::sqrt(squares / hashed.size()) / mean;
+    }
+};
+
+// Runs the attack's inner loop on `threads` threads of its own for about
+// `seconds`: 8-character candidates from a keyspace go through the batcher,
+// the kernel and the digest lookup exactly as in crackKeyspaces(), against a
+// target that never matches. The threads are released together and stopped
+// by one flag, so their counts cover the same interval and can be compared.
+inline KernelBenchmark benchmarkKernel(const HashKernel& kernel, size_t threads, double seconds) {
+    static constexpr uint64_t CHECK_INTERVAL = 1 << 12;
+    threads = std::max<size_t>(threads, 1);
+    DigestSet targets(kernel.algorithm);
+    std::array<uint8_t, MAX_DIGEST_SIZE> unreachable;
+    unreachable.fill(0xff);
+    targets.add(unreachable.data());
+    CrackLedger ledger(targets.size());
+    Keyspace keyspace;
+    Keyspace::uniform("abcdefghijklmnopqrstuvwxyz0123456789", 8, keyspace);
+
+    KernelBenchmark result;
+    result.hashed.assign(threads, 0);
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<bool> stop(false);
+    auto run = [&](size_t thread) {
+        CandidateBatcher batcher(targets, kernel, ledger);
+        char candidate[Keyspace::MAX_LENGTH];
+        size_t digits[Keyspace::MAX_LENGTH];
+        keyspace.decode(keyspace.size() / threads * thread, candidate, digits);
+        const std::string_view view(candidate, keyspace.length());
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (uint64_t i = 0; i < CHECK_INTERVAL; ++i) {
+                batcher.add(view);
+                keyspace.next(candidate, digits);
+            }
+        }
+        result.hashed[thread] = batcher.hashed();
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t thread = 0; thread < threads; ++thread) {
+        workers.emplace_back(run, thread);
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace Oroto
+
+#endif // OROTO_HASH_CRACKER_H
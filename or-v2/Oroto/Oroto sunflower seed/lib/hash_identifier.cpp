@@ -0,0 +1,61 @@
+#include "hash_identifier.h"
+#include <iterator>
+
+namespace Oroto {
+
+namespace {
+
+using namespace HashChars;
+
+constexpr HashAlgorithm NONE = HashAlgorithm::MD5;   // ignored when not crackable
+
+// Formats of one shape are listed most likely first: a 32-digit hex string
+// is far more often MD5 than NTLM, MD4 or LM
+const HashSignature BUILTIN_SIGNATURES[] = {
+    {"md5crypt", 500, "$1$", 26, 34, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"Apache APR1", 1600, "$apr1$", 29, 37, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"bcrypt", 3200, "$2a$", 60, 60, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"bcrypt", 3200, "$2b$", 60, 60, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"bcrypt", 3200, "$2x$", 60, 60, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"bcrypt", 3200, "$2y$", 60, 60, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"sha256crypt", 7400, "$5$", 47, 80, CRYPT64 | DOLLAR | PLUS_EQUALS, HashStrength::SLOW, false, NONE},
+    {"sha512crypt", 1800, "$6$", 90, 123, CRYPT64 | DOLLAR | PLUS_EQUALS, HashStrength::SLOW, false, NONE},
+    {"yescrypt", -1, "$y$", 40, 160, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"Argon2id", 34000, "$argon2id$", 40, 256, BASE64 | DOLLAR | PUNCT, HashStrength::SLOW, false, NONE},
+    {"Argon2i", 34000, "$argon2i$", 40, 256, BASE64 | DOLLAR | PUNCT, HashStrength::SLOW, false, NONE},
+    {"Argon2d", 34000, "$argon2d$", 40, 256, BASE64 | DOLLAR | PUNCT, HashStrength::SLOW, false, NONE},
+    {"phpass", 400, "$P$", 34, 34, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"phpass", 400, "$H$", 34, 34, CRYPT64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"Django PBKDF2-SHA256", 10000, "pbkdf2_sha256$", 60, 128, BASE64 | DOLLAR, HashStrength::SLOW, false, NONE},
+    {"MySQL 4.1+", 300, "*", 41, 41, HEX, HashStrength::BROKEN, false, NONE},
+    {"LDAP SHA-1", 101, "{SHA}", 33, 33, BASE64, HashStrength::BROKEN, false, NONE},
+    {"LDAP salted SHA-1", 111, "{SSHA}", 34, 80, BASE64, HashStrength::BROKEN, false, NONE},
+
+    {"CRC32", 11500, "", 8, 8, HEX, HashStrength::CHECKSUM, false, NONE},
+    {"DES crypt", 1500, "", 13, 13, CRYPT64, HashStrength::BROKEN, false, NONE},
+    {"MySQL323", 200, "", 16, 16, HEX, HashStrength::BROKEN, false, NONE},
+    {"MD5", 0, "", 32, 32, HEX, HashStrength::BROKEN, true, HashAlgorithm::MD5},
+    {"NTLM", 1000, "", 32, 32, HEX, HashStrength::BROKEN, false, NONE},
+    {"MD4", 900, "", 32, 32, HEX, HashStrength::BROKEN, false, NONE},
+    {"LM", 3000, "", 32, 32, HEX, HashStrength::BROKEN, false, NONE},
+    {"SHA-1", 100, "", 40, 40, HEX, HashStrength::BROKEN, true, HashAlgorithm::SHA1},
+    {"RIPEMD-160", 6000, "", 40, 40, HEX, HashStrength::FAST, false, NONE},
+    {"SHA-224", 1300, "", 56, 56, HEX, HashStrength::FAST, false, NONE},
+    {"SHA3-224", 17300, "", 56, 56, HEX, HashStrength::FAST, false, NONE},
+    {"SHA-256", 1400, "", 64, 64, HEX, HashStrength::FAST, true, HashAlgorithm::SHA256},
+    {"SHA3-256", 17400, "", 64, 64, HEX, HashStrength::FAST, false, NONE},
+    {"SHA-384", 10800, "", 96, 96, HEX, HashStrength::FAST, false, NONE},
+    {"SHA3-384", 17500, "", 96, 96, HEX, HashStrength::FAST, false, NONE},
+    {"SHA-512", 1700, "", 128, 128, HEX, HashStrength::FAST, false, NONE},
+    {"SHA3-512", 17600, "", 128, 128, HEX, HashStrength::FAST, false, NONE},
+    {"Whirlpool", 6100, "", 128, 128, HEX, HashStrength::FAST, false, NONE},
+};
+
+} // namespace
+
+const HashIdentifier& hashIdentifier() {
+    static const HashIdentifier identifier(BUILTIN_SIGNATURES, std::size(BUILTIN_SIGNATURES));
+    return identifier;
+}
+
+} // namespace Oroto
@@ -0,0 +1,230 @@
+#ifndef OROTO_HASH_IDENTIFIER_H
+#define OROTO_HASH_IDENTIFIER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "hash_kernels.h"
+#include "mapped_wordlist.h"
+#include "thread_pool.h"
+
+namespace Oroto {
+
+// Character classes a signature may allow; every byte falls in exactly one
+namespace HashChars {
+constexpr uint16_t DIGIT = 1 << 0;
+constexpr uint16_t HEX_LOWER = 1 << 1;      // a-f
+constexpr uint16_t HEX_UPPER = 1 << 2;      // A-F
+constexpr uint16_t ALPHA_LOWER = 1 << 3;    // g-z
+constexpr uint16_t ALPHA_UPPER = 1 << 4;    // G-Z
+constexpr uint16_t DOT_SLASH = 1 << 5;
+constexpr uint16_t PLUS_EQUALS = 1 << 6;
+constexpr uint16_t DOLLAR = 1 << 7;
+constexpr uint16_t PUNCT = 1 << 8;          // other printable ASCII
+constexpr uint16_t OTHER = 1 << 9;          // space, control and non-ASCII bytes
+
+constexpr uint16_t HEX = DIGIT | HEX_LOWER | HEX_UPPER;
+constexpr uint16_t ALNUM = HEX | ALPHA_LOWER | ALPHA_UPPER;
+constexpr uint16_t CRYPT64 = ALNUM | DOT_SLASH;            // the crypt(3) alphabet
+constexpr uint16_t BASE64 = ALNUM | DOT_SLASH | PLUS_EQUALS;
+} // namespace HashChars
+
+enum class HashStrength : uint8_t {
+    CHECKSUM,   // not meant for passwords at all
+    BROKEN,     // fast and cryptographically broken
+    FAST,       // sound digest, but unsalted and cheap to brute force
+    SLOW,       // salted, iterated password hash
+};
+
+// One hash format. A string matches when it starts with the prefix, its
+// whole length is in range and every byte is in charset (or in the prefix).
+struct HashSignature {
+    const char* name;
+    int hashcatMode;          // -1 if hashcat has none
+    const char* prefix;       // "" for bare digests
+    uint16_t minLength;
+    uint16_t maxLength;
+    uint16_t charset;         // HashChars classes allowed after the prefix
+    HashStrength strength;
+    bool crackable;           // a cracking kernel exists for it
+    HashAlgorithm algorithm;  // that kernel's algorithm, when crackable
+};
+
+// Names the format of a hash string from a table of signatures. The table is
+// compiled once: bare digests are bucketed by length, prefixed formats are
+// only tried when the first byte starts one of their prefixes, and each
+// signature's allowed classes (its charset plus whatever its prefix uses)
+// become one mask. Identifying a string is then a single pass that ORs a
+// class lookup per byte, followed by mask tests against the few signatures
+// of its length or prefix. Matches come in table order, so the table lists
+// the most likely format for a shape first.
+class HashIdentifier {
+private:
+    std::vector<HashSignature> signatures_;
+    std::vector<uint16_t> allowed_;                 // per signature
+    std::vector<std::vector<uint16_t>> bare_;       // by length: bare signature indices
+    std::vector<uint16_t> prefixed_;
+    std::array<bool, 256> prefixStarts_{};
+    std::array<uint16_t, 256> classes_{};
+
+    static uint16_t classify(unsigned char c) {
+        using namespace HashChars;
+        if (c >= '0' && c <= '9') return DIGIT;
+        if (c >= 'a' && c <= 'f') return HEX_LOWER;
+        if (c >= 'A' && c <= 'F') return HEX_UPPER;
+        if (c >= 'g' && c <= 'z') return ALPHA_LOWER;
+        if (c >= 'G' && c <= 'Z') return ALPHA_UPPER;
+        if (c == '.' || c == '/') return DOT_SLASH;
+        if (c == '+' || c == '=') return PLUS_EQUALS;
+        if (c == '$') return DOLLAR;
+        if (c > ' ' && c < 0x7f) return PUNCT;
+        return OTHER;
+    }
+
+    bool matches(size_t index, std::string_view hash, uint16_t mask) const {
+        const HashSignature& signature = signatures_[index];
+        return hash.size() >= signature.minLength && hash.size() <= signature.maxLength &&
+               (mask & ~allowed_[index]) == 0;
+    }
+
+public:
+    HashIdentifier(const HashSignature* signatures, size_t count) : signatures_(signatures, signatures + count) {
+        for (size_t c = 0; c < classes_.size(); ++c) {
+            classes_[c] = classify(static_cast<unsigned char>(c));
+        }
+        for (size_t i = 0; i < signatures_.size(); ++i) {
+            const HashSignature& signature = signatures_[i];
+            uint16_t allowed = signature.charset;
+            for (const char* p = signature.prefix; *p; ++p) {
+                allowed |= classes_[static_cast<unsigned char>(*p)];
+            }
+            allowed_.push_back(allowed);
+            if (*signature.prefix) {
+                prefixed_.push_back(static_cast<uint16_t>(i));
+                prefixStarts_[static_cast<unsigned char>(signature.prefix[0])] = true;
+            } else {
+                if (bare_.size() <= signature.maxLength) {
+                    bare_.resize(signature.maxLength + 1);
+                }
+                for (size_t length = signature.minLength; length <= signature.maxLength; ++length) {
+                    bare_[length].push_back(static_cast<uint16_t>(i));
+                }
+            }
+        }
+    }
+
+    const std::vector<HashSignature>& signatures() const { return signatures_; }
+
+    // Calls fn(index) for each signature the string matches, most likely
+    // first, until fn returns true
+    template <typename Fn>
+    void forEachMatch(std::string_view hash, Fn&& fn) const {
+        if (hash.empty()) {
+            return;
+        }
+        uint16_t mask = 0;
+        for (unsigned char c : hash) {
+            mask |= classes_[c];
+        }
+        if (prefixStarts_[static_cast<unsigned char>(hash[0])]) {
+            for (uint16_t index : prefixed_) {
+                const char* prefix = signatures_[index].prefix;
+                size_t length = std::strlen(prefix);
+                if (hash.compare(0, length, prefix) == 0 && matches(index, hash, mask) && fn(index)) {
+                    return;
+                }
+            }
+        }
+        if (hash.size() < bare_.size()) {
+            for (uint16_t index : bare_[hash.size()]) {
+                if (matches(index, hash, mask) && fn(index)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // Every format the string could be, most likely first
+    std::vector<const HashSignature*> identify(std::string_view hash) const {
+        std::vector<const HashSignature*> found;
+        forEachMatch(hash, [&](size_t index) {
+            found.push_back(&signatures_[index]);
+            return false;
+        });
+        return found;
+    }
+
+    // The most likely format, or null
+    const HashSignature* best(std::string_view hash) const {
+        const HashSignature* found = nullptr;
+        forEachMatch(hash, [&](size_t index) {
+            found = &signatures_[index];
+            return true;
+        });
+        return found;
+    }
+
+    // The most likely format a cracking kernel exists for, or null
+    const HashSignature* crackable(std::string_view hash) const {
+        const HashSignature* found = nullptr;
+        forEachMatch(hash, [&](size_t index) {
+            found = signatures_[index].crackable ? &signatures_[index] : nullptr;
+            return found != nullptr;
+        });
+        return found;
+    }
+
+    // Counts each line of text under its most likely format; lines matching
+    // none are counted at index signatures().size(). Surrounding blanks are
+    // ignored, and blank lines and '#' comments are not counted. Text is cut
+    // into newline-aligned chunks for the pool, so a mapped file is
+    // classified as fast as it can be paged in.
+    std::vector<uint64_t> census(std::string_view text, ThreadPool* pool = nullptr) const {
+        static constexpr size_t CHUNK = 4 << 20;
+        std::vector<uint64_t> total(signatures_.size() + 1, 0);
+        std::mutex mutex;
+        const size_t chunks = text.empty() ? 0 : (text.size() - 1) / CHUNK + 1;
+        auto count = [&](size_t chunk) {
+            std::vector<uint64_t> counts(total.size(), 0);
+            std::string_view range = wordlistChunk(text, chunk, CHUNK);
+            forEachLine(range.data(), range.data() + range.size(), [&](std::string_view line) {
+                size_t first = line.find_first_not_of(" \t");
+                if (first == std::string_view::npos || line[first] == '#') {
+                    return false;
+                }
+                line = line.substr(first, line.find_last_not_of(" \t") - first + 1);
+                size_t type = signatures_.size();
+                forEachMatch(line, [&](size_t index) {
+                    type = index;
+                    return true;
+                });
+                ++counts[type];
+                return false;
+            });
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < total.size(); ++i) {
+                total[i] += counts[i];
+            }
+        };
+        if (pool && chunks > 1) {
+            pool->parallelFor(chunks, count);
+        } else {
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                count(chunk);
+            }
+        }
+        return total;
+    }
+};
+
+// The identifier over the built-in signature table
+const HashIdentifier& hashIdentifier();
+
+} // namespace Oroto
+
+#endif // OROTO_HASH_IDENTIFIER_H
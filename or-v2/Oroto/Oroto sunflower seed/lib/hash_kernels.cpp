@@ -0,0 +1,98 @@
+#include "hash_kernels.h"
+#include <cstdlib>
+#include <string_view>
+
+namespace Oroto {
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OROTO_X86_KERNELS 1
+// Defined in hash_kernels_sse2.cpp, hash_kernels_avx2.cpp and hash_kernels_avx512.cpp
+void md5Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha1Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha256Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void md5Avx2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha1Avx2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha256Avx2(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void md5Avx512(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha1Avx512(const uint8_t* const* messages, size_t length, uint8_t* digests);
+void sha256Avx512(const uint8_t* const* messages, size_t length, uint8_t* digests);
+#endif
+
+namespace {
+
+void md5Scalar(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    hashOne(HashAlgorithm::MD5, std::string_view(reinterpret_cast<const char*>(messages[0]), length), digests);
+}
+
+void sha1Scalar(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    hashOne(HashAlgorithm::SHA1, std::string_view(reinterpret_cast<const char*>(messages[0]), length), digests);
+}
+
+void sha256Scalar(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    hashOne(HashAlgorithm::SHA256, std::string_view(reinterpret_cast<const char*>(messages[0]), length), digests);
+}
+
+enum class Isa : uint8_t { SCALAR, SSE2, AVX2, AVX512 };
+
+struct KernelEntry {
+    Isa isa;
+    HashKernel kernel;
+};
+
+// Narrowest first within each algorithm
+const KernelEntry KERNELS[] = {
+    {Isa::SCALAR, {"scalar", HashAlgorithm::MD5, 1, md5Scalar}},
+    {Isa::SCALAR, {"scalar", HashAlgorithm::SHA1, 1, sha1Scalar}},
+    {Isa::SCALAR, {"scalar", HashAlgorithm::SHA256, 1, sha256Scalar}},
+#ifdef OROTO_X86_KERNELS
+    {Isa::SSE2, {"sse2", HashAlgorithm::MD5, 4, md5Sse2}},
+    {Isa::SSE2, {"sse2", HashAlgorithm::SHA1, 4, sha1Sse2}},
+    {Isa::SSE2, {"sse2", HashAlgorithm::SHA256, 4, sha256Sse2}},
+    {Isa::AVX2, {"avx2", HashAlgorithm::MD5, 8, md5Avx2}},
+    {Isa::AVX2, {"avx2", HashAlgorithm::SHA1, 8, sha1Avx2}},
+    {Isa::AVX2, {"avx2", HashAlgorithm::SHA256, 8, sha256Avx2}},
+    {Isa::AVX512, {"avx512", HashAlgorithm::MD5, 16, md5Avx512}},
+    {Isa::AVX512, {"avx512", HashAlgorithm::SHA1, 16, sha1Avx512}},
+    {Isa::AVX512, {"avx512", HashAlgorithm::SHA256, 16, sha256Avx512}},
+#endif
+};
+
+bool cpuSupports(Isa isa) {
+#ifdef OROTO_X86_KERNELS
+    switch (isa) {
+        case Isa::SCALAR: return true;
+        case Isa::SSE2: return __builtin_cpu_supports("sse2");
+        case Isa::AVX2: return __builtin_cpu_supports("avx2");
+        case Isa::AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return isa == Isa::SCALAR;
+#endif
+}
+
+} // namespace
+
+std::vector<const HashKernel*> hashKernels(HashAlgorithm algorithm) {
+    std::vector<const HashKernel*> kernels;
+    for (const auto& entry : KERNELS) {
+        if (entry.kernel.algorithm == algorithm && cpuSupports(entry.isa)) {
+            kernels.push_back(&entry.kernel);
+        }
+    }
+    return kernels;
+}
+
+const HashKernel& bestHashKernel(HashAlgorithm algorithm) {
+    std::vector<const HashKernel*> kernels = hashKernels(algorithm);
+    if (const char* wanted = std::getenv("OROTO_HASH_KERNEL")) {
+        for (const HashKernel* kernel : kernels) {
+            if (std::string_view(kernel->name) == wanted) {
+                return *kernel;
+            }
+        }
+    }
+    return *kernels.back();
+}
+
+} // namespace Oroto
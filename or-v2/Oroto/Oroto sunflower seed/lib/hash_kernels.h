@@ -0,0 +1,84 @@
+#ifndef OROTO_HASH_KERNELS_H
+#define OROTO_HASH_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "md5.h"
+#include "sha.h"
+
+namespace Oroto {
+
+enum class HashAlgorithm : uint8_t {
+    MD5,
+    SHA1,
+    SHA256,
+};
+
+inline const char* hashAlgorithmName(HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::MD5: return "MD5";
+        case HashAlgorithm::SHA1: return "SHA-1";
+        case HashAlgorithm::SHA256: return "SHA-256";
+    }
+    return "unknown";
+}
+
+inline size_t digestSize(HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::MD5: return 16;
+        case HashAlgorithm::SHA1: return 20;
+        case HashAlgorithm::SHA256: return 32;
+    }
+    return 0;
+}
+
+constexpr size_t MAX_DIGEST_SIZE = 32;
+constexpr size_t MAX_KERNEL_LANES = 16;
+// Longest message that still fits one padded 64-byte block
+constexpr size_t MAX_BLOCK_MESSAGE = 55;
+
+// Hashes `lanes` messages of the same length (at most MAX_BLOCK_MESSAGE) in
+// one call. Digest i is written to digests + i * digestSize(algorithm).
+using HashKernelFn = void (*)(const uint8_t* const* messages, size_t length, uint8_t* digests);
+
+struct HashKernel {
+    const char* name;          // "scalar", "sse2", "avx2" or "avx512"
+    HashAlgorithm algorithm;
+    size_t lanes;
+    HashKernelFn run;
+};
+
+// Kernels this CPU can run for the algorithm, scalar first and widest last
+std::vector<const HashKernel*> hashKernels(HashAlgorithm algorithm);
+
+// The widest supported kernel. OROTO_HASH_KERNEL=scalar|sse2|avx2|avx512
+// picks a narrower one instead (for comparisons, or to rule out a CPU issue).
+const HashKernel& bestHashKernel(HashAlgorithm algorithm);
+
+// One message of any length through the scalar code
+inline void hashOne(HashAlgorithm algorithm, std::string_view text, uint8_t* digest) {
+    switch (algorithm) {
+        case HashAlgorithm::MD5: {
+            Md5Digest d = Md5::digest(text);
+            std::memcpy(digest, d.data(), d.size());
+            break;
+        }
+        case HashAlgorithm::SHA1: {
+            Sha1Digest d = Sha1::digest(text);
+            std::memcpy(digest, d.data(), d.size());
+            break;
+        }
+        case HashAlgorithm::SHA256: {
+            Sha256Digest d = Sha256::digest(text);
+            std::memcpy(digest, d.data(), d.size());
+            break;
+        }
+    }
+}
+
+} // namespace Oroto
+
+#endif // OROTO_HASH_KERNELS_H
@@ -0,0 +1,280 @@
+#ifndef OROTO_HASH_KERNELS_SIMD_H
+#define OROTO_HASH_KERNELS_SIMD_H
+
+// Multi-buffer MD5, SHA-1 and SHA-256: lane i of every vector belongs to
+// message i, so one pass of the rounds hashes Ops::LANES candidates. Only the
+// hash_kernels_<isa>.cpp files include this, each after switching the
+// compiler to its instruction set and defining an Ops struct in an anonymous
+// namespace:
+//
+//   V, LANES, load, store, set1, add, xor_, and_, or_, rotl<N>, shr<N>
+//
+// Everything here is a template over Ops, so each file gets its own
+// internal-linkage copy and no AVX code can leak into another file's inline
+// functions.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "sha.h"
+
+namespace Oroto {
+namespace simd {
+
+// Pads each message into its single block and transposes the blocks so
+// words[i] holds word i of every lane. MD5 reads words little-endian and
+// stores the bit length little-endian; SHA does both big-endian. Words past
+// the message and its 0x80 are zero in every lane and are filled once. The
+// ISA files only build on x86, so a plain load is a little-endian load.
+template <class Ops, bool BigEndian>
+inline void loadBlocks(const uint8_t* const* messages, size_t length, uint32_t (*words)[Ops::LANES]) {
+    const size_t used = length / 4 + 1;
+    std::memset(words[used], 0, (16 - used) * sizeof(words[0]));
+    for (size_t lane = 0; lane < Ops::LANES; ++lane) {
+        uint8_t block[64] = {};
+        std::memcpy(block, messages[lane], length);
+        block[length] = 0x80;
+        for (size_t i = 0; i < used; ++i) {
+            uint32_t word;
+            std::memcpy(&word, block + 4 * i, 4);
+            words[i][lane] = BigEndian ? __builtin_bswap32(word) : word;
+        }
+    }
+    const uint32_t bits = static_cast<uint32_t>(length * 8);
+    for (size_t lane = 0; lane < Ops::LANES; ++lane) {
+        words[BigEndian ? 15 : 14][lane] = bits;
+    }
+}
+
+// Writes word k of lane i into digest i, in the algorithm's byte order
+template <class Ops, bool BigEndian, size_t WORDS>
+inline void storeDigests(const typename Ops::V (&state)[WORDS], uint8_t* digests) {
+    alignas(64) uint32_t out[WORDS][Ops::LANES];
+    for (size_t k = 0; k < WORDS; ++k) {
+        Ops::store(out[k], state[k]);
+    }
+    for (size_t lane = 0; lane < Ops::LANES; ++lane) {
+        uint8_t* digest = digests + lane * 4 * WORDS;
+        for (size_t k = 0; k < WORDS; ++k) {
+            uint32_t word = BigEndian ? __builtin_bswap32(out[k][lane]) : out[k][lane];
+            std::memcpy(digest + 4 * k, &word, 4);
+        }
+    }
+}
+
+template <class Ops, int S>
+inline void md5Step(typename Ops::V& a, typename Ops::V b, typename Ops::V f, typename Ops::V x, uint32_t t) {
+    a = Ops::add(a, Ops::add(f, Ops::add(x, Ops::set1(t))));
+    a = Ops::add(Ops::template rotl<S>(a), b);
+}
+
+template <class Ops>
+void md5Lanes(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    using V = typename Ops::V;
+    alignas(64) uint32_t words[16][Ops::LANES];
+    loadBlocks<Ops, false>(messages, length, words);
+    V x[16];
+    for (int i = 0; i < 16; ++i) {
+        x[i] = Ops::load(words[i]);
+    }
+    const V ones = Ops::set1(0xffffffff);
+    V a = Ops::set1(0x67452301), b = Ops::set1(0xefcdab89), c = Ops::set1(0x98badcfe), d = Ops::set1(0x10325476);
+
+#define OROTO_SIMD_F(b, c, d) Ops::xor_(d, Ops::and_(b, Ops::xor_(c, d)))
+#define OROTO_SIMD_G(b, c, d) Ops::xor_(c, Ops::and_(d, Ops::xor_(b, c)))
+#define OROTO_SIMD_H(b, c, d) Ops::xor_(b, Ops::xor_(c, d))
+#define OROTO_SIMD_I(b, c, d) Ops::xor_(c, Ops::or_(b, Ops::xor_(d, ones)))
+#define OROTO_SIMD_STEP(f, a, b, c, d, k, s, t) md5Step<Ops, s>(a, b, f(b, c, d), x[k], t);
+
+    OROTO_SIMD_STEP(OROTO_SIMD_F, a, b, c, d,  0,  7, 0xd76aa478)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, d, a, b, c,  1, 12, 0xe8c7b756)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, c, d, a, b,  2, 17, 0x242070db)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, b, c, d, a,  3, 22, 0xc1bdceee)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, a, b, c, d,  4,  7, 0xf57c0faf)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, d, a, b, c,  5, 12, 0x4787c62a)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, c, d, a, b,  6, 17, 0xa8304613)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, b, c, d, a,  7, 22, 0xfd469501)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, a, b, c, d,  8,  7, 0x698098d8)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, d, a, b, c,  9, 12, 0x8b44f7af)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, c, d, a, b, 10, 17, 0xffff5bb1)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, b, c, d, a, 11, 22, 0x895cd7be)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, a, b, c, d, 12,  7, 0x6b901122)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, d, a, b, c, 13, 12, 0xfd987193)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, c, d, a, b, 14, 17, 0xa679438e)
+    OROTO_SIMD_STEP(OROTO_SIMD_F, b, c, d, a, 15, 22, 0x49b40821)
+
+    OROTO_SIMD_STEP(OROTO_SIMD_G, a, b, c, d,  1,  5, 0xf61e2562)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, d, a, b, c,  6,  9, 0xc040b340)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, c, d, a, b, 11, 14, 0x265e5a51)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, b, c, d, a,  0, 20, 0xe9b6c7aa)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, a, b, c, d,  5,  5, 0xd62f105d)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, d, a, b, c, 10,  9, 0x02441453)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, c, d, a, b, 15, 14, 0xd8a1e681)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, b, c, d, a,  4, 20, 0xe7d3fbc8)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, a, b, c, d,  9,  5, 0x21e1cde6)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, d, a, b, c, 14,  9, 0xc33707d6)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, c, d, a, b,  3, 14, 0xf4d50d87)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, b, c, d, a,  8, 20, 0x455a14ed)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, a, b, c, d, 13,  5, 0xa9e3e905)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, d, a, b, c,  2,  9, 0xfcefa3f8)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, c, d, a, b,  7, 14, 0x676f02d9)
+    OROTO_SIMD_STEP(OROTO_SIMD_G, b, c, d, a, 12, 20, 0x8d2a4c8a)
+
+    OROTO_SIMD_STEP(OROTO_SIMD_H, a, b, c, d,  5,  4, 0xfffa3942)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, d, a, b, c,  8, 11, 0x8771f681)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, c, d, a, b, 11, 16, 0x6d9d6122)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, b, c, d, a, 14, 23, 0xfde5380c)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, a, b, c, d,  1,  4, 0xa4beea44)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, d, a, b, c,  4, 11, 0x4bdecfa9)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, c, d, a, b,  7, 16, 0xf6bb4b60)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, b, c, d, a, 10, 23, 0xbebfbc70)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, a, b, c, d, 13,  4, 0x289b7ec6)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, d, a, b, c,  0, 11, 0xeaa127fa)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, c, d, a, b,  3, 16, 0xd4ef3085)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, b, c, d, a,  6, 23, 0x04881d05)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, a, b, c, d,  9,  4, 0xd9d4d039)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, d, a, b, c, 12, 11, 0xe6db99e5)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, c, d, a, b, 15, 16, 0x1fa27cf8)
+    OROTO_SIMD_STEP(OROTO_SIMD_H, b, c, d, a,  2, 23, 0xc4ac5665)
+
+    OROTO_SIMD_STEP(OROTO_SIMD_I, a, b, c, d,  0,  6, 0xf4292244)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, d, a, b, c,  7, 10, 0x432aff97)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, c, d, a, b, 14, 15, 0xab9423a7)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, b, c, d, a,  5, 21, 0xfc93a039)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, a, b, c, d, 12,  6, 0x655b59c3)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, d, a, b, c,  3, 10, 0x8f0ccc92)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, c, d, a, b, 10, 15, 0xffeff47d)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, b, c, d, a,  1, 21, 0x85845dd1)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, a, b, c, d,  8,  6, 0x6fa87e4f)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, d, a, b, c, 15, 10, 0xfe2ce6e0)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, c, d, a, b,  6, 15, 0xa3014314)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, b, c, d, a, 13, 21, 0x4e0811a1)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, a, b, c, d,  4,  6, 0xf7537e82)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, d, a, b, c, 11, 10, 0xbd3af235)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, c, d, a, b,  2, 15, 0x2ad7d2bb)
+    OROTO_SIMD_STEP(OROTO_SIMD_I, b, c, d, a,  9, 21, 0xeb86d391)
+
+#undef OROTO_SIMD_STEP
+#undef OROTO_SIMD_F
+#undef OROTO_SIMD_G
+#undef OROTO_SIMD_H
+#undef OROTO_SIMD_I
+
+    const V state[4] = {
+        Ops::add(a, Ops::set1(0x67452301)),
+        Ops::add(b, Ops::set1(0xefcdab89)),
+        Ops::add(c, Ops::set1(0x98badcfe)),
+        Ops::add(d, Ops::set1(0x10325476)),
+    };
+    storeDigests<Ops, false>(state, digests);
+}
+
+template <class Ops>
+void sha1Lanes(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    using V = typename Ops::V;
+    alignas(64) uint32_t words[16][Ops::LANES];
+    loadBlocks<Ops, true>(messages, length, words);
+    // Rolling 16-word window of the schedule
+    V w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Ops::load(words[i]);
+    }
+    V a = Ops::set1(0x67452301), b = Ops::set1(0xefcdab89), c = Ops::set1(0x98badcfe);
+    V d = Ops::set1(0x10325476), e = Ops::set1(0xc3d2e1f0);
+
+    for (int i = 0; i < 80; ++i) {
+        if (i >= 16) {
+            w[i & 15] = Ops::template rotl<1>(Ops::xor_(Ops::xor_(w[(i - 3) & 15], w[(i - 8) & 15]),
+                                                        Ops::xor_(w[(i - 14) & 15], w[i & 15])));
+        }
+        V f;
+        uint32_t k;
+        if (i < 20) {
+            f = Ops::xor_(d, Ops::and_(b, Ops::xor_(c, d)));
+            k = 0x5a827999;
+        } else if (i < 40) {
+            f = Ops::xor_(b, Ops::xor_(c, d));
+            k = 0x6ed9eba1;
+        } else if (i < 60) {
+            f = Ops::or_(Ops::and_(b, c), Ops::and_(d, Ops::or_(b, c)));
+            k = 0x8f1bbcdc;
+        } else {
+            f = Ops::xor_(b, Ops::xor_(c, d));
+            k = 0xca62c1d6;
+        }
+        V temp = Ops::add(Ops::add(Ops::template rotl<5>(a), f), Ops::add(Ops::add(e, Ops::set1(k)), w[i & 15]));
+        e = d;
+        d = c;
+        c = Ops::template rotl<30>(b);
+        b = a;
+        a = temp;
+    }
+
+    const V state[5] = {
+        Ops::add(a, Ops::set1(0x67452301)),
+        Ops::add(b, Ops::set1(0xefcdab89)),
+        Ops::add(c, Ops::set1(0x98badcfe)),
+        Ops::add(d, Ops::set1(0x10325476)),
+        Ops::add(e, Ops::set1(0xc3d2e1f0)),
+    };
+    storeDigests<Ops, true>(state, digests);
+}
+
+template <class Ops, int N>
+inline typename Ops::V rotr(typename Ops::V x) {
+    return Ops::template rotl<32 - N>(x);
+}
+
+template <class Ops>
+void sha256Lanes(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    using V = typename Ops::V;
+    static constexpr uint32_t INITIAL[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    alignas(64) uint32_t words[16][Ops::LANES];
+    loadBlocks<Ops, true>(messages, length, words);
+    V w[16];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Ops::load(words[i]);
+    }
+    V s[8];
+    for (int i = 0; i < 8; ++i) {
+        s[i] = Ops::set1(INITIAL[i]);
+    }
+    V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+    for (int i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            V w15 = w[(i - 15) & 15];
+            V w2 = w[(i - 2) & 15];
+            V s0 = Ops::xor_(Ops::xor_(rotr<Ops, 7>(w15), rotr<Ops, 18>(w15)), Ops::template shr<3>(w15));
+            V s1 = Ops::xor_(Ops::xor_(rotr<Ops, 17>(w2), rotr<Ops, 19>(w2)), Ops::template shr<10>(w2));
+            w[i & 15] = Ops::add(Ops::add(w[i & 15], s0), Ops::add(w[(i - 7) & 15], s1));
+        }
+        V sum1 = Ops::xor_(Ops::xor_(rotr<Ops, 6>(e), rotr<Ops, 11>(e)), rotr<Ops, 25>(e));
+        V choose = Ops::xor_(g, Ops::and_(e, Ops::xor_(f, g)));
+        V t1 = Ops::add(Ops::add(h, sum1), Ops::add(choose, Ops::add(Ops::set1(Sha256::K[i]), w[i & 15])));
+        V sum0 = Ops::xor_(Ops::xor_(rotr<Ops, 2>(a), rotr<Ops, 13>(a)), rotr<Ops, 22>(a));
+        V majority = Ops::or_(Ops::and_(a, b), Ops::and_(c, Ops::or_(a, b)));
+        V t2 = Ops::add(sum0, majority);
+        h = g;
+        g = f;
+        f = e;
+        e = Ops::add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = Ops::add(t1, t2);
+    }
+
+    const V state[8] = {
+        Ops::add(a, s[0]), Ops::add(b, s[1]), Ops::add(c, s[2]), Ops::add(d, s[3]),
+        Ops::add(e, s[4]), Ops::add(f, s[5]), Ops::add(g, s[6]), Ops::add(h, s[7]),
+    };
+    storeDigests<Ops, true>(state, digests);
+}
+
+} // namespace simd
+} // namespace Oroto
+
+#endif // OROTO_HASH_KERNELS_SIMD_H
@@ -0,0 +1,61 @@
+// 4-lane kernels. The file is compiled for SSE2 no matter what the rest of the
+// build targets; hash_kernels.cpp only calls in after CPUID says it is safe.
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include "hash_kernels.h"
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#include "hash_kernels_simd.h"
+
+namespace Oroto {
+
+namespace {
+
+struct Sse2Ops {
+    using V = __m128i;
+    static constexpr size_t LANES = 4;
+
+    static V load(const uint32_t* p) { return _mm_load_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint32_t* p, V v) { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V set1(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static V add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V xor_(V a, V b) { return _mm_xor_si128(a, b); }
+    static V and_(V a, V b) { return _mm_and_si128(a, b); }
+    static V or_(V a, V b) { return _mm_or_si128(a, b); }
+    template <int N> static V rotl(V x) { return _mm_or_si128(_mm_slli_epi32(x, N), _mm_srli_epi32(x, 32 - N)); }
+    template <int N> static V shr(V x) { return _mm_srli_epi32(x, N); }
+};
+
+} // namespace
+
+void md5Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    simd::md5Lanes<Sse2Ops>(messages, length, digests);
+}
+
+void sha1Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    simd::sha1Lanes<Sse2Ops>(messages, length, digests);
+}
+
+void sha256Sse2(const uint8_t* const* messages, size_t length, uint8_t* digests) {
+    simd::sha256Lanes<Sse2Ops>(messages, length, digests);
+}
+
+} // namespace Oroto
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
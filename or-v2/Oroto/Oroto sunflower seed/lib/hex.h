@@ -0,0 +1,57 @@
+#ifndef OROTO_HEX_H
+#define OROTO_HEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Oroto {
+
+// Lower-case hex of any digest
+inline std::string toHex(const uint8_t* bytes, size_t size) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex(2 * size, '0');
+    for (size_t i = 0; i < size; ++i) {
+        hex[2 * i] = DIGITS[bytes[i] >> 4];
+        hex[2 * i + 1] = DIGITS[bytes[i] & 0x0f];
+    }
+    return hex;
+}
+
+template <size_t N>
+std::string toHex(const std::array<uint8_t, N>& digest) {
+    return toHex(digest.data(), N);
+}
+
+// Exactly 2*size hex digits, either case
+inline bool parseHex(std::string_view hex, uint8_t* bytes, size_t size) {
+    if (hex.size() != 2 * size) {
+        return false;
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < size; ++i) {
+        int high = nibble(hex[2 * i]);
+        int low = nibble(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+template <size_t N>
+bool parseHex(std::string_view hex, std::array<uint8_t, N>& digest) {
+    return parseHex(hex, digest.data(), N);
+}
+
+} // namespace Oroto
+
+#endif // OROTO_HEX_H
@@ -0,0 +1,146 @@
+#ifndef OROTO_JOB_OUTPUT_H
+#define OROTO_JOB_OUTPUT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace Oroto {
+
+// Output of one background job. The job appends while it runs; the shell
+// reads from any offset (jobs, fg) and can block for more until close().
+class JobOutput {
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::string data_;
+    bool closed_;
+
+public:
+    JobOutput() : closed_(false) {}
+
+    void append(const char* text, size_t length) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            data_.append(text, length);
+        }
+        changed_.notify_all();
+    }
+
+    // The job finished: no more output, wake any reader
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        changed_.notify_all();
+    }
+
+    // Appends everything past `offset` to `out` and returns the new offset.
+    // With `wait`, blocks until there is something new or the buffer is closed.
+    size_t readFrom(size_t offset, std::string& out, bool wait) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wait) {
+            changed_.wait(lock, [this, offset] { return closed_ || data_.size() > offset; });
+        }
+        if (data_.size() > offset) {
+            out.append(data_, offset, std::string::npos);
+        }
+        return data_.size();
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return data_.size();
+    }
+};
+
+// Stream buffer that sends each thread's writes to that thread's JobOutput,
+// or to the original buffer when the thread has none. Installed on std::cout,
+// it lets commands keep writing to std::cout while running as pool jobs.
+// It keeps no buffer of its own, so writes from different threads never mix
+// inside it.
+class OutputRouter : public std::streambuf {
+private:
+    std::streambuf* fallback_;
+
+    static JobOutput*& target() {
+        static thread_local JobOutput* current = nullptr;
+        return current;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+        char ch = traits_type::to_char_type(c);
+        if (JobOutput* output = target()) {
+            output->append(&ch, 1);
+            return c;
+        }
+        return fallback_->sputc(ch);
+    }
+
+    std::streamsize xsputn(const char* text, std::streamsize length) override {
+        if (JobOutput* output = target()) {
+            output->append(text, static_cast<size_t>(length));
+            return length;
+        }
+        return fallback_->sputn(text, length);
+    }
+
+    int sync() override {
+        return target() ? 0 : fallback_->pubsync();
+    }
+
+public:
+    explicit OutputRouter(std::streambuf* fallback) : fallback_(fallback) {}
+
+    std::streambuf* fallback() const { return fallback_; }
+
+    // Where this thread's writes currently go (nullptr: the fallback)
+    static JobOutput* current() { return target(); }
+
+    // Route this thread's writes to `output` (nullptr: back to the fallback);
+    // returns the previous target
+    static JobOutput* redirect(JobOutput* output) {
+        JobOutput* previous = target();
+        target() = output;
+        return previous;
+    }
+};
+
+// Puts an OutputRouter in front of `stream` the first time it is called for
+// it. The router lives for the rest of the process, like the stream.
+inline void installOutputRouter(std::ostream& stream) {
+    static std::mutex installMutex;
+    std::lock_guard<std::mutex> lock(installMutex);
+    if (dynamic_cast<OutputRouter*>(stream.rdbuf()) == nullptr) {
+        stream.rdbuf(new OutputRouter(stream.rdbuf()));
+    }
+}
+
+// Captures this thread's routed output into `output` for the scope
+class OutputCapture {
+private:
+    JobOutput* previous_;
+
+public:
+    explicit OutputCapture(JobOutput* output) : previous_(OutputRouter::redirect(output)) {}
+    ~OutputCapture() { OutputRouter::redirect(previous_); }
+
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+};
+
+} // namespace Oroto
+
+#endif // OROTO_JOB_OUTPUT_H
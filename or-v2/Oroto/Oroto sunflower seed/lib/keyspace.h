@@ -0,0 +1,106 @@
+#ifndef OROTO_KEYSPACE_H
+#define OROTO_KEYSPACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "hash_kernels.h"
+
+namespace Oroto {
+
+// Every candidate of a fixed length where position i draws from its own
+// character set, numbered 0 .. size()-1 as a mixed-radix integer with the
+// last position turning fastest. decode() jumps to any index, so a range of
+// indices can be handed to a thread; next() then walks it in place like an
+// odometer without allocating.
+class Keyspace {
+private:
+    std::vector<std::string> positions_;
+    uint64_t size_ = 0;
+
+    bool computeSize() {
+        size_ = positions_.empty() ? 0 : 1;
+        for (const auto& charset : positions_) {
+            if (charset.empty() || __builtin_mul_overflow(size_, charset.size(), &size_)) {
+                size_ = 0;
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // Longest candidate: one that fits a single block for the SIMD kernels
+    static constexpr size_t MAX_LENGTH = MAX_BLOCK_MESSAGE;
+
+    // length copies of one charset. False if the keyspace does not fit 64 bits.
+    static bool uniform(std::string_view charset, size_t length, Keyspace& keyspace) {
+        if (length == 0 || length > MAX_LENGTH) {
+            return false;
+        }
+        keyspace.positions_.assign(length, std::string(charset));
+        return keyspace.computeSize();
+    }
+
+    // Mask syntax: ?l a-z, ?u A-Z, ?d 0-9, ?s printable symbols, ?a all of
+    // those, ?? a literal '?'; any other character stands for itself.
+    static bool parseMask(std::string_view mask, Keyspace& keyspace) {
+        static const std::string LOWER = "abcdefghijklmnopqrstuvwxyz";
+        static const std::string UPPER = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        static const std::string DIGITS = "0123456789";
+        static const std::string SYMBOLS = " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+        keyspace.positions_.clear();
+        for (size_t i = 0; i < mask.size(); ++i) {
+            if (mask[i] != '?') {
+                keyspace.positions_.emplace_back(1, mask[i]);
+                continue;
+            }
+            if (++i == mask.size()) {
+                return false;
+            }
+            switch (mask[i]) {
+                case 'l': keyspace.positions_.push_back(LOWER); break;
+                case 'u': keyspace.positions_.push_back(UPPER); break;
+                case 'd': keyspace.positions_.push_back(DIGITS); break;
+                case 's': keyspace.positions_.push_back(SYMBOLS); break;
+                case 'a': keyspace.positions_.push_back(LOWER + UPPER + DIGITS + SYMBOLS); break;
+                case '?': keyspace.positions_.emplace_back(1, '?'); break;
+                default: return false;
+            }
+        }
+        return keyspace.positions_.size() <= MAX_LENGTH && keyspace.computeSize();
+    }
+
+    uint64_t size() const { return size_; }
+    size_t length() const { return positions_.size(); }
+
+    // Writes candidate `index` to out[0 .. length()) and its digits
+    void decode(uint64_t index, char* out, size_t* digits) const {
+        for (size_t i = positions_.size(); i-- > 0;) {
+            const std::string& charset = positions_[i];
+            digits[i] = static_cast<size_t>(index % charset.size());
+            index /= charset.size();
+            out[i] = charset[digits[i]];
+        }
+    }
+
+    // Steps to the following index; false after the last one
+    bool next(char* out, size_t* digits) const {
+        for (size_t i = positions_.size(); i-- > 0;) {
+            const std::string& charset = positions_[i];
+            if (++digits[i] < charset.size()) {
+                out[i] = charset[digits[i]];
+                return true;
+            }
+            digits[i] = 0;
+            out[i] = charset[0];
+        }
+        return false;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_KEYSPACE_H
@@ -0,0 +1,217 @@
+#ifndef OROTO_LINE_EDITOR_H
+#define OROTO_LINE_EDITOR_H
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <termios.h>
+#include <unistd.h>
+#include "completion_trie.h"
+
+namespace Oroto {
+
+// Minimal line reader for an interactive terminal with Tab completion.
+// The terminal is in non-canonical, no-echo mode only while a line is being
+// read, so commands still see a normal terminal and Ctrl-C keeps working.
+// Every keystroke updates a CompletionQuery, so Tab answers from a trie
+// cursor that is already in place. Editing is append-only: printable
+// characters, Backspace, Ctrl-U (clear), Ctrl-D (end of input on an empty
+// line); escape sequences such as arrow keys are read and ignored.
+class LineEditor {
+private:
+    int in_;
+    int out_;
+    CompletionEngine& engine_;
+
+    static constexpr size_t LIST_LIMIT = 60;
+
+    // The mode to put back if the process exits while a line is being read
+    struct SavedTerminal {
+        struct termios mode;
+        int fd;
+        volatile sig_atomic_t active;
+    };
+
+    static SavedTerminal& savedTerminal() {
+        static SavedTerminal terminal{};
+        return terminal;
+    }
+
+    static volatile sig_atomic_t& interrupted() {
+        static volatile sig_atomic_t flag = 0;
+        return flag;
+    }
+
+    void write(std::string_view text) {
+        while (!text.empty()) {
+            ssize_t n = ::write(out_, text.data(), text.size());
+            if (n <= 0) {
+                return;
+            }
+            text.remove_prefix(static_cast<size_t>(n));
+        }
+    }
+
+    bool readByte(char& c) {
+        while (true) {
+            ssize_t n = ::read(in_, &c, 1);
+            if (n == 1) {
+                return true;
+            }
+            if (n < 0 && errno == EINTR && !interrupted()) {
+                continue;
+            }
+            return false;
+        }
+    }
+
+    // Reads the rest of "ESC [ ... final" or "ESC O x"
+    void skipEscape() {
+        char c;
+        if (!readByte(c) || (c != '[' && c != 'O')) {
+            return;
+        }
+        bool ss3 = c == 'O';
+        while (readByte(c)) {
+            if (ss3 || (c >= 0x40 && c <= 0x7e)) {
+                return;
+            }
+        }
+    }
+
+    void listCandidates(const CompletionResult& result, std::string_view prompt, std::string_view line) {
+        std::string listing = "\n";
+        size_t column = 0;
+        for (const auto& candidate : result.candidates) {
+            if (column > 0 && column + candidate.size() + 2 > 80) {
+                listing += "\n";
+                column = 0;
+            }
+            listing += candidate;
+            listing += "  ";
+            column += candidate.size() + 2;
+        }
+        if (result.total > result.candidates.size()) {
+            listing += "\n... " + std::to_string(result.total - result.candidates.size()) + " more";
+        }
+        listing += "\n";
+        write(listing);
+        write(prompt);
+        write(line);
+    }
+
+public:
+    LineEditor(int in, int out, CompletionEngine& engine) : in_(in), out_(out), engine_(engine) {}
+
+    // Puts the terminal back in the mode it had before readLine. Exiting from
+    // the prompt (a Ctrl-C handler, or any std::exit) would otherwise leave
+    // the user's shell without echo. tcsetattr is async-signal-safe, so a
+    // signal handler may call this.
+    static void restoreTerminal() {
+        SavedTerminal& terminal = savedTerminal();
+        if (terminal.active) {
+            terminal.active = 0;
+            ::tcsetattr(terminal.fd, TCSANOW, &terminal.mode);
+        }
+    }
+
+    // Makes a blocked readLine return false, as at end of input, once a signal
+    // handler calls this and the signal has interrupted its read. Later calls
+    // return false too. Async-signal-safe.
+    static void interrupt() {
+        interrupted() = 1;
+    }
+
+    // Only worth using when a person is typing at a terminal
+    static bool available(int in, int out) {
+        return ::isatty(in) && ::isatty(out);
+    }
+
+    // False at end of input. The prompt must already be on screen; it is
+    // redrawn after a completion listing.
+    bool readLine(std::string_view prompt, std::string& line) {
+        line.clear();
+        struct termios saved;
+        if (::tcgetattr(in_, &saved) != 0) {
+            return false;
+        }
+        static const bool restoreAtExit = std::atexit(restoreTerminal) == 0;
+        (void)restoreAtExit;
+        SavedTerminal& terminal = savedTerminal();
+        terminal.mode = saved;
+        terminal.fd = in_;
+        terminal.active = 1;
+        struct termios raw = saved;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        ::tcsetattr(in_, TCSANOW, &raw);
+
+        CompletionQuery query;
+        engine_.update(query, line);
+        bool gotLine = false;
+        char c;
+        while (readByte(c)) {
+            if (c == '\r' || c == '\n') {
+                write("\n");
+                gotLine = true;
+                break;
+            }
+            if (c == 4) {              // Ctrl-D
+                if (line.empty()) {
+                    break;
+                }
+                continue;
+            }
+            if (c == 127 || c == 8) {  // Backspace: drop one UTF-8 character
+                if (line.empty()) {
+                    continue;
+                }
+                while (!line.empty() && (static_cast<unsigned char>(line.back()) & 0xc0) == 0x80) {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    line.pop_back();
+                }
+                write("\b \b");
+            } else if (c == 21) {      // Ctrl-U
+                write("\r\x1b[K");
+                write(prompt);
+                line.clear();
+            } else if (c == '\t') {
+                CompletionResult result = engine_.result(query, LIST_LIMIT);
+                std::string added = result.extension;
+                // A unique match is finished off, except a directory
+                if (result.total == 1 && result.candidates.front().back() != '/') {
+                    added += ' ';
+                }
+                if (result.total == 0) {
+                    write("\a");
+                } else if (!added.empty()) {
+                    line += added;
+                    write(added);
+                } else {
+                    listCandidates(result, prompt, line);
+                }
+            } else if (c == 27) {
+                skipEscape();
+                continue;
+            } else if (static_cast<unsigned char>(c) >= 32) {
+                line += c;
+                write(std::string_view(&c, 1));
+            } else {
+                continue;
+            }
+            engine_.update(query, line);
+        }
+
+        restoreTerminal();
+        return gotLine;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_LINE_EDITOR_H
@@ -11,16 +11,20 @@ bool Logger::initialized = false;
 
 #ifndef USE_SPDLOG
 bool Logger::initialize(const std::string& filename, LogLevel level) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    if (!initialized) {
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (initialized) {
+            return true;
+        }
         logFile.open(filename, std::ios::app);
         if (!logFile.is_open()) {
             return false;
         }
         currentLevel = level;
         initialized = true;
-        log(LogLevel::INFO, "Logger", "Oroto Logger initialized");
     }
+    // log() takes logMutex itself, so it must run after the lock is released
+    log(LogLevel::INFO, "Logger", "Oroto Logger initialized");
     return true;
 }
 
@@ -36,9 +40,10 @@ std::string Logger::levelToString(LogLevel level) {
 }
 
 void Logger::shutdown() {
+    log(LogLevel::INFO, "Logger", "Oroto Logger shutting down");
+
     std::lock_guard<std::mutex> lock(logMutex);
     if (initialized && logFile.is_open()) {
-        log(LogLevel::INFO, "Logger", "Oroto Logger shutting down");
         logFile.close();
         initialized = false;
     }
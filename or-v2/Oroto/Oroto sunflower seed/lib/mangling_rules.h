@@ -0,0 +1,358 @@
+#ifndef OROTO_MANGLING_RULES_H
+#define OROTO_MANGLING_RULES_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Oroto {
+
+// Word-mangling rules in the syntax shared by hashcat and John the Ripper,
+// one rule per line, each a sequence of single-letter functions:
+//
+//   :     nothing              l u    lower / upper case all
+//   c C   capitalize / invert  t TN   toggle case of all / position N
+//   r     reverse              d pN   duplicate / append N more copies
+//   f     append reversed      { }    rotate left / right
+//   $X ^X append / prepend X   [ ]    delete first / last character
+//   DN    delete position N    'N     truncate to N characters
+//   xNM   keep M from N        ONM    omit M from N
+//   iNX   insert X at N        oNX    overwrite position N with X
+//   sXY   replace X with Y     @X     purge every X
+//   zN ZN repeat first / last character N times
+//   q     double every character
+//
+// Positions N and M are 0-9 then A-Z for 10-35. Spaces between functions
+// are ignored, so "sa4 se3 so0" is one leetspeak rule. A position past the
+// end leaves the word unchanged, as in hashcat.
+//
+// A rule is compiled once into 3-byte instructions; runs of substitutions
+// such as a leetspeak rule fold into one 256-entry translation table, so
+// they cost a single branch-free pass. Applying a rule to a word is then a
+// loop over its instructions in a fixed stack buffer, so the rules multiply
+// candidates without allocating. A result longer than MAX_LENGTH is dropped.
+class RuleSet {
+private:
+    enum class Op : uint8_t {
+        LOWER, UPPER, CAPITALIZE, INVERT_CAPITALIZE, TOGGLE_ALL, TOGGLE_AT,
+        REVERSE_ALL, DUPLICATE, DUPLICATE_N, REFLECT, ROTATE_LEFT, ROTATE_RIGHT,
+        APPEND, PREPEND, DELETE_FIRST, DELETE_LAST, DELETE_AT, TRUNCATE,
+        EXTRACT, OMIT, INSERT, OVERWRITE, TRANSLATE, PURGE,
+        REPEAT_FIRST, REPEAT_LAST, DOUBLE_ALL
+    };
+
+    struct Instruction {
+        Op op;
+        uint8_t a;
+        uint8_t b;
+    };
+
+    using Table = std::array<uint8_t, 256>;
+
+    std::vector<Instruction> code_;
+    std::vector<Table> tables_;          // TRANSLATE operands, indexed by a | b << 8
+    std::vector<uint32_t> starts_{0};   // rule i is code_[starts_[i], starts_[i + 1])
+
+    static bool position(char c, uint8_t& value) {
+        if (c >= '0' && c <= '9') {
+            value = static_cast<uint8_t>(c - '0');
+        } else if (c >= 'A' && c <= 'Z') {
+            value = static_cast<uint8_t>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static char lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c; }
+    static char upper(char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 32) : c; }
+    static char toggle(char c) { return c >= 'a' && c <= 'z' ? upper(c) : lower(c); }
+
+    // Runs one instruction on word[0 .. length); false to drop the candidate
+    bool execute(const Instruction& in, char* word, size_t& length) const {
+        const size_t n = length;
+        switch (in.op) {
+            case Op::LOWER:
+                std::transform(word, word + n, word, lower);
+                break;
+            case Op::UPPER:
+                std::transform(word, word + n, word, upper);
+                break;
+            case Op::CAPITALIZE:
+                std::transform(word, word + n, word, lower);
+                if (n > 0) word[0] = upper(word[0]);
+                break;
+            case Op::INVERT_CAPITALIZE:
+                std::transform(word, word + n, word, upper);
+                if (n > 0) word[0] = lower(word[0]);
+                break;
+            case Op::TOGGLE_ALL:
+                std::transform(word, word + n, word, toggle);
+                break;
+            case Op::TOGGLE_AT:
+                if (in.a < n) word[in.a] = toggle(word[in.a]);
+                break;
+            case Op::REVERSE_ALL:
+                std::reverse(word, word + n);
+                break;
+            case Op::DUPLICATE:
+                if (n * 2 > MAX_LENGTH) return false;
+                std::memcpy(word + n, word, n);
+                length = n * 2;
+                break;
+            case Op::DUPLICATE_N:
+                if (n * (in.a + 1) > MAX_LENGTH) return false;
+                for (size_t copy = 1; copy <= in.a; ++copy) {
+                    std::memcpy(word + n * copy, word, n);
+                }
+                length = n * (in.a + 1);
+                break;
+            case Op::REFLECT:
+                if (n * 2 > MAX_LENGTH) return false;
+                std::reverse_copy(word, word + n, word + n);
+                length = n * 2;
+                break;
+            case Op::ROTATE_LEFT:
+                if (n > 0) std::rotate(word, word + 1, word + n);
+                break;
+            case Op::ROTATE_RIGHT:
+                if (n > 0) std::rotate(word, word + n - 1, word + n);
+                break;
+            case Op::APPEND:
+                if (n + 1 > MAX_LENGTH) return false;
+                word[length++] = static_cast<char>(in.a);
+                break;
+            case Op::PREPEND:
+                if (n + 1 > MAX_LENGTH) return false;
+                std::memmove(word + 1, word, n);
+                word[0] = static_cast<char>(in.a);
+                ++length;
+                break;
+            case Op::DELETE_FIRST:
+                if (n > 0) {
+                    std::memmove(word, word + 1, n - 1);
+                    --length;
+                }
+                break;
+            case Op::DELETE_LAST:
+                if (n > 0) --length;
+                break;
+            case Op::DELETE_AT:
+                if (in.a < n) {
+                    std::memmove(word + in.a, word + in.a + 1, n - in.a - 1);
+                    --length;
+                }
+                break;
+            case Op::TRUNCATE:
+                length = std::min<size_t>(n, in.a);
+                break;
+            case Op::EXTRACT:
+                if (in.a < n) {
+                    length = std::min<size_t>(in.b, n - in.a);
+                    std::memmove(word, word + in.a, length);
+                }
+                break;
+            case Op::OMIT:
+                if (in.a < n) {
+                    size_t count = std::min<size_t>(in.b, n - in.a);
+                    std::memmove(word + in.a, word + in.a + count, n - in.a - count);
+                    length -= count;
+                }
+                break;
+            case Op::INSERT:
+                if (in.a <= n) {
+                    if (n + 1 > MAX_LENGTH) return false;
+                    std::memmove(word + in.a + 1, word + in.a, n - in.a);
+                    word[in.a] = static_cast<char>(in.b);
+                    ++length;
+                }
+                break;
+            case Op::OVERWRITE:
+                if (in.a < n) word[in.a] = static_cast<char>(in.b);
+                break;
+            case Op::TRANSLATE: {
+                const Table& table = tables_[in.a | in.b << 8];
+                for (size_t i = 0; i < n; ++i) {
+                    word[i] = static_cast<char>(table[static_cast<uint8_t>(word[i])]);
+                }
+                break;
+            }
+            case Op::PURGE:
+                length = static_cast<size_t>(std::remove(word, word + n, static_cast<char>(in.a)) - word);
+                break;
+            case Op::REPEAT_FIRST:
+                if (n > 0) {
+                    if (n + in.a > MAX_LENGTH) return false;
+                    std::memmove(word + in.a, word, n);
+                    std::memset(word, word[in.a], in.a);
+                    length += in.a;
+                }
+                break;
+            case Op::REPEAT_LAST:
+                if (n > 0) {
+                    if (n + in.a > MAX_LENGTH) return false;
+                    std::memset(word + n, word[n - 1], in.a);
+                    length += in.a;
+                }
+                break;
+            case Op::DOUBLE_ALL:
+                if (n * 2 > MAX_LENGTH) return false;
+                for (size_t i = n; i-- > 0;) {
+                    word[2 * i] = word[2 * i + 1] = word[i];
+                }
+                length = n * 2;
+                break;
+        }
+        return true;
+    }
+
+public:
+    // Longest candidate a rule may produce
+    static constexpr size_t MAX_LENGTH = 255;
+
+    // Compiles one rule and adds it to the set. False on a syntax error, in
+    // which case the set is unchanged.
+    bool add(std::string_view rule) {
+        const size_t mark = code_.size();
+        const size_t tableMark = tables_.size();
+        auto fail = [&] {
+            code_.resize(mark);
+            tables_.resize(tableMark);
+            return false;
+        };
+        for (size_t i = 0; i < rule.size(); ++i) {
+            const char function = rule[i];
+            // Argument i + k, or false if the rule ends first
+            auto argument = [&](size_t k, char& c) {
+                if (i + k >= rule.size()) {
+                    return false;
+                }
+                c = rule[i + k];
+                return true;
+            };
+            char c1 = 0;
+            char c2 = 0;
+            uint8_t p1 = 0;
+            uint8_t p2 = 0;
+            Instruction in{Op::LOWER, 0, 0};
+            switch (function) {
+                case ' ': case '\t': case ':': continue;
+                case 'l': in.op = Op::LOWER; break;
+                case 'u': in.op = Op::UPPER; break;
+                case 'c': in.op = Op::CAPITALIZE; break;
+                case 'C': in.op = Op::INVERT_CAPITALIZE; break;
+                case 't': in.op = Op::TOGGLE_ALL; break;
+                case 'r': in.op = Op::REVERSE_ALL; break;
+                case 'd': in.op = Op::DUPLICATE; break;
+                case 'f': in.op = Op::REFLECT; break;
+                case '{': in.op = Op::ROTATE_LEFT; break;
+                case '}': in.op = Op::ROTATE_RIGHT; break;
+                case '[': in.op = Op::DELETE_FIRST; break;
+                case ']': in.op = Op::DELETE_LAST; break;
+                case 'q': in.op = Op::DOUBLE_ALL; break;
+                case 'T': case 'p': case 'D': case '\'': case 'z': case 'Z':
+                    if (!argument(1, c1) || !position(c1, p1)) {
+                        return fail();
+                    }
+                    in = {function == 'T' ? Op::TOGGLE_AT : function == 'p' ? Op::DUPLICATE_N
+                          : function == 'D' ? Op::DELETE_AT : function == '\'' ? Op::TRUNCATE
+                          : function == 'z' ? Op::REPEAT_FIRST : Op::REPEAT_LAST, p1, 0};
+                    i += 1;
+                    break;
+                case '$': case '^': case '@':
+                    if (!argument(1, c1)) {
+                        return fail();
+                    }
+                    in = {function == '$' ? Op::APPEND : function == '^' ? Op::PREPEND : Op::PURGE,
+                          static_cast<uint8_t>(c1), 0};
+                    i += 1;
+                    break;
+                case 's':
+                    if (!argument(1, c1) || !argument(2, c2)) {
+                        return fail();
+                    }
+                    i += 2;
+                    // Composed into the table of a substitution just before
+                    if (code_.size() == mark || code_.back().op != Op::TRANSLATE) {
+                        if (tables_.size() > 0xffff) {
+                            return fail();
+                        }
+                        Table identity;
+                        for (size_t c = 0; c < identity.size(); ++c) {
+                            identity[c] = static_cast<uint8_t>(c);
+                        }
+                        tables_.push_back(identity);
+                        size_t index = tables_.size() - 1;
+                        code_.push_back({Op::TRANSLATE, static_cast<uint8_t>(index), static_cast<uint8_t>(index >> 8)});
+                    }
+                    for (uint8_t& to : tables_.back()) {
+                        if (to == static_cast<uint8_t>(c1)) {
+                            to = static_cast<uint8_t>(c2);
+                        }
+                    }
+                    continue;
+                case 'x': case 'O':
+                    if (!argument(1, c1) || !argument(2, c2) || !position(c1, p1) || !position(c2, p2)) {
+                        return fail();
+                    }
+                    in = {function == 'x' ? Op::EXTRACT : Op::OMIT, p1, p2};
+                    i += 2;
+                    break;
+                case 'i': case 'o':
+                    if (!argument(1, c1) || !argument(2, c2) || !position(c1, p1)) {
+                        return fail();
+                    }
+                    in = {function == 'i' ? Op::INSERT : Op::OVERWRITE, p1, static_cast<uint8_t>(c2)};
+                    i += 2;
+                    break;
+                default:
+                    return fail();
+            }
+            code_.push_back(in);
+        }
+        starts_.push_back(static_cast<uint32_t>(code_.size()));
+        return true;
+    }
+
+    size_t size() const { return starts_.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    // Writes rule `rule` applied to word into buffer (MAX_LENGTH bytes) and
+    // returns the length, or -1 if the rule drops this word
+    int apply(size_t rule, std::string_view word, char* buffer) const {
+        if (word.size() > MAX_LENGTH) {
+            return -1;
+        }
+        std::memcpy(buffer, word.data(), word.size());
+        size_t length = word.size();
+        for (uint32_t pc = starts_[rule]; pc < starts_[rule + 1]; ++pc) {
+            if (!execute(code_[pc], buffer, length)) {
+                return -1;
+            }
+        }
+        return static_cast<int>(length);
+    }
+
+    // Calls fn(std::string_view) with each rule's version of word, in rule
+    // order, from a buffer on the caller's stack. Stops early, returning
+    // true, when fn returns true.
+    template <typename Fn>
+    bool forEachCandidate(std::string_view word, Fn&& fn) const {
+        char buffer[MAX_LENGTH];
+        for (size_t rule = 0; rule < size(); ++rule) {
+            int length = apply(rule, word, buffer);
+            if (length >= 0 && fn(std::string_view(buffer, static_cast<size_t>(length)))) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_MANGLING_RULES_H
@@ -0,0 +1,150 @@
+#ifndef OROTO_MAPPED_WORDLIST_H
+#define OROTO_MAPPED_WORDLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "expected.h"
+
+namespace Oroto {
+
+// Bit i set where block[i] is '\n', for 64 bytes at once. SSE2 is part of
+// x86-64, so no dispatch is needed.
+inline uint64_t newlineMask(const char* block) {
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        mask |= static_cast<uint64_t>(bits) << (i * 16);
+    }
+    return mask;
+#else
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) {
+        mask |= static_cast<uint64_t>(block[i] == '\n') << i;
+    }
+    return mask;
+#endif
+}
+
+// Calls fn(std::string_view) for each line of [begin, end) with the same
+// rules as WordlistReader: a trailing '\r' is stripped and empty lines are
+// skipped. The views point into the buffer, so nothing is copied. Newlines
+// are found 64 bytes at a time and walked bit by bit, which beats a memchr()
+// per line on wordlists where the average line is under ten bytes. Stops
+// early, returning true, when fn returns true.
+template <typename Fn>
+bool forEachLine(const char* begin, const char* end, Fn&& fn) {
+    const char* line = begin;
+    auto emit = [&](const char* newline) {
+        const char* last = newline;
+        if (last > line && last[-1] == '\r') {
+            --last;
+        }
+        bool stop = last > line && fn(std::string_view(line, static_cast<size_t>(last - line)));
+        line = newline + 1;
+        return stop;
+    };
+
+    const char* block = begin;
+    for (; end - block >= 64; block += 64) {
+        for (uint64_t mask = newlineMask(block); mask != 0; mask &= mask - 1) {
+            if (emit(block + __builtin_ctzll(mask))) {
+                return true;
+            }
+        }
+    }
+    for (; block < end; ++block) {
+        if (*block == '\n' && emit(block)) {
+            return true;
+        }
+    }
+    return line < end && emit(end);
+}
+
+// Byte range of chunk `index` when text is cut every chunkBytes and each cut
+// is moved forward to just past the next newline, so every line falls in
+// exactly one chunk. Chunks past the end, or swallowed by a long line, are
+// empty.
+inline std::string_view wordlistChunk(std::string_view text, size_t index, size_t chunkBytes) {
+    auto boundary = [&](size_t offset) -> size_t {
+        if (offset == 0 || offset >= text.size()) {
+            return std::min(offset, text.size());
+        }
+        size_t newline = text.find('\n', offset - 1);
+        return newline == std::string_view::npos ? text.size() : newline + 1;
+    };
+    size_t first = boundary(index * chunkBytes);
+    size_t last = boundary((index + 1) * chunkBytes);
+    return text.substr(first, last - first);
+}
+
+// A wordlist file mapped read-only for the lifetime of the object. The
+// kernel is told it will be read sequentially so it reads ahead aggressively
+// and drops pages behind; on a multi-GB list that is most of the I/O cost.
+class MappedWordlist {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    void close() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+public:
+    MappedWordlist() = default;
+    MappedWordlist(const MappedWordlist&) = delete;
+    MappedWordlist& operator=(const MappedWordlist&) = delete;
+    ~MappedWordlist() { close(); }
+
+    // FILE_NOT_FOUND if the file cannot be opened, DEVICE_ERROR if it cannot
+    // be mapped (pipes, character devices)
+    Status open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            ::close(fd);
+            return makeError(ErrorCode::DEVICE_ERROR);
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                return makeError(ErrorCode::DEVICE_ERROR);
+            }
+            ::madvise(data, size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(data);
+            size_ = size;
+        }
+        ::close(fd);
+        return ok();
+    }
+
+    std::string_view text() const { return std::string_view(data_, size_); }
+    size_t size() const { return size_; }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_MAPPED_WORDLIST_H
@@ -0,0 +1,215 @@
+#ifndef OROTO_MD5_H
+#define OROTO_MD5_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "hex.h"
+
+namespace Oroto {
+
+using Md5Digest = std::array<uint8_t, 16>;
+
+// MD5 (RFC 1321). The 64 steps are written out with their constants and
+// shifts inline so the compiler keeps the state in registers. Candidates of up
+// to 55 bytes, which is nearly every password, fit one padded block and take
+// the digest() fast path: one compression and no buffering.
+class Md5 {
+private:
+    uint32_t state_[4];
+    uint8_t buffer_[64];
+    uint64_t length_;
+
+    static uint32_t rotl(uint32_t x, int c) { return (x << c) | (x >> (32 - c)); }
+
+    static uint32_t load(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    static void store(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+    }
+
+    static void reset(uint32_t state[4]) {
+        state[0] = 0x67452301;
+        state[1] = 0xefcdab89;
+        state[2] = 0x98badcfe;
+        state[3] = 0x10325476;
+    }
+
+    static Md5Digest output(const uint32_t state[4]) {
+        Md5Digest digest;
+        for (int i = 0; i < 4; ++i) {
+            store(digest.data() + 4 * i, state[i]);
+        }
+        return digest;
+    }
+
+public:
+    static void compress(uint32_t state[4], const uint8_t block[64]) {
+        uint32_t x[16];
+        for (int i = 0; i < 16; ++i) {
+            x[i] = load(block + 4 * i);
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+#define OROTO_MD5_STEP(f, a, b, c, d, k, s, t) \
+        a += f(b, c, d) + x[k] + (t); a = rotl(a, s) + b;
+#define OROTO_MD5_FN_F(b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
+#define OROTO_MD5_FN_G(b, c, d) ((c) ^ ((d) & ((b) ^ (c))))
+#define OROTO_MD5_FN_H(b, c, d) ((b) ^ (c) ^ (d))
+#define OROTO_MD5_FN_I(b, c, d) ((c) ^ ((b) | ~(d)))
+
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, a, b, c, d,  0,  7, 0xd76aa478)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, d, a, b, c,  1, 12, 0xe8c7b756)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, c, d, a, b,  2, 17, 0x242070db)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, b, c, d, a,  3, 22, 0xc1bdceee)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, a, b, c, d,  4,  7, 0xf57c0faf)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, d, a, b, c,  5, 12, 0x4787c62a)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, c, d, a, b,  6, 17, 0xa8304613)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, b, c, d, a,  7, 22, 0xfd469501)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, a, b, c, d,  8,  7, 0x698098d8)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, d, a, b, c,  9, 12, 0x8b44f7af)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, c, d, a, b, 10, 17, 0xffff5bb1)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, b, c, d, a, 11, 22, 0x895cd7be)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, a, b, c, d, 12,  7, 0x6b901122)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, d, a, b, c, 13, 12, 0xfd987193)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, c, d, a, b, 14, 17, 0xa679438e)
+        OROTO_MD5_STEP(OROTO_MD5_FN_F, b, c, d, a, 15, 22, 0x49b40821)
+
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, a, b, c, d,  1,  5, 0xf61e2562)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, d, a, b, c,  6,  9, 0xc040b340)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, c, d, a, b, 11, 14, 0x265e5a51)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, b, c, d, a,  0, 20, 0xe9b6c7aa)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, a, b, c, d,  5,  5, 0xd62f105d)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, d, a, b, c, 10,  9, 0x02441453)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, c, d, a, b, 15, 14, 0xd8a1e681)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, b, c, d, a,  4, 20, 0xe7d3fbc8)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, a, b, c, d,  9,  5, 0x21e1cde6)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, d, a, b, c, 14,  9, 0xc33707d6)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, c, d, a, b,  3, 14, 0xf4d50d87)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, b, c, d, a,  8, 20, 0x455a14ed)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, a, b, c, d, 13,  5, 0xa9e3e905)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, d, a, b, c,  2,  9, 0xfcefa3f8)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, c, d, a, b,  7, 14, 0x676f02d9)
+        OROTO_MD5_STEP(OROTO_MD5_FN_G, b, c, d, a, 12, 20, 0x8d2a4c8a)
+
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, a, b, c, d,  5,  4, 0xfffa3942)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, d, a, b, c,  8, 11, 0x8771f681)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, c, d, a, b, 11, 16, 0x6d9d6122)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, b, c, d, a, 14, 23, 0xfde5380c)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, a, b, c, d,  1,  4, 0xa4beea44)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, d, a, b, c,  4, 11, 0x4bdecfa9)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, c, d, a, b,  7, 16, 0xf6bb4b60)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, b, c, d, a, 10, 23, 0xbebfbc70)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, a, b, c, d, 13,  4, 0x289b7ec6)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, d, a, b, c,  0, 11, 0xeaa127fa)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, c, d, a, b,  3, 16, 0xd4ef3085)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, b, c, d, a,  6, 23, 0x04881d05)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, a, b, c, d,  9,  4, 0xd9d4d039)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, d, a, b, c, 12, 11, 0xe6db99e5)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, c, d, a, b, 15, 16, 0x1fa27cf8)
+        OROTO_MD5_STEP(OROTO_MD5_FN_H, b, c, d, a,  2, 23, 0xc4ac5665)
+
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, a, b, c, d,  0,  6, 0xf4292244)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, d, a, b, c,  7, 10, 0x432aff97)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, c, d, a, b, 14, 15, 0xab9423a7)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, b, c, d, a,  5, 21, 0xfc93a039)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, a, b, c, d, 12,  6, 0x655b59c3)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, d, a, b, c,  3, 10, 0x8f0ccc92)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, c, d, a, b, 10, 15, 0xffeff47d)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, b, c, d, a,  1, 21, 0x85845dd1)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, a, b, c, d,  8,  6, 0x6fa87e4f)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, d, a, b, c, 15, 10, 0xfe2ce6e0)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, c, d, a, b,  6, 15, 0xa3014314)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, b, c, d, a, 13, 21, 0x4e0811a1)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, a, b, c, d,  4,  6, 0xf7537e82)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, d, a, b, c, 11, 10, 0xbd3af235)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, c, d, a, b,  2, 15, 0x2ad7d2bb)
+        OROTO_MD5_STEP(OROTO_MD5_FN_I, b, c, d, a,  9, 21, 0xeb86d391)
+
+#undef OROTO_MD5_STEP
+#undef OROTO_MD5_FN_F
+#undef OROTO_MD5_FN_G
+#undef OROTO_MD5_FN_H
+#undef OROTO_MD5_FN_I
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+
+    Md5() : length_(0) { reset(state_); }
+
+    void update(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        size_t used = static_cast<size_t>(length_ % 64);
+        length_ += size;
+        if (used > 0) {
+            size_t take = size < 64 - used ? size : 64 - used;
+            std::memcpy(buffer_ + used, bytes, take);
+            bytes += take;
+            size -= take;
+            if (used + take < 64) {
+                return;
+            }
+            compress(state_, buffer_);
+        }
+        for (; size >= 64; bytes += 64, size -= 64) {
+            compress(state_, bytes);
+        }
+        std::memcpy(buffer_, bytes, size);
+    }
+
+    void update(std::string_view text) { update(text.data(), text.size()); }
+
+    Md5Digest finish() {
+        uint64_t bits = length_ * 8;
+        size_t used = static_cast<size_t>(length_ % 64);
+        buffer_[used++] = 0x80;
+        if (used > 56) {
+            std::memset(buffer_ + used, 0, 64 - used);
+            compress(state_, buffer_);
+            used = 0;
+        }
+        std::memset(buffer_ + used, 0, 56 - used);
+        for (int i = 0; i < 8; ++i) {
+            buffer_[56 + i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        compress(state_, buffer_);
+        Md5Digest digest = output(state_);
+        reset(state_);
+        length_ = 0;
+        return digest;
+    }
+
+    static Md5Digest digest(std::string_view text) {
+        if (text.size() > 55) {
+            Md5 md5;
+            md5.update(text);
+            return md5.finish();
+        }
+        uint8_t block[64] = {};
+        std::memcpy(block, text.data(), text.size());
+        block[text.size()] = 0x80;
+        uint64_t bits = static_cast<uint64_t>(text.size()) * 8;
+        block[56] = static_cast<uint8_t>(bits);
+        block[57] = static_cast<uint8_t>(bits >> 8);
+        uint32_t state[4];
+        reset(state);
+        compress(state, block);
+        return output(state);
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_MD5_H
@@ -7,6 +7,39 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <string_view>
+#include <memory_resource>
+#include "command_arena.h"
+#include "expected.h"
+
+// Argument list for one command. The elements view the command line (or the
+// per-command arena for unescaped arguments) and are valid while it is dispatched.
+using CommandArgs = std::pmr::vector<std::string_view>;
+
+// Value of a "--name=value" or "--name value" flag anywhere in args, empty if absent.
+// Lets scripts pass the choices that interactive tools would otherwise prompt for.
+inline std::string_view findOption(const CommandArgs& args, std::string_view name) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string_view arg = args[i];
+        if (arg.size() < name.size() + 2 || arg.substr(0, 2) != "--" || arg.substr(2, name.size()) != name) {
+            continue;
+        }
+        std::string_view rest = arg.substr(2 + name.size());
+        if (rest.empty()) {
+            return i + 1 < args.size() ? args[i + 1] : std::string_view();
+        }
+        if (rest[0] == '=') {
+            return rest.substr(1);
+        }
+    }
+    return std::string_view();
+}
+
+// Index of the first operand after a device action. "storage write NAME" and
+// "oroto storage write NAME" reach the same handler, one word apart.
+inline size_t actionOperand(const CommandArgs& args) {
+    return !args.empty() && args[0] == "oroto" ? 3 : 2;
+}
 
 // Shell interface declarations
 void showPrompt();
@@ -15,24 +48,24 @@ void displayBanner();
 void simulateLoading(int milliseconds);
 
 // Command processing
-std::vector<std::string> parseArguments(const std::string& command);
-void processCommand(const std::string& command);
+Oroto::Status processCommand(const std::string& command);
 void initCommandParser();
+void registerBuiltinCommands();
 
 // System calls interface
-void executeSystemCall(const std::string& syscall, const std::vector<std::string>& args);
+Oroto::Status executeSystemCall(const std::string& syscall, const CommandArgs& args);
 void initSystemCalls();
 void shutdownSystem();
 void rebootSystem();
 
 // Device interface
-void executeDeviceCommand(const std::string& device, const std::string& action, const std::vector<std::string>& args);
+Oroto::Status executeDeviceCommand(const std::string& device, std::string_view action, const CommandArgs& args);
 void initDeviceInterface();
 
 // Security tools interface
-void executeNmapScan(const std::vector<std::string>& args);
-void executeHashCrack(const std::vector<std::string>& args);
-void executePing(const std::vector<std::string>& args);
+Oroto::Status executeNmapScan(const CommandArgs& args);
+Oroto::Status executeHashCrack(const CommandArgs& args);
+Oroto::Status executePing(const CommandArgs& args);
 
 // Utility functions
 inline std::string getCurrentTimestamp() {
@@ -0,0 +1,592 @@
+#ifndef OROTO_OUTPUT_WRITER_H
+#define OROTO_OUTPUT_WRITER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "colors.h"
+#include "expected.h"
+
+namespace Oroto {
+
+// How a session wants command output: decorated text for people, one JSON
+// object per event for scripts, or length-prefixed binary events for programs
+enum class OutputMode : uint8_t { HUMAN, JSON, BINARY };
+
+inline const char* outputModeName(OutputMode mode) {
+    switch (mode) {
+        case OutputMode::JSON: return "json";
+        case OutputMode::BINARY: return "binary";
+        default: return "human";
+    }
+}
+
+inline bool parseOutputMode(std::string_view name, OutputMode& mode) {
+    if (name == "human" || name == "text") {
+        mode = OutputMode::HUMAN;
+    } else if (name == "json") {
+        mode = OutputMode::JSON;
+    } else if (name == "binary") {
+        mode = OutputMode::BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Mode of the session running on this thread. Sessions are the interactive
+// shell, a script, one control-socket connection; jobs and pipeline stages
+// take on the mode of the session that started them.
+inline OutputMode& sessionOutputMode() {
+    static thread_local OutputMode mode = OutputMode::HUMAN;
+    return mode;
+}
+
+inline OutputMode currentOutputMode() {
+    return sessionOutputMode();
+}
+
+// Runs a scope on this thread under another session's mode
+class OutputModeScope {
+private:
+    OutputMode previous_;
+
+public:
+    explicit OutputModeScope(OutputMode mode) : previous_(sessionOutputMode()) {
+        sessionOutputMode() = mode;
+    }
+    ~OutputModeScope() { sessionOutputMode() = previous_; }
+
+    OutputModeScope(const OutputModeScope&) = delete;
+    OutputModeScope& operator=(const OutputModeScope&) = delete;
+};
+
+// What a record describes; the fields that follow depend on it
+enum class RecordKind {
+    HOST,    // addr, state
+    PORT,    // host, port, proto, state, service [, banner]
+    RESULT   // free-form fields from any other stage
+};
+
+inline const char* recordKindName(RecordKind kind) {
+    switch (kind) {
+        case RecordKind::HOST: return "host";
+        case RecordKind::PORT: return "port";
+        default: return "result";
+    }
+}
+
+// One unit passed between pipeline stages: a kind and ordered key/value
+// fields. Records are moved from stage to stage, never re-parsed from text.
+struct Record {
+    RecordKind kind;
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    explicit Record(RecordKind recordKind = RecordKind::RESULT) : kind(recordKind) {}
+
+    const std::string* find(std::string_view key) const {
+        for (const auto& field : fields) {
+            if (field.first == key) {
+                return &field.second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Replaces the value of an existing key, otherwise appends the field
+    Record& set(std::string_view key, std::string value) {
+        for (auto& field : fields) {
+            if (field.first == key) {
+                field.second = std::move(value);
+                return *this;
+            }
+        }
+        fields.emplace_back(std::string(key), std::move(value));
+        return *this;
+    }
+};
+
+// JSON string contents without the quotes, so a string can be built in pieces
+inline void appendJsonEscaped(std::string& out, std::string_view text) {
+    static const char HEX[] = "0123456789abcdef";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[(c >> 4) & 0xf];
+                    out += HEX[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+inline void appendJsonString(std::string& out, std::string_view text) {
+    out += '"';
+    appendJsonEscaped(out, text);
+    out += '"';
+}
+
+// kind followed by key=value pairs; values with spaces or quotes are quoted
+inline void appendRecordText(std::string& out, const Record& record) {
+    out += recordKindName(record.kind);
+    for (const auto& field : record.fields) {
+        out += ' ';
+        out += field.first;
+        out += '=';
+        if (field.second.empty() || field.second.find_first_of(" \t\"") != std::string::npos) {
+            out += '"';
+            for (char c : field.second) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                }
+                out += c;
+            }
+            out += '"';
+        } else {
+            out += field.second;
+        }
+    }
+    out += '\n';
+}
+
+// "type":"port","fields":{"host":"10.0.0.5",...}, the members of a record's
+// JSON object. The fields are nested so that one called "type" (or "event",
+// in an OutputWriter event) cannot repeat a key.
+inline void appendRecordJsonMembers(std::string& out, const Record& record) {
+    out += "\"type\":\"";
+    out += recordKindName(record.kind);
+    out += "\",\"fields\":{";
+    bool first = true;
+    for (const auto& field : record.fields) {
+        if (!first) {
+            out += ',';
+        }
+        appendJsonString(out, field.first);
+        out += ':';
+        appendJsonString(out, field.second);
+        first = false;
+    }
+    out += '}';
+}
+
+// {"type":"port","fields":{...}} on one line
+inline void appendRecordJson(std::string& out, const Record& record) {
+    out += '{';
+    appendRecordJsonMembers(out, record);
+    out += "}\n";
+}
+
+inline void writeRecordText(const Record& record, std::ostream& out) {
+    std::string line;
+    appendRecordText(line, record);
+    out << line;
+}
+
+inline void writeRecordJson(const Record& record, std::ostream& out) {
+    std::string line;
+    appendRecordJson(line, record);
+    out << line;
+}
+
+// Meaning of a message or line; human output picks its colour from it
+enum class Tone : uint8_t {
+    PLAIN,     // neutral text
+    PROGRESS,  // something is starting or under way
+    OK,        // something succeeded or was found
+    WARNING,
+    ERROR,
+    HINT,      // what to try next
+    NOTICE     // job and session notices
+};
+
+inline const char* toneName(Tone tone) {
+    switch (tone) {
+        case Tone::PROGRESS: return "progress";
+        case Tone::OK: return "ok";
+        case Tone::WARNING: return "warning";
+        case Tone::ERROR: return "error";
+        case Tone::HINT: return "hint";
+        case Tone::NOTICE: return "notice";
+        default: return "plain";
+    }
+}
+
+// One cell of a table row: key names it for JSON and binary output, width
+// pads it in human output (negative: right-aligned, 0: no padding)
+struct OutputCell {
+    std::string_view key;
+    std::string_view value;
+    int width;
+};
+
+// Commands describe their output as events and the writer renders them for
+// the session's mode. HUMAN reproduces the kernel's coloured, boxed look;
+// JSON and BINARY carry the same events without any decoration (boxes,
+// colours, blank lines, ASCII art), so scripts read values instead of
+// scraping text. Each event is rendered into one reused buffer and written
+// with a single call, so events from concurrent jobs never interleave.
+//
+// JSON: one object per event, {"event":"field","key":"Used RAM","value":"2150 MB"},
+// with "level" unless the tone is plain. Keys chosen by the caller are nested:
+// a row's cells under "cells", a record's fields under "fields".
+// BINARY: per event, type:u8 tone:u8 and a LEB128 count, then `count`
+// strings each as a LEB128 length and the bytes. The strings are the event's values in the
+// order of the JSON keys (row and record: alternating keys and values).
+class OutputWriter {
+public:
+    enum class Event : uint8_t {
+        TITLE = 1, SECTION, FIELD, ITEM, MESSAGE, LINE, ROW, RECORD, RESULT
+    };
+
+private:
+    std::ostream* out_;
+    OutputMode mode_;
+    std::string buffer_;
+
+    static const char* toneColor(Tone tone) {
+        switch (tone) {
+            case Tone::PROGRESS: return YELLOW;
+            case Tone::OK: return GREEN;
+            case Tone::WARNING: return YELLOW;
+            case Tone::ERROR: return RED;
+            case Tone::HINT: return YELLOW;
+            case Tone::NOTICE: return CYAN;
+            default: return WHITE;
+        }
+    }
+
+    static const char* eventName(Event event) {
+        switch (event) {
+            case Event::TITLE: return "title";
+            case Event::SECTION: return "section";
+            case Event::FIELD: return "field";
+            case Event::ITEM: return "item";
+            case Event::MESSAGE: return "message";
+            case Event::LINE: return "line";
+            case Event::ROW: return "row";
+            case Event::RECORD: return "record";
+            default: return "result";
+        }
+    }
+
+    // Columns a UTF-8 string takes up, for padding
+    static size_t displayWidth(std::string_view text) {
+        size_t width = 0;
+        for (char c : text) {
+            width += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+        }
+        return width;
+    }
+
+    void pad(std::string_view text, int width) {
+        size_t target = static_cast<size_t>(width < 0 ? -width : width);
+        size_t used = displayWidth(text);
+        std::string padding(used < target ? target - used : 0, ' ');
+        if (width < 0) {
+            buffer_ += padding;
+            buffer_ += text;
+        } else {
+            buffer_ += text;
+            buffer_ += padding;
+        }
+    }
+
+    void flush() {
+        out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    // Machine-readable events: `values` pairs a JSON key with each string
+    void machineEvent(Event event, Tone tone, std::initializer_list<std::pair<std::string_view, std::string_view>> values) {
+        if (mode_ == OutputMode::JSON) {
+            jsonBegin(event, tone);
+            for (const auto& value : values) {
+                jsonMember(value.first, value.second);
+            }
+            buffer_ += "}\n";
+        } else {
+            binaryBegin(event, tone, values.size());
+            for (const auto& value : values) {
+                binaryString(value.second);
+            }
+        }
+        flush();
+    }
+
+    void jsonBegin(Event event, Tone tone) {
+        buffer_ += "{\"event\":\"";
+        buffer_ += eventName(event);
+        buffer_ += '"';
+        if (tone != Tone::PLAIN) {
+            buffer_ += ",\"level\":\"";
+            buffer_ += toneName(tone);
+            buffer_ += '"';
+        }
+    }
+
+    void jsonMember(std::string_view key, std::string_view value) {
+        buffer_ += ',';
+        appendJsonString(buffer_, key);
+        buffer_ += ':';
+        appendJsonString(buffer_, value);
+    }
+
+    void binaryBegin(Event event, Tone tone, size_t count) {
+        buffer_ += static_cast<char>(event);
+        buffer_ += static_cast<char>(tone);
+        binaryLength(count);
+    }
+
+    void binaryLength(size_t length) {
+        do {
+            unsigned char byte = length & 0x7f;
+            length >>= 7;
+            buffer_ += static_cast<char>(length ? byte | 0x80 : byte);
+        } while (length);
+    }
+
+    void binaryString(std::string_view value) {
+        binaryLength(value.size());
+        buffer_ += value;
+    }
+
+    // MESSAGE (tag, text) and LINE (text) with the text in pieces
+    void textEvent(Event event, Tone tone, std::string_view tag, std::initializer_list<std::string_view> pieces) {
+        if (mode_ == OutputMode::HUMAN) {
+            buffer_ += toneColor(tone);
+            if (!tag.empty()) {
+                buffer_ += '['; buffer_ += tag; buffer_ += "] ";
+            }
+            for (std::string_view piece : pieces) {
+                buffer_ += piece;
+            }
+            buffer_ += RESET; buffer_ += "\n";
+        } else if (mode_ == OutputMode::JSON) {
+            jsonBegin(event, tone);
+            if (event == Event::MESSAGE) {
+                jsonMember("tag", tag);
+            }
+            buffer_ += ",\"text\":\"";
+            for (std::string_view piece : pieces) {
+                appendJsonEscaped(buffer_, piece);
+            }
+            buffer_ += "\"}\n";
+        } else {
+            size_t length = 0;
+            for (std::string_view piece : pieces) {
+                length += piece.size();
+            }
+            binaryBegin(event, tone, event == Event::MESSAGE ? 2 : 1);
+            if (event == Event::MESSAGE) {
+                binaryString(tag);
+            }
+            binaryLength(length);
+            for (std::string_view piece : pieces) {
+                buffer_ += piece;
+            }
+        }
+        flush();
+    }
+
+public:
+    OutputWriter(std::ostream& out, OutputMode mode) : out_(&out), mode_(mode) {}
+
+    OutputMode mode() const { return mode_; }
+    void setMode(OutputMode mode) { mode_ = mode; }
+    bool human() const { return mode_ == OutputMode::HUMAN; }
+
+    // Boxed report heading
+    void title(std::string_view text, const char* color = CYAN) {
+        if (!human()) {
+            machineEvent(Event::TITLE, Tone::PLAIN, {{"text", text}});
+            return;
+        }
+        static constexpr size_t BOX_WIDTH = 66;
+        std::string rule;
+        for (size_t i = 0; i < BOX_WIDTH; ++i) {
+            rule += "═";
+        }
+        size_t width = displayWidth(text);
+        size_t left = width < BOX_WIDTH ? (BOX_WIDTH - width) / 2 : 0;
+        size_t right = width + left < BOX_WIDTH ? BOX_WIDTH - width - left : 0;
+
+        buffer_ += "\n";
+        buffer_ += BOLD; buffer_ += color; buffer_ += "╔"; buffer_ += rule; buffer_ += "╗"; buffer_ += RESET; buffer_ += "\n";
+        buffer_ += BOLD; buffer_ += color; buffer_ += "║";
+        buffer_.append(left, ' '); buffer_ += text; buffer_.append(right, ' ');
+        buffer_ += "║"; buffer_ += RESET; buffer_ += "\n";
+        buffer_ += BOLD; buffer_ += color; buffer_ += "╚"; buffer_ += rule; buffer_ += "╝"; buffer_ += RESET; buffer_ += "\n\n";
+        flush();
+    }
+
+    // Heading for the lines that follow ("Network Tools:")
+    void section(std::string_view text) {
+        if (!human()) {
+            machineEvent(Event::SECTION, Tone::PLAIN, {{"text", text}});
+            return;
+        }
+        buffer_ += WHITE; buffer_ += text; buffer_ += ":"; buffer_ += RESET; buffer_ += "\n";
+        flush();
+    }
+
+    // "Key:   value", the label padded to `width` columns
+    void field(std::string_view key, std::string_view value, Tone tone = Tone::OK, int width = 15) {
+        if (!human()) {
+            machineEvent(Event::FIELD, tone == Tone::OK ? Tone::PLAIN : tone, {{"key", key}, {"value", value}});
+            return;
+        }
+        buffer_ += WHITE;
+        std::string label(key);
+        label += ": ";
+        pad(label, width);
+        buffer_ += toneColor(tone); buffer_ += value; buffer_ += RESET; buffer_ += "\n";
+        flush();
+    }
+
+    // A name and what it is, as in command and tool lists
+    void item(std::string_view name, std::string_view description, int width = 22) {
+        if (!human()) {
+            machineEvent(Event::ITEM, Tone::PLAIN, {{"name", name}, {"description", description}});
+            return;
+        }
+        buffer_ += GREEN; buffer_ += "  ";
+        pad(name, width);
+        buffer_ += WHITE; buffer_ += " - "; buffer_ += description; buffer_ += RESET; buffer_ += "\n";
+        flush();
+    }
+
+    // "[TAG] text", or just the text without a tag. The text may be given in
+    // pieces ({"Job ", id, " done"}); they are joined straight into the buffer.
+    void message(Tone tone, std::string_view tag, std::initializer_list<std::string_view> text) {
+        textEvent(Event::MESSAGE, tone, tag, text);
+    }
+
+    void message(Tone tone, std::string_view tag, std::string_view text) {
+        textEvent(Event::MESSAGE, tone, tag, {text});
+    }
+
+    // A line of tool output taken as is (a packet, a hop, a response)
+    void line(std::initializer_list<std::string_view> text, Tone tone = Tone::PLAIN) {
+        textEvent(Event::LINE, tone, std::string_view(), text);
+    }
+
+    void line(std::string_view text, Tone tone = Tone::PLAIN) {
+        textEvent(Event::LINE, tone, std::string_view(), {text});
+    }
+
+    // One table row; cells are joined by two spaces in human output
+    void row(std::initializer_list<OutputCell> cells, Tone tone = Tone::PLAIN) {
+        if (mode_ == OutputMode::JSON) {
+            jsonBegin(Event::ROW, tone);
+            buffer_ += ",\"cells\":{";
+            bool first = true;
+            for (const auto& cell : cells) {
+                if (!first) {
+                    buffer_ += ',';
+                }
+                appendJsonString(buffer_, cell.key);
+                buffer_ += ':';
+                appendJsonString(buffer_, cell.value);
+                first = false;
+            }
+            buffer_ += "}}\n";
+        } else if (mode_ == OutputMode::BINARY) {
+            binaryBegin(Event::ROW, tone, cells.size() * 2);
+            for (const auto& cell : cells) {
+                binaryString(cell.key);
+                binaryString(cell.value);
+            }
+        } else {
+            buffer_ += toneColor(tone);
+            bool first = true;
+            for (const auto& cell : cells) {
+                if (!first) {
+                    buffer_ += "  ";
+                }
+                pad(cell.value, cell.width);
+                first = false;
+            }
+            buffer_ += RESET; buffer_ += "\n";
+        }
+        flush();
+    }
+
+    void record(const Record& record) {
+        if (mode_ == OutputMode::JSON) {
+            jsonBegin(Event::RECORD, Tone::PLAIN);
+            buffer_ += ',';
+            appendRecordJsonMembers(buffer_, record);
+            buffer_ += "}\n";
+        } else if (mode_ == OutputMode::BINARY) {
+            binaryBegin(Event::RECORD, Tone::PLAIN, 1 + record.fields.size() * 2);
+            binaryString(recordKindName(record.kind));
+            for (const auto& field : record.fields) {
+                binaryString(field.first);
+                binaryString(field.second);
+            }
+        } else {
+            appendRecordText(buffer_, record);
+        }
+        flush();
+    }
+
+    // How a command ended; only machine-readable sessions get it, people
+    // already see the error message
+    void result(std::string_view command, ErrorCode code) {
+        if (human()) {
+            return;
+        }
+        std::string number = std::to_string(static_cast<int>(code));
+        std::string_view error = code == ErrorCode::SUCCESS ? "" : errorMessage(code);
+        if (mode_ == OutputMode::BINARY) {
+            machineEvent(Event::RESULT, code == ErrorCode::SUCCESS ? Tone::PLAIN : Tone::ERROR,
+                         {{"command", command}, {"code", number}, {"error", error}});
+            return;
+        }
+        // The code is a JSON number so scripts can test it directly
+        jsonBegin(Event::RESULT, Tone::PLAIN);
+        jsonMember("command", command);
+        buffer_ += ",\"code\":";
+        buffer_ += number;
+        jsonMember("error", error);
+        buffer_ += "}\n";
+        flush();
+    }
+
+    // Spacing and art that only people see
+    void blank() {
+        if (human()) {
+            out_->put('\n');
+        }
+    }
+
+    void decoration(std::string_view text) {
+        if (human()) {
+            out_->write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+    }
+};
+
+// This thread's writer for std::cout, in the mode of the session it serves.
+// The buffer lives as long as the thread, so events do not allocate once warm.
+inline OutputWriter& out() {
+    static thread_local OutputWriter writer(std::cout, OutputMode::HUMAN);
+    writer.setMode(currentOutputMode());
+    return writer;
+}
+
+} // namespace Oroto
+
+#endif // OROTO_OUTPUT_WRITER_H
@@ -0,0 +1,30 @@
+#include "plugin_manager.h"
+
+namespace Oroto {
+
+// Global plugin manager instance
+std::unique_ptr<PluginManager> g_pluginManager;
+
+void initializePluginManager() {
+    if (!g_pluginManager) {
+        g_pluginManager = std::make_unique<PluginManager>();
+        LOG_INFO("Global", "Global plugin manager initialized");
+    }
+}
+
+PluginManager& getPluginManager() {
+    if (!g_pluginManager) {
+        initializePluginManager();
+    }
+    return *g_pluginManager;
+}
+
+void shutdownPluginManager() {
+    if (g_pluginManager) {
+        g_pluginManager->unloadAllPlugins();
+        g_pluginManager.reset();
+        LOG_INFO("Global", "Global plugin manager shutdown complete");
+    }
+}
+
+} // namespace Oroto
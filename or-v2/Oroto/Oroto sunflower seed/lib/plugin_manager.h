@@ -7,9 +7,20 @@
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <unordered_set>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
 #include <dlfcn.h>
+#include <dirent.h>
+#include <unistd.h>
 #include "logger.h"
 #include "error_handler.h"
+#include "command_registry.h"
+#include "plugin_manifest.h"
+#include "thread_pool.h"
 
 namespace Oroto {
 
@@ -22,6 +33,10 @@ public:
     virtual std::string getName() const = 0;
     virtual std::string getVersion() const = 0;
     virtual std::string getDescription() const = 0;
+
+    // Called right after a successful initialize(); commands added here are
+    // dispatched by processCommand like built-ins and removed on unload
+    virtual void registerCommands(CommandRegistrar& registrar) { (void)registrar; }
 };
 
 // Plugin metadata
@@ -30,12 +45,16 @@ struct PluginInfo {
     std::string version;
     std::string description;
     std::string filename;
+    std::string path;
     void* handle;
+    // Owns the library: the last reference runs shutdown(), deletes the plugin
+    // and then dlcloses, so plugin code is never unmapped while in use
     std::shared_ptr<IPlugin> instance;
     bool loaded;
     bool initialized;
+    unsigned generation;    // bumped by every hot reload
 
-    PluginInfo() : handle(nullptr), loaded(false), initialized(false) {}
+    PluginInfo() : handle(nullptr), loaded(false), initialized(false), generation(0) {}
 };
 
 // Plugin factory function type
@@ -45,11 +64,15 @@ typedef void (*DestroyPluginFunc)(IPlugin*);
 class PluginManager {
 private:
     std::unordered_map<std::string, std::unique_ptr<PluginInfo>> plugins_;
+    std::unordered_map<std::string, PluginInfo*> plugins_by_name_;
     std::vector<std::string> search_paths_;
+    std::string manifest_path_;
+    CommandRegistry& registry_;
     mutable std::mutex plugin_mutex_;
 
 public:
-    PluginManager() {
+    explicit PluginManager(CommandRegistry& registry = getCommandRegistry())
+        : manifest_path_("oroto_plugins.manifest"), registry_(registry) {
         // Default search paths
         search_paths_.push_back("./plugins/");
         search_paths_.push_back("/usr/local/lib/oroto/plugins/");
@@ -67,118 +90,241 @@ public:
         LOG_INFO("PluginManager", "Added search path: " + path);
     }
 
-    // Load plugin from file
+    // Load plugin from file (a name in the search paths, or a path)
     bool loadPlugin(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(plugin_mutex_);
-        
-        std::string full_path = findPluginFile(filename);
+        std::string full_path;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            full_path = findPluginFile(filename);
+        }
         if (full_path.empty()) {
             LOG_ERROR("PluginManager", "Plugin file not found: " + filename);
             return false;
         }
+        return loadPluginAt(filename, full_path);
+    }
 
-        // Check if already loaded
-        if (plugins_.find(filename) != plugins_.end()) {
-            LOG_WARNING("PluginManager", "Plugin already loaded: " + filename);
-            return true;
+    // Find plugin libraries (*.so) in every search path, one scan per path in
+    // parallel. Earlier search paths win when the same file name appears twice.
+    // Returns (key, path) pairs where key is the file name used by unloadPlugin.
+    std::vector<std::pair<std::string, std::string>> discoverPlugins(ThreadPool& pool) const {
+        std::vector<std::string> paths;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            paths = search_paths_;
         }
 
-        auto plugin_info = std::make_unique<PluginInfo>();
-        plugin_info->filename = filename;
+        std::vector<std::vector<std::string>> found(paths.size());
+        pool.parallelFor(paths.size(), [&paths, &found](size_t i) {
+            DIR* dir = opendir(paths[i].c_str());
+            if (!dir) {
+                return;
+            }
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.size() > 3 && name.compare(name.size() - 3, 3, ".so") == 0) {
+                    found[i].push_back(name);
+                }
+            }
+            closedir(dir);
+            std::sort(found[i].begin(), found[i].end());
+        });
+
+        std::vector<std::pair<std::string, std::string>> result;
+        std::unordered_set<std::string> seen;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::string dir = paths[i];
+            if (!dir.empty() && dir.back() != '/') {
+                dir += '/';
+            }
+            for (const auto& name : found[i]) {
+                if (seen.insert(name).second) {
+                    result.emplace_back(name, dir + name);
+                }
+            }
+        }
+        return result;
+    }
 
-        // Load shared library
-        plugin_info->handle = dlopen(full_path.c_str(), RTLD_LAZY);
-        if (!plugin_info->handle) {
-            LOG_ERROR("PluginManager", "Failed to load plugin " + filename + ": " + dlerror());
-            return false;
+    // Boot-time load of every discovered plugin. dlopen and initialize() run
+    // on the thread pool; the manifest lets unchanged libraries that failed
+    // before be skipped without touching them. Returns the number loaded.
+    size_t loadAllPlugins(ThreadPool& pool) {
+        auto start = std::chrono::steady_clock::now();
+        auto candidates = discoverPlugins(pool);
+
+        PluginManifest manifest(manifest_path_);
+        manifest.load();
+
+        std::vector<PluginManifestEntry> stamps(candidates.size());
+        std::vector<size_t> pending;
+        std::unordered_set<std::string> seenPaths;
+        std::unordered_set<std::string> cachedNames;
+        size_t skipped = 0;
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (!PluginManifest::stampFile(candidates[i].second, stamps[i])) {
+                continue;
+            }
+            seenPaths.insert(stamps[i].path);
+
+            const PluginManifestEntry* cached = manifest.findUnchanged(stamps[i]);
+            if (cached && !cached->loadable) {
+                LOG_INFO("PluginManager", "Skipping " + candidates[i].first + " (failed to load, unchanged since)");
+                ++skipped;
+                continue;
+            }
+            // A known name already provided by an earlier search path would be rejected after dlopen
+            if (cached && !cached->name.empty() && !cachedNames.insert(cached->name).second) {
+                LOG_INFO("PluginManager", "Skipping " + candidates[i].first + " (duplicate of plugin " + cached->name + ")");
+                manifest.update(*cached);
+                ++skipped;
+                continue;
+            }
+            pending.push_back(i);
         }
 
-        // Get factory function
-        CreatePluginFunc create_func = (CreatePluginFunc)dlsym(plugin_info->handle, "createPlugin");
-        if (!create_func) {
-            LOG_ERROR("PluginManager", "Plugin " + filename + " missing createPlugin function");
-            dlclose(plugin_info->handle);
-            return false;
+        std::vector<char> loaded(pending.size(), 0);
+        pool.parallelFor(pending.size(), [&](size_t n) {
+            const auto& candidate = candidates[pending[n]];
+            loaded[n] = loadPluginAt(candidate.first, candidate.second) ? 1 : 0;
+        });
+
+        size_t loadedCount = 0;
+        for (size_t n = 0; n < pending.size(); ++n) {
+            PluginManifestEntry entry = stamps[pending[n]];
+            entry.loadable = loaded[n] != 0;
+            if (entry.loadable) {
+                ++loadedCount;
+                std::lock_guard<std::mutex> lock(plugin_mutex_);
+                auto it = plugins_.find(candidates[pending[n]].first);
+                if (it != plugins_.end()) {
+                    entry.name = it->second->name;
+                    entry.version = it->second->version;
+                    entry.description = it->second->description;
+                }
+            }
+            manifest.update(entry);
         }
 
-        // Create plugin instance
-        try {
-            auto plugin_instance = create_func();
-            if (!plugin_instance) {
-                LOG_ERROR("PluginManager", "Failed to create plugin instance: " + filename);
-                dlclose(plugin_info->handle);
+        manifest.retainOnly(seenPaths);
+        if (!candidates.empty()) {
+            manifest.save();
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("PluginManager", "Loaded " + std::to_string(loadedCount) + " of " +
+                std::to_string(candidates.size()) + " plugins (" + std::to_string(skipped) +
+                " skipped via manifest) in " + std::to_string(elapsed) + "ms");
+        return loadedCount;
+    }
+
+    void setManifestPath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(plugin_mutex_);
+        manifest_path_ = path;
+    }
+
+    // Unload plugin. Its commands disappear at once; calls already running in
+    // it finish first, and the library is closed when the last one returns.
+    bool unloadPlugin(const std::string& filename) {
+        std::unique_ptr<PluginInfo> removed;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+
+            auto it = plugins_.find(filename);
+            if (it == plugins_.end()) {
+                LOG_WARNING("PluginManager", "Plugin not loaded: " + filename);
                 return false;
             }
 
-            plugin_info->instance = std::move(plugin_instance);
-            plugin_info->name = plugin_info->instance->getName();
-            plugin_info->version = plugin_info->instance->getVersion();
-            plugin_info->description = plugin_info->instance->getDescription();
-            plugin_info->loaded = true;
+            removed = std::move(it->second);
+            plugins_.erase(it);
+            forgetName(*removed);
+        }
 
-            // Initialize plugin
-            if (plugin_info->instance->initialize()) {
-                plugin_info->initialized = true;
-                LOG_INFO("PluginManager", "Successfully loaded and initialized plugin: " + 
-                        plugin_info->name + " v" + plugin_info->version);
-            } else {
-                LOG_WARNING("PluginManager", "Plugin loaded but failed to initialize: " + filename);
-            }
+        bool inUse = removed->instance.use_count() > 1;
+        LOG_INFO("PluginManager", "Unloaded plugin: " + filename +
+                (inUse ? " (still in use, released when its calls finish)" : ""));
+        return true;
+    }
 
-            plugins_[filename] = std::move(plugin_info);
-            return true;
+    // Hot reload: load the current file next to the running version, switch
+    // commands and getPlugin() over to it in one step, then drop the old one.
+    // Calls already running in the old version (e.g. a long scan) finish on it,
+    // and its library is unmapped once the last of them returns. If the new
+    // version fails to load or initialize, the old one keeps serving.
+    bool reloadPlugin(const std::string& filename) {
+        std::string full_path;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            auto it = plugins_.find(filename);
+            if (it == plugins_.end()) {
+                LOG_WARNING("PluginManager", "Plugin not loaded: " + filename);
+                return false;
+            }
+            full_path = it->second->path;
+        }
 
-        } catch (const std::exception& e) {
-            LOG_ERROR("PluginManager", "Exception while loading plugin " + filename + ": " + e.what());
-            dlclose(plugin_info->handle);
+        // dlopen hands back the mapped library for a path it already knows, so
+        // the new version is loaded from a private copy of the file
+        std::string copy_path = makeReloadCopy(full_path);
+        if (copy_path.empty()) {
+            LOG_ERROR("PluginManager", "Cannot stage new version of " + filename + " from " + full_path);
             return false;
         }
-    }
-
-    // Unload plugin
-    bool unloadPlugin(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(plugin_mutex_);
-        
-        auto it = plugins_.find(filename);
-        if (it == plugins_.end()) {
-            LOG_WARNING("PluginManager", "Plugin not loaded: " + filename);
+        auto fresh = openPlugin(filename, copy_path);
+        unlink(copy_path.c_str());
+        if (!fresh) {
             return false;
         }
-
-        auto& plugin_info = it->second;
-        
-        try {
-            if (plugin_info->initialized && plugin_info->instance) {
-                plugin_info->instance->shutdown();
-                plugin_info->initialized = false;
+        if (!fresh->initialized) {
+            LOG_ERROR("PluginManager", "New version of " + filename + " failed to initialize, keeping the running one");
+            return false;
+        }
+        fresh->path = full_path;
+
+        // Commands are collected now and published together with the swap below
+        CommandRegistrar registrar(registry_, fresh->name, fresh->instance, true);
+        fresh->instance->registerCommands(registrar);
+
+        std::unique_ptr<PluginInfo> retired;
+        std::string summary;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            auto it = plugins_.find(filename);
+            if (it == plugins_.end()) {
+                LOG_WARNING("PluginManager", "Plugin " + filename + " was unloaded during reload");
+                return false;
             }
-
-            if (plugin_info->handle) {
-                dlclose(plugin_info->handle);
-                plugin_info->handle = nullptr;
+            auto clash = plugins_by_name_.find(fresh->name);
+            if (clash != plugins_by_name_.end() && clash->second != it->second.get()) {
+                LOG_WARNING("PluginManager", "Plugin name " + fresh->name + " is taken by " + clash->second->filename);
+                return false;
             }
 
-            LOG_INFO("PluginManager", "Unloaded plugin: " + filename);
-            plugins_.erase(it);
-            return true;
+            retired = std::move(it->second);
+            forgetName(*retired, false);
+            registrar.commit(retired->initialized ? retired->name : fresh->name);
 
-        } catch (const std::exception& e) {
-            LOG_ERROR("PluginManager", "Exception while unloading plugin " + filename + ": " + e.what());
-            return false;
+            fresh->generation = retired->generation + 1;
+            plugins_by_name_[fresh->name] = fresh.get();
+            summary = fresh->name + " v" + retired->version + " -> v" + fresh->version +
+                      " (generation " + std::to_string(fresh->generation) + ")";
+            it->second = std::move(fresh);
         }
+
+        LOG_INFO("PluginManager", "Reloaded plugin " + summary);
+        return true;
     }
 
-    // Get plugin by name
+    // Get plugin by name. The returned plugin stays usable, with its library
+    // mapped, until the caller drops it, even across an unload or reload.
     std::shared_ptr<IPlugin> getPlugin(const std::string& name) const {
         std::lock_guard<std::mutex> lock(plugin_mutex_);
         
-        for (const auto& [filename, plugin_info] : plugins_) {
-            if (plugin_info->name == name && plugin_info->initialized) {
-                return plugin_info->instance;
-            }
-        }
-        
-        return nullptr;
+        auto it = plugins_by_name_.find(name);
+        return (it != plugins_by_name_.end()) ? it->second->instance : nullptr;
     }
 
     // List all loaded plugins
@@ -192,6 +338,8 @@ public:
             info.version = plugin_info->version;
             info.description = plugin_info->description;
             info.filename = plugin_info->filename;
+            info.path = plugin_info->path;
+            info.generation = plugin_info->generation;
             info.loaded = plugin_info->loaded;
             info.initialized = plugin_info->initialized;
             result.push_back(info);
@@ -202,31 +350,183 @@ public:
 
     // Unload all plugins
     void unloadAllPlugins() {
-        std::lock_guard<std::mutex> lock(plugin_mutex_);
-        
-        LOG_INFO("PluginManager", "Unloading all plugins");
-        
-        for (auto& [filename, plugin_info] : plugins_) {
-            try {
-                if (plugin_info->initialized && plugin_info->instance) {
-                    plugin_info->instance->shutdown();
+        std::unordered_map<std::string, std::unique_ptr<PluginInfo>> removed;
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+
+            LOG_INFO("PluginManager", "Unloading all plugins");
+            for (auto& [filename, plugin_info] : plugins_) {
+                forgetName(*plugin_info);
+            }
+            removed.swap(plugins_);
+        }
+        // Plugins shut down and close here, outside the lock
+        removed.clear();
+    }
+
+private:
+    // dlopen, construction, initialize() and registerCommands() run without
+    // plugin_mutex_ so several plugins can load at once. The commands are
+    // staged and published under the lock together with the insert, so an
+    // unload can never run between the two and leave them orphaned.
+    bool loadPluginAt(const std::string& filename, const std::string& full_path) {
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            if (plugins_.find(filename) != plugins_.end()) {
+                LOG_WARNING("PluginManager", "Plugin already loaded: " + filename);
+                return true;
+            }
+        }
+
+        auto plugin_info = openPlugin(filename, full_path);
+        if (!plugin_info) {
+            return false;
+        }
+        plugin_info->path = full_path;
+
+        std::string name = plugin_info->name;
+        std::string version = plugin_info->version;
+        bool initialized = plugin_info->initialized;
+        CommandRegistrar registrar(registry_, name, plugin_info->instance, true);
+        if (initialized) {
+            plugin_info->instance->registerCommands(registrar);
+        }
+        {
+            std::lock_guard<std::mutex> lock(plugin_mutex_);
+            bool duplicate = plugins_.count(filename) != 0 ||
+                (initialized && plugins_by_name_.count(name) != 0);
+            if (!duplicate) {
+                if (initialized) {
+                    plugins_by_name_[name] = plugin_info.get();
+                    registrar.commit(name);
                 }
-                if (plugin_info->handle) {
-                    dlclose(plugin_info->handle);
+                plugins_[filename] = std::move(plugin_info);
+            }
+        }
+
+        // Lost a race with another load of the same file or plugin name;
+        // dropping it shuts the plugin down and closes the library
+        if (plugin_info) {
+            LOG_WARNING("PluginManager", "Plugin " + name + " already loaded, discarding " + full_path);
+            return false;
+        }
+
+        if (initialized) {
+            LOG_INFO("PluginManager", "Successfully loaded and initialized plugin: " + 
+                    name + " v" + version);
+        }
+        return true;
+    }
+
+    // dlopen the library, then create and initialize its plugin. The library
+    // handle is owned by the instance's deleter (see PluginInfo::instance).
+    std::unique_ptr<PluginInfo> openPlugin(const std::string& filename, const std::string& load_path) {
+        void* handle = dlopen(load_path.c_str(), RTLD_LAZY);
+        if (!handle) {
+            LOG_ERROR("PluginManager", "Failed to load plugin " + filename + ": " + dlerror());
+            return nullptr;
+        }
+        std::shared_ptr<void> library(handle, [](void* h) { dlclose(h); });
+
+        // Get factory function
+        CreatePluginFunc create_func = (CreatePluginFunc)dlsym(handle, "createPlugin");
+        if (!create_func) {
+            LOG_ERROR("PluginManager", "Plugin " + filename + " missing createPlugin function");
+            return nullptr;
+        }
+
+        auto plugin_info = std::make_unique<PluginInfo>();
+        plugin_info->filename = filename;
+        plugin_info->handle = handle;
+
+        // Create and initialize plugin instance
+        std::unique_ptr<IPlugin> plugin_instance;
+        try {
+            plugin_instance = create_func();
+            if (!plugin_instance) {
+                LOG_ERROR("PluginManager", "Failed to create plugin instance: " + filename);
+                return nullptr;
+            }
+
+            plugin_info->name = plugin_instance->getName();
+            plugin_info->version = plugin_instance->getVersion();
+            plugin_info->description = plugin_instance->getDescription();
+            plugin_info->loaded = true;
+
+            plugin_info->initialized = plugin_instance->initialize();
+            if (!plugin_info->initialized) {
+                LOG_WARNING("PluginManager", "Plugin loaded but failed to initialize: " + filename);
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("PluginManager", "Exception while loading plugin " + filename + ": " + e.what());
+            // The instance's destructor lives in the library, release it first
+            plugin_instance.reset();
+            return nullptr;
+        }
+
+        bool initialized = plugin_info->initialized;
+        std::string label = plugin_info->name + " v" + plugin_info->version;
+        plugin_info->instance = std::shared_ptr<IPlugin>(plugin_instance.release(),
+            [library, initialized, label](IPlugin* plugin) {
+                try {
+                    if (initialized) {
+                        plugin->shutdown();
+                    }
+                } catch (const std::exception& e) {
+                    LOG_ERROR("PluginManager", "Exception while shutting down plugin " + label + ": " + e.what());
                 }
-            } catch (const std::exception& e) {
-                LOG_ERROR("PluginManager", "Error unloading plugin " + filename + ": " + e.what());
+                delete plugin;
+                LOG_INFO("PluginManager", "Released plugin " + label);
+                // library is released with this deleter, after the plugin is gone
+            });
+        return plugin_info;
+    }
+
+    // Caller holds plugin_mutex_. Drops the name index entry and, if
+    // dropCommands, the registry commands that belong to this plugin.
+    void forgetName(const PluginInfo& info, bool dropCommands = true) {
+        if (!info.initialized) {
+            return;
+        }
+        auto it = plugins_by_name_.find(info.name);
+        if (it != plugins_by_name_.end() && it->second == &info) {
+            plugins_by_name_.erase(it);
+            if (dropCommands) {
+                registry_.unregisterOwner(info.name);
             }
         }
-        
-        plugins_.clear();
     }
 
-private:
+    // Copy a plugin file to a fresh temporary path; empty on failure
+    static std::string makeReloadCopy(const std::string& path) {
+        const char* tmp = std::getenv("TMPDIR");
+        std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/oroto-plugin-XXXXXX";
+        std::vector<char> name(pattern.begin(), pattern.end());
+        name.push_back('\0');
+
+        int fd = mkstemp(name.data());
+        if (fd < 0) {
+            return "";
+        }
+        close(fd);
+
+        std::ifstream in(path, std::ios::binary);
+        std::ofstream out(name.data(), std::ios::binary | std::ios::trunc);
+        if (in && out) {
+            out << in.rdbuf();
+            out.close();
+        }
+        if (!in || out.fail()) {
+            unlink(name.data());
+            return "";
+        }
+        return std::string(name.data());
+    }
+
     std::string findPluginFile(const std::string& filename) const {
-        // Try absolute path first
-        if (filename[0] == '/') {
-            return filename;
+        // Paths are used as given
+        if (filename.find('/') != std::string::npos) {
+            return access(filename.c_str(), F_OK) == 0 ? filename : "";
         }
         
         // Search in all search paths
@@ -241,6 +541,18 @@ private:
     }
 };
 
+// Global plugin manager instance
+extern std::unique_ptr<PluginManager> g_pluginManager;
+
+// Initialize global plugin manager
+void initializePluginManager();
+
+// Get global plugin manager
+PluginManager& getPluginManager();
+
+// Unload all plugins and destroy the global plugin manager
+void shutdownPluginManager();
+
 } // namespace Oroto
 
 // Macros for plugin creation
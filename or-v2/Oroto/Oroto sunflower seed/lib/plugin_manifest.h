@@ -0,0 +1,156 @@
+
+#ifndef OROTO_PLUGIN_MANIFEST_H
+#define OROTO_PLUGIN_MANIFEST_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <sys/stat.h>
+#include "logger.h"
+
+namespace Oroto {
+
+// What the last boot learned about one plugin file
+struct PluginManifestEntry {
+    std::string path;
+    int64_t mtimeNs;
+    uint64_t size;
+    uint64_t inode;
+    bool loadable;
+    std::string name;
+    std::string version;
+    std::string description;
+
+    PluginManifestEntry() : mtimeNs(0), size(0), inode(0), loadable(false) {}
+
+    bool sameFileAs(const PluginManifestEntry& other) const {
+        return mtimeNs == other.mtimeNs && size == other.size && inode == other.inode;
+    }
+};
+
+// On-disk cache of plugin metadata keyed by path and file identity
+// (mtime, size, inode). A file whose identity is unchanged since the last boot
+// is not re-probed: libraries that failed to load are skipped without dlopen.
+class PluginManifest {
+private:
+    static constexpr const char* HEADER = "# oroto plugin manifest v1";
+
+    std::string path_;
+    std::unordered_map<std::string, PluginManifestEntry> entries_;
+
+    // Tabs and newlines delimit fields and records
+    static std::string sanitize(const std::string& text) {
+        std::string clean = text;
+        for (char& c : clean) {
+            if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+        return clean;
+    }
+
+public:
+    explicit PluginManifest(const std::string& path) : path_(path) {}
+
+    // Fill path and file identity from stat(); false if the file is gone
+    static bool stampFile(const std::string& path, PluginManifestEntry& entry) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return false;
+        }
+        entry.path = path;
+        entry.mtimeNs = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+        entry.size = static_cast<uint64_t>(info.st_size);
+        entry.inode = static_cast<uint64_t>(info.st_ino);
+        return true;
+    }
+
+    bool load() {
+        std::ifstream in(path_);
+        if (!in) {
+            return false;
+        }
+
+        std::string line;
+        if (!std::getline(in, line) || line != HEADER) {
+            LOG_WARNING("PluginManifest", "Ignoring manifest with unknown format: " + path_);
+            return false;
+        }
+
+        entries_.clear();
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            PluginManifestEntry entry;
+            std::string mtime, size, inode, loadable;
+            if (!std::getline(fields, entry.path, '\t') || !std::getline(fields, mtime, '\t') ||
+                !std::getline(fields, size, '\t') || !std::getline(fields, inode, '\t') ||
+                !std::getline(fields, loadable, '\t')) {
+                continue;
+            }
+            std::getline(fields, entry.name, '\t');
+            std::getline(fields, entry.version, '\t');
+            std::getline(fields, entry.description);
+
+            try {
+                entry.mtimeNs = std::stoll(mtime);
+                entry.size = std::stoull(size);
+                entry.inode = std::stoull(inode);
+            } catch (const std::exception&) {
+                continue;
+            }
+            entry.loadable = (loadable == "1");
+            entries_[entry.path] = std::move(entry);
+        }
+        return true;
+    }
+
+    bool save() const {
+        // Write a sibling file and rename so a crash never leaves a torn manifest
+        std::string temp = path_ + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            if (!out) {
+                LOG_WARNING("PluginManifest", "Cannot write manifest: " + temp);
+                return false;
+            }
+            out << HEADER << "\n";
+            for (const auto& [path, entry] : entries_) {
+                out << sanitize(entry.path) << '\t' << entry.mtimeNs << '\t' << entry.size << '\t'
+                    << entry.inode << '\t' << (entry.loadable ? '1' : '0') << '\t'
+                    << sanitize(entry.name) << '\t' << sanitize(entry.version) << '\t'
+                    << sanitize(entry.description) << "\n";
+            }
+            if (!out) {
+                return false;
+            }
+        }
+        return std::rename(temp.c_str(), path_.c_str()) == 0;
+    }
+
+    // Cached entry for this file if its identity has not changed, else nullptr
+    const PluginManifestEntry* findUnchanged(const PluginManifestEntry& stamp) const {
+        auto it = entries_.find(stamp.path);
+        return (it != entries_.end() && it->second.sameFileAs(stamp)) ? &it->second : nullptr;
+    }
+
+    void update(const PluginManifestEntry& entry) {
+        entries_[entry.path] = entry;
+    }
+
+    // Forget files that were not seen during this discovery pass
+    void retainOnly(const std::unordered_set<std::string>& paths) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            it = paths.count(it->first) ? std::next(it) : entries_.erase(it);
+        }
+    }
+
+    size_t size() const { return entries_.size(); }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_PLUGIN_MANIFEST_H
@@ -0,0 +1,10 @@
+#include "potfile.h"
+
+namespace Oroto {
+
+Potfile& getPotfile() {
+    static Potfile potfile;
+    return potfile;
+}
+
+} // namespace Oroto
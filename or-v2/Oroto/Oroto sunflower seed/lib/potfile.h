@@ -0,0 +1,455 @@
+#ifndef OROTO_POTFILE_H
+#define OROTO_POTFILE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "expected.h"
+#include "hex.h"
+#include "logger.h"
+
+namespace Oroto {
+
+struct PotEntry {
+    std::string hash;        // as the cracker prints it: lower-case hex
+    std::string plaintext;
+};
+
+// Every hash ever cracked, shared by all crack jobs and processes that open
+// the same file. The log is the usual "<hash>:<plaintext>\n" potfile, with
+// plaintexts that would not survive a text line (control bytes, non-ASCII)
+// written as $HEX[...]. The sidecar index (<path>.idx) is an open-addressing
+// table of {64-bit key of the hash, line offset + 1} slots behind a small
+// header, kept at most half full. Both files are memory-mapped, so a lookup
+// is a probe or two plus a look at one log line, with no read() and no
+// parsing of the rest of the file.
+//
+// Appends take an exclusive flock() on the log, write all their lines with
+// one write() and fill the index slots in the shared mapping, so concurrent
+// jobs never interleave or lose entries. When the table needs to grow it is
+// rebuilt into a new file that is renamed over the old one; other processes
+// notice the new inode and reopen it. Lines the index does not cover (after
+// a crash between the two writes, or a deleted index) are indexed the next
+// time the file is opened or appended to.
+class Potfile {
+private:
+    static constexpr uint64_t MAGIC = 0x31764f50544f524fULL;   // "OROTPOv1"
+    static constexpr uint64_t MIN_SLOTS = 1024;
+
+    struct Header {
+        uint64_t magic;
+        uint64_t slots;          // a power of two
+        uint64_t count;
+        uint64_t indexedEnd;     // log offset just past the last indexed line
+    };
+
+    struct Slot {
+        uint64_t key;
+        uint64_t offset;         // line start + 1; 0 marks an empty slot
+    };
+
+    std::string path_;
+    int logFd_;
+    int indexFd_;
+    ino_t indexInode_;
+    const char* log_;
+    size_t logSize_;
+    Header* header_;             // start of the index mapping
+    size_t indexBytes_;
+    mutable std::mutex mutex_;
+
+    static void unmap(const void* data, size_t size) {
+        if (data && size > 0) {
+            ::munmap(const_cast<void*>(data), size);
+        }
+    }
+
+    static size_t fileSize(int fd) {
+        struct stat info;
+        return ::fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+    }
+
+    static bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // FNV-1a; hashes are hex digests, so their bits are already well mixed
+    static uint64_t keyOf(std::string_view hash) {
+        uint64_t key = 0xcbf29ce484222325ULL;
+        for (unsigned char c : hash) {
+            key = (key ^ c) * 0x100000001b3ULL;
+        }
+        return key;
+    }
+
+    static bool plainByte(unsigned char c) { return c >= 0x20 && c < 0x7f; }
+
+    static std::string encodePlaintext(std::string_view plaintext) {
+        bool plain = plaintext.substr(0, 5) != "$HEX[";
+        for (unsigned char c : plaintext) {
+            plain = plain && plainByte(c);
+        }
+        if (plain) {
+            return std::string(plaintext);
+        }
+        return "$HEX[" + toHex(reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size()) + "]";
+    }
+
+    static bool decodePlaintext(std::string_view text, std::string& plaintext) {
+        if (text.size() < 6 || text.substr(0, 5) != "$HEX[" || text.back() != ']') {
+            plaintext.assign(text);
+            return true;
+        }
+        std::string_view hex = text.substr(5, text.size() - 6);
+        plaintext.assign(hex.size() / 2, '\0');
+        return parseHex(hex, reinterpret_cast<uint8_t*>(plaintext.data()), plaintext.size());
+    }
+
+    Slot* slots() const { return reinterpret_cast<Slot*>(header_ + 1); }
+
+    // The line starting at offset, without its newline; empty if the offset
+    // is outside the mapping
+    std::string_view lineAt(size_t offset) const {
+        if (offset >= logSize_) {
+            return {};
+        }
+        const void* newline = std::memchr(log_ + offset, '\n', logSize_ - offset);
+        size_t end = newline ? static_cast<const char*>(newline) - log_ : logSize_;
+        return std::string_view(log_ + offset, end - offset);
+    }
+
+    // Offset + 1 of the line recording hash, or 0
+    uint64_t findLine(std::string_view hash) const {
+        if (!header_) {
+            return 0;
+        }
+        uint64_t key = keyOf(hash);
+        uint64_t mask = header_->slots - 1;
+        const Slot* table = slots();
+        for (uint64_t slot = key & mask;; slot = (slot + 1) & mask) {
+            uint64_t offset = __atomic_load_n(&table[slot].offset, __ATOMIC_ACQUIRE);
+            if (offset == 0) {
+                return 0;
+            }
+            if (table[slot].key != key) {
+                continue;
+            }
+            std::string_view line = lineAt(offset - 1);
+            if (line.size() > hash.size() && line[hash.size()] == ':' && line.substr(0, hash.size()) == hash) {
+                return offset;
+            }
+        }
+    }
+
+    // The key goes in first and the offset is published last, so a lookup
+    // without the flock never follows a half-written slot
+    static void place(Slot* table, uint64_t mask, uint64_t key, uint64_t offset) {
+        uint64_t slot = key & mask;
+        while (table[slot].offset != 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot].key = key;
+        __atomic_store_n(&table[slot].offset, offset, __ATOMIC_RELEASE);
+    }
+
+    bool remapLog() {
+        size_t size = fileSize(logFd_);
+        if (size == logSize_) {
+            return true;
+        }
+        unmap(log_, logSize_);
+        log_ = nullptr;
+        logSize_ = 0;
+        if (size > 0) {
+            void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, logFd_, 0);
+            if (data == MAP_FAILED) {
+                return false;
+            }
+            log_ = static_cast<const char*>(data);
+            logSize_ = size;
+        }
+        return true;
+    }
+
+    void closeIndex() {
+        unmap(header_, indexBytes_);
+        if (indexFd_ >= 0) {
+            ::close(indexFd_);
+        }
+        indexFd_ = -1;
+        indexInode_ = 0;
+        header_ = nullptr;
+        indexBytes_ = 0;
+    }
+
+    // Maps <path>.idx as it is on disk; header_ stays null when the file is
+    // missing, empty or not a valid index
+    bool openIndex() {
+        closeIndex();
+        indexFd_ = ::open((path_ + ".idx").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        struct stat info;
+        if (indexFd_ < 0 || ::fstat(indexFd_, &info) != 0) {
+            return false;
+        }
+        indexInode_ = info.st_ino;
+        size_t size = static_cast<size_t>(info.st_size);
+        if (size < sizeof(Header)) {
+            return true;
+        }
+        void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, indexFd_, 0);
+        if (data == MAP_FAILED) {
+            return true;
+        }
+        Header* header = static_cast<Header*>(data);
+        uint64_t slots = header->slots;
+        bool valid = header->magic == MAGIC && slots >= MIN_SLOTS && (slots & (slots - 1)) == 0 &&
+                     size == sizeof(Header) + slots * sizeof(Slot);
+        if (!valid) {
+            ::munmap(data, size);
+            return true;
+        }
+        header_ = header;
+        indexBytes_ = size;
+        return true;
+    }
+
+    // True once another process has renamed a rebuilt index over ours
+    bool indexReplaced() const {
+        struct stat info;
+        return ::stat((path_ + ".idx").c_str(), &info) == 0 && info.st_ino != indexInode_;
+    }
+
+    // Picks up other jobs' appends and rebuilt indexes without the flock
+    void refresh() {
+        if (indexFd_ < 0 || indexReplaced()) {
+            openIndex();
+        }
+        remapLog();
+    }
+
+    // Writes a table of `slots` holding every entry of the current one (if
+    // any) to a sibling file and renames it over the index; caller holds
+    // the flock
+    bool rebuild(uint64_t slots) {
+        std::string temp = path_ + ".idx.tmp";
+        int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        size_t size = sizeof(Header) + slots * sizeof(Slot);
+        if (fd < 0) {
+            return false;
+        }
+        void* data = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            std::remove(temp.c_str());
+            return false;
+        }
+        Header* header = static_cast<Header*>(data);
+        Slot* table = reinterpret_cast<Slot*>(header + 1);
+        header->magic = MAGIC;
+        header->slots = slots;
+        header->count = 0;
+        header->indexedEnd = 0;
+        if (header_) {
+            const Slot* old = this->slots();
+            for (uint64_t i = 0; i < header_->slots; ++i) {
+                if (old[i].offset != 0) {
+                    place(table, slots - 1, old[i].key, old[i].offset);
+                }
+            }
+            header->count = header_->count;
+            header->indexedEnd = header_->indexedEnd;
+        }
+        if (std::rename(temp.c_str(), (path_ + ".idx").c_str()) != 0) {
+            ::munmap(data, size);
+            ::close(fd);
+            std::remove(temp.c_str());
+            return false;
+        }
+        closeIndex();
+        struct stat info;
+        indexFd_ = fd;
+        indexInode_ = ::fstat(fd, &info) == 0 ? info.st_ino : 0;
+        header_ = header;
+        indexBytes_ = size;
+        return true;
+    }
+
+    // Indexes complete lines past header_->indexedEnd, growing the table as
+    // needed; a hash already indexed keeps its first line. Caller holds the
+    // flock.
+    bool catchUp() {
+        refresh();
+        if (!header_) {
+            if (fileSize(indexFd_) > 0) {
+                LOG_WARNING("Potfile", "Index of " + path_ + " is not valid; rebuilding");
+            }
+            if (!rebuild(MIN_SLOTS)) {
+                return false;
+            }
+        }
+        if (header_->indexedEnd > logSize_) {
+            // Log truncated by hand: every offset is suspect
+            unmap(header_, indexBytes_);
+            header_ = nullptr;
+            indexBytes_ = 0;
+            if (!rebuild(MIN_SLOTS)) {
+                return false;
+            }
+        }
+        size_t pos = header_->indexedEnd;
+        while (pos < logSize_) {
+            const void* newline = std::memchr(log_ + pos, '\n', logSize_ - pos);
+            if (!newline) {
+                break;   // a line still being written
+            }
+            size_t next = static_cast<const char*>(newline) - log_ + 1;
+            std::string_view line(log_ + pos, next - pos - 1);
+            size_t colon = line.find(':');
+            if (colon != std::string_view::npos && colon > 0 && findLine(line.substr(0, colon)) == 0) {
+                if ((header_->count + 1) * 2 > header_->slots && !rebuild(header_->slots * 2)) {
+                    return false;
+                }
+                place(slots(), header_->slots - 1, keyOf(line.substr(0, colon)), pos + 1);
+                ++header_->count;
+            }
+            pos = next;
+        }
+        header_->indexedEnd = pos;
+        return true;
+    }
+
+    void closeFiles() {
+        closeIndex();
+        unmap(log_, logSize_);
+        if (logFd_ >= 0) {
+            ::close(logFd_);
+        }
+        logFd_ = -1;
+        log_ = nullptr;
+        logSize_ = 0;
+    }
+
+public:
+    Potfile() : logFd_(-1), indexFd_(-1), indexInode_(0), log_(nullptr), logSize_(0), header_(nullptr),
+                indexBytes_(0) {}
+
+    ~Potfile() { closeFiles(); }
+
+    Potfile(const Potfile&) = delete;
+    Potfile& operator=(const Potfile&) = delete;
+
+    Status open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closeFiles();
+        path_ = path;
+        logFd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+        if (logFd_ < 0) {
+            LOG_WARNING("Potfile", "Cannot open " + path + ": " + std::strerror(errno));
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        ::flock(logFd_, LOCK_EX);
+        bool indexed = catchUp();
+        ::flock(logFd_, LOCK_UN);
+        if (!indexed) {
+            LOG_WARNING("Potfile", "Cannot index " + path);
+            closeFiles();
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        return ok();
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return logFd_ >= 0;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        return header_ ? static_cast<size_t>(header_->count) : 0;
+    }
+
+    bool lookup(std::string_view hash, std::string& plaintext) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        uint64_t offset = findLine(hash);
+        return offset != 0 && decodePlaintext(lineAt(offset - 1).substr(hash.size() + 1), plaintext);
+    }
+
+    // Looks up every hash with a single refresh and calls
+    // found(index, plaintext) for each one on file; returns how many were
+    template <typename Found>
+    size_t lookupAll(const std::vector<std::string>& hashes, Found&& found) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        size_t hits = 0;
+        std::string plaintext;
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            uint64_t offset = findLine(hashes[i]);
+            if (offset != 0 && decodePlaintext(lineAt(offset - 1).substr(hashes[i].size() + 1), plaintext)) {
+                found(i, plaintext);
+                ++hits;
+            }
+        }
+        return hits;
+    }
+
+    // Adds the entries whose hash is not on file yet, as one write. Hashes
+    // must be non-empty and free of ':' and line breaks.
+    Status append(const std::vector<PotEntry>& entries) {
+        for (const PotEntry& entry : entries) {
+            if (entry.hash.empty() || entry.hash.find_first_of(":\r\n") != std::string::npos) {
+                return makeError(ErrorCode::INVALID_ARGUMENTS);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (logFd_ < 0) {
+            return makeError(ErrorCode::FILE_NOT_FOUND);
+        }
+        ::flock(logFd_, LOCK_EX);
+        bool written = catchUp();
+        // Finish a line left incomplete by a crash so the new ones stay whole
+        std::string lines = written && logSize_ > 0 && log_[logSize_ - 1] != '\n' ? "\n" : "";
+        std::unordered_set<std::string_view> batch;
+        for (size_t i = 0; written && i < entries.size(); ++i) {
+            if (findLine(entries[i].hash) == 0 && batch.insert(entries[i].hash).second) {
+                lines += entries[i].hash + ":" + encodePlaintext(entries[i].plaintext) + "\n";
+            }
+        }
+        written = written && writeAll(logFd_, lines.data(), lines.size()) && catchUp();
+        ::flock(logFd_, LOCK_UN);
+        return written ? ok() : makeError(ErrorCode::INTERNAL_ERROR);
+    }
+};
+
+// The potfile the crack commands share (opened by the kernel at startup)
+Potfile& getPotfile();
+
+} // namespace Oroto
+
+#endif // OROTO_POTFILE_H
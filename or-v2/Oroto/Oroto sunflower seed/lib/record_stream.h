@@ -0,0 +1,241 @@
+#ifndef OROTO_RECORD_STREAM_H
+#define OROTO_RECORD_STREAM_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "oroto_shell.h"
+#include "expected.h"
+#include "command_registry.h"
+#include "job_output.h"
+#include "output_writer.h"
+#include "thread_pool.h"
+
+namespace Oroto {
+
+// Bounded queue between two adjacent stages. push() blocks while the queue is
+// full, which is what throttles a fast producer to its consumer's pace.
+// Either side can close it: the writer when it has no more records, the
+// reader when it wants no more (after which push() returns false and the
+// producer should stop). Waits wake up regularly to honour job cancellation.
+class RecordQueue {
+private:
+    std::deque<Record> records_;
+    size_t capacity_;
+    bool writerClosed_;
+    bool readerClosed_;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+
+    static constexpr std::chrono::milliseconds CANCEL_POLL{100};
+
+public:
+    explicit RecordQueue(size_t capacity)
+        : capacity_(capacity == 0 ? 1 : capacity), writerClosed_(false), readerClosed_(false) {}
+
+    RecordQueue(const RecordQueue&) = delete;
+    RecordQueue& operator=(const RecordQueue&) = delete;
+
+    bool push(Record&& record) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!readerClosed_ && records_.size() >= capacity_) {
+            if (notFull_.wait_for(lock, CANCEL_POLL) == std::cv_status::timeout) {
+                ThreadPool::cancellationPoint();
+            }
+        }
+        if (readerClosed_) {
+            return false;
+        }
+        records_.push_back(std::move(record));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // False once the writer has closed and every record has been taken
+    bool pop(Record& record) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (records_.empty() && !writerClosed_) {
+            if (notEmpty_.wait_for(lock, CANCEL_POLL) == std::cv_status::timeout) {
+                ThreadPool::cancellationPoint();
+            }
+        }
+        if (records_.empty()) {
+            return false;
+        }
+        record = std::move(records_.front());
+        records_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void closeWriter() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writerClosed_ = true;
+        notEmpty_.notify_all();
+    }
+
+    // Drops anything still queued; the writer's next push() fails
+    void closeReader() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readerClosed_ = true;
+        records_.clear();
+        notFull_.notify_all();
+    }
+
+    size_t capacity() const { return capacity_; }
+};
+
+// A stage's view of the pipeline. The first stage has no input; the last one
+// has no downstream queue, so what it emits is written to the terminal as
+// record events in the session's output mode.
+class RecordStream {
+private:
+    RecordQueue* input_;
+    RecordQueue* output_;
+    std::ostream& terminal_;
+    OutputWriter writer_;
+
+public:
+    RecordStream(RecordQueue* input, RecordQueue* output, std::ostream& terminal)
+        : input_(input), output_(output), terminal_(terminal), writer_(terminal, currentOutputMode()) {}
+
+    bool hasInput() const { return input_ != nullptr; }
+    bool isLast() const { return output_ == nullptr; }
+    std::ostream& terminal() { return terminal_; }
+
+    // False at the end of the input (at once for the first stage)
+    bool next(Record& record) {
+        return input_ && input_->pop(record);
+    }
+
+    // False when the rest of the pipeline has stopped reading: the stage
+    // should return ok() without producing anything more
+    bool emit(Record record) {
+        if (output_) {
+            return output_->push(std::move(record));
+        }
+        writer_.record(record);
+        return true;
+    }
+};
+
+struct PipelineStage {
+    const CommandArgs* args;
+    CommandStreamHandler handler;
+};
+
+// Runs the stages concurrently, linked by bounded queues. Every stage but the
+// last gets a thread of its own: stages block on their queues, so sharing a
+// fixed-size pool could leave a consumer waiting for a worker held by its own
+// producer. The last stage runs on the calling thread. Helper threads take on
+// the caller's job (for kill), output capture (for background jobs) and
+// output mode.
+//
+// When a stage returns, its input is closed so everything upstream winds
+// down, and its output is closed so the next stage sees the end. The result
+// is the status of the last stage that failed, like a shell's pipefail.
+// If the calling job was killed, JobCancelled is thrown once all stages stop.
+inline Status runPipeline(const std::vector<PipelineStage>& stages, std::ostream& terminal,
+                          size_t queueCapacity = 64) {
+    const size_t count = stages.size();
+    if (count == 0) {
+        return ok();
+    }
+
+    std::vector<std::unique_ptr<RecordQueue>> queues;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        queues.push_back(std::make_unique<RecordQueue>(queueCapacity));
+    }
+    std::vector<Status> results(count, ok());
+
+    auto runStage = [&](size_t index) {
+        RecordQueue* input = index > 0 ? queues[index - 1].get() : nullptr;
+        RecordQueue* output = index + 1 < count ? queues[index].get() : nullptr;
+        RecordStream stream(input, output, terminal);
+        try {
+            results[index] = stages[index].handler(*stages[index].args, stream);
+        } catch (const JobCancelled&) {
+            results[index] = makeError(ErrorCode::CANCELLED);
+        } catch (const OrotoException& e) {
+            results[index] = makeError(e.getCode());
+        } catch (const std::exception& e) {
+            LOG_ERROR("Pipeline", "Stage " + std::to_string(index + 1) + " threw: " + e.what());
+            results[index] = makeError(ErrorCode::INTERNAL_ERROR);
+        } catch (...) {
+            LOG_ERROR("Pipeline", "Stage " + std::to_string(index + 1) + " threw an unknown exception");
+            results[index] = makeError(ErrorCode::INTERNAL_ERROR);
+        }
+        if (input) {
+            input->closeReader();
+        }
+        if (output) {
+            output->closeWriter();
+        }
+    };
+
+    // Joins the helpers however this function is left. If starting one of
+    // them threw, every queue is closed first so the started stages return
+    // instead of waiting on a neighbour that never ran.
+    struct StageThreads {
+        std::vector<std::unique_ptr<RecordQueue>>& queues;
+        std::vector<std::thread> threads;
+
+        void join() {
+            for (auto& thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+
+        ~StageThreads() {
+            if (std::none_of(threads.begin(), threads.end(), [](const std::thread& t) { return t.joinable(); })) {
+                return;
+            }
+            for (auto& queue : queues) {
+                queue->closeReader();
+                queue->closeWriter();
+            }
+            join();
+        }
+    } helpers{queues, {}};
+
+    JobInfo* job = ThreadPool::runningJob();
+    JobOutput* capture = OutputRouter::current();
+    OutputMode mode = currentOutputMode();
+    helpers.threads.reserve(count - 1);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        helpers.threads.emplace_back([&runStage, i, job, capture, mode]() {
+            ThreadPool::adoptJob(job);
+            OutputCapture scope(capture);
+            OutputModeScope modeScope(mode);
+            runStage(i);
+        });
+    }
+    runStage(count - 1);
+    helpers.join();
+
+    // Whichever stage noticed a kill first, the job itself ends as cancelled
+    ThreadPool::cancellationPoint();
+    for (size_t i = count; i-- > 0;) {
+        if (!results[i]) {
+            return results[i];
+        }
+    }
+    return ok();
+}
+
+} // namespace Oroto
+
+#endif // OROTO_RECORD_STREAM_H
@@ -0,0 +1,208 @@
+#ifndef OROTO_SHA_H
+#define OROTO_SHA_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "hex.h"
+
+namespace Oroto {
+
+using Sha1Digest = std::array<uint8_t, 20>;
+using Sha256Digest = std::array<uint8_t, 32>;
+
+// Buffering and Merkle-Damgard padding shared by SHA-1 and SHA-256 (FIPS
+// 180-4); Derived supplies the state size, the initial values and compress().
+// Both store words and the bit length big-endian.
+template <class Derived, size_t WORDS>
+class ShaBase {
+protected:
+    uint32_t state_[WORDS];
+    uint8_t buffer_[64];
+    uint64_t length_;
+
+    static uint32_t load(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+               static_cast<uint32_t>(p[2]) << 8 | static_cast<uint32_t>(p[3]);
+    }
+
+    static void store(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    static uint32_t rotl(uint32_t x, int c) { return (x << c) | (x >> (32 - c)); }
+    static uint32_t rotr(uint32_t x, int c) { return (x >> c) | (x << (32 - c)); }
+
+    ShaBase() : length_(0) { Derived::reset(state_); }
+
+public:
+    using Digest = std::array<uint8_t, 4 * WORDS>;
+
+    void update(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        size_t used = static_cast<size_t>(length_ % 64);
+        length_ += size;
+        if (used > 0) {
+            size_t take = size < 64 - used ? size : 64 - used;
+            std::memcpy(buffer_ + used, bytes, take);
+            bytes += take;
+            size -= take;
+            if (used + take < 64) {
+                return;
+            }
+            Derived::compress(state_, buffer_);
+        }
+        for (; size >= 64; bytes += 64, size -= 64) {
+            Derived::compress(state_, bytes);
+        }
+        std::memcpy(buffer_, bytes, size);
+    }
+
+    void update(std::string_view text) { update(text.data(), text.size()); }
+
+    Digest finish() {
+        uint64_t bits = length_ * 8;
+        size_t used = static_cast<size_t>(length_ % 64);
+        buffer_[used++] = 0x80;
+        if (used > 56) {
+            std::memset(buffer_ + used, 0, 64 - used);
+            Derived::compress(state_, buffer_);
+            used = 0;
+        }
+        std::memset(buffer_ + used, 0, 56 - used);
+        for (int i = 0; i < 8; ++i) {
+            buffer_[63 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        Derived::compress(state_, buffer_);
+        Digest digest;
+        for (size_t i = 0; i < WORDS; ++i) {
+            store(digest.data() + 4 * i, state_[i]);
+        }
+        Derived::reset(state_);
+        length_ = 0;
+        return digest;
+    }
+
+    static Digest digest(std::string_view text) {
+        Derived hash;
+        hash.update(text);
+        return hash.finish();
+    }
+};
+
+class Sha1 : public ShaBase<Sha1, 5> {
+public:
+    static void reset(uint32_t state[5]) {
+        state[0] = 0x67452301;
+        state[1] = 0xefcdab89;
+        state[2] = 0x98badcfe;
+        state[3] = 0x10325476;
+        state[4] = 0xc3d2e1f0;
+    }
+
+    static void compress(uint32_t state[5], const uint8_t block[64]) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = load(block + 4 * i);
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = d ^ (b & (c ^ d));
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (d & (b | c));
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+};
+
+class Sha256 : public ShaBase<Sha256, 8> {
+public:
+    static constexpr uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    static void reset(uint32_t state[8]) {
+        state[0] = 0x6a09e667;
+        state[1] = 0xbb67ae85;
+        state[2] = 0x3c6ef372;
+        state[3] = 0xa54ff53a;
+        state[4] = 0x510e527f;
+        state[5] = 0x9b05688c;
+        state[6] = 0x1f83d9ab;
+        state[7] = 0x5be0cd19;
+    }
+
+    static void compress(uint32_t state[8], const uint8_t block[64]) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = load(block + 4 * i);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + (g ^ (e & (f ^ g))) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) | (c & (a | b)));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+};
+
+} // namespace Oroto
+
+#endif // OROTO_SHA_H
@@ -12,8 +12,11 @@
 #include <atomic>
 #include <chrono>
 #include <unordered_map>
+#include <algorithm>
+#include <exception>
 #include "logger.h"
 #include "error_handler.h"
+#include "job_output.h"
 
 namespace Oroto {
 
@@ -26,18 +29,35 @@ enum class JobStatus {
     CANCELLED
 };
 
-// Job information structure
+// Job information structure. status is written by the worker and read by the
+// shell, so it is atomic; the other fields are final once status is.
 struct JobInfo {
     size_t id;
     std::string name;
-    JobStatus status;
+    std::atomic<JobStatus> status;
+    std::atomic<bool> cancelRequested;
     std::chrono::steady_clock::time_point startTime;
     std::chrono::steady_clock::time_point endTime;
     std::string result;
     std::string error;
+    ErrorCode errorCode;
+    // Set for jobs submitted with submitCapturedJob
+    std::shared_ptr<JobOutput> output;
 
     JobInfo(size_t jobId, const std::string& jobName) 
-        : id(jobId), name(jobName), status(JobStatus::PENDING) {}
+        : id(jobId), name(jobName), status(JobStatus::PENDING), cancelRequested(false),
+          startTime(std::chrono::steady_clock::now()), errorCode(ErrorCode::SUCCESS) {}
+
+    bool finished() const {
+        JobStatus current = status.load();
+        return current != JobStatus::PENDING && current != JobStatus::RUNNING;
+    }
+};
+
+// Thrown by ThreadPool::cancellationPoint() inside a job that was killed
+class JobCancelled : public std::runtime_error {
+public:
+    JobCancelled() : std::runtime_error("Job cancelled") {}
 };
 
 class ThreadPool {
@@ -52,16 +72,154 @@ private:
     // Job tracking
     std::unordered_map<size_t, std::shared_ptr<JobInfo>> jobs_;
     std::mutex jobsMutex_;
+    std::condition_variable jobFinished_;
+    // Workers blocked in helpUntil(), which also wait on condition_
+    std::atomic<size_t> helpers_;
+
+    // Job running on this thread, for cancellationPoint()
+    static JobInfo*& currentJob() {
+        static thread_local JobInfo* job = nullptr;
+        return job;
+    }
+
+    // Pool this thread is a worker of, if any
+    static ThreadPool*& workerOf() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    // A job changed state; wake workers that run tasks while waiting on it.
+    // Taking the queue lock orders this against their predicate check.
+    void notifyHelpers() {
+        if (helpers_.load() > 0) {
+            { std::lock_guard<std::mutex> lock(queueMutex_); }
+            condition_.notify_all();
+        }
+    }
+
+    void finishJob(JobInfo& jobInfo, JobStatus status) {
+        jobInfo.endTime = std::chrono::steady_clock::now();
+        if (jobInfo.output) {
+            jobInfo.output->close();
+        }
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            jobInfo.status = status;
+        }
+        jobFinished_.notify_all();
+        notifyHelpers();
+    }
+
+    // Runs queued tasks on this worker until done() holds. A worker that just
+    // blocked on a job could be holding the very thread that job is queued
+    // for; with every worker doing so nothing would run at all. Returns false
+    // once the queue is empty during shutdown, leaving the caller to block.
+    template<typename Done>
+    bool helpUntil(Done done) {
+        ++helpers_;
+        bool satisfied = false;
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex_);
+                condition_.wait(lock, [&] { return done() || !tasks_.empty() || stop_.load(); });
+                if (done()) {
+                    satisfied = true;
+                    break;
+                }
+                if (tasks_.empty()) {
+                    break;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+        --helpers_;
+        return satisfied;
+    }
+
+    // Track a job and queue its body; the wrapper records the outcome
+    size_t enqueueJob(std::shared_ptr<JobInfo> jobInfo, std::function<void()> body) {
+        size_t jobId = jobInfo->id;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            jobs_[jobId] = jobInfo;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            
+            if (stop_.load()) {
+                OROTO_THROW(ErrorCode::INTERNAL_ERROR, "ThreadPool", 
+                           "Cannot submit job to stopped thread pool");
+            }
+            
+            tasks_.emplace([body = std::move(body), jobInfo, this]() {
+                // Killed while still queued
+                JobStatus expected = JobStatus::PENDING;
+                if (!jobInfo->status.compare_exchange_strong(expected, JobStatus::RUNNING)) {
+                    return;
+                }
+                notifyHelpers();
+                jobInfo->startTime = std::chrono::steady_clock::now();
+                // A worker waiting on another job may run this one nested
+                JobInfo* outerJob = currentJob();
+                currentJob() = jobInfo.get();
+                OutputCapture capture(jobInfo->output.get());
+                
+                JobStatus outcome = JobStatus::COMPLETED;
+                try {
+                    body();
+                    jobInfo->result = "Job completed successfully";
+                    LOG_INFO("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
+                            " (" + jobInfo->name + ") completed");
+                } catch (const JobCancelled&) {
+                    outcome = JobStatus::CANCELLED;
+                    LOG_INFO("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
+                            " (" + jobInfo->name + ") stopped after cancellation");
+                } catch (const OrotoException& e) {
+                    outcome = JobStatus::FAILED;
+                    jobInfo->error = e.what();
+                    jobInfo->errorCode = e.getCode();
+                    LOG_ERROR("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
+                             " (" + jobInfo->name + ") failed: " + e.what());
+                } catch (const std::exception& e) {
+                    outcome = JobStatus::FAILED;
+                    jobInfo->error = e.what();
+                    jobInfo->errorCode = ErrorCode::INTERNAL_ERROR;
+                    LOG_ERROR("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
+                             " (" + jobInfo->name + ") failed: " + e.what());
+                } catch (...) {
+                    outcome = JobStatus::FAILED;
+                    jobInfo->error = "Unknown error";
+                    jobInfo->errorCode = ErrorCode::INTERNAL_ERROR;
+                    LOG_ERROR("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
+                             " (" + jobInfo->name + ") failed with unknown error");
+                }
+                
+                currentJob() = outerJob;
+                finishJob(*jobInfo, outcome);
+            });
+        }
+        
+        condition_.notify_one();
+        LOG_INFO("ThreadPool", "Submitted job " + std::to_string(jobId) + 
+                " (" + jobInfo->name + ") to thread pool");
+        
+        return jobId;
+    }
 
 public:
     explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency()) 
-        : stop_(false), nextJobId_(1) {
+        : stop_(false), nextJobId_(1), helpers_(0) {
         
         LOG_INFO("ThreadPool", "Initializing thread pool with " + 
                 std::to_string(numThreads) + " threads");
         
         for (size_t i = 0; i < numThreads; ++i) {
             workers_.emplace_back([this] {
+                workerOf() = this;
                 while (true) {
                     std::function<void()> task;
                     
@@ -94,61 +252,129 @@ public:
     size_t submitJob(const std::string& jobName, F&& f, Args&&... args) {
         using ReturnType = typename std::result_of<F(Args...)>::type;
         
-        size_t jobId = nextJobId_++;
-        auto jobInfo = std::make_shared<JobInfo>(jobId, jobName);
-        
-        {
-            std::lock_guard<std::mutex> lock(jobsMutex_);
-            jobs_[jobId] = jobInfo;
-        }
-        
         auto task = std::make_shared<std::packaged_task<ReturnType()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...)
         );
         
-        auto future = task->get_future();
-        
+        return enqueueJob(std::make_shared<JobInfo>(nextJobId_++, jobName), [task]() {
+            (*task)();
+            // packaged_task stores exceptions in its future; surface them to the job status
+            task->get_future().get();
+        });
+    }
+
+    // Submit a job whose std::cout output goes to its own JobOutput (see
+    // installOutputRouter) instead of the terminal
+    size_t submitCapturedJob(const std::string& jobName, std::function<void()> body) {
+        auto jobInfo = std::make_shared<JobInfo>(nextJobId_++, jobName);
+        jobInfo->output = std::make_shared<JobOutput>();
+        return enqueueJob(std::move(jobInfo), std::move(body));
+    }
+
+    // Called from long-running job code: throws JobCancelled once the job has
+    // been killed. A no-op outside pool jobs.
+    static void cancellationPoint() {
+        JobInfo* job = currentJob();
+        if (job && job->cancelRequested.load(std::memory_order_relaxed)) {
+            throw JobCancelled();
+        }
+    }
+
+    // Job whose cancellation this thread observes. A job that starts helper
+    // threads of its own passes it to adoptJob() on each of them, so killing
+    // the job stops the helpers at their cancellation points too.
+    static JobInfo* runningJob() { return currentJob(); }
+    static void adoptJob(JobInfo* job) { currentJob() = job; }
+
+    // Queue a task without job tracking, for short units of work (such as one
+    // control-socket request) that would otherwise flood the jobs list
+    void submitTask(std::function<void()> task) {
         {
             std::unique_lock<std::mutex> lock(queueMutex_);
-            
             if (stop_.load()) {
                 OROTO_THROW(ErrorCode::INTERNAL_ERROR, "ThreadPool", 
-                           "Cannot submit job to stopped thread pool");
+                           "Cannot submit task to stopped thread pool");
             }
-            
-            tasks_.emplace([task, jobInfo, this]() {
-                jobInfo->status = JobStatus::RUNNING;
-                jobInfo->startTime = std::chrono::steady_clock::now();
-                
+            tasks_.emplace(std::move(task));
+        }
+        condition_.notify_one();
+    }
+
+    // Run fn(0) .. fn(count - 1) across the pool and wait for all of them.
+    // The calling thread claims indices too, so this cannot deadlock when it is
+    // itself a pool job or every worker is busy; idle workers just speed it up.
+    // The first exception thrown by fn is rethrown here once all indices finish.
+    void parallelFor(size_t count, std::function<void(size_t)> fn) {
+        if (count == 0) {
+            return;
+        }
+
+        struct State {
+            std::function<void(size_t)> fn;
+            size_t count;
+            std::atomic<size_t> next;
+            size_t done;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+
+        auto state = std::make_shared<State>();
+        state->fn = std::move(fn);
+        state->count = count;
+        state->next = 0;
+        state->done = 0;
+
+        // Helpers that start after all work is claimed exit without touching fn
+        auto drain = [state]() {
+            size_t completed = 0;
+            for (size_t i = state->next++; i < state->count; i = state->next++) {
                 try {
-                    (*task)();
-                    jobInfo->status = JobStatus::COMPLETED;
-                    jobInfo->result = "Job completed successfully";
-                    LOG_INFO("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
-                            " (" + jobInfo->name + ") completed");
-                } catch (const std::exception& e) {
-                    jobInfo->status = JobStatus::FAILED;
-                    jobInfo->error = e.what();
-                    LOG_ERROR("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
-                             " (" + jobInfo->name + ") failed: " + e.what());
+                    state->fn(i);
                 } catch (...) {
-                    jobInfo->status = JobStatus::FAILED;
-                    jobInfo->error = "Unknown error";
-                    LOG_ERROR("ThreadPool", "Job " + std::to_string(jobInfo->id) + 
-                             " (" + jobInfo->name + ") failed with unknown error");
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
                 }
-                
-                jobInfo->endTime = std::chrono::steady_clock::now();
-            });
+                ++completed;
+            }
+            if (completed > 0) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done += completed;
+                if (state->done == state->count) {
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min(workers_.size(), count - 1);
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            if (stop_.load()) {
+                helpers = 0;
+            }
+            for (size_t i = 0; i < helpers; ++i) {
+                tasks_.emplace(drain);
+            }
+        }
+        if (helpers == 1) {
+            condition_.notify_one();
+        } else if (helpers > 1) {
+            condition_.notify_all();
+        }
+
+        drain();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state] { return state->done == state->count; });
+        if (state->error) {
+            std::rethrow_exception(state->error);
         }
-        
-        condition_.notify_one();
-        LOG_INFO("ThreadPool", "Submitted job " + std::to_string(jobId) + 
-                " (" + jobName + ") to thread pool");
-        
-        return jobId;
     }
 
+    size_t workerCount() const { return workers_.size(); }
+
     // Get job information
     std::shared_ptr<JobInfo> getJobInfo(size_t jobId) {
         std::lock_guard<std::mutex> lock(jobsMutex_);
@@ -166,18 +392,55 @@ public:
         return result;
     }
 
-    // Cancel a job (if not started yet)
+    // Cancel a job. A queued job never starts; a running one stops at its
+    // next cancellationPoint(). False if the job is unknown or already finished.
     bool cancelJob(size_t jobId) {
-        std::lock_guard<std::mutex> lock(jobsMutex_);
-        auto it = jobs_.find(jobId);
-        if (it != jobs_.end() && it->second->status == JobStatus::PENDING) {
-            it->second->status = JobStatus::CANCELLED;
+        std::shared_ptr<JobInfo> job = getJobInfo(jobId);
+        if (!job) {
+            return false;
+        }
+        job->cancelRequested = true;
+
+        JobStatus expected = JobStatus::PENDING;
+        if (job->status.compare_exchange_strong(expected, JobStatus::CANCELLED)) {
+            // The queued wrapper sees CANCELLED and returns without running
+            finishJob(*job, JobStatus::CANCELLED);
             LOG_INFO("ThreadPool", "Cancelled job " + std::to_string(jobId));
             return true;
         }
+        if (expected == JobStatus::RUNNING) {
+            LOG_INFO("ThreadPool", "Requested cancellation of running job " + std::to_string(jobId));
+            return true;
+        }
         return false;
     }
 
+    // Block until the job finishes; nullptr if it is unknown. Called from
+    // one of this pool's workers (a control-socket 'wait'), the worker runs
+    // queued tasks meanwhile, as parallelFor does.
+    std::shared_ptr<JobInfo> waitJob(size_t jobId) {
+        std::shared_ptr<JobInfo> job = getJobInfo(jobId);
+        if (!job) {
+            return nullptr;
+        }
+        if (workerOf() == this && helpUntil([&job] { return job->finished(); })) {
+            return job;
+        }
+        std::unique_lock<std::mutex> lock(jobsMutex_);
+        jobFinished_.wait(lock, [&job] { return job->finished(); });
+        return job;
+    }
+
+    // Block until the job has left the queue, so that following its output
+    // cannot wait on a job that never starts; nullptr if it is unknown
+    std::shared_ptr<JobInfo> waitJobStarted(size_t jobId) {
+        std::shared_ptr<JobInfo> job = getJobInfo(jobId);
+        if (job && workerOf() == this) {
+            helpUntil([&job] { return job->status.load() != JobStatus::PENDING; });
+        }
+        return job;
+    }
+
     // Remove completed jobs from tracking
     void cleanupJobs() {
         std::lock_guard<std::mutex> lock(jobsMutex_);
@@ -4,18 +4,34 @@
 #include "lib/error_handler.h"
 #include "lib/resource_manager.h"
 #include "lib/thread_pool.h"
+#include "lib/plugin_manager.h"
+#include "lib/batch_runner.h"
+#include "lib/control_server.h"
+#include "lib/boot_graph.h"
+#include "lib/output_writer.h"
+#include "lib/command_history.h"
+#include "lib/line_editor.h"
+#include "lib/crack_session.h"
+#include "lib/potfile.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
 #include <chrono>
 #include <thread>
 #include <cstdlib>
+#include <atomic>
+#include <pthread.h>
 #include <signal.h>
 #include <unistd.h>
 
 extern void initCommandParser();
-extern void processCommand(const std::string& command);
+extern void registerBuiltinCommands();
+extern Oroto::Status processCommand(const std::string& command);
 extern void initSystemCalls();
 extern void initDeviceInterface();
 extern void shutdownSystem();
@@ -34,10 +50,20 @@ private:
     std::string kernelVersion;
     std::map<std::string, std::string> systemInfo;
     std::unique_ptr<Oroto::ResourceManager<std::string>> resourceManager;
+    // Time spent in initializeKernel, reported with the first fast boot
+    double coreInitMs;
+    // Format of command output (-o); the interactive boot screen stays human
+    Oroto::OutputMode outputMode;
+    // The server runServer is serving, for interrupt()
+    std::atomic<Oroto::ControlServer*> server_{nullptr};
+    std::atomic<bool> interrupted_{false};
 
 public:
-    OrotoKernel() : systemRunning(false), kernelVersion("3.2.1") {
+    OrotoKernel() : systemRunning(false), kernelVersion("3.2.1"), coreInitMs(0.0),
+                    outputMode(Oroto::OutputMode::HUMAN) {
+        auto start = std::chrono::steady_clock::now();
         initializeKernel();
+        coreInitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 
     ~OrotoKernel() {
@@ -53,6 +79,19 @@ public:
 
             Oroto::ErrorHandler::initialize();
             Oroto::initializeThreadPool(std::thread::hardware_concurrency());
+            Oroto::initializePluginManager();
+            registerBuiltinCommands();
+            Oroto::getPluginManager().loadAllPlugins(Oroto::getThreadPool());
+
+            // Shared by every session; a kernel without history still runs
+            const char* historyPath = getenv("OROTO_HISTORY");
+            if (!Oroto::getCommandHistory().open(historyPath && *historyPath ? historyPath : "oroto_history")) {
+                LOG_WARNING("Kernel", "Command history disabled");
+            }
+            const char* potfilePath = getenv("OROTO_POTFILE");
+            if (!Oroto::getPotfile().open(potfilePath && *potfilePath ? potfilePath : "oroto.potfile")) {
+                LOG_WARNING("Kernel", "Potfile disabled");
+            }
 
             LOG_INFO("Kernel", "Oroto Kernel v" + kernelVersion + " initialization started");
 
@@ -94,6 +133,7 @@ public:
                     resourceManager->clearResources();
                 }
 
+                Oroto::shutdownPluginManager();
                 Oroto::shutdownThreadPool();
                 Oroto::Logger::shutdown();
 
@@ -107,71 +147,83 @@ public:
         try {
             LOG_INFO("Kernel", "Starting boot sequence");
 
-            // Check for headless mode
-            bool headless = (getenv("OROTO_HEADLESS") != nullptr);
-            
-            if (!headless) {
-                clearScreen();
-                showKernelHeader();
-            } else {
-                std::cout << YELLOW << "[KERNEL] Starting in headless mode" << RESET << "\n";
+            if (Oroto::isFastBoot()) {
+                fastBootSequence();
+                systemRunning = true;
+                LOG_INFO("Kernel", "Fast boot completed successfully");
+                return;
             }
 
-            std::cout << YELLOW << "[KERNEL] Initializing Oroto Kernel v" << kernelVersion << RESET << "\n";
+            // Batch runs boot silently: stdout carries only command output
+            const bool batch = Oroto::isBatchMode();
+            bool headless = batch || (getenv("OROTO_HEADLESS") != nullptr);
             
-            // Debug: Check environment variables
-            std::cout << YELLOW << "[DEBUG] OROTO_HEADLESS=" << (getenv("OROTO_HEADLESS") ? getenv("OROTO_HEADLESS") : "NOT_SET") << RESET << "\n";
-            std::cout << YELLOW << "[DEBUG] CI=" << (getenv("CI") ? getenv("CI") : "NOT_SET") << RESET << "\n";
-            std::cout << YELLOW << "[DEBUG] isatty(STDIN_FILENO)=" << isatty(STDIN_FILENO) << RESET << "\n";
+            if (!batch) {
+                if (!headless) {
+                    clearScreen();
+                    showKernelHeader();
+                } else {
+                    std::cout << YELLOW << "[KERNEL] Starting in headless mode" << RESET << "\n";
+                }
+
+                std::cout << YELLOW << "[KERNEL] Initializing Oroto Kernel v" << kernelVersion << RESET << "\n";
+                
+                // Debug: Check environment variables
+                std::cout << YELLOW << "[DEBUG] OROTO_HEADLESS=" << (getenv("OROTO_HEADLESS") ? getenv("OROTO_HEADLESS") : "NOT_SET") << RESET << "\n";
+                std::cout << YELLOW << "[DEBUG] CI=" << (getenv("CI") ? getenv("CI") : "NOT_SET") << RESET << "\n";
+                std::cout << YELLOW << "[DEBUG] isatty(STDIN_FILENO)=" << isatty(STDIN_FILENO) << RESET << "\n";
+            }
             
             simulateLoading(400);
 
-            std::cout << GREEN << "[KERNEL] Loading command parser module..." << RESET << "\n";
+            bootMessage("[KERNEL] Loading command parser module...");
             if (!Oroto::ErrorHandler::safeExecute([]() { initCommandParser(); }, "CommandParser")) {
                 throw std::runtime_error("Failed to initialize command parser");
             }
             simulateLoading(300);
 
-            std::cout << GREEN << "[KERNEL] Loading system calls..." << RESET << "\n";
+            bootMessage("[KERNEL] Loading system calls...");
             if (!Oroto::ErrorHandler::safeExecute([]() { initSystemCalls(); }, "SystemCalls")) {
                 throw std::runtime_error("Failed to initialize system calls");
             }
             simulateLoading(300);
 
-            std::cout << GREEN << "[KERNEL] Initializing device interface..." << RESET << "\n";
+            bootMessage("[KERNEL] Initializing device interface...");
             if (!Oroto::ErrorHandler::safeExecute([]() { initDeviceInterface(); }, "DeviceInterface")) {
                 throw std::runtime_error("Failed to initialize device interface");
             }
             simulateLoading(400);
 
-            std::cout << GREEN << "[KERNEL] Loading security tools..." << RESET << "\n";
+            bootMessage("[KERNEL] Loading security tools...");
             simulateLoading(500);
 
-            // Initialize UI system with timeout protection
-            std::cout << GREEN << "[KERNEL] Initializing UI system..." << RESET << "\n";
-            std::cerr << "[DEBUG] Starting UI subsystem\n";
-            try {
-                UI::start(headless);
+            // Initialize UI system with timeout protection; batch runs have no screen to set up
+            if (!batch) {
+                try {
+                    std::cout << GREEN << "[KERNEL] Initializing UI system..." << RESET << "\n";
+                    std::cerr << "[DEBUG] Starting UI subsystem\n";
+                    UI::start(headless);
                 
-                // Only wait for UI if not in headless mode, with timeout
-                if (!headless) {
-                    auto timeout_start = std::chrono::steady_clock::now();
-                    while (!UI::ready()) {
-                        auto elapsed = std::chrono::steady_clock::now() - timeout_start;
-                        if (elapsed > std::chrono::seconds(2)) {
-                            std::cout << YELLOW << "[KERNEL] UI timeout; continuing in headless mode" << RESET << "\n";
-                            break;
+                    // Only wait for UI if not in headless mode, with timeout
+                    if (!headless) {
+                        auto timeout_start = std::chrono::steady_clock::now();
+                        while (!UI::ready()) {
+                            auto elapsed = std::chrono::steady_clock::now() - timeout_start;
+                            if (elapsed > std::chrono::seconds(2)) {
+                                std::cout << YELLOW << "[KERNEL] UI timeout; continuing in headless mode" << RESET << "\n";
+                                break;
+                            }
+                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
                         }
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
                     }
+                    std::cerr << "[DEBUG] UI subsystem started successfully\n";
+                } catch (const std::exception& e) {
+                    std::cerr << "[ERROR] UI subsystem failed: " << e.what() << "\n";
+                    std::cout << YELLOW << "[KERNEL] Continuing without UI subsystem" << RESET << "\n";
                 }
-                std::cerr << "[DEBUG] UI subsystem started successfully\n";
-            } catch (const std::exception& e) {
-                std::cerr << "[ERROR] UI subsystem failed: " << e.what() << "\n";
-                std::cout << YELLOW << "[KERNEL] Continuing without UI subsystem" << RESET << "\n";
-            }
 
-            std::cout << BOLD << GREEN << "[KERNEL] Oroto kernel ready. All modules loaded." << RESET << "\n\n";
+                std::cout << BOLD << GREEN << "[KERNEL] Oroto kernel ready. All modules loaded." << RESET << "\n\n";
+            }
             systemRunning = true;
 
             LOG_INFO("Kernel", "Boot sequence completed successfully");
@@ -183,6 +235,78 @@ public:
         }
     }
 
+    // Same subsystems as the classic sequence, started from a dependency graph
+    // with no cosmetic delays. Independent stages run in parallel on the pool.
+    void fastBootSequence() {
+        const bool batch = Oroto::isBatchMode();
+        const bool headless = batch || (getenv("OROTO_HEADLESS") != nullptr);
+        if (!batch) {
+            std::cout << YELLOW << "[KERNEL] Fast boot: Oroto Kernel v" << kernelVersion << RESET << "\n";
+        }
+
+        // Stages may run on pool threads: they print in this session's mode
+        const Oroto::OutputMode mode = Oroto::currentOutputMode();
+        auto safeStage = [mode](void (*init)(), const char* module) {
+            return [init, module, mode]() -> Oroto::Status {
+                Oroto::OutputModeScope modeScope(mode);
+                if (!Oroto::ErrorHandler::safeExecute([init]() { init(); }, module)) {
+                    return Oroto::makeError(Oroto::ErrorCode::INTERNAL_ERROR);
+                }
+                return Oroto::ok();
+            };
+        };
+
+        Oroto::BootGraph graph;
+        graph.addStage("command-parser", {}, safeStage(initCommandParser, "CommandParser"));
+        graph.addStage("system-calls", {}, safeStage(initSystemCalls, "SystemCalls"));
+        graph.addStage("device-interface", {}, safeStage(initDeviceInterface, "DeviceInterface"));
+        // The UI shows the prompt, so it comes up once commands can be dispatched
+        if (!batch) {
+            graph.addStage("ui", {"command-parser"}, [headless]() -> Oroto::Status {
+                UI::start(headless);
+                return Oroto::ok();
+            });
+        }
+
+        Oroto::Status status = graph.run(Oroto::getThreadPool());
+        reportBootTimings(graph, batch);
+        if (!status) {
+            throw std::runtime_error("Boot stage '" + graph.failedStage() + "' failed: " + status.message());
+        }
+
+        if (!batch) {
+            std::cout << BOLD << GREEN << "[KERNEL] Oroto kernel ready. All modules loaded." << RESET << "\n\n";
+        }
+    }
+
+    // Always logged; shown on the console only in interactive sessions
+    void reportBootTimings(const Oroto::BootGraph& graph, bool quiet) {
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(2);
+        if (coreInitMs > 0.0) {
+            report << "  " << std::left << std::setw(18) << "kernel-core" << std::right
+                   << std::setw(8) << coreInitMs << " ms\n";
+        }
+        for (const auto& stage : graph.timings()) {
+            report << "  " << std::left << std::setw(18) << stage.name << std::right;
+            if (stage.ran) {
+                report << std::setw(8) << stage.durationMs << " ms  (at +" << stage.startMs << " ms)"
+                       << (stage.succeeded ? "" : "  FAILED") << "\n";
+            } else {
+                report << std::setw(8) << "-" << "     skipped\n";
+            }
+        }
+        report << "  " << std::left << std::setw(18) << "total" << std::right
+               << std::setw(8) << coreInitMs + graph.totalMs() << " ms\n";
+        // Core init happens once; a reboot only re-runs the graph
+        coreInitMs = 0.0;
+
+        LOG_INFO("Kernel", "Boot timings:\n" + report.str());
+        if (!quiet) {
+            std::cout << WHITE << "[KERNEL] Boot timings:\n" << report.str() << RESET;
+        }
+    }
+
     void showKernelHeader() {
         std::cout << BOLD << CYAN;
         std::cout << "╔══════════════════════════════════════════════════════════════════╗\n";
@@ -199,7 +323,16 @@ public:
         std::cout << RESET << "\n";
     }
 
+    void bootMessage(const char* message) {
+        if (!Oroto::isBatchMode()) {
+            std::cout << GREEN << message << RESET << "\n";
+        }
+    }
+
     void simulateLoading(int milliseconds) {
+        if (Oroto::isBatchMode()) {
+            return;
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
     }
 
@@ -215,13 +348,32 @@ public:
         #endif
     }
 
+    void setOutputMode(Oroto::OutputMode mode) {
+        outputMode = mode;
+    }
+
     void run() {
         bootSequence();
+        Oroto::sessionOutputMode() = outputMode;
+
+        // Tab completion needs a terminal; piped input is read line by line
+        const bool editing = Oroto::LineEditor::available(STDIN_FILENO, STDOUT_FILENO) && Oroto::out().human();
+        Oroto::LineEditor editor(STDIN_FILENO, STDOUT_FILENO, Oroto::getCompletionEngine());
 
         std::string command;
-        while (systemRunning) {
+        while (systemRunning && !Oroto::crackShutdownPending()) {
             showPrompt();
-            std::getline(std::cin, command);
+            bool gotLine = editing ? editor.readLine(PROMPT, command) : static_cast<bool>(std::getline(std::cin, command));
+            if (Oroto::crackShutdownPending()) {
+                break;
+            }
+            if (!gotLine) {
+                // EOF (Ctrl-D) ends the session like 'oroto poweroff'
+                std::cout << "\n";
+                shutdownSystem();
+                systemRunning = false;
+                break;
+            }
 
             if (!command.empty()) {
                 if (command == "oroto poweroff") {
@@ -231,43 +383,244 @@ public:
                     rebootSystem();
                     bootSequence();
                 } else {
-                    processCommand(command);
+                    (void)processCommand(command);
                 }
             }
         }
     }
 
+    // Non-interactive mode: run every line of `input` with no prompt and
+    // return the process exit status (0 only if every command succeeded)
+    int runBatch(std::istream& input, bool stopOnError) {
+        // Before booting, so a script reading JSON or binary gets nothing else
+        Oroto::sessionOutputMode() = outputMode;
+        bootSequence();
+
+        Oroto::BatchRunner runner([this, &runner](const std::string& line) -> Oroto::Status {
+            if (line == "oroto poweroff") {
+                shutdownSystem();
+                systemRunning = false;
+                runner.stop();
+                return Oroto::ok();
+            }
+            if (line == "oroto reboot") {
+                rebootSystem();
+                bootSequence();
+                return Oroto::ok();
+            }
+            Oroto::Status status = processCommand(line);
+            if (Oroto::crackShutdownPending()) {
+                runner.stop();
+            }
+            return status;
+        }, stopOnError);
+
+        Oroto::BatchResult result = runner.run(input);
+
+        std::cerr << "[BATCH] " << result.commands << " commands, " << result.failed << " failed in "
+                  << std::fixed << std::setprecision(3) << result.seconds << "s ("
+                  << std::setprecision(0) << result.commandsPerSecond() << " commands/sec)\n";
+        LOG_INFO("Kernel", "Batch run: " + std::to_string(result.commands) + " commands, " +
+                 std::to_string(result.failed) + " failed, " +
+                 std::to_string(static_cast<long long>(result.commandsPerSecond())) + " commands/sec");
+        return result.exitCode();
+    }
+
+    // Daemon mode: boot once, then serve command sessions on a Unix socket
+    // until a client sends 'oroto poweroff'
+    int runServer(const std::string& socketPath) {
+        // New sessions start in this thread's mode
+        Oroto::sessionOutputMode() = outputMode;
+        bootSequence();
+
+        Oroto::ControlServer server(socketPath, Oroto::getThreadPool(),
+            [&server](const std::string& line) -> Oroto::Status {
+                if (line == "oroto poweroff") {
+                    Oroto::out().message(Oroto::Tone::PLAIN, "SERVER", "Shutting down");
+                    server.stop();
+                    return Oroto::ok();
+                }
+                if (line == "oroto reboot") {
+                    // Re-running boot under other live sessions is not safe
+                    Oroto::out().message(Oroto::Tone::ERROR, "ERROR", "'oroto reboot' is not available over the control socket");
+                    return Oroto::makeError(Oroto::ErrorCode::PERMISSION_DENIED);
+                }
+                return processCommand(line);
+            });
+
+        if (!server.listen()) {
+            std::cerr << BOLD << RED << "[FATAL] Cannot listen on " << socketPath << RESET << "\n";
+            return 1;
+        }
+        std::cerr << "[SERVER] Oroto kernel v" << kernelVersion << " listening on " << socketPath << "\n";
+        server_ = &server;
+        server.run();
+        server_ = nullptr;
+        std::cerr << "[SERVER] Served " << server.requestsServed() << " requests\n";
+        return 0;
+    }
+
+    bool serving() const { return server_.load() != nullptr; }
+    bool interrupted() const { return interrupted_.load(); }
+
+    // From the signal handler once an attack has agreed to stop, or while
+    // serving: wakes the loop on the main thread so it can shut down.
+    // Async-signal-safe.
+    void interrupt() {
+        interrupted_ = true;
+        Oroto::LineEditor::interrupt();
+        if (Oroto::ControlServer* server = server_.load()) {
+            server->stop();
+        }
+    }
+
+    static constexpr const char* PROMPT = BLUE "oroto-kernel@mobile:~# " RESET;
+
     void showPrompt() {
-        std::cout << BLUE << "oroto-kernel@mobile:~# " << RESET;
+        Oroto::out().decoration(PROMPT);
     }
 };
 
 // Signal handler for graceful shutdown
 OrotoKernel* g_kernel = nullptr;
+pthread_t g_mainThread;
 
 void signalHandler(int signal) {
+    // Handled on the main thread, whose blocking read or epoll_wait it
+    // interrupts; any other thread that caught the signal passes it on
+    if (!pthread_equal(pthread_self(), g_mainThread)) {
+        pthread_kill(g_mainThread, signal);
+        return;
+    }
+    // A resumable crack saves its session and returns CANCELLED; the main
+    // loop then shuts down (see shutdownAfterCrackStop)
+    if (Oroto::requestCrackShutdown()) {
+        if (g_kernel) {
+            g_kernel->interrupt();
+        }
+        return;
+    }
+    // A server drains the requests on the pool and returns from runServer;
+    // exit here would destroy what those requests are still using
+    if (g_kernel && g_kernel->serving()) {
+        g_kernel->interrupt();
+        return;
+    }
+    // Ctrl-C at the prompt arrives while the editor has echo off
+    Oroto::LineEditor::restoreTerminal();
     if (g_kernel) {
         std::cout << "\n" << YELLOW << "[SIGNAL] Received signal " << signal << ", shutting down..." << RESET << "\n";
     }
     std::exit(0);
 }
 
-int main() {
-    // Set up signal handling
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+// Background jobs stop at their next cancellation point instead of holding
+// up the pool's shutdown
+static void cancelAllJobs() {
+    Oroto::ThreadPool& pool = Oroto::getThreadPool();
+    for (const auto& job : pool.listJobs()) {
+        pool.cancelJob(job->id);
+    }
+}
+
+// Once the stopped attacks have saved their sessions, cancels the other jobs
+// and joins the pool here, on the main thread, instead of in a static
+// destructor on whichever thread called exit
+static void shutdownAfterCrackStop() {
+    Oroto::waitForStoppedCracks();
+    cancelAllJobs();
+    Oroto::shutdownThreadPool();
+    std::cerr << YELLOW << "[SIGNAL] Attack stopped and saved, shutting down" << RESET << "\n";
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [-f script.oro] [-e] [-s socket] [-o mode] [--fast-boot]\n"
+              << "  -f FILE   run the commands in FILE non-interactively and exit\n"
+              << "  -e        with -f or piped input, stop at the first failing command\n"
+              << "  -s PATH   serve command sessions on the Unix socket PATH\n"
+              << "  -o MODE   command output as human, json or binary (also OROTO_OUTPUT)\n"
+              << "  --fast-boot  boot in parallel with no loading delays (also OROTO_FAST_BOOT=1)\n"
+              << "Batch mode is also used when stdin is not a terminal.\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Set up signal handling. No SA_RESTART: a signal that stops an attack
+    // must also end the main thread's wait for input.
+    g_mainThread = pthread_self();
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    const char* scriptPath = nullptr;
+    const char* socketPath = nullptr;
+    bool stopOnError = false;
+    bool fastBoot = getenv("OROTO_FAST_BOOT") != nullptr;
+    const char* outputName = getenv("OROTO_OUTPUT");
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputName = argv[++i];
+        } else if (std::strcmp(argv[i], "--fast-boot") == 0) {
+            fastBoot = true;
+        } else if (std::strcmp(argv[i], "-e") == 0) {
+            stopOnError = true;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    Oroto::OutputMode outputMode = Oroto::OutputMode::HUMAN;
+    if (outputName && !Oroto::parseOutputMode(outputName, outputMode)) {
+        std::cerr << BOLD << RED << "[FATAL] Unknown output mode: " << outputName << RESET << "\n";
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream script;
+    if (scriptPath) {
+        script.open(scriptPath);
+        if (!script) {
+            std::cerr << BOLD << RED << "[FATAL] Cannot open script: " << scriptPath << RESET << "\n";
+            return 2;
+        }
+    }
+    // Nobody is at a terminal to answer prompts in script or daemon runs
+    Oroto::setBatchMode(scriptPath != nullptr || socketPath != nullptr || !isatty(STDIN_FILENO));
+    Oroto::setFastBoot(fastBoot || Oroto::isBatchMode());
 
     try {
         srand(time(nullptr));
 
-        std::cout << BOLD << GREEN << "[BOOT] Starting Oroto Mobile Operating System..." << RESET << "\n\n";
+        if (!Oroto::isBatchMode()) {
+            std::cout << BOLD << GREEN << "[BOOT] Starting Oroto Mobile Operating System..." << RESET << "\n\n";
+        }
 
         OrotoKernel kernel;
         g_kernel = &kernel;
-
-        kernel.run();
-
-        return 0;
+        kernel.setOutputMode(outputMode);
+
+        int status = 0;
+        if (socketPath) {
+            status = kernel.runServer(socketPath);
+        } else if (Oroto::isBatchMode()) {
+            status = kernel.runBatch(scriptPath ? static_cast<std::istream&>(script) : std::cin, stopOnError);
+        } else {
+            kernel.run();
+        }
+        if (Oroto::crackShutdownPending()) {
+            shutdownAfterCrackStop();
+        } else if (kernel.interrupted()) {
+            // A server stopped by a signal has answered its running requests
+            cancelAllJobs();
+        }
+        return status;
     } catch (const std::exception& e) {
         std::cerr << BOLD << RED << "[FATAL] Unhandled exception: " << e.what() << RESET << "\n";
         return 1;
@@ -1,7 +1,11 @@
 
 #include "lib/oroto_shell.h"
 #include "lib/colors.h"
+#include "lib/batch_runner.h"
+#include "lib/thread_pool.h"
+#include "lib/boot_graph.h"
 #include "lib/logger.h"
+#include "lib/output_writer.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,7 +14,14 @@
 #include <cstdlib>
 #include <iomanip>
 
+using Oroto::Tone;
+
 void simulateSystemLoading(int milliseconds) {
+    // Delays are where a killed background job stops
+    Oroto::ThreadPool::cancellationPoint();
+    if (Oroto::isBatchMode()) {
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
@@ -19,127 +30,159 @@ void initSystemCalls() {
 }
 
 void showSystemStatus() {
-    std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                        KERNEL STATUS REPORT                     ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-    
-    std::cout << WHITE << "Kernel Version:    " << GREEN << "Oroto-Kernel v3.2.1" << RESET << "\n";
-    std::cout << WHITE << "Architecture:      " << GREEN << "ARM64-Mobile" << RESET << "\n";
-    std::cout << WHITE << "Build Date:        " << GREEN << "2024.01.02" << RESET << "\n";
-    std::cout << WHITE << "Uptime:           " << GREEN << "0d 0h 15m 32s" << RESET << "\n";
-    std::cout << WHITE << "Memory Usage:     " << GREEN << "2.1GB / 8.0GB (26%)" << RESET << "\n";
-    std::cout << WHITE << "Storage Free:     " << GREEN << "198GB / 256GB" << RESET << "\n";
-    std::cout << WHITE << "CPU Usage:        " << GREEN << "12% (4 cores)" << RESET << "\n";
-    std::cout << WHITE << "Network Status:   " << GREEN << "CONNECTED (WiFi)" << RESET << "\n";
-    std::cout << WHITE << "Security Level:   " << GREEN << "HIGH (Root Protected)" << RESET << "\n";
-    std::cout << WHITE << "Loaded Modules:   " << GREEN << "15 Active" << RESET << "\n";
-    std::cout << WHITE << "Active Processes: " << GREEN << "47 Running" << RESET << "\n\n";
-    
-    std::cout << GREEN << "[KERNEL] All systems operational and secure." << RESET << "\n\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("KERNEL STATUS REPORT");
+
+    out.field("Kernel Version", "Oroto-Kernel v3.2.1", Tone::OK, 19);
+    out.field("Architecture", "ARM64-Mobile", Tone::OK, 19);
+    out.field("Build Date", "2024.01.02", Tone::OK, 19);
+    out.field("Uptime", "0d 0h 15m 32s", Tone::OK, 18);
+    out.field("Memory Usage", "2.1GB / 8.0GB (26%)", Tone::OK, 18);
+    out.field("Storage Free", "198GB / 256GB", Tone::OK, 18);
+    out.field("CPU Usage", "12% (4 cores)", Tone::OK, 18);
+    out.field("Network Status", "CONNECTED (WiFi)", Tone::OK, 18);
+    out.field("Security Level", "HIGH (Root Protected)", Tone::OK, 18);
+    out.field("Loaded Modules", "15 Active", Tone::OK, 18);
+    out.field("Active Processes", "47 Running", Tone::OK, 18);
+    out.blank();
+
+    out.message(Tone::OK, "KERNEL", "All systems operational and secure.");
+    out.blank();
+}
+
+static Oroto::Status runRootCommand(std::string_view rootCommand) {
+    if (rootCommand.substr(0, 7) != "kernel.") {
+        Oroto::out().message(Tone::ERROR, "ROOT", "Invalid kernel command. Use 'exit' to leave root mode.");
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+    }
+    Oroto::out().message(Tone::OK, "ROOT", {"Executing kernel-level command: ", rootCommand});
+    simulateSystemLoading(800);
+    Oroto::out().message(Tone::OK, "ROOT", "Command executed successfully");
+    Oroto::out().blank();
+    return Oroto::ok();
 }
 
 void enterRootMode() {
-    std::cout << "\n" << YELLOW << "[KERNEL] Entering root-level kernel access..." << RESET << "\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.blank();
+    out.message(Tone::PROGRESS, "KERNEL", "Entering root-level kernel access...");
     simulateSystemLoading(1500);
     
-    std::cout << RED << "⚠️  ROOT ACCESS GRANTED - HANDLE WITH EXTREME CARE ⚠️" << RESET << "\n\n";
-    
-    std::cout << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                     ROOT KERNEL CONSOLE                         ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-    
-    std::cout << WHITE << "Available Root Commands:" << RESET << "\n";
-    std::cout << RED << "  kernel.memory.dump" << WHITE << "     - Dump memory contents" << RESET << "\n";
-    std::cout << RED << "  kernel.process.kill" << WHITE << "    - Terminate processes" << RESET << "\n";
-    std::cout << RED << "  kernel.security.bypass" << WHITE << " - Bypass security checks" << RESET << "\n";
-    std::cout << RED << "  kernel.fs.mount" << WHITE << "       - Mount filesystems" << RESET << "\n";
-    std::cout << RED << "  kernel.net.intercept" << WHITE << "  - Network interception" << RESET << "\n";
-    std::cout << RED << "  kernel.debug.enable" << WHITE << "   - Enable debug mode" << RESET << "\n";
-    std::cout << WHITE << "  exit" << WHITE << "                   - Exit root mode" << RESET << "\n\n";
-    
+    out.message(Tone::WARNING, "", "⚠️  ROOT ACCESS GRANTED - HANDLE WITH EXTREME CARE ⚠️");
+    out.blank();
+
+    out.title("ROOT KERNEL CONSOLE");
+
+    out.section("Available Root Commands");
+    out.item("kernel.memory.dump", "Dump memory contents");
+    out.item("kernel.process.kill", "Terminate processes");
+    out.item("kernel.security.bypass", "Bypass security checks");
+    out.item("kernel.fs.mount", "Mount filesystems");
+    out.item("kernel.net.intercept", "Network interception");
+    out.item("kernel.debug.enable", "Enable debug mode");
+    out.item("exit", "Exit root mode");
+    out.blank();
+
+
     std::string rootCommand;
     while (true) {
-        std::cout << RED << "root@oroto-kernel:~# " << RESET;
-        std::getline(std::cin, rootCommand);
-        
-        if (rootCommand == "exit") {
-            std::cout << YELLOW << "[KERNEL] Exiting root mode... Access revoked." << RESET << "\n\n";
+        out.decoration(RED "root@oroto-kernel:~# " RESET);
+        std::cout.flush();
+        if (!std::getline(std::cin, rootCommand) || rootCommand == "exit") {
+            out.message(Tone::PROGRESS, "KERNEL", "Exiting root mode... Access revoked.");
+            out.blank();
             break;
-        } else if (rootCommand.find("kernel.") == 0) {
-            std::cout << GREEN << "[ROOT] Executing kernel-level command: " << rootCommand << RESET << "\n";
-            simulateSystemLoading(800);
-            std::cout << GREEN << "[ROOT] Command executed successfully" << RESET << "\n\n";
-        } else if (!rootCommand.empty()) {
-            std::cout << RED << "[ROOT] Invalid kernel command. Use 'exit' to leave root mode." << RESET << "\n";
+        }
+        if (!rootCommand.empty()) {
+            (void)runRootCommand(rootCommand);
         }
     }
 }
 
-void executeToolCommand(const std::string& toolName) {
-    std::cout << YELLOW << "[EXEC] Loading tool: " << toolName << RESET << "\n";
+Oroto::Status executeToolCommand(std::string_view toolName) {
+    Oroto::out().message(Tone::PROGRESS, "EXEC", {"Loading tool: ", toolName});
     simulateSystemLoading(1000);
     
     if (toolName == "nmap") {
-        std::cout << GREEN << "[EXEC] Nmap network scanner loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: nmap [options] target" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "Nmap network scanner loaded");
+        Oroto::out().field("Usage", "nmap [options] target", Tone::PLAIN, 0);
     } else if (toolName == "whois") {
-        std::cout << GREEN << "[EXEC] Whois domain lookup loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: whois domain.com" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "Whois domain lookup loaded");
+        Oroto::out().field("Usage", "whois domain.com", Tone::PLAIN, 0);
     } else if (toolName == "ssh") {
-        std::cout << GREEN << "[EXEC] SSH client loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: ssh user@host" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "SSH client loaded");
+        Oroto::out().field("Usage", "ssh user@host", Tone::PLAIN, 0);
     } else if (toolName == "hydra") {
-        std::cout << GREEN << "[EXEC] Hydra brute force tool loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: hydra -l user -P wordlist.txt target service" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "Hydra brute force tool loaded");
+        Oroto::out().field("Usage", "hydra -l user -P wordlist.txt target service", Tone::PLAIN, 0);
     } else if (toolName == "sqlmap") {
-        std::cout << GREEN << "[EXEC] SQLMap injection scanner loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: sqlmap -u 'http://target.com/page?id=1'" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "SQLMap injection scanner loaded");
+        Oroto::out().field("Usage", "sqlmap -u 'http://target.com/page?id=1'", Tone::PLAIN, 0);
     } else if (toolName == "aircrack") {
-        std::cout << GREEN << "[EXEC] Aircrack WiFi security tool loaded" << RESET << "\n";
-        std::cout << WHITE << "Usage: aircrack-ng capture.cap -w wordlist.txt" << RESET << "\n";
+        Oroto::out().message(Tone::OK, "EXEC", "Aircrack WiFi security tool loaded");
+        Oroto::out().field("Usage", "aircrack-ng capture.cap -w wordlist.txt", Tone::PLAIN, 0);
     } else {
-        std::cout << RED << "[ERROR] Tool not found: " << toolName << RESET << "\n";
-        std::cout << YELLOW << "[HINT] Use 'oroto tool list' to see available tools" << RESET << "\n";
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Tool not found: ", toolName});
+        Oroto::out().message(Tone::HINT, "HINT", "Use 'oroto tool list' to see available tools");
+        Oroto::out().blank();
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
     }
-    std::cout << "\n";
+    Oroto::out().blank();
+    return Oroto::ok();
 }
 
-void executeSystemCall(const std::string& syscall, const std::vector<std::string>& args) {
+Oroto::Status executeSystemCall(const std::string& syscall, const CommandArgs& args) {
     if (syscall == "status") {
         showSystemStatus();
     } else if (syscall == "root") {
+        // 'oroto root kernel.x' runs one root command without opening the console
+        if (args.size() >= 3) {
+            return runRootCommand(args[2]);
+        }
+        if (Oroto::isBatchMode()) {
+            Oroto::out().message(Tone::ERROR, "ERROR", "Root console is interactive; use 'oroto root kernel.<command>'");
+            return Oroto::makeError(Oroto::ErrorCode::PERMISSION_DENIED);
+        }
         enterRootMode();
     } else if (syscall == "exec" && args.size() >= 3) {
-        executeToolCommand(args[2]);
+        return executeToolCommand(args[2]);
     } else if (syscall == "reboot") {
         rebootSystem();
     } else if (syscall == "shutdown") {
         shutdownSystem();
     } else {
-        std::cout << RED << "[ERROR] Unknown system call: " << syscall << RESET << "\n";
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Unknown system call: ", syscall});
+        return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
     }
+    return Oroto::ok();
 }
 
 void shutdownSystem() {
-    std::cout << YELLOW << "[KERNEL] Initiating system shutdown sequence..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "KERNEL", "Initiating system shutdown sequence...");
     simulateSystemLoading(1000);
     
-    std::cout << GREEN << "[KERNEL] Stopping active processes..." << RESET << "\n";
+    Oroto::out().message(Tone::OK, "KERNEL", "Stopping active processes...");
     simulateSystemLoading(800);
     
-    std::cout << GREEN << "[KERNEL] Unmounting filesystems..." << RESET << "\n";
+    Oroto::out().message(Tone::OK, "KERNEL", "Unmounting filesystems...");
     simulateSystemLoading(600);
     
-    std::cout << GREEN << "[KERNEL] Saving system state..." << RESET << "\n";
+    Oroto::out().message(Tone::OK, "KERNEL", "Saving system state...");
     simulateSystemLoading(500);
     
-    std::cout << BOLD << RED << "[KERNEL] System halted. Power off safe." << RESET << "\n";
+    Oroto::out().message(Tone::ERROR, "KERNEL", "System halted. Power off safe.");
 }
 
 void rebootSystem() {
-    std::cout << YELLOW << "[KERNEL] Initiating system reboot..." << RESET << "\n";
-    simulateSystemLoading(1500);
+    // A fast-boot kernel restarts without the cosmetic pauses
+    const bool fastBoot = Oroto::isFastBoot();
+    Oroto::out().message(Tone::PROGRESS, "KERNEL", "Initiating system reboot...");
+    if (!fastBoot) {
+        simulateSystemLoading(1500);
+    }
     
-    std::cout << GREEN << "[KERNEL] Restarting kernel modules..." << RESET << "\n";
-    simulateSystemLoading(1000);
+    Oroto::out().message(Tone::OK, "KERNEL", "Restarting kernel modules...");
+    if (!fastBoot) {
+        simulateSystemLoading(1000);
+    }
 }
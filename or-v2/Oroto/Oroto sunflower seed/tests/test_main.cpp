@@ -3,6 +3,27 @@
 #include "../lib/thread_pool.h"
 #include "../lib/resource_manager.h"
 #include "../lib/logger.h"
+#include "../lib/command_arena.h"
+#include "../lib/error_handler.h"
+#include "../lib/command_registry.h"
+#include "../lib/plugin_manifest.h"
+#include "../lib/command_tokenizer.h"
+#include "../lib/batch_runner.h"
+#include "../lib/control_server.h"
+#include "../lib/boot_graph.h"
+#include "../lib/record_stream.h"
+#include "../lib/output_writer.h"
+#include "../lib/command_history.h"
+#include "../lib/completion_trie.h"
+#include "../lib/line_editor.h"
+#include "../lib/hash_cracker.h"
+#include "../lib/potfile.h"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <cmath>
 #include <memory>
 #include <thread>
 #include <chrono>
@@ -100,6 +121,1512 @@ void testLoggerInitialization() {
     Oroto::Logger::shutdown();
 }
 
+void testCommandArenaRewind() {
+    Oroto::CommandArena arena;
+
+    auto before = arena.mark();
+    {
+        Oroto::ArenaScope scope(arena);
+        std::pmr::vector<std::pmr::string> tokens(&arena);
+        for (int i = 0; i < 64; ++i) {
+            tokens.emplace_back("a token long enough to defeat small string optimisation");
+        }
+        ASSERT_TRUE(arena.bytesUsed() > Oroto::CommandArena::INLINE_SIZE);
+    }
+
+    // Scope exit frees everything, spill blocks are kept for the next command
+    ASSERT_EQ(before.offset, arena.mark().offset);
+    ASSERT_EQ(0u, arena.bytesUsed());
+    size_t blocks = arena.spillBlockCount();
+    ASSERT_TRUE(blocks > 0);
+
+    {
+        Oroto::ArenaScope scope(arena);
+        std::pmr::vector<std::pmr::string> tokens(&arena);
+        for (int i = 0; i < 64; ++i) {
+            tokens.emplace_back("a token long enough to defeat small string optimisation");
+        }
+    }
+    ASSERT_EQ(blocks, arena.spillBlockCount());
+}
+
+void testCommandArenaNestedScope() {
+    Oroto::CommandArena arena;
+    Oroto::ArenaScope outer(arena);
+
+    std::pmr::string outerValue("outer command argument that lives on the arena", &arena);
+    size_t used = arena.bytesUsed();
+    {
+        Oroto::ArenaScope inner(arena);
+        std::pmr::string innerValue("inner command argument that lives on the arena", &arena);
+        ASSERT_TRUE(arena.bytesUsed() > used);
+    }
+
+    ASSERT_EQ(used, arena.bytesUsed());
+    ASSERT_EQ(std::string("outer command argument that lives on the arena"), std::string(outerValue));
+}
+
+Oroto::Expected<int> parsePort(int value) {
+    if (value <= 0 || value > 65535) {
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    return value;
+}
+
+void testExpectedResult() {
+    auto good = parsePort(443);
+    ASSERT_TRUE(good.hasValue());
+    ASSERT_EQ(443, *good);
+
+    auto bad = parsePort(70000);
+    ASSERT_FALSE(bad.hasValue());
+    ASSERT_TRUE(bad.error() == Oroto::ErrorCode::INVALID_ARGUMENTS);
+    ASSERT_EQ(std::string("Invalid arguments provided"), std::string(bad.message()));
+    ASSERT_EQ(22, bad.valueOr(22));
+
+    // SUCCESS is not a failure code, whatever the value type
+    Oroto::Expected<int> misuse = Oroto::makeError(Oroto::ErrorCode::SUCCESS);
+    Oroto::Status misuseStatus = Oroto::makeError(Oroto::ErrorCode::SUCCESS);
+    ASSERT_TRUE(misuse.error() == Oroto::ErrorCode::INTERNAL_ERROR);
+    ASSERT_TRUE(misuseStatus.error() == Oroto::ErrorCode::INTERNAL_ERROR);
+}
+
+void testSafeExecuteExpected() {
+    size_t before = Oroto::ErrorHandler::getErrorCount(Oroto::ErrorCode::TIMEOUT);
+
+    Oroto::Status status = Oroto::ErrorHandler::safeExecute([]() -> Oroto::Status {
+        return Oroto::makeError(Oroto::ErrorCode::TIMEOUT);
+    });
+
+    ASSERT_FALSE(status.hasValue());
+    ASSERT_EQ(before + 1, Oroto::ErrorHandler::getErrorCount(Oroto::ErrorCode::TIMEOUT));
+
+    Oroto::Status fine = Oroto::ErrorHandler::safeExecute([]() { return Oroto::ok(); });
+    ASSERT_TRUE(fine.hasValue());
+}
+
+void testCommandRegistryLookup() {
+    Oroto::CommandRegistry registry;
+    Oroto::CommandRegistrar registrar(registry, "TestPlugin");
+    int calls = 0;
+
+    // Enough commands to force the table to grow past its initial capacity
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(registrar.add("cmd" + std::to_string(i), [&calls](const CommandArgs&) {
+            ++calls;
+            return Oroto::ok();
+        }));
+    }
+    ASSERT_FALSE(registrar.add("cmd7", [](const CommandArgs&) { return Oroto::ok(); }));
+    ASSERT_EQ(size_t(40), registry.size());
+
+    auto entry = registry.find("cmd27");
+    ASSERT_TRUE(entry != nullptr);
+    ASSERT_EQ(std::string("TestPlugin"), entry->owner);
+    CommandArgs args;
+    ASSERT_TRUE(entry->handler(args).hasValue());
+    ASSERT_EQ(1, calls);
+    ASSERT_TRUE(registry.find("cmd40") == nullptr);
+
+    // Entries removed by their owner vanish from lookups, held references stay valid
+    ASSERT_EQ(size_t(40), registry.unregisterOwner("TestPlugin"));
+    ASSERT_TRUE(registry.find("cmd27") == nullptr);
+    ASSERT_EQ(std::string("cmd27"), entry->name);
+}
+
+void testCommandRegistryReplaceOwner() {
+    Oroto::CommandRegistry registry;
+    Oroto::CommandRegistrar v1(registry, "Scanner");
+    ASSERT_TRUE(v1.add("scan", [](const CommandArgs&) { return Oroto::ok(); }));
+    ASSERT_TRUE(v1.add("oldonly", [](const CommandArgs&) { return Oroto::ok(); }));
+    ASSERT_TRUE(registry.registerCommand("other", "OtherPlugin", [](const CommandArgs&) { return Oroto::ok(); }));
+
+    // A call in flight holds the old entry, which keeps its owner alive
+    auto library = std::make_shared<int>(1);
+    std::weak_ptr<int> watch = library;
+    auto inFlight = registry.find("scan");
+    {
+        Oroto::CommandRegistrar v2(registry, "Scanner", std::move(library), true);
+        ASSERT_TRUE(v2.add("scan", [](const CommandArgs&) { return Oroto::makeError(Oroto::ErrorCode::TIMEOUT); }));
+        ASSERT_TRUE(v2.add("other", [](const CommandArgs&) { return Oroto::ok(); }));
+        ASSERT_TRUE(registry.find("scan")->handler(CommandArgs()).hasValue());
+        ASSERT_EQ(size_t(1), v2.commit("Scanner"));
+    }
+    ASSERT_TRUE(inFlight->handler(CommandArgs()).hasValue());
+    ASSERT_FALSE(registry.find("scan")->handler(CommandArgs()).hasValue());
+    ASSERT_TRUE(registry.find("oldonly") == nullptr);
+    ASSERT_EQ(std::string("OtherPlugin"), registry.find("other")->owner);
+
+    ASSERT_FALSE(watch.expired());
+    registry.unregisterOwner("Scanner");
+    ASSERT_TRUE(watch.expired());
+}
+
+void testThreadPoolParallelFor() {
+    Oroto::ThreadPool pool(4);
+    std::vector<int> hits(100, 0);
+
+    pool.parallelFor(hits.size(), [&hits](size_t i) { hits[i]++; });
+    for (int h : hits) {
+        ASSERT_EQ(1, h);
+    }
+
+    // Nested use from inside a pool job must not deadlock
+    std::atomic<int> inner(0);
+    pool.parallelFor(8, [&pool, &inner](size_t) {
+        pool.parallelFor(8, [&inner](size_t) { inner++; });
+    });
+    ASSERT_EQ(64, inner.load());
+}
+
+void testPluginManifestRoundTrip() {
+    const std::string path = "tests/test_plugins.manifest";
+    Oroto::PluginManifestEntry stamp;
+    ASSERT_TRUE(Oroto::PluginManifest::stampFile("tests/test_runner.h", stamp));
+
+    {
+        Oroto::PluginManifest manifest(path);
+        Oroto::PluginManifestEntry entry = stamp;
+        entry.loadable = true;
+        entry.name = "Sample";
+        entry.version = "1.0";
+        entry.description = "tab\there";
+        manifest.update(entry);
+        ASSERT_TRUE(manifest.save());
+    }
+
+    Oroto::PluginManifest manifest(path);
+    ASSERT_TRUE(manifest.load());
+    const Oroto::PluginManifestEntry* cached = manifest.findUnchanged(stamp);
+    ASSERT_TRUE(cached != nullptr);
+    ASSERT_TRUE(cached->loadable);
+    ASSERT_EQ(std::string("Sample"), cached->name);
+    ASSERT_EQ(std::string("tab here"), cached->description);
+
+    // A changed file identity is a cache miss
+    Oroto::PluginManifestEntry touched = stamp;
+    touched.mtimeNs += 1;
+    ASSERT_TRUE(manifest.findUnchanged(touched) == nullptr);
+
+    manifest.retainOnly({});
+    ASSERT_EQ(size_t(0), manifest.size());
+    std::remove(path.c_str());
+}
+
+void testTokenizerQuotingAndEscapes() {
+    Oroto::CommandArena arena;
+    std::string line = "storage write name \"some \\\"data\\\"\" 'a b' plain\\ space \"\"";
+    auto parsed = Oroto::tokenizeCommandLine(line, &arena);
+    ASSERT_TRUE(parsed.hasValue());
+    ASSERT_EQ(size_t(1), parsed->size());
+
+    const CommandArgs& args = (*parsed)[0].args;
+    ASSERT_EQ(size_t(7), args.size());
+    ASSERT_EQ(std::string("write"), std::string(args[1]));
+    ASSERT_EQ(std::string("some \"data\""), std::string(args[3]));
+    ASSERT_EQ(std::string("a b"), std::string(args[4]));
+    ASSERT_EQ(std::string("plain space"), std::string(args[5]));
+    ASSERT_EQ(size_t(0), args[6].size());
+
+    // Plain and simply-quoted arguments are slices of the line itself
+    ASSERT_TRUE(args[1].data() == line.data() + 8);
+    ASSERT_TRUE(args[4].data() == line.data() + line.find("a b"));
+}
+
+void testTokenizerSeparators() {
+    Oroto::CommandArena arena;
+    std::string line = "ls; cd 'x;y' && pwd ;";
+    auto parsed = Oroto::tokenizeCommandLine(line, &arena);
+    ASSERT_TRUE(parsed.hasValue());
+    ASSERT_EQ(size_t(3), parsed->size());
+    ASSERT_TRUE((*parsed)[0].next == Oroto::CommandSeparator::SEQUENCE);
+    ASSERT_TRUE((*parsed)[1].next == Oroto::CommandSeparator::AND);
+    ASSERT_TRUE((*parsed)[2].next == Oroto::CommandSeparator::END);
+    ASSERT_EQ(std::string("x;y"), std::string((*parsed)[1].args[1]));
+
+    // A typical line is served entirely from the arena's inline buffer
+    ASSERT_EQ(size_t(0), arena.spillBlockCount());
+
+    auto jobs = Oroto::tokenizeCommandLine("nmap host & ping 'a&b'&", &arena);
+    ASSERT_TRUE(jobs.hasValue());
+    ASSERT_EQ(size_t(2), jobs->size());
+    ASSERT_TRUE((*jobs)[0].next == Oroto::CommandSeparator::BACKGROUND);
+    ASSERT_TRUE((*jobs)[1].next == Oroto::CommandSeparator::BACKGROUND);
+    ASSERT_EQ(std::string("a&b"), std::string((*jobs)[1].args[1]));
+
+    auto pipeline = Oroto::tokenizeCommandLine("nmap net|filter 'a|b' | report &", &arena);
+    ASSERT_TRUE(pipeline.hasValue());
+    ASSERT_EQ(size_t(3), pipeline->size());
+    ASSERT_TRUE((*pipeline)[0].next == Oroto::CommandSeparator::PIPE);
+    ASSERT_TRUE((*pipeline)[1].next == Oroto::CommandSeparator::PIPE);
+    ASSERT_TRUE((*pipeline)[2].next == Oroto::CommandSeparator::BACKGROUND);
+    ASSERT_EQ(std::string("a|b"), std::string((*pipeline)[1].args[1]));
+
+    for (const char* bad : {"echo \"open", "echo 'open", "ls \\", "&& ls", "ls &&", "ls && ; pwd", "& ls", "ls && & pwd",
+                            "| ls", "ls |", "ls || pwd", "ls | ; pwd", "ls | & pwd"}) {
+        auto result = Oroto::tokenizeCommandLine(bad, &arena);
+        ASSERT_FALSE(result.hasValue());
+        ASSERT_TRUE(result.error() == Oroto::ErrorCode::PARSE_ERROR);
+    }
+}
+
+void testBatchRunnerScript() {
+    std::istringstream script("# setup\nls\n\n   \nbad one\r\npwd\nstop\nls\n");
+    std::vector<std::string> seen;
+    Oroto::BatchRunner runner([&seen, &runner](const std::string& line) -> Oroto::Status {
+        seen.push_back(line);
+        if (line == "stop") {
+            runner.stop();
+        }
+        if (line == "bad one") {
+            return Oroto::makeError(Oroto::ErrorCode::COMMAND_NOT_FOUND);
+        }
+        return Oroto::ok();
+    });
+
+    Oroto::BatchResult result = runner.run(script);
+    ASSERT_EQ(size_t(4), result.commands);
+    ASSERT_EQ(size_t(1), result.failed);
+    ASSERT_EQ(1, result.exitCode());
+    ASSERT_EQ(std::string("bad one"), seen[1]);
+    ASSERT_EQ(std::string("stop"), seen.back());
+
+    // Menu choices arrive as --name=value or --name value
+    Oroto::CommandArena arena;
+    auto parsed = Oroto::tokenizeCommandLine("oroto ping host --count 3 --mode=2", &arena);
+    ASSERT_TRUE(parsed.hasValue());
+    const CommandArgs& args = (*parsed)[0].args;
+    ASSERT_EQ(std::string("2"), std::string(findOption(args, "mode")));
+    ASSERT_EQ(std::string("3"), std::string(findOption(args, "count")));
+    ASSERT_TRUE(findOption(args, "mod").empty());
+    ASSERT_TRUE(findOption(args, "missing").empty());
+}
+
+void testStorageWriteOperands() {
+    // Both spellings of the line put the filename and data in the same place
+    Oroto::CommandArena arena;
+    for (const char* line : {"storage write name \"some data\"", "oroto storage write name \"some data\""}) {
+        auto parsed = Oroto::tokenizeCommandLine(line, &arena);
+        ASSERT_TRUE(parsed.hasValue());
+        const CommandArgs& args = (*parsed)[0].args;
+        ASSERT_EQ(std::string("name"), std::string(args[actionOperand(args)]));
+
+        std::ostringstream captured;
+        std::streambuf* saved = std::cout.rdbuf(captured.rdbuf());
+        bool wasBatch = Oroto::isBatchMode();
+        Oroto::setBatchMode(true);
+        Oroto::Status status = executeDeviceCommand("storage", args[actionOperand(args) - 1], args);
+        Oroto::setBatchMode(wasBatch);
+        std::cout.rdbuf(saved);
+
+        ASSERT_TRUE(status.hasValue());
+        ASSERT_TRUE(captured.str().find("/storage/user/name") != std::string::npos);
+        ASSERT_TRUE(captured.str().find("9 bytes") != std::string::npos);
+        ASSERT_TRUE(captured.str().find("some data") == std::string::npos);
+    }
+}
+
+void testCapturedJobs() {
+    std::ostringstream terminal;
+    std::ostream out(terminal.rdbuf());
+    Oroto::installOutputRouter(out);
+    Oroto::ThreadPool pool(2);
+
+    size_t echo = pool.submitCapturedJob("echo", [&out]() { out << "from job " << 42 << std::flush; });
+    out << "from shell";
+    auto echoJob = pool.waitJob(echo);
+    ASSERT_TRUE(echoJob->status == Oroto::JobStatus::COMPLETED);
+    std::string captured;
+    echoJob->output->readFrom(0, captured, true);
+    ASSERT_EQ(std::string("from job 42"), captured);
+    ASSERT_EQ(std::string("from shell"), terminal.str());
+
+    // A running job stops at its next cancellation point
+    std::atomic<bool> started(false);
+    size_t loop = pool.submitCapturedJob("loop", [&started]() {
+        started = true;
+        while (true) {
+            Oroto::ThreadPool::cancellationPoint();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    ASSERT_TRUE(pool.cancelJob(loop));
+    ASSERT_TRUE(pool.waitJob(loop)->status == Oroto::JobStatus::CANCELLED);
+    ASSERT_FALSE(pool.cancelJob(loop));
+
+    size_t bad = pool.submitJob("bad", []() {
+        throw Oroto::OrotoException(Oroto::ErrorCode::NETWORK_ERROR, "Test", "link down");
+    });
+    auto badJob = pool.waitJob(bad);
+    ASSERT_TRUE(badJob->status == Oroto::JobStatus::FAILED);
+    ASSERT_TRUE(badJob->errorCode == Oroto::ErrorCode::NETWORK_ERROR);
+}
+
+void testControlServerSessions() {
+    const std::string path = "tests/test_control.sock";
+    Oroto::ThreadPool pool(2);
+    Oroto::ControlServer server(path, pool, [](const std::string& line) -> Oroto::Status {
+        if (line == "fail") {
+            std::cout << "bad";
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        std::cout << "echo:" << line;
+        return Oroto::ok();
+    });
+    ASSERT_TRUE(server.listen().hasValue());
+    std::thread loop([&server]() { server.run(); });
+
+    // Two sessions interleave; each sees only its own replies, in order
+    Oroto::ControlClient first;
+    Oroto::ControlClient second;
+    ASSERT_TRUE(first.connect(path).hasValue());
+    ASSERT_TRUE(second.connect(path).hasValue());
+
+    std::string output;
+    for (int i = 0; i < 20; ++i) {
+        auto code = first.execute("a" + std::to_string(i), output);
+        ASSERT_TRUE(code.hasValue() && *code == Oroto::ErrorCode::SUCCESS);
+        ASSERT_EQ("echo:a" + std::to_string(i), output);
+
+        code = second.execute(i % 5 == 0 ? "fail" : "b", output);
+        ASSERT_TRUE(code.hasValue());
+        if (i % 5 == 0) {
+            ASSERT_TRUE(*code == Oroto::ErrorCode::INVALID_ARGUMENTS);
+            ASSERT_EQ(std::string("bad"), output);
+        } else {
+            ASSERT_EQ(std::string("echo:b"), output);
+        }
+    }
+
+    server.stop();
+    loop.join();
+    ASSERT_EQ(size_t(40), server.requestsServed());
+}
+
+void testControlBinaryReplies() {
+    // Binary events may contain the reply mark: a 30-byte string's length
+    // byte is 0x1e, and so is any value carrying that byte
+    const std::string path = "tests/test_control_binary.sock";
+    const std::string thirty(30, 'x');
+    const std::string marked("a\x1e" "5\nb");
+    Oroto::ThreadPool pool(2);
+    Oroto::ControlServer server(path, pool, [&](const std::string& line) -> Oroto::Status {
+        if (line == "output binary") {
+            Oroto::sessionOutputMode() = Oroto::OutputMode::BINARY;
+        } else {
+            Oroto::out().field("Key", line == "thirty" ? thirty : marked);
+        }
+        return Oroto::ok();
+    });
+    ASSERT_TRUE(server.listen().hasValue());
+    std::thread loop([&server]() { server.run(); });
+
+    Oroto::ControlClient client;
+    ASSERT_TRUE(client.connect(path).hasValue());
+    std::string output;
+    ASSERT_TRUE(client.execute("output binary", output).hasValue());
+    for (int i = 0; i < 3; ++i) {
+        auto code = client.execute("thirty", output);
+        ASSERT_TRUE(code.hasValue() && *code == Oroto::ErrorCode::SUCCESS);
+        ASSERT_EQ(std::string("\x03\x00\x02\x03Key\x1e", 8) + thirty, output);
+
+        code = client.execute("marked", output);
+        ASSERT_TRUE(code.hasValue() && *code == Oroto::ErrorCode::SUCCESS);
+        ASSERT_EQ(std::string("\x03\x00\x02\x03Key\x05", 8) + marked, output);
+    }
+
+    server.stop();
+    loop.join();
+}
+
+void testControlSessionsWaitOnJobs() {
+    // Every worker serves a request that queues a job and then waits on it,
+    // as 'sleep 1 & ; wait' would. The jobs can only run on those workers.
+    const std::string path = "tests/test_control_wait.sock";
+    Oroto::ThreadPool pool(2);
+    std::atomic<int> arrived(0);
+    Oroto::ControlServer server(path, pool, [&pool, &arrived](const std::string& line) -> Oroto::Status {
+        // The first two requests hold both workers before either queues its job
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        if (++arrived <= 2) {
+            while (arrived.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+        size_t id = pool.submitCapturedJob("echo", []() { std::cout << "done"; });
+        if (line == "fg") {
+            std::string output;
+            pool.waitJobStarted(id)->output->readFrom(0, output, true);
+            std::cout << output;
+            return Oroto::ok();
+        }
+        auto job = pool.waitJob(id);
+        return job->status == Oroto::JobStatus::COMPLETED ? Oroto::ok() : Oroto::makeError(Oroto::ErrorCode::INTERNAL_ERROR);
+    });
+    ASSERT_TRUE(server.listen().hasValue());
+    std::thread loop([&server]() { server.run(); });
+
+    std::atomic<int> finished(0);
+    auto session = [&](const char* command) {
+        Oroto::ControlClient client;
+        if (!client.connect(path).hasValue()) {
+            return;
+        }
+        for (int i = 0; i < 10; ++i) {
+            std::string output;
+            auto code = client.execute(command, output);
+            if (code.hasValue() && *code == Oroto::ErrorCode::SUCCESS) {
+                ++finished;
+            }
+        }
+    };
+    std::thread first(session, "wait");
+    std::thread second(session, "fg");
+    first.join();
+    second.join();
+
+    server.stop();
+    loop.join();
+    ASSERT_EQ(20, finished.load());
+}
+
+void testControlHangupMidRequest() {
+    // A client that hangs up while its request runs leaves the loop idle
+    // until the reply is ready; the session is closed then
+    const std::string path = "tests/test_control_hangup.sock";
+    Oroto::ThreadPool pool(2);
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    Oroto::ControlServer server(path, pool, [&](const std::string&) -> Oroto::Status {
+        started = true;
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << "late";
+        return Oroto::ok();
+    });
+    ASSERT_TRUE(server.listen().hasValue());
+    std::thread loop([&server]() { server.run(); });
+    clockid_t loopClock;
+    pthread_getcpuclockid(loop.native_handle(), &loopClock);
+    auto cpuMs = [loopClock]() {
+        timespec now;
+        clock_gettime(loopClock, &now);
+        return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+    };
+
+    sockaddr_un address;
+    ASSERT_TRUE(Oroto::fillSocketAddress(path, address));
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool sent = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+                ::send(fd, "hold\n", 5, MSG_NOSIGNAL) == 5;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (sent && !started.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ::close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    double before = cpuMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    double busy = cpuMs() - before;
+
+    release = true;
+    server.stop();
+    loop.join();
+    ASSERT_TRUE(sent && started.load());
+    ASSERT_TRUE(busy < 50.0);
+    ASSERT_EQ(size_t(1), server.requestsServed());
+    ASSERT_EQ(size_t(0), server.sessionCount());
+}
+
+void testBootGraphDependencies() {
+    Oroto::ThreadPool pool(3);
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto stage = [&](const std::string& name, bool succeed) {
+        return [&, name, succeed]() -> Oroto::Status {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+            return succeed ? Oroto::ok() : Oroto::makeError(Oroto::ErrorCode::DEVICE_ERROR);
+        };
+    };
+    auto position = [&order](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+
+    Oroto::BootGraph graph;
+    graph.addStage("ui", {"parser", "devices"}, stage("ui", true));
+    graph.addStage("parser", {}, stage("parser", true));
+    graph.addStage("devices", {"syscalls"}, stage("devices", true));
+    graph.addStage("syscalls", {}, stage("syscalls", true));
+    ASSERT_TRUE(graph.run(pool).hasValue());
+    ASSERT_EQ(size_t(4), order.size());
+    ASSERT_TRUE(position("syscalls") < position("devices"));
+    ASSERT_TRUE(position("devices") < position("ui"));
+    ASSERT_TRUE(position("parser") < position("ui"));
+    for (const auto& timing : graph.timings()) {
+        ASSERT_TRUE(timing.ran && timing.succeeded);
+    }
+
+    // A failed stage skips everything downstream but not its siblings
+    order.clear();
+    Oroto::BootGraph failing;
+    failing.addStage("devices", {}, stage("devices", false));
+    failing.addStage("parser", {}, stage("parser", true));
+    failing.addStage("ui", {"devices"}, stage("ui", true));
+    failing.addStage("shell", {"ui"}, stage("shell", true));
+    auto status = failing.run(pool);
+    ASSERT_FALSE(status.hasValue());
+    ASSERT_TRUE(status.error() == Oroto::ErrorCode::DEVICE_ERROR);
+    ASSERT_EQ(std::string("devices"), failing.failedStage());
+    ASSERT_EQ(size_t(2), order.size());
+    ASSERT_FALSE(failing.timings()[2].ran);
+    ASSERT_FALSE(failing.timings()[3].ran);
+
+    // Unknown dependencies and cycles are rejected before anything runs
+    order.clear();
+    Oroto::BootGraph unknown;
+    unknown.addStage("ui", {"display"}, stage("ui", true));
+    ASSERT_TRUE(unknown.run(pool).error() == Oroto::ErrorCode::INVALID_ARGUMENTS);
+
+    Oroto::BootGraph cycle;
+    cycle.addStage("a", {"b"}, stage("a", true));
+    cycle.addStage("b", {"a"}, stage("b", true));
+    cycle.addStage("c", {}, stage("c", true));
+    ASSERT_TRUE(cycle.run(pool).error() == Oroto::ErrorCode::INVALID_ARGUMENTS);
+    ASSERT_TRUE(order.empty());
+}
+
+void testPipelineBackpressure() {
+    Oroto::CommandArena arena;
+    CommandArgs args(&arena);
+    args.emplace_back("stage");
+    std::ostringstream terminal;
+
+    // The producer could emit far more than the consumer takes; bounded queues
+    // keep it at most a few records ahead, and it stops once 'head' is done
+    std::atomic<size_t> produced(0);
+    auto producer = [&produced](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        for (size_t i = 0; i < 100000; ++i) {
+            ++produced;
+            if (!stream.emit(Oroto::Record(Oroto::RecordKind::PORT).set("port", std::to_string(i)))) {
+                break;
+            }
+        }
+        return Oroto::ok();
+    };
+    auto evenOnly = [](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        Oroto::Record record;
+        while (stream.next(record)) {
+            if (std::stoul(*record.find("port")) % 2 == 0 && !stream.emit(std::move(record))) {
+                break;
+            }
+        }
+        return Oroto::ok();
+    };
+    auto headThree = [](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        Oroto::Record record;
+        for (int i = 0; i < 3 && stream.next(record); ++i) {
+            stream.emit(std::move(record));
+        }
+        return Oroto::ok();
+    };
+
+    auto status = Oroto::runPipeline({{&args, producer}, {&args, evenOnly}, {&args, headThree}}, terminal, 4);
+    ASSERT_TRUE(status.hasValue());
+    ASSERT_EQ(std::string("port port=0\nport port=2\nport port=4\n"), terminal.str());
+    ASSERT_TRUE(produced.load() < 32);
+
+    // The status is that of the last stage to fail, and a failing first stage
+    // still lets the rest finish what it produced
+    terminal.str("");
+    auto failing = [](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        stream.emit(Oroto::Record(Oroto::RecordKind::HOST).set("addr", "10.0.0.1"));
+        return Oroto::makeError(Oroto::ErrorCode::NETWORK_ERROR);
+    };
+    auto json = [](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        Oroto::Record record;
+        while (stream.next(record)) {
+            Oroto::writeRecordJson(record, stream.terminal());
+        }
+        return Oroto::ok();
+    };
+    status = Oroto::runPipeline({{&args, failing}, {&args, json}}, terminal);
+    ASSERT_FALSE(status.hasValue());
+    ASSERT_TRUE(status.error() == Oroto::ErrorCode::NETWORK_ERROR);
+    ASSERT_EQ(std::string("{\"type\":\"host\",\"fields\":{\"addr\":\"10.0.0.1\"}}\n"), terminal.str());
+
+    // A stage throwing something other than std::exception fails the
+    // pipeline instead of terminating the process, and the producer stops
+    terminal.str("");
+    produced = 0;
+    auto throwing = [](const CommandArgs&, Oroto::RecordStream& stream) -> Oroto::Status {
+        Oroto::Record record;
+        stream.next(record);
+        throw 42;
+    };
+    status = Oroto::runPipeline({{&args, producer}, {&args, throwing}, {&args, json}}, terminal, 4);
+    ASSERT_TRUE(status.error() == Oroto::ErrorCode::INTERNAL_ERROR);
+    ASSERT_TRUE(produced.load() < 32);
+    ASSERT_EQ(std::string(""), terminal.str());
+}
+
+void testOutputWriterModes() {
+    // The same events in each mode
+    auto render = [](Oroto::OutputMode mode) {
+        std::ostringstream stream;
+        Oroto::OutputWriter out(stream, mode);
+        out.title("MEMORY USAGE REPORT");
+        out.field("Used RAM", "2150 MB");
+        out.message(Oroto::Tone::ERROR, "ERROR", {"Unknown command: ", "f\"o"});
+        out.blank();
+        out.decoration("ascii art\n");
+        out.result("bogus", Oroto::ErrorCode::COMMAND_NOT_FOUND);
+        return stream.str();
+    };
+
+    std::string human = render(Oroto::OutputMode::HUMAN);
+    ASSERT_TRUE(human.find("MEMORY USAGE REPORT") != std::string::npos);
+    ASSERT_TRUE(human.find("Used RAM:      ") != std::string::npos);
+    ASSERT_TRUE(human.find("[ERROR] Unknown command: f\"o") != std::string::npos);
+    ASSERT_TRUE(human.find("ascii art") != std::string::npos);
+    ASSERT_TRUE(human.find("result") == std::string::npos);
+
+    // No colours, boxes or spacing in machine output: one object per event
+    std::string json = render(Oroto::OutputMode::JSON);
+    ASSERT_EQ(std::string(
+        "{\"event\":\"title\",\"text\":\"MEMORY USAGE REPORT\"}\n"
+        "{\"event\":\"field\",\"key\":\"Used RAM\",\"value\":\"2150 MB\"}\n"
+        "{\"event\":\"message\",\"level\":\"error\",\"tag\":\"ERROR\",\"text\":\"Unknown command: f\\\"o\"}\n"
+        "{\"event\":\"result\",\"command\":\"bogus\",\"code\":1,\"error\":\"Command not found\"}\n"), json);
+
+    // Rows keep their tone; keys chosen by the caller are nested, so a cell
+    // or field called "event", "level" or "type" cannot repeat a key
+    std::ostringstream tables;
+    Oroto::OutputWriter tableOut(tables, Oroto::OutputMode::JSON);
+    tableOut.row({{"event", "login", 0}, {"level", "3", 0}}, Oroto::Tone::OK);
+    tableOut.record(Oroto::Record(Oroto::RecordKind::RESULT).set("type", "md5").set("event", "x"));
+    ASSERT_EQ(std::string(
+        "{\"event\":\"row\",\"level\":\"ok\",\"cells\":{\"event\":\"login\",\"level\":\"3\"}}\n"
+        "{\"event\":\"record\",\"type\":\"result\",\"fields\":{\"type\":\"md5\",\"event\":\"x\"}}\n"), tables.str());
+
+    // Binary: type, tone, string count, then length-prefixed strings
+    std::string binary = render(Oroto::OutputMode::BINARY);
+    ASSERT_EQ(std::string("\x01\x00\x01\x13MEMORY USAGE REPORT", 23), binary.substr(0, 23));
+    ASSERT_EQ(std::string("\x03\x00\x02\x08Used RAM\x07" "2150 MB", 20), binary.substr(23, 20));
+    ASSERT_TRUE(binary.find('\x1b') == std::string::npos);
+    ASSERT_TRUE(binary.find("ascii art") == std::string::npos);
+
+    // Counts past 127 take more than one byte, like lengths
+    Oroto::Record wide(Oroto::RecordKind::HOST);
+    for (int i = 0; i < 200; ++i) {
+        wide.fields.emplace_back("k", "v");
+    }
+    std::ostringstream wideStream;
+    Oroto::OutputWriter(wideStream, Oroto::OutputMode::BINARY).record(wide);
+    ASSERT_EQ(std::string("\x91\x03", 2), wideStream.str().substr(2, 2));
+    ASSERT_EQ(size_t(4 + 5 + 200 * 4), wideStream.str().size());
+
+    // Threads start human; a scope lends them a session's mode
+    ASSERT_TRUE(Oroto::currentOutputMode() == Oroto::OutputMode::HUMAN);
+    {
+        Oroto::OutputModeScope scope(Oroto::OutputMode::JSON);
+        ASSERT_FALSE(Oroto::out().human());
+    }
+    ASSERT_TRUE(Oroto::out().human());
+}
+
+void testCommandHistoryPersistence() {
+    const std::string path = "tests/test_history";
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+
+    {
+        Oroto::CommandHistory history;
+        ASSERT_TRUE(history.open(path).hasValue());
+        ASSERT_TRUE(history.append("nmap 10.0.0.1", 100).hasValue());
+        ASSERT_TRUE(history.append("ping host", 101).hasValue());
+        ASSERT_TRUE(history.append("   ", 102).hasValue());
+        ASSERT_TRUE(history.append("nmap 10.0.0.2 | filter open", 103).hasValue());
+        ASSERT_TRUE(history.append("nmap 10.0.0.1", 104).hasValue());
+        ASSERT_EQ(static_cast<size_t>(4), history.size());
+    }
+
+    // A second instance sees the same entries, and each sees the other's appends
+    Oroto::CommandHistory history;
+    Oroto::CommandHistory other;
+    ASSERT_TRUE(history.open(path).hasValue());
+    ASSERT_TRUE(other.open(path).hasValue());
+    Oroto::HistoryEntry entry;
+    ASSERT_TRUE(history.get(2, entry));
+    ASSERT_EQ(std::string("ping host"), entry.command);
+    ASSERT_TRUE(entry.time == 101);
+    ASSERT_FALSE(history.get(5, entry));
+    ASSERT_TRUE(history.findPrefix("nmap", entry));
+    ASSERT_TRUE(entry.number == 4);
+    ASSERT_TRUE(history.findPrefix("nmap", entry, 4));
+    ASSERT_TRUE(entry.number == 3);
+    ASSERT_TRUE(history.findPrefix("nmap 10.0.0.1", entry, 4));
+    ASSERT_TRUE(entry.number == 1);
+    ASSERT_FALSE(history.findPrefix("nmap", entry, 1));
+    ASSERT_TRUE(other.append("whois example.com", 105).hasValue());
+    ASSERT_TRUE(history.findPrefix("w", entry));
+    ASSERT_TRUE(entry.number == 5);
+
+    auto found = history.search("10.0.0", 10);
+    ASSERT_EQ(static_cast<size_t>(3), found.size());
+    ASSERT_TRUE(found[0].number == 4 && found[2].number == 1);
+    auto last = history.tail(2);
+    ASSERT_EQ(static_cast<size_t>(2), last.size());
+    ASSERT_EQ(std::string("whois example.com"), last[1].command);
+
+    // A lost index is rebuilt from the log, and a line cut short by a crash
+    // is closed off before the next one
+    std::remove((path + ".idx").c_str());
+    {
+        std::ofstream log(path, std::ios::app);
+        log << "106\tcd /tm";
+    }
+    Oroto::CommandHistory rebuilt;
+    ASSERT_TRUE(rebuilt.open(path).hasValue());
+    ASSERT_EQ(static_cast<size_t>(5), rebuilt.size());
+    ASSERT_TRUE(rebuilt.append("ls", 107).hasValue());
+    ASSERT_EQ(static_cast<size_t>(7), rebuilt.size());
+    ASSERT_TRUE(rebuilt.get(6, entry));
+    ASSERT_EQ(std::string("cd /tm"), entry.command);
+    ASSERT_TRUE(rebuilt.get(7, entry));
+    ASSERT_EQ(std::string("ls"), entry.command);
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+void testCommandHistoryIndexedLookups() {
+    // Prefix and substring lookups agree with a plain scan, also after
+    // appends extend the indexes; the last round mixes merged entries with
+    // ones still waiting to be merged
+    const std::string path = "tests/test_history_index";
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+    Oroto::CommandHistory history;
+    ASSERT_TRUE(history.open(path).hasValue());
+
+    const char* words[] = {"nmap", "ping", "nmap -p", "crack", "cat", "ping -c"};
+    std::vector<std::string> commands;
+    uint32_t seed = 7;
+    auto append = [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            std::string command = std::string(words[(seed >> 8) % 6]) + " 10.0." +
+                                  std::to_string((seed >> 12) % 7) + "." + std::to_string((seed >> 16) % 50);
+            commands.push_back(command);
+            ASSERT_TRUE(history.append(command, 1000 + static_cast<int64_t>(commands.size())).hasValue());
+        }
+    };
+    auto newestBelow = [&](const std::string& prefix, size_t before) -> size_t {
+        size_t limit = before == 0 ? commands.size() : before - 1;
+        for (size_t i = limit; i-- > 0;) {
+            if (commands[i].compare(0, prefix.size(), prefix) == 0) {
+                return i + 1;
+            }
+        }
+        return 0;
+    };
+
+    for (int round = 0; round < 3; ++round) {
+        append(700);
+        for (const std::string prefix : {"nmap", "nmap -p 10.0.3", "ping", "c", "cat 10.0.6.4", "z", ""}) {
+            for (size_t before : {size_t(0), commands.size() / 2, size_t(2)}) {
+                Oroto::HistoryEntry entry;
+                size_t expected = newestBelow(prefix, before);
+                ASSERT_TRUE(history.findPrefix(prefix, entry, before) == (expected != 0));
+                ASSERT_TRUE(expected == 0 || entry.number == expected);
+            }
+        }
+        for (const std::string term : {"10.0.4.1", "-c 10", "p 10.0.2.3", "k 1", "xyz", ".4"}) {
+            std::vector<size_t> expected;
+            for (size_t i = commands.size(); i-- > 0 && expected.size() < 25;) {
+                if (commands[i].find(term) != std::string::npos) {
+                    expected.push_back(i + 1);
+                }
+            }
+            auto found = history.search(term, 25);
+            ASSERT_EQ(expected.size(), found.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                ASSERT_TRUE(found[i].number == expected[i] && found[i].command == commands[expected[i] - 1]);
+            }
+        }
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+void testLineEditorRestoresTerminal() {
+    int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_TRUE(master >= 0);
+    ASSERT_TRUE(::grantpt(master) == 0 && ::unlockpt(master) == 0);
+    int slave = ::open(::ptsname(master), O_RDWR | O_NOCTTY);
+    ASSERT_TRUE(slave >= 0);
+
+    Oroto::CompletionEngine engine;
+    Oroto::LineEditor editor(slave, slave, engine);
+    std::string line;
+    bool gotLine = false;
+    std::thread reader([&]() { gotLine = editor.readLine("> ", line); });
+
+    // Wait for raw mode, then exit the prompt the way the Ctrl-C handler does
+    struct termios mode;
+    for (int i = 0; i < 2000; ++i) {
+        ::tcgetattr(slave, &mode);
+        if (!(mode.c_lflag & ECHO)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool raw = !(mode.c_lflag & ECHO);
+    Oroto::LineEditor::restoreTerminal();
+    ::tcgetattr(slave, &mode);
+    bool restored = (mode.c_lflag & (ECHO | ICANON)) == (ECHO | ICANON);
+
+    // Restoring twice is harmless; the editor's own exit path does it again
+    Oroto::LineEditor::restoreTerminal();
+    ASSERT_TRUE(::write(master, "ls\n", 3) == 3);
+    reader.join();
+    ::close(slave);
+    ::close(master);
+
+    ASSERT_TRUE(raw);
+    ASSERT_TRUE(restored);
+    ASSERT_TRUE(gotLine);
+    ASSERT_EQ(std::string("ls"), line);
+}
+
+void testCompletionTrie() {
+    Oroto::CompletionTrie trie;
+    ASSERT_TRUE(trie.insert("netstat"));
+    ASSERT_TRUE(trie.insert("nmap"));
+    ASSERT_TRUE(trie.insert("nmapx"));
+    ASSERT_FALSE(trie.insert("nmap"));
+    ASSERT_EQ(size_t(3), trie.size());
+
+    auto cursor = trie.find("n");
+    ASSERT_EQ(size_t(3), trie.count(cursor));
+    ASSERT_EQ(std::string(""), trie.commonExtension(cursor));
+    ASSERT_TRUE(trie.advance(cursor, 'm'));
+    ASSERT_EQ(std::string("ap"), trie.commonExtension(cursor));
+    auto found = trie.candidates(cursor, "nm", 10);
+    ASSERT_EQ(size_t(2), found.size());
+    ASSERT_EQ(std::string("nmap"), found[0]);
+    ASSERT_EQ(std::string("nmapx"), found[1]);
+    ASSERT_FALSE(trie.advance(cursor, 'z'));
+    ASSERT_EQ(size_t(0), trie.count(cursor));
+
+    // Erased words drop out of counts and listings
+    ASSERT_TRUE(trie.erase("nmap"));
+    ASSERT_FALSE(trie.erase("nmap"));
+    ASSERT_EQ(size_t(1), trie.count(trie.find("nm")));
+    ASSERT_EQ(std::string("apx"), trie.commonExtension(trie.find("nm")));
+
+    // Commands come from the registry, argument kinds from usage text
+    Oroto::CommandRegistry& registry = Oroto::getCommandRegistry();
+    Oroto::CommandRegistrar registrar(registry, "CompletionTest");
+    auto handler = [](const CommandArgs&) { return Oroto::ok(); };
+    ASSERT_TRUE(registrar.add("zping", handler, "zping [host]"));
+    ASSERT_TRUE(registrar.add("zcat", handler, "zcat [file]"));
+    ASSERT_TRUE(registrar.add("zscan net", handler, "zscan net [target]"));
+
+    Oroto::CompletionEngine engine;
+    for (int i = 0; i < 20000; ++i) {
+        engine.addHost("10." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ".1");
+    }
+    engine.addFile("kernel.conf");
+    engine.addFile("etc/");
+
+    auto result = engine.complete("zp", 10);
+    ASSERT_EQ(size_t(1), result.total);
+    ASSERT_EQ(std::string("ing"), result.extension);
+    result = engine.complete("zscan n", 10);
+    ASSERT_EQ(std::string("et"), result.extension);
+    ASSERT_EQ(size_t(0), result.start);
+    result = engine.complete("zcat k", 10);
+    ASSERT_EQ(std::string("ernel.conf"), result.extension);
+    ASSERT_EQ(size_t(5), result.start);
+    result = engine.complete("zping 10.7.", 5);
+    ASSERT_EQ(size_t(256), result.total);
+    ASSERT_EQ(size_t(5), result.candidates.size());
+    ASSERT_EQ(std::string("10.7.0.1"), result.candidates[0]);
+
+    // Typing one key at a time moves the same query down the trie
+    Oroto::CompletionQuery query;
+    engine.update(query, "pwd; zping 10.");
+    engine.update(query, "pwd; zping 10.77");
+    engine.update(query, "pwd; zping 10.77.25");
+    result = engine.result(query, 10);
+    ASSERT_EQ(size_t(7), result.total);
+    ASSERT_EQ(size_t(11), result.start);
+
+    // Hosts typed in a command that ran are offered next time
+    engine.noteTargets("zscan net 172.16.0.0/24 && zping gateway.local");
+    ASSERT_EQ(std::string("ateway.local"), engine.complete("zping g", 10).extension);
+    ASSERT_EQ(std::string("2.16.0.0/24"), engine.complete("zscan net 17", 10).extension);
+
+    // Unloading commands rebuilds the command trie
+    ASSERT_EQ(size_t(3), registry.unregisterOwner("CompletionTest"));
+    ASSERT_EQ(size_t(0), engine.complete("zp", 10).total);
+}
+
+void testMd5KnownAnswers() {
+    // RFC 1321 test suite
+    const std::pair<std::string, std::string> vectors[] = {
+        {"", "d41d8cd98f00b204e9800998ecf8427e"},
+        {"a", "0cc175b9c0f1b6a831c399e269772661"},
+        {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+        {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+        {"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+        {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f"},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+         "57edf4a22be3c955ac49da2e2107b67a"},
+    };
+    for (const auto& vector : vectors) {
+        ASSERT_EQ(vector.second, Oroto::toHex(Oroto::Md5::digest(vector.first)));
+        // Fed in uneven pieces through the streaming interface
+        Oroto::Md5 md5;
+        for (size_t pos = 0; pos < vector.first.size(); pos += 7) {
+            md5.update(std::string_view(vector.first).substr(pos, 7));
+        }
+        ASSERT_EQ(vector.second, Oroto::toHex(md5.finish()));
+    }
+    // Around the one-block limit of the fast path
+    for (size_t length : {55, 56, 63, 64, 65}) {
+        std::string text(length, 'x');
+        Oroto::Md5 md5;
+        md5.update(text);
+        ASSERT_TRUE(md5.finish() == Oroto::Md5::digest(text));
+    }
+
+    Oroto::Md5Digest digest;
+    ASSERT_FALSE(Oroto::parseHex("5d41402abc4b2a76b9719d911017c59", digest));
+    ASSERT_FALSE(Oroto::parseHex("zd41402abc4b2a76b9719d911017c592", digest));
+    ASSERT_TRUE(Oroto::parseHex("5D41402ABC4B2A76B9719D911017C592", digest));
+
+    // Every word is hashed until the match, blank lines and CRs aside. The
+    // scalar kernel hashes each word as it comes, so the count is exact.
+    Oroto::CrackTarget target;
+    ASSERT_TRUE(Oroto::CrackTarget::parse("5D41402ABC4B2A76B9719D911017C592", target));
+    const Oroto::HashKernel* scalar = Oroto::hashKernels(Oroto::HashAlgorithm::MD5).front();
+    std::istringstream wordlist("123456\r\n\npassword\nhello\nworld\n");
+    Oroto::CrackResult result = Oroto::crackDictionary(target, wordlist, 0, nullptr, scalar);
+    ASSERT_TRUE(result.found);
+    ASSERT_EQ(std::string("hello"), result.plaintext);
+    ASSERT_TRUE(result.attempts == 3);
+
+    std::istringstream misses("a\nb\nc\n");
+    result = Oroto::crackDictionary(target, misses, 0, nullptr, scalar);
+    ASSERT_FALSE(result.found);
+    ASSERT_TRUE(result.attempts == 3);
+}
+
+void testHashKernels() {
+    ASSERT_EQ(std::string("a9993e364706816aba3e25717850c26c9cd0d89d"), Oroto::toHex(Oroto::Sha1::digest("abc")));
+    ASSERT_EQ(std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+              Oroto::toHex(Oroto::Sha256::digest("abc")));
+    ASSERT_EQ(std::string("84983e441c3bd26ebaae4aa1f95129e5e54670f1"),
+              Oroto::toHex(Oroto::Sha1::digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")));
+
+    // Every kernel the CPU runs agrees with the scalar code, lane by lane
+    const Oroto::HashAlgorithm algorithms[] = {Oroto::HashAlgorithm::MD5, Oroto::HashAlgorithm::SHA1,
+                                               Oroto::HashAlgorithm::SHA256};
+    for (Oroto::HashAlgorithm algorithm : algorithms) {
+        std::vector<const Oroto::HashKernel*> kernels = Oroto::hashKernels(algorithm);
+        ASSERT_TRUE(!kernels.empty() && kernels.front()->lanes == 1);
+        ASSERT_TRUE(&Oroto::bestHashKernel(algorithm) == kernels.back());
+        size_t size = Oroto::digestSize(algorithm);
+        for (const Oroto::HashKernel* kernel : kernels) {
+            for (size_t length : {0, 1, 8, 31, 55}) {
+                std::vector<std::string> messages;
+                const uint8_t* pointers[Oroto::MAX_KERNEL_LANES];
+                for (size_t lane = 0; lane < kernel->lanes; ++lane) {
+                    std::string message(length, 'a');
+                    for (size_t i = 0; i < length; ++i) {
+                        message[i] = static_cast<char>('!' + (lane * 7 + i * 13) % 90);
+                    }
+                    messages.push_back(message);
+                }
+                for (size_t lane = 0; lane < kernel->lanes; ++lane) {
+                    pointers[lane] = reinterpret_cast<const uint8_t*>(messages[lane].data());
+                }
+                uint8_t digests[Oroto::MAX_KERNEL_LANES * Oroto::MAX_DIGEST_SIZE];
+                kernel->run(pointers, length, digests);
+                for (size_t lane = 0; lane < kernel->lanes; ++lane) {
+                    uint8_t expected[Oroto::MAX_DIGEST_SIZE];
+                    Oroto::hashOne(algorithm, messages[lane], expected);
+                    ASSERT_TRUE(std::memcmp(expected, digests + lane * size, size) == 0);
+                }
+            }
+        }
+    }
+
+    // Brute force over a small keyspace with the widest kernel, including a
+    // final partial batch
+    Oroto::CrackTarget target;
+    ASSERT_TRUE(Oroto::CrackTarget::parse(Oroto::toHex(Oroto::Sha256::digest("cab")), target));
+    ASSERT_TRUE(target.algorithm == Oroto::HashAlgorithm::SHA256);
+    Oroto::CrackResult result = Oroto::crackKeyspaces(target, Oroto::bruteForceKeyspaces("abc", 1, 3));
+    ASSERT_TRUE(result.found);
+    ASSERT_EQ(std::string("cab"), result.plaintext);
+    ASSERT_TRUE(Oroto::CrackTarget::parse(Oroto::toHex(Oroto::Sha1::digest("abcd")), target));
+    result = Oroto::crackKeyspaces(target, Oroto::bruteForceKeyspaces("abc", 1, 3));
+    ASSERT_FALSE(result.found);
+    ASSERT_TRUE(result.attempts == 3 + 9 + 27);
+    ASSERT_FALSE(Oroto::CrackTarget::parse("abc", target));
+}
+
+void testKeyspacePartitioning() {
+    // decode() of any index agrees with walking there with next()
+    Oroto::Keyspace keyspace;
+    ASSERT_TRUE(Oroto::Keyspace::parseMask("?d?l-?u", keyspace));
+    ASSERT_TRUE(keyspace.size() == 10 * 26 * 26);
+    char walked[Oroto::Keyspace::MAX_LENGTH];
+    char jumped[Oroto::Keyspace::MAX_LENGTH];
+    size_t walkedDigits[Oroto::Keyspace::MAX_LENGTH];
+    size_t jumpedDigits[Oroto::Keyspace::MAX_LENGTH];
+    keyspace.decode(0, walked, walkedDigits);
+    ASSERT_EQ(std::string("0a-A"), std::string(walked, keyspace.length()));
+    for (uint64_t index = 1; index < keyspace.size(); ++index) {
+        ASSERT_TRUE(keyspace.next(walked, walkedDigits));
+        if (index % 397 == 0) {
+            keyspace.decode(index, jumped, jumpedDigits);
+            ASSERT_EQ(std::string(jumped, keyspace.length()), std::string(walked, keyspace.length()));
+        }
+    }
+    ASSERT_EQ(std::string("9z-Z"), std::string(walked, keyspace.length()));
+    ASSERT_FALSE(keyspace.next(walked, walkedDigits));
+    ASSERT_FALSE(Oroto::Keyspace::parseMask("?x", keyspace));
+    ASSERT_FALSE(Oroto::Keyspace::parseMask("ab?", keyspace));
+    // 95^10 does not fit 64 bits
+    ASSERT_FALSE(Oroto::Keyspace::parseMask("?a?a?a?a?a?a?a?a?a?a", keyspace));
+
+    // Split across a pool: the match is found in whichever chunk holds it,
+    // and the other threads stop well before the keyspace runs out
+    Oroto::ThreadPool pool(3);
+    std::vector<Oroto::Keyspace> keyspaces = Oroto::bruteForceKeyspaces("abcdefghijklmnopqrstuvwxyz", 1, 5);
+    Oroto::CrackTarget target;
+    ASSERT_TRUE(Oroto::CrackTarget::parse(Oroto::toHex(Oroto::Md5::digest("fooba")), target));
+    Oroto::CrackResult result = Oroto::crackKeyspaces(target, keyspaces, nullptr, nullptr, &pool);
+    ASSERT_TRUE(result.found);
+    ASSERT_EQ(std::string("fooba"), result.plaintext);
+    ASSERT_TRUE(result.attempts < 26ULL * 26 * 26 * 26 * 26);
+
+    ASSERT_TRUE(Oroto::Keyspace::parseMask("x?d?d?d", keyspace));
+    ASSERT_TRUE(Oroto::CrackTarget::parse(Oroto::toHex(Oroto::Sha256::digest("y123")), target));
+    result = Oroto::crackKeyspaces(target, {keyspace}, nullptr, nullptr, &pool);
+    ASSERT_FALSE(result.found);
+    ASSERT_TRUE(result.attempts == 1000);
+}
+
+void testDigestSetBatchCracking() {
+    // Thousands of unrelated targets plus a few real ones
+    Oroto::DigestSet targets(Oroto::HashAlgorithm::MD5);
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(targets.add(Oroto::Md5::digest("noise-" + std::to_string(i)).data()));
+    }
+    const char* const passwords[] = {"apple", "zebra", "mango", "kiwi"};
+    for (const char* password : passwords) {
+        ASSERT_TRUE(targets.add(Oroto::Md5::digest(password).data()));
+    }
+    ASSERT_FALSE(targets.add(Oroto::Md5::digest("apple").data()));
+    ASSERT_TRUE(targets.size() == 5004);
+    ASSERT_TRUE(targets.find(Oroto::Md5::digest("noise-1234").data()) == 1234);
+    ASSERT_TRUE(targets.find(Oroto::Md5::digest("kiwi").data()) == 5003);
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(targets.find(Oroto::Md5::digest("other-" + std::to_string(i)).data()) ==
+                    Oroto::DigestSet::NOT_FOUND);
+    }
+
+    // One pass over the wordlist cracks every target it contains
+    std::istringstream wordlist("banana\nmango\ncherry\napple\nkiwi\n");
+    Oroto::CrackResult result = Oroto::crackDictionary(targets, wordlist);
+    ASSERT_TRUE(result.found);
+    ASSERT_TRUE(result.cracked.size() == 3);
+    ASSERT_TRUE(result.attempts == 5);
+    for (const auto& cracked : result.cracked) {
+        ASSERT_TRUE(std::memcmp(targets.digest(cracked.target), Oroto::Md5::digest(cracked.plaintext).data(), 16) == 0);
+    }
+
+    // Brute force stops once the last target falls, here before length 4
+    Oroto::DigestSet shaTargets(Oroto::HashAlgorithm::SHA1);
+    for (const char* password : {"q", "ab", "zzz"}) {
+        ASSERT_TRUE(shaTargets.add(Oroto::Sha1::digest(password).data()));
+    }
+    Oroto::ThreadPool pool(2);
+    result = Oroto::crackKeyspaces(shaTargets, Oroto::bruteForceKeyspaces("abcdefghijklmnopqrstuvwxyz", 1, 4),
+                                   nullptr, nullptr, &pool);
+    ASSERT_TRUE(result.cracked.size() == 3);
+    ASSERT_TRUE(result.attempts <= 26 + 26 * 26 + 26 * 26 * 26);
+}
+
+void testMappedWordlistChunks() {
+    // Long enough for several chunks; a few odd lines sit across 64-byte blocks
+    const std::string path = "tests/test_wordlist";
+    std::string expected;
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int i = 0; i < 300000; ++i) {
+            file << "word" << i << (i % 7 == 0 ? "\r\n" : "\n") << (i % 1000 == 0 ? "\n" : "");
+        }
+        file << "lastline";
+    }
+    Oroto::MappedWordlist wordlist;
+    ASSERT_TRUE(wordlist.open(path));
+    ASSERT_FALSE(wordlist.open("tests/no_such_wordlist"));
+    ASSERT_TRUE(wordlist.open(path));
+
+    // Same lines as the streaming reader, whatever the chunk size
+    std::ifstream stream(path, std::ios::binary);
+    Oroto::WordlistReader reader(stream);
+    std::vector<std::string> streamed;
+    for (std::string word; reader.next(word);) {
+        streamed.push_back(word);
+    }
+    ASSERT_TRUE(streamed.size() == 300001);
+    for (size_t chunk : {size_t(5), size_t(64), size_t(4093), size_t(1) << 20}) {
+        std::vector<std::string_view> split;
+        for (size_t index = 0; index * chunk < wordlist.size(); ++index) {
+            std::string_view range = Oroto::wordlistChunk(wordlist.text(), index, chunk);
+            ASSERT_TRUE(range.empty() || range.data() == wordlist.text().data() || range.data()[-1] == '\n');
+            Oroto::forEachLine(range.data(), range.data() + range.size(), [&](std::string_view word) {
+                split.push_back(word);
+                return false;
+            });
+        }
+        ASSERT_TRUE(split.size() == streamed.size());
+        ASSERT_TRUE(std::equal(split.begin(), split.end(), streamed.begin()));
+    }
+
+    // Targets scattered over the file, cracked across the pool's chunks
+    Oroto::DigestSet targets(Oroto::HashAlgorithm::SHA256);
+    for (const char* password : {"word0", "word123457", "word299999", "lastline"}) {
+        ASSERT_TRUE(targets.add(Oroto::Sha256::digest(password).data()));
+    }
+    Oroto::ThreadPool pool(2);
+    Oroto::CrackResult result = Oroto::crackWordlist(targets, wordlist.text(), nullptr, nullptr, &pool);
+    ASSERT_TRUE(result.cracked.size() == 4);
+    ASSERT_TRUE(result.attempts <= streamed.size());
+    std::remove(path.c_str());
+}
+
+void testManglingRules() {
+    Oroto::RuleSet rules;
+    const char* const valid[] = {":", "c", "u", "t", "T1", "r", "d", "p2", "f", "{", "}", "$1 $2", "^!",
+                                 "[", "]", "D2", "'3", "x13", "O12", "i2-", "o0X", "sa4 se3 so0", "@s",
+                                 "z2", "Z2", "q", "c $2 $0 $2 $4"};
+    for (const char* rule : valid) {
+        ASSERT_TRUE(rules.add(rule));
+    }
+    ASSERT_FALSE(rules.add("$"));
+    ASSERT_FALSE(rules.add("T!"));
+    ASSERT_FALSE(rules.add("s4"));
+    ASSERT_FALSE(rules.add("k"));
+    ASSERT_TRUE(rules.size() == std::size(valid));
+
+    const char* const expected[] = {"password", "Password", "PASSWORD", "PASSWORD", "pAssword", "drowssap",
+                                    "passwordpassword", "passwordpasswordpassword", "passworddrowssap",
+                                    "asswordp", "dpasswor", "password12", "!password", "assword", "passwor",
+                                    "pasword", "pas", "ass", "psword", "pa-ssword", "Xassword", "p4ssw0rd",
+                                    "paword", "pppassword", "passworddd", "ppaasssswwoorrdd", "Password2024"};
+    std::vector<std::string> produced;
+    rules.forEachCandidate("password", [&](std::string_view candidate) {
+        produced.emplace_back(candidate);
+        return false;
+    });
+    ASSERT_TRUE(produced.size() == std::size(expected));
+    for (size_t i = 0; i < produced.size(); ++i) {
+        ASSERT_EQ(std::string(expected[i]), produced[i]);
+    }
+
+    // Positions past the end change nothing; results that would not fit are dropped
+    char buffer[Oroto::RuleSet::MAX_LENGTH];
+    Oroto::RuleSet edge;
+    ASSERT_TRUE(edge.add("T9 D9 x9Z") && edge.add("d d d d d"));
+    ASSERT_TRUE(edge.apply(0, "abc", buffer) == 3 && std::string_view(buffer, 3) == "abc");
+    ASSERT_TRUE(edge.apply(1, "abcdefgh", buffer) == -1);
+
+    // Every rule's candidate is hashed, threaded or streamed
+    Oroto::DigestSet targets(Oroto::HashAlgorithm::MD5);
+    for (const char* password : {"Monkey2024", "dr4g0n", "SHADOW"}) {
+        ASSERT_TRUE(targets.add(Oroto::Md5::digest(password).data()));
+    }
+    Oroto::RuleSet attack;
+    for (const char* rule : {":", "c $2 $0 $2 $4", "sa4 so0", "u"}) {
+        ASSERT_TRUE(attack.add(rule));
+    }
+    Oroto::ThreadPool pool(2);
+    Oroto::CrackResult result = Oroto::crackWordlist(targets, "monkey\ndragon\nshadow\n", nullptr, nullptr, &pool,
+                                                     &attack);
+    ASSERT_TRUE(result.cracked.size() == 3);
+    std::istringstream wordlist("monkey\ndragon\nshadow\n");
+    result = Oroto::crackDictionary(targets, wordlist, 0, nullptr, nullptr, &attack);
+    ASSERT_TRUE(result.cracked.size() == 3);
+    ASSERT_TRUE(result.attempts == 12);
+}
+
+void testCrackSessionResume() {
+    // Arguments and plaintexts survive any byte, including the separators
+    const std::string path = "tests/test_crack.session";
+    Oroto::CrackSession saved;
+    saved.args = {"--mask=?l\t?d", "--mode=brute"};
+    saved.mode = '2';
+    saved.position = {3, 123456789};
+    saved.inputSize = 42;
+    saved.attempts = 1000;
+    saved.seconds = 2.5;
+    saved.cracked = {{"0cc175b9c0f1b6a831c399e269772661", "a\nb"}};
+    ASSERT_TRUE(saved.save(path));
+    Oroto::CrackSession loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_TRUE(loaded.args == saved.args && loaded.mode == '2' && loaded.cracked == saved.cracked);
+    ASSERT_TRUE(loaded.position.part == 3 && loaded.position.offset == 123456789 && loaded.attempts == 1000);
+    std::remove(path.c_str());
+    ASSERT_TRUE(loaded.load(path).error() == Oroto::ErrorCode::FILE_NOT_FOUND);
+    ASSERT_FALSE(Oroto::CrackSession::validName("../etc"));
+
+    // No resumable attack running: signals keep their old meaning
+    ASSERT_FALSE(Oroto::requestCrackStop());
+
+    // Stop a single-threaded brute force part way, as SIGINT would, then carry
+    // on across the pool from the last checkpoint: together the two runs
+    // crack an early and a late target
+    Oroto::DigestSet targets(Oroto::HashAlgorithm::MD5);
+    for (const char* password : {"b", "aaaa", "zzzy"}) {
+        ASSERT_TRUE(targets.add(Oroto::Md5::digest(password).data()));
+    }
+    std::vector<Oroto::Keyspace> keyspaces = Oroto::bruteForceKeyspaces("abcdefghijklmnopqrstuvwxyz", 1, 4);
+    Oroto::ThreadPool pool(2);
+    Oroto::CrackPosition checkpoint;
+    Oroto::CrackResult snapshot;
+    int saves = 0;
+    Oroto::CrackResume first;
+    first.interval = 0.0;
+    first.save = [&](const Oroto::CrackPosition& position, const Oroto::CrackResult& progress) {
+        checkpoint = position;
+        snapshot = progress;
+        if (++saves == 40) {
+            ASSERT_TRUE(Oroto::requestCrackStop());
+        }
+    };
+    Oroto::CrackResult result;
+    {
+        Oroto::CrackStopScope stoppable;
+        result = Oroto::crackKeyspaces(targets, keyspaces, nullptr, nullptr, nullptr, &first);
+    }
+    ASSERT_TRUE(result.interrupted);
+    ASSERT_FALSE(Oroto::crackStopRequested());
+    ASSERT_TRUE(checkpoint.part == 3 && checkpoint.offset > 0 && checkpoint.offset < 26 * 26 * 26 * 26);
+    ASSERT_TRUE(result.attempts > 26 + 26 * 26 + 26 * 26 * 26 + checkpoint.offset);
+    ASSERT_TRUE(snapshot.cracked.size() == 2 && snapshot.attempts == result.attempts);
+
+    Oroto::CrackResume second;
+    second.start = checkpoint;
+    second.cracked = snapshot.cracked;
+    second.attempts = snapshot.attempts;
+    result = Oroto::crackKeyspaces(targets, keyspaces, nullptr, nullptr, &pool, &second);
+    ASSERT_FALSE(result.interrupted);
+    ASSERT_TRUE(result.cracked.size() == 3);
+    ASSERT_TRUE(result.attempts > snapshot.attempts);
+}
+
+void testCrackStopInPoolJob() {
+    // A stop during 'crack ... &' saves the sessions and fails the jobs with
+    // CANCELLED; the pool workers and the process carry on. Two unnamed
+    // attacks checkpoint to files of their own.
+    setenv("OROTO_SESSION_DIR", "tests", 1);
+    const std::string paths[] = {"tests/crack.session", "tests/crack-2.session"};
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+    Oroto::CommandArena arena;
+    auto parsed = Oroto::tokenizeCommandLine(
+        "oroto crack hash ffffffffffffffffffffffffffffffff --mode=brute --max-length=8 "
+        "--checkpoint=0.05 --potfile=off", &arena);
+    ASSERT_TRUE(parsed.hasValue());
+    const CommandArgs& args = (*parsed)[0].args;
+
+    Oroto::installOutputRouter(std::cout);
+    Oroto::ThreadPool pool(2);
+    Oroto::Status status[2];
+    size_t ids[2];
+    for (int i = 0; i < 2; ++i) {
+        ids[i] = pool.submitCapturedJob("crack", [&status, &args, i]() { status[i] = executeHashCrack(args); });
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto exists = [](const std::string& path) { return std::ifstream(path).good(); };
+    while (!(exists(paths[0]) && exists(paths[1])) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // A name held by a running attack is refused
+    ASSERT_FALSE(Oroto::CrackSessionClaim("crack").held());
+    bool stopped = Oroto::requestCrackStop();
+    for (size_t id : ids) {
+        ASSERT_TRUE(pool.waitJob(id)->status == Oroto::JobStatus::COMPLETED);
+    }
+    unsetenv("OROTO_SESSION_DIR");
+    ASSERT_TRUE(stopped);
+
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(status[i].error() == Oroto::ErrorCode::CANCELLED);
+        Oroto::CrackSession saved;
+        ASSERT_TRUE(saved.load(paths[i]));
+        ASSERT_TRUE(saved.mode == '2' && saved.attempts > 0);
+        std::remove(paths[i].c_str());
+    }
+    ASSERT_TRUE(Oroto::CrackSessionClaim("crack").held());
+    ASSERT_FALSE(Oroto::crackShutdownPending());
+
+    // The pool still runs jobs afterwards
+    size_t after = pool.submitJob("after", []() { return 1; });
+    ASSERT_TRUE(pool.waitJob(after)->status == Oroto::JobStatus::COMPLETED);
+}
+
+void testPotfileIndex() {
+    const std::string path = "tests/test_potfile";
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+    auto hashOf = [](size_t i) { return Oroto::toHex(Oroto::Md5::digest(std::to_string(i))); };
+
+    // Enough entries to grow the table several times, in two batches from
+    // two instances; repeats are only written once
+    Oroto::Potfile potfile;
+    Oroto::Potfile other;
+    ASSERT_TRUE(potfile.open(path).hasValue());
+    ASSERT_TRUE(other.open(path).hasValue());
+    std::vector<Oroto::PotEntry> entries;
+    for (size_t i = 0; i < 3000; ++i) {
+        entries.push_back({hashOf(i), "word" + std::to_string(i)});
+    }
+    entries.push_back({hashOf(7), "again"});
+    ASSERT_TRUE(potfile.append(std::vector<Oroto::PotEntry>(entries.begin(), entries.begin() + 2000)).hasValue());
+    ASSERT_TRUE(other.append(entries).hasValue());
+    ASSERT_EQ(static_cast<size_t>(3000), potfile.size());
+    std::string plaintext;
+    ASSERT_TRUE(potfile.lookup(hashOf(2999), plaintext));
+    ASSERT_EQ(std::string("word2999"), plaintext);
+    ASSERT_TRUE(other.lookup(hashOf(7), plaintext));
+    ASSERT_EQ(std::string("word7"), plaintext);
+    ASSERT_FALSE(potfile.lookup(hashOf(3000), plaintext));
+    ASSERT_FALSE(potfile.append({{"bad:hash", "x"}}).hasValue());
+
+    // Plaintexts a text line cannot hold round-trip through $HEX[...]
+    std::string binary("a:b\nc\0\xff", 7);
+    ASSERT_TRUE(other.append({{"deadbeef", binary}, {"cafe", "$HEX[41]"}}).hasValue());
+    ASSERT_TRUE(potfile.lookup("deadbeef", plaintext));
+    ASSERT_TRUE(plaintext == binary);
+    ASSERT_TRUE(potfile.lookup("cafe", plaintext));
+    ASSERT_EQ(std::string("$HEX[41]"), plaintext);
+
+    std::vector<std::string> wanted = {hashOf(5), "feed", hashOf(1234)};
+    std::vector<size_t> hits;
+    ASSERT_TRUE(potfile.lookupAll(wanted, [&](size_t i, const std::string&) { hits.push_back(i); }) == 2);
+    ASSERT_TRUE(hits.size() == 2 && hits[0] == 0 && hits[1] == 2);
+
+    // A lost index is rebuilt from the log, and a line cut short by a crash
+    // is closed off before the next append
+    std::remove((path + ".idx").c_str());
+    {
+        std::ofstream log(path, std::ios::app);
+        log << "0123abcd:cut sh";
+    }
+    Oroto::Potfile rebuilt;
+    ASSERT_TRUE(rebuilt.open(path).hasValue());
+    ASSERT_EQ(static_cast<size_t>(3002), rebuilt.size());
+    ASSERT_TRUE(rebuilt.append({{"beef", "steak"}}).hasValue());
+    ASSERT_TRUE(rebuilt.lookup("0123abcd", plaintext));
+    ASSERT_EQ(std::string("cut sh"), plaintext);
+    ASSERT_TRUE(rebuilt.lookup(hashOf(42), plaintext));
+    ASSERT_EQ(std::string("word42"), plaintext);
+    // The first instance notices the replaced index
+    ASSERT_TRUE(potfile.lookup("beef", plaintext));
+    ASSERT_EQ(std::string("steak"), plaintext);
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+void testHashIdentifier() {
+    const Oroto::HashIdentifier& identifier = Oroto::hashIdentifier();
+    auto bestName = [&](std::string_view hash) {
+        const Oroto::HashSignature* signature = identifier.best(hash);
+        return std::string(signature ? signature->name : "");
+    };
+    ASSERT_EQ(std::string("MD5"), bestName("5d41402abc4b2a76b9719d911017c592"));
+    ASSERT_EQ(std::string("SHA-1"), bestName("AAF4C61DDCC5E8A2DABEDE0F3B482CD9AEA9434D"));
+    ASSERT_EQ(std::string("SHA-256"), bestName(Oroto::toHex(Oroto::Sha256::digest("x"))));
+    ASSERT_EQ(std::string("SHA-512"), bestName(std::string(128, 'e')));
+    ASSERT_EQ(std::string("bcrypt"), bestName("$2y$10$N9qo8uLOickgx2ZMRZoMyeIjZAgcfl7p92ldGxad68LJZdL17lhWy"));
+    ASSERT_EQ(std::string("md5crypt"), bestName("$1$28772684$iEwNOgGugqO9.bIz5sk8k/"));
+    ASSERT_EQ(std::string("sha512crypt"), bestName("$6$52450745$k5ka2p8bFuSmoVT1tzOyyuaREkkKBcCNqoDKzYiJL9RaE8yMnPgh2XzzF0NDrUhgrcLwg78xs1w5pJiypEdFX/"));
+    ASSERT_EQ(std::string("MySQL 4.1+"), bestName("*2470C0C06DEE42FD1618BB99005ADCA2EC9D1E19"));
+    ASSERT_EQ(std::string("phpass"), bestName("$P$984478476IagS59wHZvyQMArzfx58u."));
+    ASSERT_EQ(std::string(""), bestName("hello world"));
+    ASSERT_EQ(std::string(""), bestName("$2y$10$short"));
+    ASSERT_EQ(std::string(""), bestName(std::string(31, 'a') + "g"));
+
+    // Every shape lists all its formats; only some have a kernel
+    auto md5Shape = identifier.identify("5d41402abc4b2a76b9719d911017c592");
+    ASSERT_TRUE(md5Shape.size() == 4);
+    ASSERT_EQ(std::string("NTLM"), std::string(md5Shape[1]->name));
+    ASSERT_TRUE(identifier.crackable("5d41402abc4b2a76b9719d911017c592")->algorithm == Oroto::HashAlgorithm::MD5);
+    ASSERT_TRUE(identifier.crackable("$1$28772684$iEwNOgGugqO9.bIz5sk8k/") == nullptr);
+
+    // The census counts each line under its most likely format, with the
+    // same totals whether or not the pool splits the text
+    std::string text = "# dump\n\n";
+    for (int i = 0; i < 20000; ++i) {
+        text += i % 4 == 0 ? Oroto::toHex(Oroto::Sha1::digest(std::to_string(i)))
+              : i % 4 == 1 ? "  " + Oroto::toHex(Oroto::Md5::digest(std::to_string(i))) + "\r"
+              : i % 4 == 2 ? std::string("$2b$12$") + std::string(53, 'A')
+                           : std::string("junk line");
+        text += '\n';
+    }
+    auto census = [&](const std::vector<uint64_t>& counts, std::string_view name) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < identifier.signatures().size(); ++i) {
+            total += name == identifier.signatures()[i].name ? counts[i] : 0;
+        }
+        return total;
+    };
+    Oroto::ThreadPool pool(3);
+    std::vector<uint64_t> serial = identifier.census(text);
+    std::vector<uint64_t> parallel = identifier.census(std::string(1 << 23, '\n') + text, &pool);
+    ASSERT_TRUE(serial == parallel);
+    ASSERT_TRUE(census(serial, "SHA-1") == 5000);
+    ASSERT_TRUE(census(serial, "MD5") == 5000);
+    ASSERT_TRUE(census(serial, "bcrypt") == 5000);
+    ASSERT_TRUE(serial.back() == 5000);
+}
+
+void testKernelBenchmark() {
+    const Oroto::HashKernel& kernel = Oroto::bestHashKernel(Oroto::HashAlgorithm::MD5);
+    Oroto::KernelBenchmark run = Oroto::benchmarkKernel(kernel, 3, 0.05);
+    ASSERT_TRUE(run.hashed.size() == 3);
+    for (uint64_t count : run.hashed) {
+        ASSERT_TRUE(count > 0);
+    }
+    ASSERT_TRUE(run.seconds >= 0.05);
+    ASSERT_TRUE(run.hashesPerSecond() > 0.0);
+
+    Oroto::KernelBenchmark even;
+    even.hashed = {100, 100, 100, 100};
+    even.seconds = 2.0;
+    ASSERT_TRUE(even.total() == 400 && even.hashesPerSecond() == 200.0);
+    ASSERT_TRUE(even.spread() == 0.0);
+    even.hashed = {50, 150};
+    ASSERT_TRUE(std::fabs(even.spread() - 0.5) < 1e-9);
+}
+
 int main() {
     TestRunner runner;
     
@@ -110,6 +1637,41 @@ int main() {
     runner.addTest("ResourceManager Create In Place", testResourceManagerCreateInPlace);
     runner.addTest("ResourceManager Cleanup", testResourceManagerCleanup);
     runner.addTest("Logger Initialization", testLoggerInitialization);
+    runner.addTest("CommandArena Rewind", testCommandArenaRewind);
+    runner.addTest("CommandArena Nested Scope", testCommandArenaNestedScope);
+    runner.addTest("Expected Result", testExpectedResult);
+    runner.addTest("ErrorHandler SafeExecute Expected", testSafeExecuteExpected);
+    runner.addTest("CommandRegistry Lookup", testCommandRegistryLookup);
+    runner.addTest("CommandRegistry Replace Owner", testCommandRegistryReplaceOwner);
+    runner.addTest("Tokenizer Quoting And Escapes", testTokenizerQuotingAndEscapes);
+    runner.addTest("Tokenizer Separators", testTokenizerSeparators);
+    runner.addTest("Storage Write Operands", testStorageWriteOperands);
+    runner.addTest("ThreadPool ParallelFor", testThreadPoolParallelFor);
+    runner.addTest("PluginManifest Round Trip", testPluginManifestRoundTrip);
+    runner.addTest("BatchRunner Script", testBatchRunnerScript);
+    runner.addTest("ThreadPool Captured Jobs", testCapturedJobs);
+    runner.addTest("ControlServer Sessions", testControlServerSessions);
+    runner.addTest("ControlServer Sessions Wait On Jobs", testControlSessionsWaitOnJobs);
+    runner.addTest("ControlServer Binary Replies", testControlBinaryReplies);
+    runner.addTest("ControlServer Hangup Mid Request", testControlHangupMidRequest);
+    runner.addTest("BootGraph Dependencies", testBootGraphDependencies);
+    runner.addTest("Pipeline Backpressure", testPipelineBackpressure);
+    runner.addTest("OutputWriter Modes", testOutputWriterModes);
+    runner.addTest("CommandHistory Persistence", testCommandHistoryPersistence);
+    runner.addTest("CommandHistory Indexed Lookups", testCommandHistoryIndexedLookups);
+    runner.addTest("Completion Trie And Engine", testCompletionTrie);
+    runner.addTest("LineEditor Restores Terminal", testLineEditorRestoresTerminal);
+    runner.addTest("MD5 Known Answers", testMd5KnownAnswers);
+    runner.addTest("Hash Kernels Match Scalar", testHashKernels);
+    runner.addTest("Keyspace Partitioning", testKeyspacePartitioning);
+    runner.addTest("DigestSet Batch Cracking", testDigestSetBatchCracking);
+    runner.addTest("Mapped Wordlist Chunks", testMappedWordlistChunks);
+    runner.addTest("Mangling Rules", testManglingRules);
+    runner.addTest("Crack Session Resume", testCrackSessionResume);
+    runner.addTest("Crack Stop In Pool Job", testCrackStopInPoolJob);
+    runner.addTest("Potfile Index", testPotfileIndex);
+    runner.addTest("Hash Identifier", testHashIdentifier);
+    runner.addTest("Kernel Benchmark", testKernelBenchmark);
     
     // Run all tests
     runner.runAllTests();
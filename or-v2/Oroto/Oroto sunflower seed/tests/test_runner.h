@@ -8,6 +8,7 @@
 #include <string>
 #include <chrono>
 #include <exception>
+#include <sstream>
 
 namespace Oroto {
 namespace Testing {
@@ -99,6 +100,14 @@ private:
     }
 };
 
+// Formats assertion operands of any streamable type
+template<typename T>
+std::string toTestString(const T& value) {
+    std::ostringstream ss;
+    ss << value;
+    return ss.str();
+}
+
 // Test assertion macros
 #define ASSERT_TRUE(condition) \
     if (!(condition)) { \
@@ -112,8 +121,8 @@ private:
 
 #define ASSERT_EQ(expected, actual) \
     if ((expected) != (actual)) { \
-        throw std::runtime_error("Assertion failed: expected " + std::to_string(expected) + \
-                               " but got " + std::to_string(actual)); \
+        throw std::runtime_error("Assertion failed: expected " + Oroto::Testing::toTestString(expected) + \
+                               " but got " + Oroto::Testing::toTestString(actual)); \
     }
 
 #define ASSERT_NE(expected, actual) \
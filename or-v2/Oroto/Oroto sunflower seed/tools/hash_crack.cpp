@@ -1,6 +1,11 @@
 
 #include "../lib/oroto_shell.h"
 #include "../lib/colors.h"
+#include "../lib/batch_runner.h"
+#include "../lib/thread_pool.h"
+#include "../lib/output_writer.h"
+#include "../lib/hash_cracker.h"
+#include "../lib/potfile.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -8,137 +13,1088 @@
 #include <thread>
 #include <random>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <charconv>
+#include <memory>
+#include <optional>
+#include <map>
+#include <algorithm>
+#include <iterator>
+#include <cctype>
+#include <cstring>
+
+using Oroto::Tone;
 
 void simulateCracking(int milliseconds) {
+    // Delays are where a killed background job stops
+    Oroto::ThreadPool::cancellationPoint();
+    if (Oroto::isBatchMode()) {
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
+// Redrawn in place, so only a terminal gets it
 void showProgressBar(int percentage) {
-    std::cout << "\r" << YELLOW << "[CRACK] Progress: [";
+    if (!Oroto::out().human()) {
+        return;
+    }
+    std::string bar = "\r" YELLOW "[CRACK] Progress: [";
     int pos = percentage / 5;
     for (int i = 0; i < 20; ++i) {
-        if (i < pos) std::cout << GREEN << "█";
-        else std::cout << WHITE << "░";
+        bar += i < pos ? GREEN "█" : WHITE "░";
     }
-    std::cout << YELLOW << "] " << percentage << "%" << RESET;
+    bar += YELLOW "] " + std::to_string(percentage) + "%" RESET;
+    Oroto::out().decoration(bar);
     std::cout.flush();
 }
 
-void performDictionaryAttack(const std::string& hash) {
-    std::cout << GREEN << "[CRACK] Starting dictionary attack on MD5 hash" << RESET << "\n";
-    std::cout << WHITE << "Hash: " << hash << RESET << "\n";
-    std::cout << WHITE << "Method: Dictionary + Rule-based" << RESET << "\n\n";
-    
-    std::vector<std::string> commonPasswords = {
-        "password", "123456", "password123", "admin", "root", "test", 
-        "hello", "world", "login", "pass", "secret", "qwerty", "abc123"
-    };
-    
-    for (int i = 0; i <= 100; i += 5) {
-        showProgressBar(i);
-        simulateCracking(200 + (rand() % 300));
-    }
-    
-    std::cout << "\n\n";
-    
-    if (hash.length() == 32 && rand() % 3 == 0) {
-        std::string cracked = commonPasswords[rand() % commonPasswords.size()];
-        std::cout << BOLD << GREEN << "🎉 HASH CRACKED SUCCESSFULLY! 🎉" << RESET << "\n";
-        std::cout << WHITE << "Original text: " << BOLD << GREEN << cracked << RESET << "\n";
-        std::cout << WHITE << "Time taken: " << GREEN << (rand() % 60 + 10) << " seconds" << RESET << "\n";
-        std::cout << WHITE << "Attempts: " << GREEN << (rand() % 10000 + 1000) << RESET << "\n\n";
-    } else if (hash.length() != 32) {
-        std::cout << RED << "[ERROR] Invalid MD5 hash format" << RESET << "\n";
-        std::cout << YELLOW << "[HINT] MD5 hashes are exactly 32 hexadecimal characters" << RESET << "\n\n";
+namespace {
+
+// Used when no --wordlist is given: the most common leaked passwords
+const char* const BUILTIN_WORDLIST =
+    "123456\npassword\n12345678\nqwerty\n123456789\n12345\n1234\n111111\n1234567\ndragon\n"
+    "123123\nbaseball\nabc123\nfootball\nmonkey\nletmein\n696969\nshadow\nmaster\n666666\n"
+    "qwertyuiop\n123321\nmustang\n1234567890\nmichael\n654321\nsuperman\n1qaz2wsx\n7777777\n"
+    "121212\n000000\nqazwsx\n123qwe\nkiller\ntrustno1\njordan\njennifer\nzxcvbnm\nasdfgh\n"
+    "hunter\nbuster\nsoccer\nharley\nbatman\nandrew\ntigger\nsunshine\niloveyou\n2000\n"
+    "charlie\nrobert\nthomas\nhockey\nranger\ndaniel\nstarwars\nklaster\n112233\ngeorge\n"
+    "computer\nmichelle\njessica\npepper\n1111\nzxcvbn\n555555\n11111111\n131313\nfreedom\n"
+    "777777\npass\nmaggie\n159753\naaaaaa\nginger\nprincess\njoshua\ncheese\namanda\n"
+    "summer\nlove\nashley\nnicole\nchelsea\nbiteme\nmatthew\naccess\nyankees\n987654321\n"
+    "dallas\naustin\nthunder\ntaylor\nmatrix\nadmin\nroot\ntest\nhello\nworld\nlogin\n"
+    "secret\npassword1\npassword123\nwelcome\ntoor\nchangeme\n";
+
+// --rules=common: the mangling people actually do to a base word, in the
+// usual rule syntax (see mangling_rules.h)
+const char* const BUILTIN_RULES =
+    ":\nc\nu\nr\nd\nt\n$1\n$!\nc $1\nc $!\n$1 $2 $3\nc $1 $2 $3\n$1 $2\n$0 $1\n$2 $0 $2 $4\n"
+    "$2 $0 $2 $5\n^1\n] \nc ]\n'8\nsa@\nsa4 se3 si1 so0\nsa@ so0 ss$\nc sa4 se3 si1 so0\n"
+    "sa4 se3 si1 so0 ss5 st7\nso0\nse3\nc so0\n";
+
+// Reads --rules (a file, or "common" for the built-in set), one rule per
+// line; blank lines and '#' comments are skipped. Lines that do not compile
+// are left out with a warning, as other crackers do.
+Oroto::Status loadRules(std::string_view spec, Oroto::RuleSet& rules) {
+    std::ifstream file;
+    std::istringstream builtin;
+    std::istream* input = &builtin;
+    if (spec == "common") {
+        builtin.str(BUILTIN_RULES);
     } else {
-        std::cout << RED << "❌ Hash could not be cracked" << RESET << "\n";
-        std::cout << YELLOW << "[INFO] Hash may use a complex password not in dictionary" << RESET << "\n";
-        std::cout << YELLOW << "[HINT] Try brute force or larger wordlist" << RESET << "\n\n";
-    }
-}
-
-void performBruteForce(const std::string& hash __attribute__((unused))) {
-    std::cout << GREEN << "[CRACK] Starting brute force attack" << RESET << "\n";
-    std::cout << WHITE << "Character set: a-z, A-Z, 0-9" << RESET << "\n";
-    std::cout << WHITE << "Max length: 6 characters" << RESET << "\n\n";
-    
-    for (int i = 0; i <= 100; i += 3) {
-        showProgressBar(i);
-        simulateCracking(400 + (rand() % 200));
-        
-        if (i > 30 && rand() % 20 == 0) {
-            std::cout << "\n\n";
-            std::cout << BOLD << GREEN << "🔓 BRUTE FORCE SUCCESS!" << RESET << "\n";
-            std::cout << WHITE << "Password found: " << BOLD << GREEN << "pass1" << RESET << "\n";
-            std::cout << WHITE << "Combinations tried: " << GREEN << (rand() % 1000000 + 100000) << RESET << "\n\n";
+        file.open(std::string(spec));
+        if (!file) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Cannot open rules file: ", spec});
+            return Oroto::makeError(Oroto::ErrorCode::FILE_NOT_FOUND);
+        }
+        input = &file;
+    }
+    size_t number = 0;
+    size_t rejected = 0;
+    std::string firstRejected;
+    std::string line;
+    while (std::getline(*input, line)) {
+        ++number;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!rules.add(line) && rejected++ == 0) {
+            firstRejected = std::to_string(number) + ": " + line;
+        }
+    }
+    if (rejected > 0) {
+        Oroto::out().message(Tone::WARNING, "CRACK", {"Skipped ", std::to_string(rejected),
+                                                      " invalid rules, first at line ", firstRejected});
+    }
+    if (rules.empty()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"No usable rules in ", spec});
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    return Oroto::ok();
+}
+
+std::string formatRate(double hashesPerSecond) {
+    static const char* const UNITS[] = {"H/s", "kH/s", "MH/s", "GH/s"};
+    size_t unit = 0;
+    while (hashesPerSecond >= 1000.0 && unit + 1 < std::size(UNITS)) {
+        hashesPerSecond /= 1000.0;
+        ++unit;
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << hashesPerSecond << " " << UNITS[unit];
+    return text.str();
+}
+
+std::string formatSeconds(double seconds) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3) << seconds << " s";
+    return text.str();
+}
+
+void showCrackStats(const Oroto::CrackResult& result, Tone tone) {
+    Oroto::out().field("Attempts", std::to_string(result.attempts), tone, 0);
+    Oroto::out().field("Time taken", formatSeconds(result.seconds), tone, 0);
+    Oroto::out().field("Speed", formatRate(result.hashesPerSecond()), tone, 0);
+}
+
+// Tells the user why the hash was rejected
+bool parseTarget(const std::string& hash, Oroto::CrackTarget& target) {
+    if (Oroto::CrackTarget::parse(hash, target)) {
+        return true;
+    }
+    const Oroto::HashSignature* signature = Oroto::hashIdentifier().best(hash);
+    if (signature) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"No cracking kernel for ", signature->name, " hashes"});
+    } else {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Invalid hash format");
+    }
+    Oroto::out().message(Tone::HINT, "HINT", "MD5, SHA-1 and SHA-256 hashes are 32, 40 and 64 hexadecimal characters");
+    Oroto::out().blank();
+    return false;
+}
+
+void showKernel(const Oroto::HashKernel& kernel) {
+    Oroto::out().field("Kernel", std::string(kernel.name) + " (" + std::to_string(kernel.lanes) +
+                       (kernel.lanes == 1 ? " lane)" : " lanes)"), Tone::PLAIN, 0);
+}
+
+// Progress callback that redraws the bar only when the percentage changes
+Oroto::CrackProgress progressBar(int& shown) {
+    return [&shown](uint64_t, double fraction) {
+        int percentage = static_cast<int>(fraction * 100);
+        if (fraction >= 0.0 && percentage != shown) {
+            showProgressBar(percentage);
+            shown = percentage;
+        }
+    };
+}
+
+// A stopped attack leaves the bar where it got to
+void finishProgressBar(int shown, bool complete = true) {
+    if (shown >= 0) {
+        if (complete) {
+            showProgressBar(100);
+        }
+        Oroto::out().decoration("\n\n");
+    }
+}
+
+// "a-z0-9" -> "abc...xyz0123456789"; repeated characters are dropped
+std::string expandCharset(std::string_view spec) {
+    std::string charset;
+    bool seen[256] = {};
+    auto add = [&](unsigned char c) {
+        if (!seen[c]) {
+            seen[c] = true;
+            charset += static_cast<char>(c);
+        }
+    };
+    for (size_t i = 0; i < spec.size(); ++i) {
+        unsigned char first = static_cast<unsigned char>(spec[i]);
+        if (i + 2 < spec.size() && spec[i + 1] == '-' && static_cast<unsigned char>(spec[i + 2]) >= first) {
+            for (unsigned c = first; c <= static_cast<unsigned char>(spec[i + 2]); ++c) {
+                add(static_cast<unsigned char>(c));
+            }
+            i += 2;
+        } else {
+            add(first);
+        }
+    }
+    return charset;
+}
+
+// "MD5 hash" or "1200 MD5 hashes"
+std::string describeTargets(const Oroto::DigestSet& targets) {
+    std::string name = Oroto::hashAlgorithmName(targets.algorithm());
+    return targets.size() == 1 ? name + " hash" : std::to_string(targets.size()) + " " + name + " hashes";
+}
+
+// One row per cracked hash, then the totals
+void showCracked(const Oroto::DigestSet& targets, const Oroto::CrackResult& result) {
+    size_t digestSize = Oroto::digestSize(targets.algorithm());
+    for (const auto& cracked : result.cracked) {
+        Oroto::out().row({{"hash", Oroto::toHex(targets.digest(cracked.target), digestSize), 0},
+                          {"plaintext", cracked.plaintext, 0}}, Tone::OK);
+    }
+    Oroto::out().blank();
+    Oroto::out().field("Cracked", std::to_string(result.cracked.size()) + " of " + std::to_string(targets.size()),
+                       result.found ? Tone::OK : Tone::ERROR, 0);
+    showCrackStats(result, result.found ? Tone::OK : Tone::PLAIN);
+    Oroto::out().blank();
+}
+
+// Hashes of a --hashfile, grouped by the kernel each one routes to
+struct HashFileTargets {
+    std::map<Oroto::HashAlgorithm, std::unique_ptr<Oroto::DigestSet>> groups;
+    std::map<std::string, size_t> uncrackable;   // formats known but without a kernel
+    size_t skipped = 0;                          // repeats and lines that are no known hash
+};
+
+// One hash per line; blank lines and '#' comments are skipped. Each line is
+// identified on its own, so a dump mixing formats is split by kernel
+// instead of being cut short at the first hash of another type.
+bool loadHashFile(const std::string& path, HashFileTargets& loaded) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        size_t last = line.find_last_not_of(" \t\r");
+        std::string_view hash = std::string_view(line).substr(first, last - first + 1);
+        Oroto::CrackTarget target;
+        if (!Oroto::CrackTarget::parse(hash, target)) {
+            const Oroto::HashSignature* signature = Oroto::hashIdentifier().best(hash);
+            if (signature) {
+                ++loaded.uncrackable[signature->name];
+            } else {
+                ++loaded.skipped;
+            }
+            continue;
+        }
+        auto& group = loaded.groups[target.algorithm];
+        if (!group) {
+            group = std::make_unique<Oroto::DigestSet>(target.algorithm);
+        }
+        if (!group->add(target.digest.data())) {
+            ++loaded.skipped;
+        }
+    }
+    return true;
+}
+
+// "sha-256", "SHA256" and "sha256" all name SHA-256
+bool sameHashType(std::string_view a, std::string_view b) {
+    auto next = [](std::string_view text, size_t& i) {
+        while (i < text.size() && text[i] == '-') {
+            ++i;
+        }
+        return i < text.size() ? std::tolower(static_cast<unsigned char>(text[i++])) : -1;
+    };
+    size_t i = 0, j = 0;
+    for (;;) {
+        int x = next(a, i);
+        int y = next(b, j);
+        if (x != y) {
+            return false;
+        }
+        if (x < 0) {
+            return true;
+        }
+    }
+}
+
+// The group of a loaded hash file to attack: --hash-type, else the largest.
+// The rest are reported as left out. Null, with the error shown, if there
+// is nothing to attack.
+std::unique_ptr<Oroto::DigestSet> chooseHashGroup(HashFileTargets& loaded, std::string_view hashFile,
+                                                  std::string_view hashType) {
+    auto chosen = loaded.groups.end();
+    for (auto it = loaded.groups.begin(); it != loaded.groups.end(); ++it) {
+        bool wanted = hashType.empty() ? chosen == loaded.groups.end() || it->second->size() > chosen->second->size()
+                                       : sameHashType(hashType, Oroto::hashAlgorithmName(it->first));
+        if (wanted) {
+            chosen = it;
+        }
+    }
+    if (chosen == loaded.groups.end()) {
+        if (!hashType.empty()) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"No ", hashType, " hashes in ", hashFile});
+        } else {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"No MD5, SHA-1 or SHA-256 hashes in ", hashFile});
+        }
+        for (const auto& [name, count] : loaded.uncrackable) {
+            Oroto::out().field(name, std::to_string(count) + " (no cracking kernel)", Tone::WARNING, 0);
+        }
+        return nullptr;
+    }
+    std::unique_ptr<Oroto::DigestSet> targets = std::move(chosen->second);
+    Oroto::out().message(Tone::OK, "CRACK", {"Loaded ", std::to_string(targets->size()), " ",
+                                             Oroto::hashAlgorithmName(targets->algorithm()),
+                                             targets->size() == 1 ? " hash from " : " hashes from ", hashFile});
+    for (const auto& [algorithm, group] : loaded.groups) {
+        if (group) {
+            std::string name = Oroto::hashAlgorithmName(algorithm);
+            std::string option = name;
+            option.erase(std::remove(option.begin(), option.end(), '-'), option.end());
+            std::transform(option.begin(), option.end(), option.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            Oroto::out().message(Tone::WARNING, "CRACK", {"Left out ", std::to_string(group->size()), " ", name,
+                                                          group->size() == 1 ? " hash" : " hashes",
+                                                          "; crack them with --hash-type=", option});
+        }
+    }
+    for (const auto& [name, count] : loaded.uncrackable) {
+        Oroto::out().message(Tone::WARNING, "CRACK", {"Left out ", std::to_string(count), " ", name,
+                                                      count == 1 ? " hash" : " hashes", ": no cracking kernel"});
+    }
+    if (loaded.skipped > 0) {
+        Oroto::out().message(Tone::WARNING, "CRACK", {"Skipped ", std::to_string(loaded.skipped),
+                                                      " lines (duplicates or not hashes)"});
+    }
+    Oroto::out().blank();
+    return targets;
+}
+
+// Lower-case hex of every target, as the potfile records them
+std::vector<std::string> targetHashes(const Oroto::DigestSet& targets) {
+    size_t digestSize = Oroto::digestSize(targets.algorithm());
+    std::vector<std::string> hashes;
+    hashes.reserve(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
+        hashes.push_back(Oroto::toHex(targets.digest(i), digestSize));
+    }
+    return hashes;
+}
+
+// Answers the targets the potfile already knows and returns the ones left
+// to attack, or null when there are none
+std::unique_ptr<Oroto::DigestSet> skipPotfileHits(std::unique_ptr<Oroto::DigestSet> targets) {
+    Oroto::Potfile& potfile = Oroto::getPotfile();
+    if (!potfile.isOpen()) {
+        return targets;
+    }
+    std::vector<std::string> hashes = targetHashes(*targets);
+    std::vector<bool> known(hashes.size(), false);
+    std::vector<Oroto::PotEntry> hits;
+    potfile.lookupAll(hashes, [&](size_t i, const std::string& plaintext) {
+        known[i] = true;
+        hits.push_back({hashes[i], plaintext});
+    });
+    if (hits.empty()) {
+        return targets;
+    }
+    if (targets->size() == 1) {
+        Oroto::out().line("🎉 HASH FOUND IN POTFILE", Tone::OK);
+        Oroto::out().field("Original text", hits.front().plaintext, Tone::OK, 0);
+        Oroto::out().blank();
+        return nullptr;
+    }
+    for (const auto& hit : hits) {
+        Oroto::out().row({{"hash", hit.hash, 0}, {"plaintext", hit.plaintext, 0}}, Tone::OK);
+    }
+    Oroto::out().blank();
+    Oroto::out().field("In potfile", std::to_string(hits.size()) + " of " + std::to_string(targets->size()),
+                       Tone::OK, 0);
+    Oroto::out().blank();
+    if (hits.size() == targets->size()) {
+        return nullptr;
+    }
+    auto rest = std::make_unique<Oroto::DigestSet>(targets->algorithm());
+    for (size_t i = 0; i < targets->size(); ++i) {
+        if (!known[i]) {
+            rest->add(targets->digest(i));
+        }
+    }
+    return rest;
+}
+
+// The checkpoint file of one crack run. A new run saves its arguments so
+// 'crack --resume NAME' can rebuild the same attack; a resumed one carries
+// on from the loaded state. The file only appears once a checkpoint is due,
+// and is removed when the attack runs to the end. Whatever was cracked goes
+// to the potfile, if the run uses one.
+class SessionRun {
+private:
+    std::string name_;
+    std::string path_;
+    Oroto::CrackSession session_;
+    bool resumed_;
+    double interval_;
+    Oroto::CrackResume resume_;
+    const Oroto::DigestSet* targets_ = nullptr;
+    bool warned_ = false;
+    Oroto::Potfile* potfile_ = nullptr;
+
+    void record(const Oroto::DigestSet& targets, const Oroto::CrackResult& result) {
+        if (!potfile_ || result.cracked.empty()) {
             return;
         }
+        size_t digestSize = Oroto::digestSize(targets.algorithm());
+        std::vector<Oroto::PotEntry> entries;
+        entries.reserve(result.cracked.size());
+        for (const auto& cracked : result.cracked) {
+            entries.push_back({Oroto::toHex(targets.digest(cracked.target), digestSize), cracked.plaintext});
+        }
+        if (!potfile_->append(entries)) {
+            LOG_WARNING("HashCrack", "Cannot add cracked hashes to the potfile");
+        }
+    }
+
+    void save(const Oroto::CrackPosition& position, const Oroto::CrackResult& snapshot) {
+        size_t digestSize = Oroto::digestSize(targets_->algorithm());
+        session_.position = position;
+        session_.attempts = snapshot.attempts;
+        session_.seconds = snapshot.seconds;
+        session_.cracked.clear();
+        for (const auto& cracked : snapshot.cracked) {
+            session_.cracked.emplace_back(Oroto::toHex(targets_->digest(cracked.target), digestSize),
+                                          cracked.plaintext);
+        }
+        if (!session_.save(path_) && !warned_) {
+            warned_ = true;
+            LOG_WARNING("HashCrack", "Cannot write session file " + path_);
+        }
+    }
+
+public:
+    // A fresh run; args are everything after 'crack'
+    SessionRun(std::string_view name, const CommandArgs& args, char mode, double interval)
+        : name_(name), path_(Oroto::CrackSession::pathFor(name)), resumed_(false), interval_(interval) {
+        session_.args.assign(args.begin(), args.end());
+        session_.mode = mode;
+    }
+
+    // Continues a loaded session
+    SessionRun(std::string_view name, Oroto::CrackSession session, double interval)
+        : name_(name), path_(Oroto::CrackSession::pathFor(name)), session_(std::move(session)), resumed_(true),
+          interval_(interval) {}
+
+    bool resumed() const { return resumed_; }
+    void recordTo(Oroto::Potfile* potfile) { potfile_ = potfile; }
+    const Oroto::CrackSession& session() const { return session_; }
+
+    // Checkpointing for an attack on targets over input of inputSize (bytes
+    // or candidates). Null, with an error shown, if this resumes a session
+    // whose input has changed since.
+    Oroto::CrackResume* attach(const Oroto::DigestSet& targets, uint64_t inputSize) {
+        if (resumed_ && session_.inputSize != inputSize) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"The input of session ", name_, " changed since it was saved"});
+            return nullptr;
+        }
+        targets_ = &targets;
+        session_.inputSize = inputSize;
+        resume_ = Oroto::CrackResume();
+        resume_.interval = interval_;
+        resume_.save = [this](const Oroto::CrackPosition& position, const Oroto::CrackResult& snapshot) {
+            save(position, snapshot);
+        };
+        if (resumed_) {
+            resume_.start = session_.position;
+            resume_.attempts = session_.attempts;
+            resume_.seconds = session_.seconds;
+            size_t digestSize = Oroto::digestSize(targets.algorithm());
+            for (const auto& [hex, plaintext] : session_.cracked) {
+                uint8_t digest[Oroto::MAX_DIGEST_SIZE];
+                int target = Oroto::parseHex(hex, digest, digestSize) ? targets.find(digest)
+                                                                      : Oroto::DigestSet::NOT_FOUND;
+                if (target != Oroto::DigestSet::NOT_FOUND) {
+                    resume_.cracked.push_back({static_cast<size_t>(target), plaintext});
+                }
+            }
+        }
+        return &resume_;
     }
-    
-    std::cout << "\n\n";
-    std::cout << RED << "⏰ Brute force timeout after 100% completion" << RESET << "\n";
-    std::cout << YELLOW << "[INFO] Password may be longer than 6 characters" << RESET << "\n\n";
+
+    void showResumed() const {
+        if (resumed_) {
+            Oroto::out().field("Resumed", std::to_string(session_.attempts) + " attempts and " +
+                               std::to_string(session_.cracked.size()) + " cracked in earlier runs", Tone::PLAIN, 0);
+        }
+    }
+
+    // After the attack: the file is only kept when it was stopped early, by
+    // SIGINT or SIGTERM (see signalHandler). False then; the attack returns
+    // CANCELLED and the process shuts down from its main thread.
+    bool finish(const Oroto::DigestSet& targets, const Oroto::CrackResult& result) {
+        record(targets, result);
+        if (!result.interrupted) {
+            std::remove(path_.c_str());
+            return true;
+        }
+        Oroto::out().line("⏸ Attack stopped, session saved", Tone::WARNING);
+        showCracked(targets, result);
+        Oroto::out().message(Tone::HINT, "HINT", {"Continue with 'crack --resume ", name_, "'"});
+        return false;
+    }
+};
+
+} // namespace
+
+// Hashes every word of the wordlist (--wordlist=FILE, else a built-in list of
+// common passwords), or each rule's version of it with --rules, and looks it
+// up among the target digests. Files are memory-mapped, split across the
+// thread pool and checkpointed to the session; anything that cannot be
+// mapped (a pipe such as /dev/stdin) is streamed on this thread instead and
+// cannot be resumed.
+Oroto::Status performDictionaryAttack(const Oroto::DigestSet& targets, std::string_view wordlistPath,
+                                      std::string_view rulesSpec, SessionRun& session) {
+    Oroto::RuleSet rules;
+    if (!rulesSpec.empty()) {
+        Oroto::Status loaded = loadRules(rulesSpec, rules);
+        if (!loaded) {
+            return loaded;
+        }
+    }
+    Oroto::MappedWordlist mapped;
+    std::ifstream stream;
+    std::string_view text = BUILTIN_WORDLIST;
+    if (!wordlistPath.empty()) {
+        Oroto::Status opened = mapped.open(std::string(wordlistPath));
+        if (opened) {
+            text = mapped.text();
+        } else if (opened.error() == Oroto::ErrorCode::DEVICE_ERROR) {
+            stream.open(std::string(wordlistPath), std::ios::binary);
+        }
+        if (!opened && !stream.is_open()) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Cannot open wordlist: ", wordlistPath});
+            return Oroto::makeError(Oroto::ErrorCode::FILE_NOT_FOUND);
+        }
+    }
+    Oroto::CrackResume* resume = nullptr;
+    if (stream.is_open() && session.resumed()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"A streamed wordlist cannot be resumed: ", wordlistPath});
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    if (!stream.is_open() && !(resume = session.attach(targets, text.size()))) {
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    Oroto::ThreadPool& pool = Oroto::getThreadPool();
+    const Oroto::HashKernel& kernel = Oroto::bestHashKernel(targets.algorithm());
+    Oroto::out().message(Tone::OK, "CRACK", {"Starting dictionary attack on ", describeTargets(targets)});
+    if (targets.size() == 1) {
+        Oroto::out().field("Hash", Oroto::toHex(targets.digest(0), Oroto::digestSize(targets.algorithm())),
+                           Tone::PLAIN, 0);
+    }
+    Oroto::out().field("Method", rules.empty() ? "Dictionary" : "Dictionary + rules", Tone::PLAIN, 0);
+    Oroto::out().field("Wordlist", wordlistPath.empty() ? std::string_view("built-in common passwords") : wordlistPath,
+                       Tone::PLAIN, 0);
+    if (!rules.empty()) {
+        Oroto::out().field("Rules", std::string(rulesSpec) + " (" + std::to_string(rules.size()) + " rules)",
+                           Tone::PLAIN, 0);
+    }
+    showKernel(kernel);
+    Oroto::out().field("Threads", std::to_string(stream.is_open() ? 1 : pool.workerCount() + 1), Tone::PLAIN, 0);
+    session.showResumed();
+    Oroto::out().blank();
+
+    // Stoppable until the session is saved or removed
+    int shown = -1;
+    Oroto::CrackResult result;
+    std::optional<Oroto::CrackStopScope> stoppable;
+    if (stream.is_open()) {
+        result = Oroto::crackDictionary(targets, stream, 0, progressBar(shown), &kernel, rules.empty() ? nullptr : &rules);
+    } else {
+        stoppable.emplace();
+        result = Oroto::crackWordlist(targets, text, progressBar(shown), &kernel, &pool,
+                                      rules.empty() ? nullptr : &rules, resume);
+    }
+    finishProgressBar(shown, !result.interrupted);
+    if (!session.finish(targets, result)) {
+        return Oroto::makeError(Oroto::ErrorCode::CANCELLED);
+    }
+
+    if (targets.size() > 1) {
+        showCracked(targets, result);
+    } else if (result.found) {
+        Oroto::out().line("🎉 HASH CRACKED SUCCESSFULLY! 🎉", Tone::OK);
+        Oroto::out().field("Original text", result.plaintext, Tone::OK, 0);
+        showCrackStats(result, Tone::OK);
+        Oroto::out().blank();
+    } else {
+        Oroto::out().line("❌ Hash could not be cracked", Tone::ERROR);
+        showCrackStats(result, Tone::PLAIN);
+        Oroto::out().message(Tone::PROGRESS, "INFO", "Hash may use a complex password not in dictionary");
+        Oroto::out().message(Tone::HINT, "HINT", "Try brute force or larger wordlist");
+        Oroto::out().blank();
+    }
+    return Oroto::ok();
 }
 
+// Every string over --charset (ranges allowed, default a-z0-9) from one to
+// --max-length characters (default 6), or every string matching --mask.
+// The keyspace is split across the thread pool and checkpointed to the
+// session.
+Oroto::Status performBruteForce(const Oroto::DigestSet& targets, const CommandArgs& args, SessionRun& session) {
+    static constexpr size_t DEFAULT_MAX_LENGTH = 6;
+    std::vector<Oroto::Keyspace> keyspaces;
+    std::string_view mask = findOption(args, "mask");
+    std::string_view charsetSpec = findOption(args, "charset");
+    size_t maxLength = DEFAULT_MAX_LENGTH;
+    if (!mask.empty()) {
+        Oroto::Keyspace keyspace;
+        if (!Oroto::Keyspace::parseMask(mask, keyspace)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --mask: ", mask});
+            Oroto::out().message(Tone::HINT, "HINT", "Use ?l ?u ?d ?s ?a for character classes, ?? for '?'");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        keyspaces.push_back(std::move(keyspace));
+    } else {
+        if (charsetSpec.empty()) {
+            charsetSpec = "a-z0-9";
+        }
+        std::string_view maxOption = findOption(args, "max-length");
+        if (!maxOption.empty()) {
+            size_t value = 0;
+            auto [end, error] = std::from_chars(maxOption.data(), maxOption.data() + maxOption.size(), value);
+            if (error != std::errc() || end != maxOption.data() + maxOption.size() || value == 0 || value > 16) {
+                Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --max-length: ", maxOption});
+                Oroto::out().message(Tone::HINT, "HINT", "Use a length from 1 to 16");
+                return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+            }
+            maxLength = value;
+        }
+        keyspaces = Oroto::bruteForceKeyspaces(expandCharset(charsetSpec), 1, maxLength);
+    }
+    double candidates = 0.0;
+    for (const auto& keyspace : keyspaces) {
+        candidates += static_cast<double>(keyspace.size());
+    }
+    if (keyspaces.empty() || candidates == 0.0) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "Keyspace is empty or too large to enumerate");
+        Oroto::out().message(Tone::HINT, "HINT", "Use a smaller charset, --max-length or --mask");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    // Sum of the sizes modulo 2^64: enough to tell a different keyspace
+    uint64_t fingerprint = 0;
+    for (const auto& keyspace : keyspaces) {
+        fingerprint += keyspace.size();
+    }
+    Oroto::CrackResume* resume = session.attach(targets, fingerprint);
+    if (!resume) {
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    Oroto::ThreadPool& pool = Oroto::getThreadPool();
+    const Oroto::HashKernel& kernel = Oroto::bestHashKernel(targets.algorithm());
+    Oroto::out().message(Tone::OK, "CRACK", {"Starting brute force attack on ", describeTargets(targets)});
+    if (!mask.empty()) {
+        Oroto::out().field("Mask", mask, Tone::PLAIN, 0);
+    } else {
+        Oroto::out().field("Character set", std::string(charsetSpec) + " (" +
+                           std::to_string(expandCharset(charsetSpec).size()) + " characters)", Tone::PLAIN, 0);
+        Oroto::out().field("Max length", std::to_string(maxLength) + " characters", Tone::PLAIN, 0);
+    }
+    std::ostringstream keyspaceText;
+    keyspaceText << std::setprecision(4) << candidates << " candidates";
+    Oroto::out().field("Keyspace", keyspaceText.str(), Tone::PLAIN, 0);
+    showKernel(kernel);
+    Oroto::out().field("Threads", std::to_string(pool.workerCount() + 1), Tone::PLAIN, 0);
+    session.showResumed();
+    Oroto::out().blank();
+
+    // Stoppable until the session is saved or removed
+    int shown = -1;
+    Oroto::CrackStopScope stoppable;
+    Oroto::CrackResult result = Oroto::crackKeyspaces(targets, keyspaces, progressBar(shown), &kernel, &pool, resume);
+    finishProgressBar(shown, !result.interrupted);
+    if (!session.finish(targets, result)) {
+        return Oroto::makeError(Oroto::ErrorCode::CANCELLED);
+    }
+
+    if (targets.size() > 1) {
+        showCracked(targets, result);
+    } else if (result.found) {
+        Oroto::out().line("🔓 BRUTE FORCE SUCCESS!", Tone::OK);
+        Oroto::out().field("Password found", result.plaintext, Tone::OK, 0);
+        showCrackStats(result, Tone::OK);
+        Oroto::out().blank();
+    } else {
+        Oroto::out().line("❌ Keyspace exhausted without a match", Tone::ERROR);
+        showCrackStats(result, Tone::PLAIN);
+        Oroto::out().message(Tone::PROGRESS, "INFO", "Password is outside this keyspace");
+        Oroto::out().message(Tone::HINT, "HINT", "Try a longer --max-length, a wider --charset or another --mask");
+        Oroto::out().blank();
+    }
+    return Oroto::ok();
+}
+
+// "MD5 (hashcat -m 0)"
+std::string describeSignature(const Oroto::HashSignature& signature) {
+    std::string text = signature.name;
+    if (signature.hashcatMode >= 0) {
+        text += " (hashcat -m " + std::to_string(signature.hashcatMode) + ")";
+    }
+    return text;
+}
+
+void showStrength(Oroto::HashStrength strength) {
+    switch (strength) {
+        case Oroto::HashStrength::CHECKSUM:
+            Oroto::out().field("Security", "None (a checksum, not a password hash)", Tone::ERROR, 0);
+            break;
+        case Oroto::HashStrength::BROKEN:
+            Oroto::out().field("Security", "Weak (Cryptographically broken)", Tone::WARNING, 0);
+            break;
+        case Oroto::HashStrength::FAST:
+            Oroto::out().field("Security", "Unsalted fast digest (cheap to brute force)", Tone::WARNING, 0);
+            break;
+        case Oroto::HashStrength::SLOW:
+            Oroto::out().field("Security", "Strong (salted and deliberately slow)", Tone::OK, 0);
+            break;
+    }
+}
+
+// The most likely format of the hash, whatever else it could be, and the
+// kernel 'crack' would use on it
 void showHashInfo(const std::string& hash) {
-    std::cout << "\n" << BOLD << CYAN << "╔══════════════════════════════════════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << CYAN << "║                        HASH ANALYSIS                            ║" << RESET << "\n";
-    std::cout << BOLD << CYAN << "╚══════════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
-    
-    std::cout << WHITE << "Hash Value: " << GREEN << hash << RESET << "\n";
-    std::cout << WHITE << "Length: " << GREEN << hash.length() << " characters" << RESET << "\n";
-    
-    if (hash.length() == 32) {
-        std::cout << WHITE << "Type: " << GREEN << "MD5 (Message Digest 5)" << RESET << "\n";
-        std::cout << WHITE << "Security: " << YELLOW << "Weak (Cryptographically broken)" << RESET << "\n";
-        std::cout << WHITE << "Crack Difficulty: " << GREEN << "Easy to Medium" << RESET << "\n";
-    } else if (hash.length() == 40) {
-        std::cout << WHITE << "Type: " << GREEN << "SHA-1" << RESET << "\n";
-        std::cout << WHITE << "Security: " << YELLOW << "Deprecated" << RESET << "\n";
-        std::cout << WHITE << "Crack Difficulty: " << YELLOW << "Medium" << RESET << "\n";
-    } else if (hash.length() == 64) {
-        std::cout << WHITE << "Type: " << GREEN << "SHA-256" << RESET << "\n";
-        std::cout << WHITE << "Security: " << GREEN << "Strong" << RESET << "\n";
-        std::cout << WHITE << "Crack Difficulty: " << RED << "Very Hard" << RESET << "\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.title("HASH ANALYSIS");
+
+    out.field("Hash Value", hash, Tone::OK, 0);
+    out.field("Length", std::to_string(hash.length()) + " characters", Tone::OK, 0);
+
+    std::vector<const Oroto::HashSignature*> matches = Oroto::hashIdentifier().identify(hash);
+    if (matches.empty()) {
+        out.field("Type", "Unknown or Invalid", Tone::ERROR, 0);
+        out.blank();
+        return;
+    }
+    out.field("Type", describeSignature(*matches.front()), Tone::OK, 0);
+    std::string others;
+    for (size_t i = 1; i < matches.size(); ++i) {
+        bool repeated = false;
+        for (size_t j = 0; j < i && !repeated; ++j) {
+            repeated = std::strcmp(matches[i]->name, matches[j]->name) == 0;
+        }
+        if (!repeated) {
+            others += (others.empty() ? "" : ", ") + describeSignature(*matches[i]);
+        }
+    }
+    if (!others.empty()) {
+        out.field("Other possibilities", others, Tone::PLAIN, 0);
+    }
+    showStrength(matches.front()->strength);
+    const Oroto::HashSignature* crackable = Oroto::hashIdentifier().crackable(hash);
+    if (crackable) {
+        out.field("Cracker", std::string(Oroto::hashAlgorithmName(crackable->algorithm)) + " kernel", Tone::OK, 0);
     } else {
-        std::cout << WHITE << "Type: " << RED << "Unknown or Invalid" << RESET << "\n";
+        out.field("Cracker", "No kernel for this format", Tone::WARNING, 0);
+    }
+    out.blank();
+}
+
+// Counts every line of a file under its most likely format
+Oroto::Status classifyHashFile(std::string_view path) {
+    Oroto::MappedWordlist mapped;
+    std::string streamed;
+    std::string_view text;
+    Oroto::Status opened = mapped.open(std::string(path));
+    if (opened) {
+        text = mapped.text();
+    } else if (opened.error() == Oroto::ErrorCode::DEVICE_ERROR) {
+        std::ifstream input{std::string(path), std::ios::binary};
+        streamed.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        text = streamed;
+    } else {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Cannot open hash file: ", path});
+        return opened;
+    }
+
+    const Oroto::HashIdentifier& identifier = Oroto::hashIdentifier();
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> counts = identifier.census(text, &Oroto::getThreadPool());
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Formats listed under several prefixes (bcrypt, phpass) are reported once
+    std::vector<std::pair<uint64_t, const Oroto::HashSignature*>> rows;
+    uint64_t lines = counts.back();
+    for (size_t i = 0; i < identifier.signatures().size(); ++i) {
+        const Oroto::HashSignature& signature = identifier.signatures()[i];
+        lines += counts[i];
+        auto same = std::find_if(rows.begin(), rows.end(),
+                                 [&](const auto& row) { return std::strcmp(row.second->name, signature.name) == 0; });
+        if (same != rows.end()) {
+            same->first += counts[i];
+        } else if (counts[i] > 0) {
+            rows.emplace_back(counts[i], &signature);
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    Oroto::out().title("HASH FILE ANALYSIS");
+    Oroto::out().field("File", path, Tone::OK, 0);
+    Oroto::out().blank();
+    for (const auto& [count, signature] : rows) {
+        std::string mode = signature->hashcatMode >= 0 ? std::to_string(signature->hashcatMode) : "-";
+        std::string kernel = signature->crackable ? Oroto::hashAlgorithmName(signature->algorithm) : "-";
+        Oroto::out().row({{"type", signature->name, 22}, {"hashcat", mode, 7}, {"count", std::to_string(count), 10},
+                          {"kernel", kernel, 0}}, signature->crackable ? Tone::OK : Tone::PLAIN);
     }
-    std::cout << "\n";
+    Oroto::out().blank();
+    Oroto::out().field("Lines", std::to_string(lines), Tone::OK, 0);
+    Oroto::out().field("Unknown", std::to_string(counts.back()), counts.back() > 0 ? Tone::WARNING : Tone::OK, 0);
+    Oroto::out().field("Time taken", formatSeconds(seconds), Tone::PLAIN, 0);
+    if (seconds > 0.0) {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(0) << text.size() / seconds / (1 << 20) << " MB/s";
+        Oroto::out().field("Throughput", rate.str(), Tone::PLAIN, 0);
+    }
+    Oroto::out().blank();
+    return Oroto::ok();
 }
 
-void executeHashCrack(const std::vector<std::string>& args) {
-    std::cout << YELLOW << "[CRACK] Loading hash cracking engine..." << RESET << "\n";
+namespace {
+
+// The attack described by args ('oroto crack hash ...'), continuing the
+// loaded session if there is one
+Oroto::Status runHashCrack(const CommandArgs& args, const Oroto::CrackSession* resumed, std::string_view resumedName) {
+    static constexpr double DEFAULT_CHECKPOINT_SECONDS = 10.0;
+    std::string_view sessionName = resumed ? resumedName : findOption(args, "session");
+    std::optional<Oroto::CrackSessionClaim> claim;
+    if (sessionName.empty()) {
+        // Concurrent unnamed attacks (jobs, control sessions) each get a file
+        for (size_t n = 1; !claim || !claim->held(); ++n) {
+            claim.emplace(n == 1 ? std::string("crack") : "crack-" + std::to_string(n));
+        }
+    } else if (!Oroto::CrackSession::validName(sessionName)) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --session: ", sessionName});
+        Oroto::out().message(Tone::HINT, "HINT", "Use letters, digits, '-' and '_'");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    } else if (!claim.emplace(std::string(sessionName)).held()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Session ", sessionName, " is in use by a running attack"});
+        Oroto::out().message(Tone::HINT, "HINT", "Wait for it to finish or pass another --session=NAME");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    sessionName = claim->name();
+    double interval = DEFAULT_CHECKPOINT_SECONDS;
+    std::string_view intervalOption = findOption(args, "checkpoint");
+    if (!intervalOption.empty()) {
+        char* end = nullptr;
+        std::string text(intervalOption);
+        interval = std::strtod(text.c_str(), &end);
+        if (*end != '\0' || !(interval > 0.0)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --checkpoint: ", intervalOption});
+            Oroto::out().message(Tone::HINT, "HINT", "Give the seconds between checkpoints, e.g. --checkpoint=30");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+    }
+
+    Oroto::out().message(Tone::PROGRESS, "CRACK", "Loading hash cracking engine...");
     simulateCracking(1200);
-    
-    if (args.size() < 4) {
-        std::cout << RED << "[ERROR] No hash provided" << RESET << "\n";
-        std::cout << YELLOW << "[USAGE] oroto crack hash [md5_hash]" << RESET << "\n";
-        std::cout << YELLOW << "[EXAMPLE] oroto crack hash 5d41402abc4b2a76b9719d911017c592" << RESET << "\n\n";
-        return;
+
+    // Either one hash from the command line or a whole dump via --hashfile
+    std::unique_ptr<Oroto::DigestSet> targets;
+    std::string_view hashFile = findOption(args, "hashfile");
+    if (!hashFile.empty()) {
+        HashFileTargets loaded;
+        if (!loadHashFile(std::string(hashFile), loaded)) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Cannot open hash file: ", hashFile});
+            return Oroto::makeError(Oroto::ErrorCode::FILE_NOT_FOUND);
+        }
+        targets = chooseHashGroup(loaded, hashFile, findOption(args, "hash-type"));
+        if (!targets) {
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+    } else if (args.size() < 4) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "No hash provided");
+        Oroto::out().message(Tone::PROGRESS, "USAGE", "oroto crack hash HASH|--hashfile=FILE [--hash-type=md5|sha1|sha256] [--mode=dict|brute] [--wordlist=FILE] [--rules=FILE|common] [--charset=a-z0-9] [--max-length=N] [--mask=?l?l?d?d] [--session=NAME] [--potfile=off]");
+        Oroto::out().message(Tone::PROGRESS, "USAGE", "oroto crack hash --resume NAME");
+        Oroto::out().message(Tone::PROGRESS, "EXAMPLE", "oroto crack hash 5d41402abc4b2a76b9719d911017c592");
+        Oroto::out().blank();
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    } else {
+        std::string hash(args[3]);
+        showHashInfo(hash);
+        Oroto::CrackTarget target;
+        if (!parseTarget(hash, target)) {
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+        targets = std::make_unique<Oroto::DigestSet>(target.toSet());
     }
-    
-    std::string hash = args[3];
-    showHashInfo(hash);
-    
-    if (hash.length() == 32) {
-        char choice;
-        std::cout << WHITE << "Select attack method:" << RESET << "\n";
-        std::cout << GREEN << "  [1] Dictionary Attack (Fast)" << RESET << "\n";
-        std::cout << GREEN << "  [2] Brute Force (Slow but thorough)" << RESET << "\n";
-        std::cout << BLUE << "Choice [1-2]: " << RESET;
-        
+
+    // Hashes cracked by any earlier run are answered from the potfile and
+    // left out of the attack; --potfile=off ignores it both ways
+    bool usePotfile = findOption(args, "potfile") != "off";
+    if (usePotfile && !(targets = skipPotfileHits(std::move(targets)))) {
+        if (resumed) {
+            std::remove(Oroto::CrackSession::pathFor(sessionName).c_str());
+        }
+        return Oroto::ok();
+    }
+
+    // --mode=dict|brute (or 1|2) skips the menu; batch runs default to dictionary
+    std::string_view mode = findOption(args, "mode");
+    char choice = '1';
+    if (resumed) {
+        choice = resumed->mode;
+    } else if (mode == "1" || mode == "dict") {
+        choice = '1';
+    } else if (mode == "2" || mode == "brute") {
+        choice = '2';
+    } else if (!mode.empty()) {
+        choice = '?';
+    } else if (!Oroto::isBatchMode()) {
+        Oroto::out().section("Select attack method");
+        Oroto::out().line("  [1] Dictionary Attack (Fast)", Tone::OK);
+        Oroto::out().line("  [2] Brute Force (Slow but thorough)", Tone::OK);
+        Oroto::out().decoration(BLUE "Choice [1-2]: " RESET);
+        std::cout.flush();
+
         std::cin >> choice;
         std::cin.ignore();
-        
-        if (choice == '1') {
-            performDictionaryAttack(hash);
-        } else if (choice == '2') {
-            performBruteForce(hash);
-        } else {
-            std::cout << YELLOW << "[INFO] Defaulting to dictionary attack" << RESET << "\n\n";
-            performDictionaryAttack(hash);
-        }
+    }
+
+    if (choice != '1' && choice != '2') {
+        Oroto::out().message(Tone::PROGRESS, "INFO", "Defaulting to dictionary attack");
+        Oroto::out().blank();
+        choice = '1';
+    }
+    CommandArgs attackArgs(args.begin() + std::min<size_t>(3, args.size()), args.end());
+    std::optional<SessionRun> session;
+    if (resumed) {
+        session.emplace(sessionName, *resumed, interval);
     } else {
-        std::cout << YELLOW << "[INFO] Only MD5 hashes supported in this version" << RESET << "\n\n";
+        session.emplace(sessionName, attackArgs, choice, interval);
+    }
+    if (usePotfile && Oroto::getPotfile().isOpen()) {
+        session->recordTo(&Oroto::getPotfile());
+    }
+    if (choice == '2') {
+        return performBruteForce(*targets, args, *session);
+    }
+    return performDictionaryAttack(*targets, findOption(args, "wordlist"), findOption(args, "rules"), *session);
+}
+
+} // namespace
+
+// 'hashid HASH' names one hash; 'hashid --file=FILE' tallies a whole dump
+Oroto::Status executeHashId(const CommandArgs& args) {
+    std::string_view file = findOption(args, "file");
+    if (!file.empty()) {
+        return classifyHashFile(file);
+    }
+    Oroto::out().message(Tone::PROGRESS, "HASHID", {"Analyzing hash: ", args[1]});
+    showHashInfo(std::string(args[1]));
+    return Oroto::ok();
+}
+
+// 'oroto crack bench': every kernel of every algorithm on 1, 2, 4 ... up to
+// --threads (default: every hardware thread) for --duration seconds each.
+// Efficiency is the rate over threads times the one-thread rate; spread is
+// how unevenly the threads of a run got through the work.
+Oroto::Status executeCrackBench(const CommandArgs& args) {
+    static constexpr double DEFAULT_SECONDS = 1.0;
+    double seconds = DEFAULT_SECONDS;
+    std::string_view durationOption = findOption(args, "duration");
+    if (!durationOption.empty()) {
+        char* end = nullptr;
+        std::string text(durationOption);
+        seconds = std::strtod(text.c_str(), &end);
+        if (*end != '\0' || !(seconds > 0.0) || seconds > 3600.0) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --duration: ", durationOption});
+            Oroto::out().message(Tone::HINT, "HINT", "Give the seconds per run, e.g. --duration=0.5");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+    }
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string_view threadsOption = findOption(args, "threads");
+    if (!threadsOption.empty()) {
+        auto [end, error] = std::from_chars(threadsOption.data(), threadsOption.data() + threadsOption.size(),
+                                            maxThreads);
+        if (error != std::errc() || end != threadsOption.data() + threadsOption.size() || maxThreads == 0 ||
+            maxThreads > 1024) {
+            Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid --threads: ", threadsOption});
+            Oroto::out().message(Tone::HINT, "HINT", "Give the most threads to try, from 1 to 1024");
+            return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+        }
+    }
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::string_view algorithmOption = findOption(args, "algorithm");
+    std::string_view kernelOption = findOption(args, "kernel");
+    std::vector<const Oroto::HashKernel*> kernels;
+    for (Oroto::HashAlgorithm algorithm : {Oroto::HashAlgorithm::MD5, Oroto::HashAlgorithm::SHA1,
+                                           Oroto::HashAlgorithm::SHA256}) {
+        if (!algorithmOption.empty() && !sameHashType(algorithmOption, Oroto::hashAlgorithmName(algorithm))) {
+            continue;
+        }
+        for (const Oroto::HashKernel* kernel : Oroto::hashKernels(algorithm)) {
+            if (kernelOption.empty() || kernelOption == kernel->name) {
+                kernels.push_back(kernel);
+            }
+        }
+    }
+    if (kernels.empty()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "No kernel matches --algorithm and --kernel on this CPU");
+        Oroto::out().message(Tone::HINT, "HINT", "Algorithms are md5, sha1 and sha256; kernels scalar, sse2, avx2 and avx512");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    Oroto::out().title("CRACKER BENCHMARK");
+    Oroto::out().field("Hardware threads", std::to_string(std::thread::hardware_concurrency()), Tone::PLAIN, 0);
+    Oroto::out().field("Runs", std::to_string(kernels.size() * threadCounts.size()) + " of " +
+                       formatSeconds(seconds), Tone::PLAIN, 0);
+    Oroto::out().blank();
+    if (Oroto::out().human()) {
+        Oroto::out().decoration(WHITE "algorithm  kernel   threads  hashes/sec     rate           efficiency  spread" RESET "\n");
+    }
+
+    auto percent = [](double value) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << value * 100.0 << "%";
+        return text.str();
+    };
+    std::map<Oroto::HashAlgorithm, std::pair<double, std::string>> fastest;
+    for (const Oroto::HashKernel* kernel : kernels) {
+        double single = 0.0;
+        for (size_t threads : threadCounts) {
+            Oroto::ThreadPool::cancellationPoint();
+            Oroto::KernelBenchmark run = Oroto::benchmarkKernel(*kernel, threads, seconds);
+            double rate = run.hashesPerSecond();
+            if (threads == 1) {
+                single = rate;
+            }
+            double efficiency = single > 0.0 ? rate / (single * threads) : 0.0;
+            std::string perSecond = std::to_string(static_cast<uint64_t>(rate));
+            Oroto::out().row({{"algorithm", Oroto::hashAlgorithmName(kernel->algorithm), 9},
+                              {"kernel", kernel->name, 7},
+                              {"threads", std::to_string(threads), 7},
+                              {"hashes_per_second", perSecond, 13},
+                              {"rate", formatRate(rate), 13},
+                              {"efficiency", percent(efficiency), 10},
+                              {"spread", percent(run.spread()), 0}},
+                             efficiency >= 0.9 ? Tone::OK : Tone::PLAIN);
+            auto& best = fastest[kernel->algorithm];
+            if (rate > best.first) {
+                best = {rate, std::string(kernel->name) + " on " + std::to_string(threads) +
+                              (threads == 1 ? " thread: " : " threads: ") + formatRate(rate)};
+            }
+        }
+    }
+    Oroto::out().blank();
+    for (const auto& [algorithm, best] : fastest) {
+        Oroto::out().field(std::string("Fastest ") + Oroto::hashAlgorithmName(algorithm), best.second, Tone::OK, 0);
+    }
+    Oroto::out().blank();
+    return Oroto::ok();
+}
+
+Oroto::Status executeHashCrack(const CommandArgs& args) {
+    // --resume NAME rebuilds the saved command line and carries on
+    std::string_view resumeName = findOption(args, "resume");
+    if (resumeName.empty()) {
+        return runHashCrack(args, nullptr, {});
+    }
+    if (!Oroto::CrackSession::validName(resumeName)) {
+        Oroto::out().message(Tone::ERROR, "ERROR", {"Invalid session name: ", resumeName});
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+    Oroto::CrackSession session;
+    Oroto::Status loaded = session.load(Oroto::CrackSession::pathFor(resumeName));
+    if (!loaded) {
+        Oroto::out().message(Tone::ERROR, "ERROR",
+                             {loaded.error() == Oroto::ErrorCode::FILE_NOT_FOUND ? "No saved session named "
+                                                                                  : "Corrupt session file for ",
+                              resumeName});
+        return loaded;
     }
+    CommandArgs resumedArgs(args.get_allocator());
+    resumedArgs.insert(resumedArgs.end(), {"oroto", "crack", "hash"});
+    resumedArgs.insert(resumedArgs.end(), session.args.begin(), session.args.end());
+    Oroto::out().message(Tone::OK, "CRACK", {"Resuming session ", resumeName});
+    return runHashCrack(resumedArgs, &session, resumeName);
 }
@@ -1,20 +1,34 @@
 
 #include "../lib/oroto_shell.h"
 #include "../lib/colors.h"
+#include "../lib/batch_runner.h"
+#include "../lib/thread_pool.h"
+#include "../lib/record_stream.h"
+#include "../lib/completion_trie.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include <random>
+#include <cstdio>
+#include <iomanip>
+
+using Oroto::Tone;
 
 void simulateNetworkScan(int milliseconds) {
+    // Delays are where a killed background job stops
+    Oroto::ThreadPool::cancellationPoint();
+    if (Oroto::isBatchMode()) {
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
 void performPortScan(const std::string& target) {
-    std::cout << GREEN << "[NMAP] Starting port scan on " << target << RESET << "\n";
-    std::cout << WHITE << "Scanning TCP ports 1-1000..." << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "NMAP", {"Starting port scan on ", target});
+    Oroto::out().line("Scanning TCP ports 1-1000...");
+    Oroto::out().blank();
     
     std::vector<int> commonPorts = {21, 22, 23, 25, 53, 80, 110, 135, 139, 143, 443, 993, 995, 1433, 3306, 3389, 5432, 5900, 8080, 8443};
     std::vector<std::string> services = {"ftp", "ssh", "telnet", "smtp", "dns", "http", "pop3", "msrpc", "netbios", "imap", "https", "imaps", "pop3s", "mssql", "mysql", "rdp", "postgresql", "vnc", "http-alt", "https-alt"};
@@ -25,22 +39,25 @@ void performPortScan(const std::string& target) {
         
         bool isOpen = (rand() % 10) > 6;
         if (isOpen) {
-            std::cout << GREEN << "PORT " << std::setfill(' ') << std::setw(5) << commonPorts[i] 
-                      << "/tcp  OPEN   " << services[i] << RESET << "\n";
+            Oroto::out().row({{"port", std::to_string(commonPorts[i]) + "/tcp", -10},
+                              {"state", "OPEN", -5}, {"service", services[i], 0}}, Tone::OK);
             openPorts++;
         }
     }
     
-    std::cout << "\n" << YELLOW << "═══════════════════════════════════════════════════════════════════" << RESET << "\n";
-    std::cout << GREEN << "[NMAP] Scan completed for " << target << RESET << "\n";
-    std::cout << WHITE << "Total open ports found: " << GREEN << openPorts << RESET << "\n";
-    std::cout << WHITE << "Scan time: " << GREEN << (rand() % 30 + 10) << " seconds" << RESET << "\n";
-    std::cout << YELLOW << "═══════════════════════════════════════════════════════════════════" << RESET << "\n\n";
+    Oroto::OutputWriter& out = Oroto::out();
+    out.decoration("\n" YELLOW "═══════════════════════════════════════════════════════════════════" RESET "\n");
+    out.message(Tone::OK, "NMAP", {"Scan completed for ", target});
+    out.field("Total open ports found", std::to_string(openPorts), Tone::OK, 0);
+    out.field("Scan time", std::to_string(rand() % 30 + 10) + " seconds", Tone::OK, 0);
+    out.decoration(YELLOW "═══════════════════════════════════════════════════════════════════" RESET "\n");
+    out.blank();
 }
 
 void performNetworkDiscovery() {
-    std::cout << GREEN << "[NMAP] Performing network discovery scan..." << RESET << "\n";
-    std::cout << WHITE << "Scanning local network 192.168.1.0/24" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "NMAP", "Performing network discovery scan...");
+    Oroto::out().line("Scanning local network 192.168.1.0/24");
+    Oroto::out().blank();
     
     std::vector<std::string> devices = {
         "192.168.1.1    Router/Gateway",
@@ -53,21 +70,170 @@ void performNetworkDiscovery() {
     for (const auto& device : devices) {
         simulateNetworkScan(300 + (rand() % 400));
         if (rand() % 4 != 0) {
-            std::cout << GREEN << "HOST FOUND: " << device << RESET << "\n";
+            Oroto::out().line({"HOST FOUND: ", device}, Tone::OK);
+            Oroto::getCompletionEngine().addHost(device.substr(0, device.find(' ')));
         }
     }
     
-    std::cout << "\n" << GREEN << "[NMAP] Network discovery completed" << RESET << "\n\n";
+    Oroto::out().blank();
+    Oroto::out().message(Tone::OK, "NMAP", "Network discovery completed");
+    Oroto::out().blank();
 }
 
-void executeNmapScan(const std::vector<std::string>& args) {
-    std::cout << YELLOW << "[NMAP] Initializing advanced network scanner..." << RESET << "\n";
+Oroto::Status executeNmapScan(const CommandArgs& args) {
+    Oroto::out().message(Tone::PROGRESS, "NMAP", "Initializing advanced network scanner...");
     simulateNetworkScan(1000);
     
     if (args.size() >= 4) {
-        std::string target = args[3];
+        std::string target(args[3]);
         performPortScan(target);
     } else {
         performNetworkDiscovery();
     }
+    return Oroto::ok();
+}
+
+// Pipeline form: 'nmap 10.0.0.0/24 | filter open | banner | report json'
+
+namespace {
+
+struct PortService {
+    int port;
+    const char* service;
+    const char* banner;
+};
+
+const PortService SCAN_PORTS[] = {
+    {21, "ftp", "220 ProFTPD 1.3.5 Server ready."},
+    {22, "ssh", "SSH-2.0-OpenSSH_8.9p1 Ubuntu-3ubuntu0.6"},
+    {23, "telnet", "Ubuntu 22.04 LTS login:"},
+    {25, "smtp", "220 mail.local ESMTP Postfix"},
+    {53, "dns", "BIND 9.18.12"},
+    {80, "http", "HTTP/1.1 200 OK Server: nginx/1.24.0"},
+    {110, "pop3", "+OK Dovecot ready."},
+    {135, "msrpc", "Microsoft Windows RPC"},
+    {139, "netbios", "Samba smbd 4.15"},
+    {143, "imap", "* OK [CAPABILITY IMAP4rev1] Dovecot ready."},
+    {443, "https", "HTTP/1.1 200 OK Server: Apache/2.4.57"},
+    {993, "imaps", "* OK IMAPS Dovecot ready."},
+    {995, "pop3s", "+OK POP3S Dovecot ready."},
+    {1433, "mssql", "Microsoft SQL Server 2019"},
+    {3306, "mysql", "8.0.35-0ubuntu0.22.04.1"},
+    {3389, "rdp", "Microsoft Terminal Services"},
+    {5432, "postgresql", "PostgreSQL 15.4"},
+    {5900, "vnc", "RFB 003.008"},
+    {8080, "http-alt", "HTTP/1.1 200 OK Server: Jetty(9.4.51)"},
+    {8443, "https-alt", "HTTP/1.1 200 OK Server: Tomcat"},
+};
+
+std::mt19937& scanRandom() {
+    static thread_local std::mt19937 generator(std::random_device{}());
+    return generator;
+}
+
+// One host, or every usable address of an IPv4 /24 to /32 network
+bool expandTargets(std::string_view target, std::vector<std::string>& hosts) {
+    size_t slash = target.find('/');
+    if (slash == std::string_view::npos) {
+        hosts.emplace_back(target);
+        return true;
+    }
+
+    std::string address(target.substr(0, slash));
+    std::string prefixText(target.substr(slash + 1));
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    int prefix = -1;
+    char trailing = 0;
+    if (std::sscanf(address.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &trailing) != 4 ||
+        std::sscanf(prefixText.c_str(), "%d%c", &prefix, &trailing) != 1 ||
+        a > 255 || b > 255 || c > 255 || d > 255 || prefix < 24 || prefix > 32) {
+        return false;
+    }
+
+    uint32_t base = (a << 24) | (b << 16) | (c << 8) | d;
+    uint32_t size = 1u << (32 - prefix);
+    base &= ~(size - 1);
+    // Network and broadcast addresses are not hosts, except in /31 and /32
+    uint32_t first = size > 2 ? 1 : 0;
+    uint32_t last = size > 2 ? size - 2 : size - 1;
+    for (uint32_t i = first; i <= last; ++i) {
+        uint32_t ip = base + i;
+        hosts.push_back(std::to_string(ip >> 24) + "." + std::to_string((ip >> 16) & 0xff) + "." +
+                        std::to_string((ip >> 8) & 0xff) + "." + std::to_string(ip & 0xff));
+    }
+    return true;
+}
+
+const PortService* findService(const std::string& service) {
+    for (const auto& entry : SCAN_PORTS) {
+        if (service == entry.service) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// Emits a host record for each live host, then a port record (open or
+// closed) for each probed port, as soon as that host has been scanned
+Oroto::Status streamNmapScan(const CommandArgs& args, Oroto::RecordStream& stream) {
+    std::vector<std::string> hosts;
+    if (!expandTargets(args[1], hosts)) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "nmap target must be a host or an IPv4 network from /24 to /32");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    auto& random = scanRandom();
+    const bool single = hosts.size() == 1;
+    for (const auto& host : hosts) {
+        simulateNetworkScan(20 + static_cast<int>(random() % 40));
+        // A named target is assumed up; in a range roughly a quarter are not
+        if (!single && random() % 4 == 0) {
+            continue;
+        }
+        // Hosts found up become completions for the next command
+        Oroto::getCompletionEngine().addHost(host);
+        if (!stream.emit(Oroto::Record(Oroto::RecordKind::HOST).set("addr", host).set("state", "up"))) {
+            return Oroto::ok();
+        }
+
+        simulateNetworkScan(40 + static_cast<int>(random() % 60));
+        for (const auto& probe : SCAN_PORTS) {
+            Oroto::Record port(Oroto::RecordKind::PORT);
+            port.set("host", host)
+                .set("port", std::to_string(probe.port))
+                .set("proto", "tcp")
+                .set("state", random() % 10 > 6 ? "open" : "closed")
+                .set("service", probe.service);
+            if (!stream.emit(std::move(port))) {
+                return Oroto::ok();
+            }
+        }
+    }
+    return Oroto::ok();
+}
+
+// Adds a 'banner' field to each open port record; everything else passes through
+Oroto::Status streamBannerGrab(const CommandArgs&, Oroto::RecordStream& stream) {
+    if (!stream.hasInput()) {
+        Oroto::out().message(Tone::ERROR, "ERROR", "banner reads port records: use it after '|'");
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
+    }
+
+    auto& random = scanRandom();
+    Oroto::Record record;
+    while (stream.next(record)) {
+        const std::string* state = record.find("state");
+        const std::string* service = record.find("service");
+        if (record.kind == Oroto::RecordKind::PORT && state && *state == "open" && service) {
+            simulateNetworkScan(30 + static_cast<int>(random() % 40));
+            const PortService* known = findService(*service);
+            record.set("banner", known ? known->banner : "");
+        }
+        if (!stream.emit(std::move(record))) {
+            break;
+        }
+    }
+    return Oroto::ok();
 }
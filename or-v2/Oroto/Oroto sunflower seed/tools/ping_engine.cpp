@@ -1,6 +1,9 @@
 
 #include "../lib/oroto_shell.h"
 #include "../lib/colors.h"
+#include "../lib/batch_runner.h"
+#include "../lib/thread_pool.h"
+#include "../lib/output_writer.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -9,13 +12,21 @@
 #include <random>
 #include <iomanip>
 
+using Oroto::Tone;
+
 void simulatePing(int milliseconds) {
+    // Delays are where a killed background job stops
+    Oroto::ThreadPool::cancellationPoint();
+    if (Oroto::isBatchMode()) {
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
 
 void performContinuousPing(const std::string& target, int count) {
-    std::cout << GREEN << "[PING] Starting ping to " << target << RESET << "\n";
-    std::cout << WHITE << "Sending " << count << " ICMP packets..." << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "PING", {"Starting ping to ", target});
+    Oroto::out().line({"Sending ", std::to_string(count), " ICMP packets..."});
+    Oroto::out().blank();
     
     int successCount = 0;
     int totalTime = 0;
@@ -34,29 +45,33 @@ void performContinuousPing(const std::string& target, int count) {
             if (responseTime < minTime) minTime = responseTime;
             if (responseTime > maxTime) maxTime = responseTime;
             
-            std::cout << WHITE << "64 bytes from " << target << ": icmp_seq=" << i 
-                      << " time=" << responseTime << "ms" << RESET << "\n";
+            Oroto::out().line({"64 bytes from ", target, ": icmp_seq=", std::to_string(i),
+                               " time=", std::to_string(responseTime), "ms"});
         } else {
-            std::cout << RED << "Request timeout for icmp_seq " << i << RESET << "\n";
+            Oroto::out().line({"Request timeout for icmp_seq ", std::to_string(i)}, Tone::ERROR);
         }
     }
     
-    std::cout << "\n" << YELLOW << "═══════════════════════════════════════════════════════════════════" << RESET << "\n";
-    std::cout << GREEN << "[PING] Statistics for " << target << ":" << RESET << "\n";
-    std::cout << WHITE << "Packets: Sent = " << count << ", Received = " << successCount 
-              << ", Lost = " << (count - successCount) << " (" 
-              << ((count - successCount) * 100 / count) << "% loss)" << RESET << "\n";
-    
+    Oroto::OutputWriter& out = Oroto::out();
+    out.decoration("\n" YELLOW "═══════════════════════════════════════════════════════════════════" RESET "\n");
+    out.message(Tone::OK, "PING", {"Statistics for ", target, ":"});
+    out.field("Packets", "Sent = " + std::to_string(count) + ", Received = " + std::to_string(successCount) +
+                         ", Lost = " + std::to_string(count - successCount) + " (" +
+                         std::to_string((count - successCount) * 100 / count) + "% loss)", Tone::PLAIN, 0);
+
     if (successCount > 0) {
-        std::cout << WHITE << "Round-trip times: Minimum = " << minTime << "ms, Maximum = " 
-                  << maxTime << "ms, Average = " << (totalTime / successCount) << "ms" << RESET << "\n";
+        out.field("Round-trip times", "Minimum = " + std::to_string(minTime) + "ms, Maximum = " +
+                                      std::to_string(maxTime) + "ms, Average = " +
+                                      std::to_string(totalTime / successCount) + "ms", Tone::PLAIN, 0);
     }
-    std::cout << YELLOW << "═══════════════════════════════════════════════════════════════════" << RESET << "\n\n";
+    out.decoration(YELLOW "═══════════════════════════════════════════════════════════════════" RESET "\n");
+    out.blank();
 }
 
 void performTraceroute(const std::string& target) {
-    std::cout << GREEN << "[TRACEROUTE] Tracing route to " << target << RESET << "\n";
-    std::cout << WHITE << "Maximum 30 hops, timeout 5 seconds" << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "TRACEROUTE", {"Tracing route to ", target});
+    Oroto::out().line("Maximum 30 hops, timeout 5 seconds");
+    Oroto::out().blank();
     
     std::vector<std::string> hops = {
         "192.168.1.1      (Local Gateway)",
@@ -73,64 +88,78 @@ void performTraceroute(const std::string& target) {
         int time2 = time1 + (rand() % 10) - 5;
         int time3 = time2 + (rand() % 10) - 5;
         
-        std::cout << WHITE << std::setw(2) << (i + 1) << "  " 
-                  << time1 << "ms  " << time2 << "ms  " << time3 << "ms  "
-                  << GREEN << hops[i] << RESET << "\n";
+        std::string times = std::to_string(time1) + "ms  " + std::to_string(time2) + "ms  " +
+                            std::to_string(time3) + "ms";
+        Oroto::out().row({{"hop", std::to_string(i + 1), -2}, {"times", times, 0}, {"host", hops[i], 0}});
     }
     
     int finalTime = 60 + (rand() % 40);
-    std::cout << WHITE << std::setw(2) << (hops.size() + 1) << "  " 
-              << finalTime << "ms  " << (finalTime + 2) << "ms  " << (finalTime + 1) << "ms  "
-              << GREEN << target << " (Destination)" << RESET << "\n\n";
-    
-    std::cout << GREEN << "[TRACEROUTE] Route trace completed" << RESET << "\n\n";
+    std::string times = std::to_string(finalTime) + "ms  " + std::to_string(finalTime + 2) + "ms  " +
+                        std::to_string(finalTime + 1) + "ms";
+    Oroto::out().row({{"hop", std::to_string(hops.size() + 1), -2}, {"times", times, 0},
+                      {"host", target + " (Destination)", 0}}, Tone::OK);
+    Oroto::out().blank();
+    
+    Oroto::out().message(Tone::OK, "TRACEROUTE", "Route trace completed");
+    Oroto::out().blank();
 }
 
 void performAdvancedPing(const std::string& target) {
-    std::cout << GREEN << "[PING] Advanced connectivity analysis for " << target << RESET << "\n\n";
+    Oroto::out().message(Tone::OK, "PING", {"Advanced connectivity analysis for ", target});
+    Oroto::out().blank();
     
     // MTU Discovery
-    std::cout << YELLOW << "[PING] Performing MTU discovery..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "PING", "Performing MTU discovery...");
     simulatePing(1500);
-    std::cout << WHITE << "Maximum MTU size: " << GREEN << "1500 bytes" << RESET << "\n\n";
+    Oroto::out().field("Maximum MTU size", "1500 bytes", Tone::OK, 0);
+    Oroto::out().blank();
     
     // Latency Analysis
-    std::cout << YELLOW << "[PING] Analyzing network latency..." << RESET << "\n";
+    Oroto::out().message(Tone::PROGRESS, "PING", "Analyzing network latency...");
     for (int size : {64, 128, 256, 512, 1024}) {
         simulatePing(300);
         int latency = 20 + (size / 50) + (rand() % 30);
-        std::cout << WHITE << "Packet size " << size << " bytes: " 
-                  << GREEN << latency << "ms" << RESET << "\n";
+        Oroto::out().field("Packet size " + std::to_string(size) + " bytes", std::to_string(latency) + "ms", Tone::OK, 0);
     }
     
-    std::cout << "\n" << GREEN << "[PING] Advanced analysis completed" << RESET << "\n\n";
+    Oroto::out().blank();
+    Oroto::out().message(Tone::OK, "PING", "Advanced analysis completed");
+    Oroto::out().blank();
 }
 
-void executePing(const std::vector<std::string>& args) {
-    std::cout << YELLOW << "[PING] Initializing network connectivity tool..." << RESET << "\n";
+Oroto::Status executePing(const CommandArgs& args) {
+    Oroto::out().message(Tone::PROGRESS, "PING", "Initializing network connectivity tool...");
     simulatePing(800);
     
     if (args.size() < 3) {
-        std::cout << RED << "[ERROR] No target specified" << RESET << "\n";
-        std::cout << YELLOW << "[USAGE] oroto ping [target]" << RESET << "\n";
-        std::cout << YELLOW << "[EXAMPLE] oroto ping google.com" << RESET << "\n\n";
-        return;
+        Oroto::out().message(Tone::ERROR, "ERROR", "No target specified");
+        Oroto::out().message(Tone::PROGRESS, "USAGE", "oroto ping [target] [--mode=1-4]");
+        Oroto::out().message(Tone::PROGRESS, "EXAMPLE", "oroto ping google.com");
+        Oroto::out().blank();
+        return Oroto::makeError(Oroto::ErrorCode::INVALID_ARGUMENTS);
     }
     
-    std::string target = args[2];
-    
-    std::cout << WHITE << "Select ping mode:" << RESET << "\n";
-    std::cout << GREEN << "  [1] Standard Ping (4 packets)" << RESET << "\n";
-    std::cout << GREEN << "  [2] Extended Ping (10 packets)" << RESET << "\n";
-    std::cout << GREEN << "  [3] Traceroute" << RESET << "\n";
-    std::cout << GREEN << "  [4] Advanced Analysis" << RESET << "\n";
-    std::cout << BLUE << "Choice [1-4]: " << RESET;
-    
-    char choice;
-    std::cin >> choice;
-    std::cin.ignore();
+    std::string target(args[2]);
+    
+    // --mode=1..4 skips the menu; batch runs default to a standard ping
+    std::string_view mode = findOption(args, "mode");
+    char choice = '1';
+    if (!mode.empty()) {
+        choice = mode.size() == 1 ? mode[0] : '?';
+    } else if (!Oroto::isBatchMode()) {
+        Oroto::out().section("Select ping mode");
+        Oroto::out().line("  [1] Standard Ping (4 packets)", Tone::OK);
+        Oroto::out().line("  [2] Extended Ping (10 packets)", Tone::OK);
+        Oroto::out().line("  [3] Traceroute", Tone::OK);
+        Oroto::out().line("  [4] Advanced Analysis", Tone::OK);
+        Oroto::out().decoration(BLUE "Choice [1-4]: " RESET);
+        std::cout.flush();
+        
+        std::cin >> choice;
+        std::cin.ignore();
+    }
     
-    std::cout << "\n";
+    Oroto::out().blank();
     
     switch (choice) {
         case '1':
@@ -146,8 +175,10 @@ void executePing(const std::vector<std::string>& args) {
             performAdvancedPing(target);
             break;
         default:
-            std::cout << YELLOW << "[INFO] Defaulting to standard ping" << RESET << "\n\n";
+            Oroto::out().message(Tone::PROGRESS, "INFO", "Defaulting to standard ping");
+            Oroto::out().blank();
             performContinuousPing(target, 4);
             break;
     }
+    return Oroto::ok();
 }